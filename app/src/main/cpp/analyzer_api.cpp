@@ -0,0 +1,565 @@
+#include "analyzer_api.h"
+#include "feature_columns.h"
+#include "parallel_analyzer.h"
+#include "pcm_convert.h"
+#include "pipelined_analyzer.h"
+#include "streaming_analyzer.h"
+#include <android/log.h>
+#include <algorithm>
+#include <memory>
+
+#define LOG_TAG "AnalyzerApi"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+struct AnalyzerInstance {
+    AnalyzerConfig config;
+    std::mutex mutex;
+    EssentiaWrapper wrapper;
+    std::unique_ptr<ParallelBufferAnalyzer> parallel;
+    std::unique_ptr<PipelinedAnalyzer> pipelined;
+};
+
+struct AnalyzerStreamInstance {
+    AnalyzerInstance* owner;
+    std::mutex mutex;           // Guards stream: push() and the frame copy in pull
+    StreamingAnalyzer stream;
+
+    // Pulls are serialized on their own lock, so pushes only ever wait
+    // for a frame copy and never for an analysis
+    std::mutex pullMutex;
+    std::vector<float> pullFrame;
+
+    AnalyzerStreamInstance(AnalyzerInstance* analyzer, int capacitySamples)
+            : owner(analyzer)
+            , stream(analyzer->wrapper, capacitySamples)
+            , pullFrame(stream.getFrameSize()) {}
+};
+
+// Hops of history kept beyond one frame, so the float copy is compacted
+// once every few hops instead of shifted on each
+static const int kRingHistoryHops = 8;
+
+// Consumer side of a float capture ring: every complete frame, one hop
+// apart, analyzed where it lies in the ring. Valid frames only, as analyzeBuffer.
+static std::vector<AudioFeatures> drainRing(EssentiaWrapper& wrapper, PcmRingFloat& ring) {
+    std::vector<AudioFeatures> results;
+    const int frameSize = wrapper.getFrameSize();
+    const int hopSize = wrapper.getHopSize();
+    if (ring.getMaxSpan() < frameSize) {
+        LOGE("Ring span %d is shorter than the frame size %d", ring.getMaxSpan(), frameSize);
+        return results;
+    }
+
+    AudioFeatures features;
+    while (const float* frame = ring.peek(frameSize)) {
+        if (wrapper.analyzeFrame(frame, frameSize, features)) {
+            results.push_back(features);
+        }
+        ring.consume(hopSize);
+    }
+    return results;
+}
+
+// drainRing for an int16 ring. Frames are analyzed from the history's float
+// copy, and only the samples it does not hold yet (normally the newest
+// hop) are converted.
+static std::vector<AudioFeatures> drainRing(EssentiaWrapper& wrapper, PcmRing16& ring, PcmRingHistory& history) {
+    std::vector<AudioFeatures> results;
+    const int frameSize = wrapper.getFrameSize();
+    const int hopSize = wrapper.getHopSize();
+    if (ring.getMaxSpan() < frameSize) {
+        LOGE("Ring span %d is shorter than the frame size %d", ring.getMaxSpan(), frameSize);
+        return results;
+    }
+
+    const int capacity = frameSize + kRingHistoryHops * hopSize;
+    if (static_cast<int>(history.samples.size()) != capacity) {
+        history.samples.assign(capacity, 0.0f);
+        history.length = 0;
+    }
+
+    AudioFeatures features;
+    int64_t frameStart = ring.getConsumed();
+    while (const int16_t* frame = ring.peek(frameSize)) {
+        int64_t offset = frameStart - history.start;
+        if (offset < 0 || offset > history.length) {
+            // Frames were consumed elsewhere (e.g. by the pipeline): start over
+            history.start = frameStart;
+            history.length = 0;
+            offset = 0;
+        } else if (offset + frameSize > capacity) {
+            // Move what is still needed to the front
+            history.length -= static_cast<int>(offset);
+            std::copy(history.samples.begin() + offset, history.samples.begin() + offset + history.length,
+                      history.samples.begin());
+            history.start = frameStart;
+            offset = 0;
+        }
+
+        float* window = history.samples.data() + offset;
+        const int converted = history.length - static_cast<int>(offset);
+        if (converted < frameSize) {
+            convertPcm16ToFloat(frame + converted, window + converted, frameSize - converted);
+            history.length = static_cast<int>(offset) + frameSize;
+        }
+
+        if (wrapper.analyzeFrame(window, frameSize, features)) {
+            results.push_back(features);
+        }
+        ring.consume(hopSize);
+        frameStart += hopSize;
+    }
+    return results;
+}
+
+static bool submitRingFrame(PipelinedAnalyzer& pipeline, const int16_t* frame) {
+    return pipeline.trySubmitPcm16(frame);
+}
+
+static bool submitRingFrame(PipelinedAnalyzer& pipeline, const float* frame) {
+    return pipeline.trySubmit(frame);
+}
+
+// drainRing through the stage pipeline: each frame is copied into a
+// pipeline record, so its hop is released to the producer as soon as the
+// frame is submitted, and results are collected whenever every record is
+// in flight. Returns once the ring is drained and every frame is finished.
+template <typename Sample>
+static std::vector<AudioFeatures> drainRingPipelined(PipelinedAnalyzer& pipeline, SpscRing<Sample>& ring) {
+    std::vector<AudioFeatures> results;
+    const int frameSize = pipeline.getFrameSize();
+    const int hopSize = pipeline.getHopSize();
+    if (ring.getMaxSpan() < frameSize) {
+        LOGE("Ring span %d is shorter than the frame size %d", ring.getMaxSpan(), frameSize);
+        return results;
+    }
+
+    AudioFeatures features;
+    bool valid = false;
+    while (const Sample* frame = ring.peek(frameSize)) {
+        while (!submitRingFrame(pipeline, frame)) {
+            if (!pipeline.receive(features, valid)) return results;
+            if (valid) results.push_back(features);
+        }
+        ring.consume(hopSize);
+    }
+    while (pipeline.receive(features, valid)) {
+        if (valid) results.push_back(features);
+    }
+    return results;
+}
+
+// The analyzer's pipeline, started on first use. Caller holds the analyzer's mutex.
+static PipelinedAnalyzer* ensurePipeline(AnalyzerInstance* analyzer) {
+    std::unique_ptr<PipelinedAnalyzer>& pipelined = analyzer->pipelined;
+    if (!pipelined) {
+        pipelined = std::make_unique<PipelinedAnalyzer>();
+        const AnalyzerConfig& cfg = analyzer->config;
+        if (!pipelined->initialize(cfg.sampleRate, cfg.frameSize, cfg.hopSize, cfg.features, cfg.pitchMethod,
+                                   cfg.pitchTracking, cfg.voiceBand, cfg.harmonicMethod)) {
+            pipelined.reset();
+        }
+    }
+    return pipelined.get();
+}
+
+// Put a pooled analyzer back to the pool's configuration and forget its
+// stream state. Settings are only reapplied where a lease changed them,
+// since some rebuild algorithms.
+static bool restoreAnalyzer(AnalyzerInstance* analyzer, const AnalyzerConfig& defaults) {
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    EssentiaWrapper& wrapper = analyzer->wrapper;
+    AnalyzerConfig& cfg = analyzer->config;
+    bool ok = true;
+
+    if (cfg.pitchMethod != defaults.pitchMethod) ok = wrapper.setPitchMethod(defaults.pitchMethod) && ok;
+    if (cfg.voiceBand != defaults.voiceBand) ok = wrapper.setVoiceBand(defaults.voiceBand) && ok;
+    if (wrapper.getFeatureSet() != (defaults.features | kFeaturePitch)) {
+        ok = wrapper.setFeatureSet(defaults.features) && ok;
+    }
+    wrapper.setHarmonicMethod(defaults.harmonicMethod);
+    wrapper.setPitchTracking(defaults.pitchTracking);
+    wrapper.resetPitchTrack();
+
+    cfg = defaults;
+    cfg.features = wrapper.getFeatureSet();
+    analyzer->parallel.reset();
+    analyzer->pipelined.reset();
+    return ok;
+}
+
+// C-style functions for JNI
+extern "C" {
+AnalyzerHandle createAnalyzer(const AnalyzerConfig* config) {
+    AnalyzerConfig cfg = config ? *config : AnalyzerConfig();
+    if (cfg.sampleRate <= 0 || cfg.frameSize <= 0 || cfg.hopSize <= 0) {
+        LOGE("Invalid analyzer config: sampleRate=%d, frameSize=%d, hopSize=%d",
+             cfg.sampleRate, cfg.frameSize, cfg.hopSize);
+        return nullptr;
+    }
+
+    try {
+        auto analyzer = std::make_unique<AnalyzerInstance>();
+        analyzer->config = cfg;
+        analyzer->wrapper.setPitchMethod(cfg.pitchMethod);
+        analyzer->wrapper.setHarmonicMethod(cfg.harmonicMethod);
+        analyzer->wrapper.setPitchTracking(cfg.pitchTracking);
+        analyzer->wrapper.setVoiceBand(cfg.voiceBand);
+        if (!analyzer->wrapper.initialize(cfg.sampleRate, cfg.frameSize, cfg.hopSize, cfg.features)) {
+            return nullptr;
+        }
+        return analyzer.release();
+    } catch (...) {
+        LOGE("Exception in createAnalyzer");
+        return nullptr;
+    }
+}
+
+bool analyzeWithAnalyzer(AnalyzerHandle analyzer, const float* audioData, int length, AudioFeatures* features) {
+    if (analyzer == nullptr || features == nullptr) {
+        LOGE("Invalid handle in analyzeWithAnalyzer");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.analyzeFrame(audioData, length, *features);
+}
+
+std::vector<AudioFeatures> analyzeBufferWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferWithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.analyzeBuffer(audioBuffer, bufferLength, hopSize);
+}
+
+bool analyzerSharesLogMelGrid(AnalyzerHandle analyzer) {
+    if (analyzer == nullptr) return false;
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.sharesLogMelGrid();
+}
+
+std::vector<AudioFeatures> analyzeBufferWithLogMelWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, float* logMel) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferWithLogMelWithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.analyzeBufferWithLogMel(audioBuffer, bufferLength, logMel);
+}
+
+std::vector<AudioFeatures> analyzeBufferParallelWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize, int numThreads) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferParallelWithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+
+    // (Re)build the worker pool when the requested size no longer matches
+    std::unique_ptr<ParallelBufferAnalyzer>& parallel = analyzer->parallel;
+    if (!parallel || parallel->getThreadCount() != numThreads) {
+        parallel = std::make_unique<ParallelBufferAnalyzer>();
+        const AnalyzerConfig& cfg = analyzer->config;
+        if (!parallel->initialize(numThreads, cfg.sampleRate, cfg.frameSize, cfg.hopSize,
+                                  cfg.features, cfg.pitchMethod, cfg.pitchTracking, cfg.voiceBand,
+                                  cfg.harmonicMethod)) {
+            parallel.reset();
+            return std::vector<AudioFeatures>();
+        }
+    }
+
+    return parallel->analyzeBuffer(audioBuffer, bufferLength, hopSize);
+}
+
+std::vector<AudioFeatures> analyzeBufferPipelinedWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferPipelinedWithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    PipelinedAnalyzer* pipeline = ensurePipeline(analyzer);
+    if (pipeline == nullptr) {
+        return std::vector<AudioFeatures>();
+    }
+    return pipeline->analyzeBuffer(audioBuffer, bufferLength, hopSize);
+}
+
+bool analyzePcm16WithAnalyzer(AnalyzerHandle analyzer, const int16_t* pcm, int length, AudioFeatures* features) {
+    if (analyzer == nullptr || features == nullptr) {
+        LOGE("Invalid handle in analyzePcm16WithAnalyzer");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.analyzeFramePcm16(pcm, length, *features);
+}
+
+std::vector<AudioFeatures> analyzeBufferPcm16WithAnalyzer(AnalyzerHandle analyzer, const int16_t* pcm, int bufferLength, int hopSize) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferPcm16WithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzer->wrapper.analyzeBufferPcm16(pcm, bufferLength, hopSize);
+}
+
+std::vector<AudioFeatures> analyzeRingPcm16WithAnalyzer(AnalyzerHandle analyzer, PcmRing16* ring,
+                                                        PcmRingHistory* history) {
+    if (analyzer == nullptr || ring == nullptr || history == nullptr) {
+        LOGE("Invalid handle in analyzeRingPcm16WithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    if (analyzer->config.pipelined) {
+        PipelinedAnalyzer* pipeline = ensurePipeline(analyzer);
+        return pipeline ? drainRingPipelined(*pipeline, *ring) : std::vector<AudioFeatures>();
+    }
+    return drainRing(analyzer->wrapper, *ring, *history);
+}
+
+std::vector<AudioFeatures> analyzeRingFloatWithAnalyzer(AnalyzerHandle analyzer, PcmRingFloat* ring) {
+    if (analyzer == nullptr || ring == nullptr) {
+        LOGE("Invalid handle in analyzeRingFloatWithAnalyzer");
+        return std::vector<AudioFeatures>();
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    if (analyzer->config.pipelined) {
+        PipelinedAnalyzer* pipeline = ensurePipeline(analyzer);
+        return pipeline ? drainRingPipelined(*pipeline, *ring) : std::vector<AudioFeatures>();
+    }
+    return drainRing(analyzer->wrapper, *ring);
+}
+
+size_t columnarCapacityForAnalyzer(AnalyzerHandle analyzer, int bufferLength, int hopSize) {
+    if (analyzer == nullptr) return 0;
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return featureColumnsCapacity(analyzer->wrapper, bufferLength, hopSize);
+}
+
+long analyzeBufferColumnarWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize, void* out, size_t outCapacity) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in analyzeBufferColumnarWithAnalyzer");
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    return analyzeBufferColumnar(analyzer->wrapper, audioBuffer, bufferLength, hopSize, out, outCapacity);
+}
+
+bool setAnalyzerFeatureSet(AnalyzerHandle analyzer, FeatureSet features) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in setAnalyzerFeatureSet");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    if (!analyzer->wrapper.setFeatureSet(features)) {
+        return false;
+    }
+
+    // Workers and stages are rebuilt with the new set on their next call
+    analyzer->config.features = analyzer->wrapper.getFeatureSet();
+    analyzer->parallel.reset();
+    analyzer->pipelined.reset();
+    return true;
+}
+
+bool setAnalyzerPitchTracking(AnalyzerHandle analyzer, bool enabled) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in setAnalyzerPitchTracking");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    analyzer->wrapper.setPitchTracking(enabled);
+    analyzer->config.pitchTracking = enabled;
+    analyzer->parallel.reset();
+    analyzer->pipelined.reset();
+    return true;
+}
+
+bool setAnalyzerPipelined(AnalyzerHandle analyzer, bool enabled) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in setAnalyzerPipelined");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    analyzer->config.pipelined = enabled;
+    if (!enabled) {
+        analyzer->pipelined.reset();
+    } else if (ensurePipeline(analyzer) == nullptr) {
+        analyzer->config.pipelined = false;
+        return false;
+    }
+    return true;
+}
+
+bool getAnalyzerConfig(AnalyzerHandle analyzer, AnalyzerConfig* config) {
+    if (analyzer == nullptr || config == nullptr) {
+        LOGE("Invalid handle in getAnalyzerConfig");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    *config = analyzer->config;
+    return true;
+}
+
+void destroyAnalyzer(AnalyzerHandle analyzer) {
+    delete analyzer;
+}
+
+AnalyzerStreamHandle createAnalyzerStream(AnalyzerHandle analyzer, int capacitySamples) {
+    if (analyzer == nullptr) {
+        LOGE("Invalid handle in createAnalyzerStream");
+        return nullptr;
+    }
+
+    // The stream reads the owner's sample rate, frame and hop size
+    std::lock_guard<std::mutex> lock(analyzer->mutex);
+    try {
+        return new AnalyzerStreamInstance(analyzer, capacitySamples);
+    } catch (...) {
+        LOGE("Exception in createAnalyzerStream");
+        return nullptr;
+    }
+}
+
+void pushAnalyzerStream(AnalyzerStreamHandle stream, const float* samples, int n) {
+    if (stream == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    stream->stream.push(samples, n);
+}
+
+void pushAnalyzerStreamPcm16(AnalyzerStreamHandle stream, const int16_t* samples, int n) {
+    if (stream == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    stream->stream.pushPcm16(samples, n);
+}
+
+bool pullAnalyzerStream(AnalyzerStreamHandle stream, StreamFrame* frame) {
+    if (stream == nullptr || frame == nullptr) return false;
+
+    std::lock_guard<std::mutex> pullLock(stream->pullMutex);
+    float dcOffset = 0.0f;
+    int64_t sampleIndex = 0;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (!stream->stream.takeFrame(stream->pullFrame.data(), dcOffset, sampleIndex)) {
+            return false;
+        }
+    }
+
+    frame->sampleIndex = sampleIndex;
+    frame->timestamp = static_cast<double>(sampleIndex) / stream->stream.getSampleRate();
+    std::lock_guard<std::mutex> analyzerLock(stream->owner->mutex);
+    stream->owner->wrapper.analyzeFrame(stream->pullFrame.data(), static_cast<int>(stream->pullFrame.size()),
+                                        dcOffset, frame->features);
+    return true;
+}
+
+void destroyAnalyzerStream(AnalyzerStreamHandle stream) {
+    delete stream;
+}
+}
+
+AnalyzerPool::AnalyzerPool(const AnalyzerConfig& cfg, int max)
+        : config(cfg)
+        , maxSize(max)
+        , created(0) {
+}
+
+AnalyzerPool::~AnalyzerPool() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!leased.empty()) {
+        LOGE("AnalyzerPool destroyed with %zu analyzers still checked out", leased.size());
+    }
+    for (AnalyzerHandle analyzer : idle) {
+        destroyAnalyzer(analyzer);
+    }
+    idle.clear();
+}
+
+int AnalyzerPool::prewarm(int count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (static_cast<int>(idle.size()) < count && (maxSize <= 0 || created < maxSize)) {
+        AnalyzerHandle analyzer = createAnalyzer(&config);
+        if (analyzer == nullptr) break;
+        idle.push_back(analyzer);
+        ++created;
+    }
+    LOGI("Analyzer pool prewarmed: %zu idle, %d total", idle.size(), created);
+    return static_cast<int>(idle.size());
+}
+
+AnalyzerHandle AnalyzerPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Wait while every analyzer the pool may create is checked out
+    available.wait(lock, [&] { return !idle.empty() || maxSize <= 0 || created < maxSize; });
+
+    if (!idle.empty()) {
+        AnalyzerHandle analyzer = idle.back();
+        idle.pop_back();
+        leased.push_back(analyzer);
+        return analyzer;
+    }
+
+    // Reserve the slot, then initialize outside the lock
+    ++created;
+    lock.unlock();
+
+    AnalyzerHandle analyzer = createAnalyzer(&config);
+    lock.lock();
+    if (analyzer == nullptr) {
+        --created;
+        lock.unlock();
+        available.notify_one();
+    } else {
+        leased.push_back(analyzer);
+    }
+    return analyzer;
+}
+
+bool AnalyzerPool::release(AnalyzerHandle analyzer) {
+    if (analyzer == nullptr) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(leased.begin(), leased.end(), analyzer);
+        if (it == leased.end()) {
+            LOGE("Analyzer %p released to a pool that does not have it checked out", static_cast<void*>(analyzer));
+            return false;
+        }
+        leased.erase(it);
+    }
+
+    // The handle is no longer leased, so nothing else touches it here
+    if (restoreAnalyzer(analyzer, config)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(analyzer);
+    } else {
+        LOGE("Analyzer could not be restored to the pool configuration; discarding it");
+        destroyAnalyzer(analyzer);
+        std::lock_guard<std::mutex> lock(mutex);
+        --created;
+    }
+    available.notify_one();
+    return true;
+}
@@ -0,0 +1,158 @@
+#ifndef ANALYZER_API_H
+#define ANALYZER_API_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "essentia_wrapper.h"
+#include "pcm_ring.h"
+
+class StreamingAnalyzer;
+struct StreamFrame;
+
+/**
+ * Configuration for one independent analyzer
+ */
+struct AnalyzerConfig {
+    int sampleRate = 44100;
+    int frameSize = 1024;
+    int hopSize = 512;
+    FeatureSet features = kFeatureAll;
+    PitchMethod pitchMethod = kPitchYinFft;
+    HarmonicMethod harmonicMethod = kHarmonicModel;
+    bool pitchTracking = false;     // See EssentiaWrapper::setPitchTracking
+    bool voiceBand = false;         // See EssentiaWrapper::setVoiceBand
+    bool pipelined = false;         // Drain capture rings through a PipelinedAnalyzer
+};
+
+/**
+ * Opaque analyzer handle. Each handle owns its own EssentiaWrapper and
+ * serializes calls made on it, so different handles can run in parallel and
+ * the same handle can be shared between threads.
+ */
+struct AnalyzerInstance;
+typedef AnalyzerInstance* AnalyzerHandle;
+
+/**
+ * Opaque streaming session bound to an analyzer handle.
+ * Must be destroyed before the analyzer it was created from.
+ */
+struct AnalyzerStreamInstance;
+typedef AnalyzerStreamInstance* AnalyzerStreamHandle;
+
+/**
+ * Float copy of the samples an int16 capture ring's consumer has already
+ * converted. Overlapping frames share all but a hop, so with it each
+ * sample is converted once rather than once per frame it falls in.
+ * Keep one per ring for the ring's lifetime; it rebuilds itself whenever
+ * it does not cover the ring's read position.
+ */
+struct PcmRingHistory {
+    std::vector<float> samples;
+    int64_t start = 0;      // Ring sample index (see getConsumed()) of samples[0]
+    int length = 0;         // Converted samples held
+};
+
+// C-style functions for JNI
+extern "C" {
+AnalyzerHandle createAnalyzer(const AnalyzerConfig* config);
+bool analyzeWithAnalyzer(AnalyzerHandle analyzer, const float* audioData, int length, AudioFeatures* features);
+std::vector<AudioFeatures> analyzeBufferWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize);
+bool analyzerSharesLogMelGrid(AnalyzerHandle analyzer);
+std::vector<AudioFeatures> analyzeBufferWithLogMelWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, float* logMel);
+std::vector<AudioFeatures> analyzeBufferParallelWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize, int numThreads);
+std::vector<AudioFeatures> analyzeBufferPipelinedWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize);
+bool analyzePcm16WithAnalyzer(AnalyzerHandle analyzer, const int16_t* pcm, int length, AudioFeatures* features);
+std::vector<AudioFeatures> analyzeBufferPcm16WithAnalyzer(AnalyzerHandle analyzer, const int16_t* pcm, int bufferLength, int hopSize);
+std::vector<AudioFeatures> analyzeRingPcm16WithAnalyzer(AnalyzerHandle analyzer, PcmRing16* ring, PcmRingHistory* history);
+std::vector<AudioFeatures> analyzeRingFloatWithAnalyzer(AnalyzerHandle analyzer, PcmRingFloat* ring);
+size_t columnarCapacityForAnalyzer(AnalyzerHandle analyzer, int bufferLength, int hopSize);
+long analyzeBufferColumnarWithAnalyzer(AnalyzerHandle analyzer, const float* audioBuffer, int bufferLength, int hopSize, void* out, size_t outCapacity);
+bool setAnalyzerFeatureSet(AnalyzerHandle analyzer, FeatureSet features);
+bool setAnalyzerPitchTracking(AnalyzerHandle analyzer, bool enabled);
+bool setAnalyzerPipelined(AnalyzerHandle analyzer, bool enabled);
+bool getAnalyzerConfig(AnalyzerHandle analyzer, AnalyzerConfig* config);
+void destroyAnalyzer(AnalyzerHandle analyzer);
+
+AnalyzerStreamHandle createAnalyzerStream(AnalyzerHandle analyzer, int capacitySamples);
+void pushAnalyzerStream(AnalyzerStreamHandle stream, const float* samples, int n);
+void pushAnalyzerStreamPcm16(AnalyzerStreamHandle stream, const int16_t* samples, int n);
+bool pullAnalyzerStream(AnalyzerStreamHandle stream, StreamFrame* frame);
+void destroyAnalyzerStream(AnalyzerStreamHandle stream);
+}
+
+/**
+ * Pool of pre-initialized analyzers sharing one configuration.
+ *
+ * Concurrent callers check analyzers out with acquire() (or a Lease) and
+ * hand them back with release(), so analyzers and the Essentia runtime are
+ * created once instead of per use. All leases must be returned before the
+ * pool is destroyed.
+ */
+class AnalyzerPool {
+private:
+    AnalyzerConfig config;
+    int maxSize;
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::vector<AnalyzerHandle> idle;
+    std::vector<AnalyzerHandle> leased;     // Checked out; release() accepts only these
+    int created;
+
+public:
+    /**
+     * @param maxSize Upper bound on analyzers; 0 means unbounded.
+     *        acquire() blocks while all maxSize analyzers are checked out.
+     */
+    explicit AnalyzerPool(const AnalyzerConfig& config, int maxSize = 0);
+    ~AnalyzerPool();
+
+    AnalyzerPool(const AnalyzerPool&) = delete;
+    AnalyzerPool& operator=(const AnalyzerPool&) = delete;
+
+    /**
+     * Create analyzers up front so the first acquire() calls do not pay for
+     * initialization. Returns the number of idle analyzers afterwards.
+     */
+    int prewarm(int count);
+
+    /**
+     * Check out an analyzer, creating one if none is idle.
+     * Returns nullptr if a new analyzer fails to initialize.
+     */
+    AnalyzerHandle acquire();
+
+    /**
+     * Return an analyzer obtained from acquire(). Its settings are restored
+     * to the pool's configuration and its pitch track and worker pipelines
+     * are reset, so the next lease starts from the same state as a fresh
+     * analyzer. Returns false, leaving the pool unchanged, for a handle
+     * this pool did not hand out or one that was already released.
+     */
+    bool release(AnalyzerHandle analyzer);
+
+    const AnalyzerConfig& getConfig() const { return config; }
+
+    /**
+     * RAII checkout that releases on destruction
+     */
+    class Lease {
+    private:
+        AnalyzerPool* pool;
+        AnalyzerHandle analyzer;
+
+    public:
+        explicit Lease(AnalyzerPool& p) : pool(&p), analyzer(p.acquire()) {}
+        ~Lease() { if (analyzer) pool->release(analyzer); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        AnalyzerHandle get() const { return analyzer; }
+        explicit operator bool() const { return analyzer != nullptr; }
+    };
+};
+
+#endif // ANALYZER_API_H
@@ -0,0 +1,246 @@
+#include "audio_source.h"
+#include "pcm_convert.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+// How often LiveAudioSource looks at an empty ring; well under one capture
+// buffer (10 ms), so polling adds little latency
+static const int kLivePollMicros = 1000;
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+bool decodeWav(const uint8_t* bytes, size_t size, std::vector<float>& samples, int& sampleRate,
+               std::string& error) {
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const uint8_t* data = nullptr;
+    size_t dataSize = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = bytes + pos;
+        const size_t chunkSize = readU32(chunk + 4);
+        const size_t available = std::min(chunkSize, size - pos - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = readU16(chunk + 8);
+            channels = readU16(chunk + 10);
+            sampleRate = static_cast<int>(readU32(chunk + 12));
+            bits = readU16(chunk + 22);
+            if (format == 0xFFFE && available >= 26) {
+                format = readU16(chunk + 32);   // WAVE_FORMAT_EXTENSIBLE sub-format
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataSize = available;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (data == nullptr || channels <= 0) {
+        error = "no fmt or data chunk";
+        return false;
+    }
+
+    const bool pcm16 = format == 1 && bits == 16;
+    const bool float32 = format == 3 && bits == 32;
+    if (!pcm16 && !float32) {
+        error = "only 16-bit PCM and 32-bit float WAV are supported";
+        return false;
+    }
+
+    const size_t frameBytes = static_cast<size_t>(channels) * (bits / 8);
+    const size_t frames = dataSize / frameBytes;
+    samples.assign(frames, 0.0f);
+
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* frame = data + i * frameBytes;
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            if (pcm16) {
+                sum += static_cast<int16_t>(readU16(frame + c * 2)) * kPcm16Scale;
+            } else {
+                float v;
+                std::memcpy(&v, frame + c * 4, 4);
+                sum += v;
+            }
+        }
+        samples[i] = sum / channels;
+    }
+    return true;
+}
+
+bool decodeRawPcm(const uint8_t* bytes, size_t size, const std::string& format, std::vector<float>& samples,
+                  std::string& error) {
+    if (format == "f32") {
+        samples.resize(size / 4);
+        std::memcpy(samples.data(), bytes, samples.size() * 4);
+    } else if (format == "s16") {
+        samples.resize(size / 2);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<int16_t>(readU16(bytes + i * 2)) * kPcm16Scale;
+        }
+    } else {
+        error = "unknown raw format " + format + " (expected s16 or f32)";
+        return false;
+    }
+    return true;
+}
+
+bool readAudioFile(const std::string& path, int rawSampleRate, std::vector<float>& samples, int& sampleRate,
+                   std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    sampleRate = rawSampleRate;
+    const size_t dot = path.rfind('.');
+    const std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    const bool ok = (ext == "wav" || ext == "WAV")
+            ? decodeWav(bytes.data(), bytes.size(), samples, sampleRate, error)
+            : decodeRawPcm(bytes.data(), bytes.size(), ext == "f32" ? "f32" : "s16", samples, error);
+    if (!ok) {
+        error = path + ": " + error;
+        return false;
+    }
+    if (sampleRate <= 0) {
+        error = path + ": no sample rate";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ReplayAudioSource
+// ---------------------------------------------------------------------------
+
+ReplayAudioSource::ReplayAudioSource()
+        : sampleRate(0)
+        , blockSize(0)
+        , pacing(kReplayRealtime)
+        , speed(1.0)
+        , position(0)
+        , startNs(0) {
+}
+
+void ReplayAudioSource::setSamples(std::vector<float> mono, int rate) {
+    samples = std::move(mono);
+    sampleRate = rate;
+    if (blockSize == 0) {
+        blockSize = std::max(1, sampleRate / 100);
+    }
+    rewind();
+}
+
+bool ReplayAudioSource::loadFile(const std::string& path, int rawSampleRate, std::string& error) {
+    std::vector<float> mono;
+    int rate = 0;
+    if (!readAudioFile(path, rawSampleRate, mono, rate, error)) {
+        return false;
+    }
+    setSamples(std::move(mono), rate);
+    return true;
+}
+
+bool ReplayAudioSource::configure(int newBlockSize, ReplayPacing newPacing, double newSpeed) {
+    if (newBlockSize <= 0 || (newPacing == kReplayScaled && !(newSpeed > 0.0))) {
+        return false;
+    }
+    blockSize = newBlockSize;
+    pacing = newPacing;
+    speed = newPacing == kReplayRealtime ? 1.0 : newSpeed;
+    rewind();
+    return true;
+}
+
+void ReplayAudioSource::rewind() {
+    position = 0;
+    startNs = 0;
+}
+
+int ReplayAudioSource::read(float* out, int maxSamples, AudioBlock& block) {
+    const int64_t remaining = static_cast<int64_t>(samples.size()) - position;
+    const int n = static_cast<int>(std::min<int64_t>(std::min(blockSize, maxSamples), remaining));
+    if (n <= 0 || sampleRate <= 0) {
+        return 0;
+    }
+
+    int64_t now = steadyNowNs();
+    if (startNs == 0) {
+        startNs = now;
+    }
+
+    // Released once its last sample would have been captured
+    int64_t releaseNs = now;
+    if (pacing != kReplayUnthrottled) {
+        releaseNs = startNs + static_cast<int64_t>(1e9 * (position + n) / (sampleRate * speed));
+        if (releaseNs > now) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(releaseNs - now));
+        }
+    }
+
+    std::memcpy(out, samples.data() + position, n * sizeof(float));
+    block.firstSample = position;
+    block.arrivalNs = releaseNs;
+    position += n;
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// LiveAudioSource
+// ---------------------------------------------------------------------------
+
+LiveAudioSource::LiveAudioSource(PcmRing16& r, int rate)
+        : ring(r)
+        , sampleRate(rate)
+        , position(0)
+        , stopped(false) {
+}
+
+int LiveAudioSource::read(float* out, int maxSamples, AudioBlock& block) {
+    if (maxSamples <= 0) {
+        return 0;
+    }
+    if (static_cast<int>(scratch.size()) < maxSamples) {
+        scratch.resize(maxSamples);
+    }
+
+    int n = 0;
+    while ((n = ring.read(scratch.data(), maxSamples)) == 0) {
+        // Checked before the final look so samples committed before stop() are not lost
+        const bool ending = stopped.load(std::memory_order_acquire);
+        if ((n = ring.read(scratch.data(), maxSamples)) > 0 || ending) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(kLivePollMicros));
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    convertPcm16ToFloat(scratch.data(), out, n);
+    block.firstSample = position;
+    block.arrivalNs = steadyNowNs();
+    position += n;
+    return n;
+}
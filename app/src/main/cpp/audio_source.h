@@ -0,0 +1,145 @@
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pcm_ring.h"
+
+/**
+ * Where a block sits in the stream and when it became available
+ */
+struct AudioBlock {
+    int64_t firstSample = 0;    // Index of the block's first sample since the source started
+    int64_t arrivalNs = 0;      // steady_clock time the block was released to the reader
+};
+
+/**
+ * Pull-based source of mono float audio, so the analysis pipeline can be
+ * driven by live capture or by a recording through the same code.
+ */
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    virtual int getSampleRate() const = 0;
+
+    /**
+     * Wait for the next block (as the source paces it) and copy up to
+     * maxSamples of it to out
+     * @return Samples written; 0 once the source has ended
+     */
+    virtual int read(float* out, int maxSamples, AudioBlock& block) = 0;
+};
+
+/**
+ * How fast ReplayAudioSource releases blocks
+ */
+enum ReplayPacing {
+    kReplayRealtime = 0,    // One block per block duration, as a microphone delivers them
+    kReplayScaled = 1,      // speed times realtime
+    kReplayUnthrottled = 2  // As fast as the reader takes them
+};
+
+/**
+ * Decode a RIFF/WAVE image (16-bit PCM or 32-bit float, any channel count)
+ * to mono float. Returns false and fills error on failure.
+ */
+bool decodeWav(const uint8_t* bytes, size_t size, std::vector<float>& samples, int& sampleRate,
+               std::string& error);
+
+/**
+ * Decode headerless mono PCM: format "s16" (little-endian int16) or "f32"
+ */
+bool decodeRawPcm(const uint8_t* bytes, size_t size, const std::string& format, std::vector<float>& samples,
+                  std::string& error);
+
+/**
+ * Read and decode an audio file: .wav through decodeWav, any other
+ * extension as raw PCM ("f32" as float, everything else as s16) at
+ * rawSampleRate
+ */
+bool readAudioFile(const std::string& path, int rawSampleRate, std::vector<float>& samples, int& sampleRate,
+                   std::string& error);
+
+/**
+ * Replays a recording in fixed-size blocks with deterministic pacing.
+ *
+ * Block k is released at start + (k + 1) * blockSize / (sampleRate * speed),
+ * i.e. when its last sample would have been captured, measured from the
+ * first read(). Release times are absolute, so a slow reader never makes
+ * the schedule drift; it only finds blocks already due.
+ */
+class ReplayAudioSource : public AudioSource {
+private:
+    std::vector<float> samples;
+    int sampleRate;
+    int blockSize;
+    ReplayPacing pacing;
+    double speed;
+    int64_t position;       // Next sample to release
+    int64_t startNs;        // steady_clock time of the first read(), 0 before it
+
+public:
+    ReplayAudioSource();
+
+    /**
+     * Replace the recording
+     */
+    void setSamples(std::vector<float> mono, int sampleRate);
+
+    /**
+     * Load a file through readAudioFile
+     */
+    bool loadFile(const std::string& path, int rawSampleRate, std::string& error);
+
+    /**
+     * @param blockSize Samples per block, e.g. the capture buffer (10 ms)
+     * @param speed Multiple of realtime for kReplayScaled
+     */
+    bool configure(int blockSize, ReplayPacing pacing, double speed = 1.0);
+
+    /**
+     * Start over from the first sample; the next read() restarts the clock
+     */
+    void rewind();
+
+    const std::vector<float>& getSamples() const { return samples; }
+    int getBlockSize() const { return blockSize; }
+    int getSampleRate() const override { return sampleRate; }
+    int read(float* out, int maxSamples, AudioBlock& block) override;
+};
+
+/**
+ * Live capture: the consumer side of the ring the capture thread fills
+ * (PcmRing on the Java side). read() polls the ring without locks and
+ * returns whatever has arrived, up to maxSamples, converted to float.
+ */
+class LiveAudioSource : public AudioSource {
+private:
+    PcmRing16& ring;
+    int sampleRate;
+    int64_t position;
+    std::atomic<bool> stopped;
+    std::vector<int16_t> scratch;
+
+public:
+    /**
+     * @param ring Capture ring; this source must be its only reader
+     */
+    LiveAudioSource(PcmRing16& ring, int sampleRate);
+
+    /**
+     * End the stream: read() returns 0 once the ring is drained.
+     * Callable from any thread.
+     */
+    void stop() { stopped.store(true, std::memory_order_release); }
+
+    int getSampleRate() const override { return sampleRate; }
+    int read(float* out, int maxSamples, AudioBlock& block) override;
+};
+
+#endif // AUDIO_SOURCE_H
@@ -0,0 +1,357 @@
+#include "batch_analyzer.h"
+#include "audio_source.h"
+#include "feature_columns.h"
+#include "resampler.h"
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <thread>
+
+#define LOG_TAG "BatchAnalyzer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+// Frames per chunk: a few hundred milliseconds of analysis, so stealing is
+// worth its lock and the pitch-track warm-up is a small fraction of the work
+static const int kDefaultChunkFrames = 256;
+
+// Frames analyzed, and discarded, ahead of each chunk when pitch tracking is
+// on, so the track enters the chunk as it would in one serial pass. It does
+// so exactly once any of them falls below the energy gate, which resets the
+// track; through continuous voicing the path costs converge within a few
+// frames.
+static const int kTrackWarmupFrames = 16;
+
+// How long a worker with nothing to steal waits before looking again while
+// other workers are still decoding files
+static const int kIdleSleepMicros = 200;
+
+struct BatchAnalyzer::FileJob {
+    int index = 0;
+    int sampleRate = 0;
+    int frameCount = 0;
+    std::vector<float> samples;
+    std::vector<AudioFeatures> frames;  // One slot per hop
+    std::vector<uint8_t> valid;
+    std::atomic<int> chunksLeft{0};
+};
+
+static std::string outputPathFor(const std::string& input, const std::string& outputDir, BatchOutputFormat format) {
+    const size_t slash = input.find_last_of('/');
+    std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+    const size_t dot = name.rfind('.');
+    if (dot != std::string::npos) name.resize(dot);
+    return outputDir + "/" + name + (format == kBatchCsv ? ".csv" : ".features");
+}
+
+static bool writeCsv(const std::string& path, const std::vector<AudioFeatures>& frames,
+                     const std::vector<uint8_t>& valid, double secondsPerHop) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (out == nullptr) return false;
+    std::fprintf(out, "time_s,pitch_hz,centroid_hz,brightness,resonance,hnr_db,f1_hz,f2_hz,f3_hz\n");
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (!valid[i]) continue;
+        const AudioFeatures& f = frames[i];
+        std::fprintf(out, "%.4f,%.3f,%.2f,%.5f,%.5f,%.3f", i * secondsPerHop, f.pitch, f.centroid,
+                     f.brightness, f.resonance, f.hnr);
+        for (size_t k = 0; k < 3; ++k) {
+            if (k < f.formants.size()) std::fprintf(out, ",%.2f", f.formants[k]);
+            else std::fputc(',', out);
+        }
+        std::fprintf(out, "\n");
+    }
+    return std::fclose(out) == 0;
+}
+
+BatchAnalyzer::BatchAnalyzer()
+        : chunkFrames(kDefaultChunkFrames)
+        , format(kBatchColumns)
+        , initialized(false)
+        , runInputs(nullptr)
+        , nextFile(0)
+        , filesPending(0)
+        , chunkCount(0)
+        , stolenCount(0) {
+}
+
+BatchAnalyzer::~BatchAnalyzer() {
+    cleanup();
+}
+
+bool BatchAnalyzer::initialize(const AnalyzerConfig& cfg, int numThreads, int frames, BatchOutputFormat fmt) {
+    if (initialized) {
+        LOGD("BatchAnalyzer already initialized");
+        return true;
+    }
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    LOGI("Starting %d batch workers (sampleRate=%d, frameSize=%d, hopSize=%d)",
+         numThreads, cfg.sampleRate, cfg.frameSize, cfg.hopSize);
+
+    for (int i = 0; i < numThreads; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->wrapper = std::make_unique<EssentiaWrapper>();
+        worker->wrapper->setPitchMethod(cfg.pitchMethod);
+        worker->wrapper->setHarmonicMethod(cfg.harmonicMethod);
+        worker->wrapper->setPitchTracking(cfg.pitchTracking);
+        worker->wrapper->setVoiceBand(cfg.voiceBand);
+        if (!worker->wrapper->initialize(cfg.sampleRate, cfg.frameSize, cfg.hopSize, cfg.features)) {
+            LOGE("Failed to initialize analyzer for batch worker %d", i);
+            workers.clear();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    config = cfg;
+    chunkFrames = frames > 0 ? frames : kDefaultChunkFrames;
+    format = fmt;
+    initialized = true;
+    return true;
+}
+
+BatchStats BatchAnalyzer::run(const std::vector<std::string>& inputs, const std::string& outputDir,
+                              std::vector<BatchFileResult>* fileResults) {
+    BatchStats stats;
+    if (!initialized) {
+        LOGE("BatchAnalyzer not initialized");
+        return stats;
+    }
+
+    runInputs = &inputs;
+    runOutputDir = outputDir;
+    nextFile.store(0);
+    filesPending.store(0);
+    chunkCount.store(0);
+    stolenCount.store(0);
+    results.assign(inputs.size(), BatchFileResult());
+    jobs.clear();
+    jobs.resize(inputs.size());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < getThreadCount(); ++i) {
+        threads.emplace_back(&BatchAnalyzer::workerLoop, this, i);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const BatchFileResult& result : results) {
+        ++stats.files;
+        stats.failedFiles += result.output.empty();
+        stats.frames += result.frames;
+        stats.validFrames += result.validFrames;
+        stats.audioSeconds += result.audioSeconds;
+    }
+    stats.chunks = chunkCount.load();
+    stats.stolenChunks = stolenCount.load();
+    if (stats.wallSeconds > 0.0) {
+        stats.framesPerSecond = stats.frames / stats.wallSeconds;
+        stats.realtimeFactor = stats.audioSeconds / stats.wallSeconds;
+    }
+
+    LOGI("Batch complete: %d files (%d failed), %lld frames, %.0f frames/sec, %.1fx realtime, %lld/%lld chunks stolen",
+         stats.files, stats.failedFiles, static_cast<long long>(stats.frames), stats.framesPerSecond,
+         stats.realtimeFactor, static_cast<long long>(stats.stolenChunks), static_cast<long long>(stats.chunks));
+
+    if (fileResults != nullptr) {
+        fileResults->swap(results);
+    }
+    results.clear();
+    jobs.clear();
+    runInputs = nullptr;
+    return stats;
+}
+
+void BatchAnalyzer::workerLoop(int index) {
+    EssentiaWrapper& wrapper = *workers[index]->wrapper;
+    Chunk chunk;
+
+    while (true) {
+        if (takeChunk(index, chunk)) {
+            runChunk(wrapper, chunk);
+            continue;
+        }
+        if (claimFile(index)) {
+            continue;
+        }
+        // No file left to claim; stay while others may still split one
+        if (filesPending.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(kIdleSleepMicros));
+    }
+}
+
+bool BatchAnalyzer::takeChunk(int index, Chunk& chunk) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the last chunk of the next worker that has any, so the owner
+    // keeps working front to back through contiguous frames
+    const int count = getThreadCount();
+    for (int k = 1; k < count; ++k) {
+        Worker& victim = *workers[(index + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            stolenCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BatchAnalyzer::claimFile(int index) {
+    const int fileIndex = nextFile.fetch_add(1);
+    if (fileIndex >= static_cast<int>(runInputs->size())) {
+        return false;
+    }
+    filesPending.fetch_add(1, std::memory_order_acq_rel);
+
+    BatchFileResult& result = results[fileIndex];
+    result.input = (*runInputs)[fileIndex];
+
+    auto job = std::make_unique<FileJob>();
+    job->index = fileIndex;
+    if (!readAudioFile(result.input, config.sampleRate, job->samples, job->sampleRate, result.error)) {
+        LOGE("%s", result.error.c_str());
+        filesPending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    result.sampleRate = job->sampleRate;
+    result.audioSeconds = static_cast<double>(job->samples.size()) / job->sampleRate;
+    if (job->sampleRate != config.sampleRate) {
+        // Analyze at the configured rate, whatever the recording was made at
+        PolyphaseResampler resampler;
+        if (!resampler.configure(job->sampleRate, config.sampleRate)) {
+            result.error = result.input + ": cannot resample from " + std::to_string(job->sampleRate) + " Hz";
+            LOGE("%s", result.error.c_str());
+            filesPending.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+        const int inputLength = static_cast<int>(job->samples.size());
+        std::vector<float> resampled(resampler.outputLength(inputLength));
+        resampler.resample(job->samples.data(), inputLength, resampled.data(), static_cast<int>(resampled.size()));
+        job->samples.swap(resampled);
+        job->sampleRate = config.sampleRate;
+    }
+
+    const int length = static_cast<int>(job->samples.size());
+    job->frameCount = length >= config.frameSize ? (length - config.frameSize) / config.hopSize + 1 : 0;
+    job->frames.resize(job->frameCount);
+    job->valid.assign(job->frameCount, 0);
+    const int chunks = (job->frameCount + chunkFrames - 1) / chunkFrames;
+    job->chunksLeft.store(chunks);
+
+    FileJob& file = *job;
+    jobs[fileIndex] = std::move(job);
+    if (chunks == 0) {
+        finishFile(file);
+        return true;
+    }
+
+    Worker& own = *workers[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    for (int c = 0; c < chunks; ++c) {
+        own.chunks.push_back({&file, c * chunkFrames, std::min((c + 1) * chunkFrames, file.frameCount), index});
+    }
+    chunkCount.fetch_add(chunks, std::memory_order_relaxed);
+    return true;
+}
+
+void BatchAnalyzer::runChunk(EssentiaWrapper& wrapper, const Chunk& chunk) {
+    FileJob& file = *chunk.file;
+
+    // Rebuild the track from the frames before the chunk; their results
+    // belong to the chunk that owns them
+    wrapper.resetPitchTrack();
+    if (config.pitchTracking) {
+        AudioFeatures discarded;
+        for (int frame = std::max(0, chunk.firstFrame - kTrackWarmupFrames); frame < chunk.firstFrame; ++frame) {
+            wrapper.analyzeFrame(file.samples.data() + static_cast<size_t>(frame) * config.hopSize,
+                                 config.frameSize, discarded);
+        }
+    }
+    for (int frame = chunk.firstFrame; frame < chunk.lastFrame; ++frame) {
+        file.valid[frame] = wrapper.analyzeFrame(file.samples.data() + static_cast<size_t>(frame) * config.hopSize,
+                                                 config.frameSize, file.frames[frame]);
+    }
+
+    if (file.chunksLeft.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finishFile(file);
+    }
+}
+
+void BatchAnalyzer::finishFile(FileJob& file) {
+    BatchFileResult& result = results[file.index];
+    const std::string path = outputPathFor(result.input, runOutputDir, format);
+
+    bool written;
+    if (format == kBatchCsv) {
+        written = writeCsv(path, file.frames, file.valid, static_cast<double>(config.hopSize) / file.sampleRate);
+    } else {
+        std::vector<uint8_t> block;
+        encodeFeatureColumns(file.frames.data(), file.valid.data(), file.frameCount, block);
+        std::ofstream out(path, std::ios::binary);
+        written = static_cast<bool>(out.write(reinterpret_cast<const char*>(block.data()), block.size()));
+    }
+
+    if (written) {
+        result.output = path;
+        result.frames = file.frameCount;
+        result.validFrames = std::count(file.valid.begin(), file.valid.end(), 1);
+    } else {
+        result.error = "cannot write " + path;
+        LOGE("%s", result.error.c_str());
+    }
+
+    // Release the recording before the next one is claimed
+    jobs[file.index].reset();
+    filesPending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void BatchAnalyzer::cleanup() {
+    if (initialized) {
+        LOGI("Stopping batch workers");
+    }
+    workers.clear();
+    initialized = false;
+}
+
+std::vector<std::string> BatchAnalyzer::listRecordings(const std::string& dir, std::string& error) {
+    std::vector<std::string> paths;
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        error = "cannot open directory " + dir;
+        return paths;
+    }
+    while (const dirent* entry = readdir(handle)) {
+        const std::string name = entry->d_name;
+        if (name.size() > 4 && name[0] != '.') {
+            std::string ext = name.substr(name.size() - 4);
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".wav") paths.push_back(dir + "/" + name);
+        }
+    }
+    closedir(handle);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
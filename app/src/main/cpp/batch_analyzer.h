@@ -0,0 +1,146 @@
+#ifndef BATCH_ANALYZER_H
+#define BATCH_ANALYZER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "analyzer_api.h"
+#include "essentia_wrapper.h"
+
+/**
+ * Feature file written per recording
+ */
+enum BatchOutputFormat {
+    kBatchColumns = 0,  // FeatureColumnsHeader block (.features)
+    kBatchCsv = 1       // One row per valid frame with its time (.csv)
+};
+
+/**
+ * Outcome for one recording
+ */
+struct BatchFileResult {
+    std::string input;
+    std::string output;             // Empty if the file failed
+    std::string error;
+    int sampleRate = 0;             // Of the recording, before any resampling
+    double audioSeconds = 0.0;
+    int64_t frames = 0;
+    int64_t validFrames = 0;
+};
+
+/**
+ * Totals for one run
+ */
+struct BatchStats {
+    int files = 0;
+    int failedFiles = 0;
+    int64_t frames = 0;
+    int64_t validFrames = 0;
+    int64_t chunks = 0;
+    int64_t stolenChunks = 0;       // Chunks run by a worker other than the one that decoded the file
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    double framesPerSecond = 0.0;
+    double realtimeFactor = 0.0;    // Audio seconds per wall second
+};
+
+/**
+ * Reanalyzes recordings (e.g. saved session WAVs) on all cores and writes
+ * one feature file per recording.
+ *
+ * Each worker owns an EssentiaWrapper. Work is balanced at two levels:
+ * a worker with nothing to do claims the next file, decodes it and splits
+ * its frames into chunks on its own deque; workers take chunks from the
+ * front of their own deque and, once it is empty, steal from the back of
+ * another's before claiming a new file. A long recording is therefore
+ * spread over every core while short ones run one per core, and at most
+ * about one decoded recording per worker is held at a time. Whichever
+ * worker finishes a file's last chunk writes its feature file.
+ *
+ * Frames are analyzed as analyzeBuffer would. With pitch tracking on, each
+ * chunk first runs the tracker over the frames just before it, so the
+ * track matches a serial pass exactly when one of them is silent (below
+ * the energy gate) and closely otherwise. Recordings at another sample
+ * rate are resampled to the configured one with PolyphaseResampler;
+ * BatchFileResult::sampleRate reports the recording's own rate.
+ */
+class BatchAnalyzer {
+private:
+    struct FileJob;
+
+    struct Chunk {
+        FileJob* file;
+        int firstFrame;
+        int lastFrame;      // Exclusive
+        int owner;          // Worker that decoded the file
+    };
+
+    struct Worker {
+        std::unique_ptr<EssentiaWrapper> wrapper;
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    AnalyzerConfig config;
+    std::vector<std::unique_ptr<Worker>> workers;
+    int chunkFrames;
+    BatchOutputFormat format;
+    bool initialized;
+
+    // Current run
+    const std::vector<std::string>* runInputs;
+    std::string runOutputDir;
+    std::atomic<int> nextFile;
+    std::atomic<int> filesPending;  // Claimed and not yet written or failed
+    std::vector<std::unique_ptr<FileJob>> jobs;     // Decoded recordings, by input index
+    std::vector<BatchFileResult> results;
+    std::atomic<int64_t> chunkCount;
+    std::atomic<int64_t> stolenCount;
+
+    void workerLoop(int index);
+    bool takeChunk(int index, Chunk& chunk);
+    bool claimFile(int index);
+    void runChunk(EssentiaWrapper& wrapper, const Chunk& chunk);
+    void finishFile(FileJob& file);
+
+public:
+    BatchAnalyzer();
+    ~BatchAnalyzer();
+
+    /**
+     * Create one analyzer per worker
+     * @param numThreads Worker count; <= 0 uses std::thread::hardware_concurrency()
+     * @param chunkFrames Frames per chunk; <= 0 for the default
+     */
+    bool initialize(const AnalyzerConfig& config, int numThreads = 0, int chunkFrames = 0,
+                    BatchOutputFormat format = kBatchColumns);
+
+    /**
+     * Analyze every input and write outputDir/<input name>.features (or
+     * .csv). Blocks until all are done.
+     * @param results Filled with one entry per input, in input order
+     */
+    BatchStats run(const std::vector<std::string>& inputs, const std::string& outputDir,
+                   std::vector<BatchFileResult>* results = nullptr);
+
+    /**
+     * Release the workers' analyzers
+     */
+    void cleanup();
+
+    bool isReady() const { return initialized; }
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+    int getChunkFrames() const { return chunkFrames; }
+
+    /**
+     * The .wav files directly inside dir, sorted by name
+     */
+    static std::vector<std::string> listRecordings(const std::string& dir, std::string& error);
+};
+
+#endif // BATCH_ANALYZER_H
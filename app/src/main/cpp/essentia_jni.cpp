@@ -1,43 +1,96 @@
 #include <jni.h>
 #include <android/log.h>
+#include <algorithm>
+#include <mutex>
 #include <vector>
 #include <string>
 #include "essentia_wrapper.h"
+#include "streaming_analyzer.h"
+#include "analyzer_api.h"
+#include "trace_events.h"
+#include "log_mel.h"
+#include "pcm_ring.h"
 
 #define LOG_TAG "EssentiaJNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
-// Helper function to create Java AudioFeatures object
-jobject createAudioFeaturesObject(JNIEnv* env, const AudioFeatures& features) {
-    // Find the AudioFeatures class
-    jclass audioFeaturesClass = env->FindClass("com/juliejohnson/voicegenderpavlok/audio/AudioFeatures");
-    if (audioFeaturesClass == nullptr) {
-        LOGE("Failed to find AudioFeatures class");
+// Class references and constructor IDs resolved once in JNI_OnLoad. FindClass
+// from native worker threads only sees the system class loader, and looking
+// them up per result object dominated the cost of building large arrays.
+static jclass g_audioFeaturesClass = nullptr;
+static jmethodID g_audioFeaturesCtor = nullptr;
+static jclass g_streamFeaturesClass = nullptr;
+static jmethodID g_streamFeaturesCtor = nullptr;
+
+static jclass findGlobalClass(JNIEnv* env, const char* name) {
+    jclass localClass = env->FindClass(name);
+    if (localClass == nullptr) {
+        LOGE("Failed to find class %s", name);
         return nullptr;
     }
+    auto globalClass = static_cast<jclass>(env->NewGlobalRef(localClass));
+    env->DeleteLocalRef(localClass);
+    return globalClass;
+}
 
-    // Get constructor method ID
-    jmethodID constructor = env->GetMethodID(audioFeaturesClass, "<init>", "(FFFF[F[FFZ)V");
-    if (constructor == nullptr) {
-        LOGE("Failed to find AudioFeatures constructor");
-        return nullptr;
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("Failed to get JNI environment");
+        return JNI_ERR;
+    }
+
+    g_audioFeaturesClass = findGlobalClass(env, "com/juliejohnson/voicegenderpavlok/audio/AudioFeatures");
+    g_streamFeaturesClass = findGlobalClass(env, "com/juliejohnson/voicegenderpavlok/audio/StreamFeatures");
+    if (g_audioFeaturesClass == nullptr || g_streamFeaturesClass == nullptr) {
+        return JNI_ERR;
+    }
+
+    g_audioFeaturesCtor = env->GetMethodID(g_audioFeaturesClass, "<init>", "(FFFF[F[FFZ[F)V");
+    g_streamFeaturesCtor = env->GetMethodID(g_streamFeaturesClass, "<init>",
+                                            "(JDLcom/juliejohnson/voicegenderpavlok/audio/AudioFeatures;)V");
+    if (g_audioFeaturesCtor == nullptr || g_streamFeaturesCtor == nullptr) {
+        LOGE("Failed to find feature constructors");
+        return JNI_ERR;
+    }
+
+    return JNI_VERSION_1_6;
+}
+
+extern "C" JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return;
     }
+    if (g_audioFeaturesClass != nullptr) env->DeleteGlobalRef(g_audioFeaturesClass);
+    if (g_streamFeaturesClass != nullptr) env->DeleteGlobalRef(g_streamFeaturesClass);
+    g_audioFeaturesClass = nullptr;
+    g_streamFeaturesClass = nullptr;
+}
 
+// Helper function to create Java AudioFeatures object
+jobject createAudioFeaturesObject(JNIEnv* env, const AudioFeatures& features) {
     // Convert MFCC vector to Java float array
     jfloatArray mfccArray = env->NewFloatArray(features.mfcc.size());
     if (mfccArray != nullptr && !features.mfcc.empty()) {
         env->SetFloatArrayRegion(mfccArray, 0, features.mfcc.size(), features.mfcc.data());
     }
 
-    // Convert MFCC vector to Java float array
+    // Convert formants vector to Java float array
     jfloatArray formantsArray = env->NewFloatArray(features.formants.size());
     if (formantsArray != nullptr && !features.formants.empty()) {
         env->SetFloatArrayRegion(formantsArray, 0, features.formants.size(), features.formants.data());
     }
 
+    jfloatArray bandwidthsArray = env->NewFloatArray(features.formantBandwidths.size());
+    if (bandwidthsArray != nullptr && !features.formantBandwidths.empty()) {
+        env->SetFloatArrayRegion(bandwidthsArray, 0, features.formantBandwidths.size(),
+                                 features.formantBandwidths.data());
+    }
+
     // Create the AudioFeatures object
-    jobject audioFeaturesObj = env->NewObject(audioFeaturesClass, constructor,
+    jobject audioFeaturesObj = env->NewObject(g_audioFeaturesClass, g_audioFeaturesCtor,
                                               features.pitch,
                                               features.brightness,
                                               features.resonance,
@@ -45,10 +98,10 @@ jobject createAudioFeaturesObject(JNIEnv* env, const AudioFeatures& features) {
                                               mfccArray,
                                               formantsArray,
                                               features.hnr,
-                                              features.isValid);
+                                              features.isValid,
+                                              bandwidthsArray);
 
     // Clean up local references
-    env->DeleteLocalRef(audioFeaturesClass);
     if (mfccArray != nullptr) {
         env->DeleteLocalRef(mfccArray);
     }
@@ -57,34 +110,126 @@ jobject createAudioFeaturesObject(JNIEnv* env, const AudioFeatures& features) {
         env->DeleteLocalRef(formantsArray);
     }
 
+    if (bandwidthsArray != nullptr) {
+        env->DeleteLocalRef(bandwidthsArray);
+    }
+
     return audioFeaturesObj;
 }
 
+// Helper function to create Java AudioFeatures[] from a list of features
+jobjectArray createAudioFeaturesArray(JNIEnv* env, const std::vector<AudioFeatures>& featuresList) {
+    jobjectArray resultArray = env->NewObjectArray(featuresList.size(), g_audioFeaturesClass, nullptr);
+    if (resultArray == nullptr) {
+        LOGE("Failed to create result array");
+        return nullptr;
+    }
+
+    // Fill the array with AudioFeatures objects
+    for (size_t i = 0; i < featuresList.size(); ++i) {
+        jobject featuresObj = createAudioFeaturesObject(env, featuresList[i]);
+        if (featuresObj != nullptr) {
+            env->SetObjectArrayElement(resultArray, i, featuresObj);
+            env->DeleteLocalRef(featuresObj);
+        }
+    }
+
+    return resultArray;
+}
+
+// Helper function to create Java StreamFeatures object
+jobject createStreamFeaturesObject(JNIEnv* env, const StreamFrame& frame) {
+    jobject featuresObj = createAudioFeaturesObject(env, frame.features);
+    if (featuresObj == nullptr) {
+        return nullptr;
+    }
+
+    jobject streamFeaturesObj = env->NewObject(g_streamFeaturesClass, g_streamFeaturesCtor,
+                                               static_cast<jlong>(frame.sampleIndex),
+                                               static_cast<jdouble>(frame.timestamp),
+                                               featuresObj);
+
+    env->DeleteLocalRef(featuresObj);
+    return streamFeaturesObj;
+}
+
+// Capture ring behind a PcmRing handle: int16 or float samples
+struct PcmRingInstance {
+    std::unique_ptr<PcmRing16> pcm16;
+    std::unique_ptr<PcmRingFloat> pcmFloat;
+    PcmRingHistory history;     // Consumer's float copy of pcm16
+};
+
+// Apply fn to whichever ring the instance holds
+template <typename Fn>
+static auto withRing(PcmRingInstance* ring, Fn fn) -> decltype(fn(*ring->pcm16)) {
+    return ring->pcm16 ? fn(*ring->pcm16) : fn(*ring->pcmFloat);
+}
+
+// Samples copied out of a Java short[] per push, so the array is never
+// held while a lock is taken
+static const int kPcmCopyBlock = 1024;
+
+// Copy the first count samples of a Java short[] into a reused per-thread buffer
+static const jshort* copyPcm16(JNIEnv* env, jshortArray array, jint count) {
+    // Grows to the largest frame this thread has analyzed, so steady-state calls do not allocate
+    static thread_local std::vector<jshort> scratch;
+    if (static_cast<jint>(scratch.size()) < count) {
+        scratch.resize(count);
+    }
+    env->GetShortArrayRegion(array, 0, count, scratch.data());
+    return env->ExceptionCheck() ? nullptr : scratch.data();
+}
+
+// Resolve a direct ByteBuffer holding at least count native-order int16 samples
+static const int16_t* directPcm16(JNIEnv* env, jobject buffer, jint count) {
+    if (buffer == nullptr || count < 0) return nullptr;
+
+    void* address = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < static_cast<jlong>(count) * 2) {
+        LOGE("PCM input must be a direct ByteBuffer of at least %d bytes", count * 2);
+        return nullptr;
+    }
+    return static_cast<const int16_t*>(address);
+}
+
 extern "C" {
 
-JNIEXPORT jboolean JNICALL
-Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeInitialize(JNIEnv *env, jobject thiz, jint sampleRate) {
-    LOGI("Initializing Essentia with sample rate: %d", sampleRate);
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeCreate(JNIEnv *env, jobject thiz, jint sampleRate,
+                                                                            jint frameSize, jint hopSize, jint features,
+                                                                            jboolean voiceBand) {
+    LOGI("Creating analyzer: sampleRate=%d, frameSize=%d, hopSize=%d, features=0x%x, voiceBand=%d",
+         sampleRate, frameSize, hopSize, features, voiceBand == JNI_TRUE);
 
     try {
-        bool success = initEssentia(static_cast<int>(sampleRate));
-        if (success) {
-            LOGI("Essentia initialized successfully");
+        AnalyzerConfig config;
+        config.sampleRate = static_cast<int>(sampleRate);
+        config.frameSize = static_cast<int>(frameSize);
+        config.hopSize = static_cast<int>(hopSize);
+        config.features = static_cast<FeatureSet>(features);
+        config.voiceBand = voiceBand == JNI_TRUE;
+
+        AnalyzerHandle analyzer = createAnalyzer(&config);
+        if (analyzer != nullptr) {
+            LOGI("Analyzer created successfully");
         } else {
-            LOGE("Failed to initialize Essentia");
+            LOGE("Failed to create analyzer");
         }
-        return static_cast<jboolean>(success);
+        return reinterpret_cast<jlong>(analyzer);
     } catch (const std::exception& e) {
-        LOGE("Exception during Essentia initialization: %s", e.what());
-        return JNI_FALSE;
+        LOGE("Exception during analyzer creation: %s", e.what());
+        return 0;
     }
 }
 
 JNIEXPORT jobject JNICALL
-Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFrame(JNIEnv *env, jobject thiz,
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFrame(JNIEnv *env, jobject thiz, jlong handle,
                                                                jfloatArray audioData, jint frameSize) {
-    if (audioData == nullptr) {
-        LOGE("Audio data is null");
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioData == nullptr) {
+        LOGE("Analyzer or audio data is null");
         return nullptr;
     }
 
@@ -104,7 +249,8 @@ Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFram
 
     try {
         // Analyze the audio frame
-        AudioFeatures features = analyzeAudioFrame(audioBuffer, frameSize);
+        AudioFeatures features;
+        analyzeWithAnalyzer(analyzer, audioBuffer, frameSize, &features);
 
         // Release the audio buffer
         env->ReleaseFloatArrayElements(audioData, audioBuffer, JNI_ABORT);
@@ -120,10 +266,11 @@ Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFram
 }
 
 JNIEXPORT jobjectArray JNICALL
-Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBuffer(JNIEnv *env, jobject thiz,
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBuffer(JNIEnv *env, jobject thiz, jlong handle,
                                                                 jfloatArray audioBuffer, jint hopSize) {
-    if (audioBuffer == nullptr) {
-        LOGE("Audio buffer is null");
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioBuffer == nullptr) {
+        LOGE("Analyzer or audio buffer is null");
         return nullptr;
     }
 
@@ -137,52 +284,590 @@ Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBuff
 
     try {
         // Analyze the audio buffer
-        std::vector<AudioFeatures> featuresList = analyzeAudioBuffer(buffer, bufferLength, hopSize);
+        std::vector<AudioFeatures> featuresList = analyzeBufferWithAnalyzer(analyzer, buffer, bufferLength, hopSize);
 
         // Release the audio buffer
         env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
 
         // Create Java object array
-        jclass audioFeaturesClass = env->FindClass("com/juliejohnson/voicegenderpavlok/audio/AudioFeatures");
-        if (audioFeaturesClass == nullptr) {
-            LOGE("Failed to find AudioFeatures class");
-            return nullptr;
-        }
+        return createAudioFeaturesArray(env, featuresList);
 
-        jobjectArray resultArray = env->NewObjectArray(featuresList.size(), audioFeaturesClass, nullptr);
-        if (resultArray == nullptr) {
-            LOGE("Failed to create result array");
-            env->DeleteLocalRef(audioFeaturesClass);
-            return nullptr;
-        }
+    } catch (const std::exception& e) {
+        LOGE("Exception during buffer analysis: %s", e.what());
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return nullptr;
+    }
+}
 
-        // Fill the array with AudioFeatures objects
-        for (size_t i = 0; i < featuresList.size(); ++i) {
-            jobject featuresObj = createAudioFeaturesObject(env, featuresList[i]);
-            if (featuresObj != nullptr) {
-                env->SetObjectArrayElement(resultArray, i, featuresObj);
-                env->DeleteLocalRef(featuresObj);
-            }
-        }
+JNIEXPORT jobjectArray JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBufferWithLogMel(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                           jfloatArray audioBuffer, jobject logMel) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioBuffer == nullptr || logMel == nullptr) {
+        LOGE("Analyzer, audio buffer or log-mel output is null");
+        return nullptr;
+    }
+    if (!analyzerSharesLogMelGrid(analyzer)) {
+        LOGE("Analyzer does not run on the log-mel grid");
+        return nullptr;
+    }
+
+    // The spectrogram goes straight into the caller's direct buffer (the ONNX input)
+    void* out = env->GetDirectBufferAddress(logMel);
+    jlong outCapacity = env->GetDirectBufferCapacity(logMel);
+    if (out == nullptr || outCapacity < kLogMelOutputSize) {
+        LOGE("Log-mel output must be a direct FloatBuffer of at least %d floats", kLogMelOutputSize);
+        return nullptr;
+    }
+
+    jsize bufferLength = env->GetArrayLength(audioBuffer);
+    jfloat* buffer = env->GetFloatArrayElements(audioBuffer, nullptr);
+    if (buffer == nullptr) {
+        LOGE("Failed to get audio buffer");
+        return nullptr;
+    }
+
+    try {
+        std::vector<AudioFeatures> featuresList =
+                analyzeBufferWithLogMelWithAnalyzer(analyzer, buffer, bufferLength, static_cast<float*>(out));
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return createAudioFeaturesArray(env, featuresList);
+    } catch (const std::exception& e) {
+        LOGE("Exception during buffer analysis with log-mel: %s", e.what());
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBufferParallel(JNIEnv *env, jobject thiz, jlong handle,
+                                                                        jfloatArray audioBuffer, jint hopSize,
+                                                                        jint numThreads) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioBuffer == nullptr) {
+        LOGE("Analyzer or audio buffer is null");
+        return nullptr;
+    }
+
+    // Get array length and data
+    jsize bufferLength = env->GetArrayLength(audioBuffer);
+    jfloat* buffer = env->GetFloatArrayElements(audioBuffer, nullptr);
+    if (buffer == nullptr) {
+        LOGE("Failed to get audio buffer");
+        return nullptr;
+    }
 
-        env->DeleteLocalRef(audioFeaturesClass);
-        return resultArray;
+    try {
+        // Analyze the audio buffer across the worker pool
+        std::vector<AudioFeatures> featuresList =
+                analyzeBufferParallelWithAnalyzer(analyzer, buffer, bufferLength, hopSize, numThreads);
+
+        // Release the audio buffer
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+
+        // Create Java object array
+        return createAudioFeaturesArray(env, featuresList);
 
     } catch (const std::exception& e) {
-        LOGE("Exception during buffer analysis: %s", e.what());
+        LOGE("Exception during parallel buffer analysis: %s", e.what());
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return nullptr;
+    }
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBufferPipelined(JNIEnv *env, jobject thiz, jlong handle,
+                                                                         jfloatArray audioBuffer, jint hopSize) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioBuffer == nullptr) {
+        LOGE("Analyzer or audio buffer is null");
+        return nullptr;
+    }
+
+    // Get array length and data
+    jsize bufferLength = env->GetArrayLength(audioBuffer);
+    jfloat* buffer = env->GetFloatArrayElements(audioBuffer, nullptr);
+    if (buffer == nullptr) {
+        LOGE("Failed to get audio buffer");
+        return nullptr;
+    }
+
+    try {
+        // Analyze the audio buffer through the stage pipeline
+        std::vector<AudioFeatures> featuresList =
+                analyzeBufferPipelinedWithAnalyzer(analyzer, buffer, bufferLength, hopSize);
+
+        // Release the audio buffer
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+
+        // Create Java object array
+        return createAudioFeaturesArray(env, featuresList);
+
+    } catch (const std::exception& e) {
+        LOGE("Exception during pipelined buffer analysis: %s", e.what());
         env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
         return nullptr;
     }
 }
 
+JNIEXPORT jobject JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFramePcm16(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                      jshortArray pcm, jint frameSize) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || pcm == nullptr) {
+        LOGE("Analyzer or PCM data is null");
+        return nullptr;
+    }
+
+    jsize arrayLength = env->GetArrayLength(pcm);
+    if (arrayLength < frameSize) {
+        LOGE("PCM data length (%d) is less than frame size (%d)", arrayLength, frameSize);
+        return nullptr;
+    }
+
+    // Copy the frame out rather than pinning the array: analysis waits on
+    // the analyzer's lock, and a critical region must not block
+    const jshort* samples = copyPcm16(env, pcm, frameSize);
+    if (samples == nullptr) {
+        LOGE("Failed to copy PCM array");
+        return nullptr;
+    }
+    AudioFeatures features;
+    analyzePcm16WithAnalyzer(analyzer, samples, frameSize, &features);
+
+    return createAudioFeaturesObject(env, features);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeFramePcm16Direct(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                            jobject pcm, jint frameSize) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    const int16_t* samples = directPcm16(env, pcm, frameSize);
+    if (analyzer == nullptr || samples == nullptr) {
+        LOGE("Analyzer or PCM buffer is invalid");
+        return nullptr;
+    }
+
+    AudioFeatures features;
+    analyzePcm16WithAnalyzer(analyzer, samples, frameSize, &features);
+    return createAudioFeaturesObject(env, features);
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBufferPcm16Direct(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                             jobject pcm, jint sampleCount,
+                                                                                             jint hopSize) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    const int16_t* samples = directPcm16(env, pcm, sampleCount);
+    if (analyzer == nullptr || samples == nullptr) {
+        LOGE("Analyzer or PCM buffer is invalid");
+        return nullptr;
+    }
+
+    try {
+        std::vector<AudioFeatures> featuresList = analyzeBufferPcm16WithAnalyzer(analyzer, samples, sampleCount, hopSize);
+        return createAudioFeaturesArray(env, featuresList);
+    } catch (const std::exception& e) {
+        LOGE("Exception during PCM buffer analysis: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jint JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeColumnarCapacity(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                       jint bufferLength, jint hopSize) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    return static_cast<jint>(columnarCapacityForAnalyzer(analyzer, bufferLength, hopSize));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeBufferColumnar(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                           jfloatArray audioBuffer, jint hopSize,
+                                                                                           jobject output) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    if (analyzer == nullptr || audioBuffer == nullptr || output == nullptr) {
+        LOGE("Analyzer, audio buffer or output is null");
+        return -1;
+    }
+
+    // The result is written straight into the caller's direct buffer
+    void* out = env->GetDirectBufferAddress(output);
+    jlong outCapacity = env->GetDirectBufferCapacity(output);
+    if (out == nullptr || outCapacity <= 0) {
+        LOGE("Columnar output must be a direct ByteBuffer");
+        return -1;
+    }
+
+    jsize bufferLength = env->GetArrayLength(audioBuffer);
+    jfloat* buffer = env->GetFloatArrayElements(audioBuffer, nullptr);
+    if (buffer == nullptr) {
+        LOGE("Failed to get audio buffer");
+        return -1;
+    }
+
+    try {
+        long written = analyzeBufferColumnarWithAnalyzer(analyzer, buffer, bufferLength, hopSize,
+                                                         out, static_cast<size_t>(outCapacity));
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return static_cast<jint>(written);
+    } catch (const std::exception& e) {
+        LOGE("Exception during columnar buffer analysis: %s", e.what());
+        env->ReleaseFloatArrayElements(audioBuffer, buffer, JNI_ABORT);
+        return -1;
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeSetFeatureSet(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                   jint features) {
+    return setAnalyzerFeatureSet(reinterpret_cast<AnalyzerHandle>(handle), static_cast<FeatureSet>(features))
+           ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeSetPitchTracking(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                     jboolean enabled) {
+    return setAnalyzerPitchTracking(reinterpret_cast<AnalyzerHandle>(handle), enabled == JNI_TRUE)
+           ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeSetPipelined(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                  jboolean enabled) {
+    return setAnalyzerPipelined(reinterpret_cast<AnalyzerHandle>(handle), enabled == JNI_TRUE)
+           ? JNI_TRUE : JNI_FALSE;
+}
+
 JNIEXPORT void JNICALL
-Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeCleanup(JNIEnv *env, jobject thiz) {
-    LOGI("Cleaning up Essentia");
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeDestroy(JNIEnv *env, jobject thiz, jlong handle) {
+    LOGI("Destroying analyzer");
     try {
-        cleanupEssentia();
-        LOGI("Essentia cleanup completed");
+        destroyAnalyzer(reinterpret_cast<AnalyzerHandle>(handle));
+        LOGI("Analyzer destroyed");
     } catch (const std::exception& e) {
         LOGE("Exception during cleanup: %s", e.what());
     }
 }
-}
\ No newline at end of file
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzerPool_nativeCreate(JNIEnv *env, jobject thiz, jint sampleRate,
+                                                                                jint frameSize, jint hopSize,
+                                                                                jint features, jboolean voiceBand,
+                                                                                jint maxSize, jint prewarm) {
+    try {
+        AnalyzerConfig config;
+        config.sampleRate = static_cast<int>(sampleRate);
+        config.frameSize = static_cast<int>(frameSize);
+        config.hopSize = static_cast<int>(hopSize);
+        config.features = static_cast<FeatureSet>(features);
+        config.voiceBand = voiceBand == JNI_TRUE;
+
+        auto* pool = new AnalyzerPool(config, static_cast<int>(maxSize));
+        pool->prewarm(static_cast<int>(prewarm));
+        return reinterpret_cast<jlong>(pool);
+    } catch (const std::exception& e) {
+        LOGE("Exception creating analyzer pool: %s", e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzerPool_nativeAcquire(JNIEnv *env, jobject thiz, jlong pool) {
+    auto* analyzerPool = reinterpret_cast<AnalyzerPool*>(pool);
+    if (analyzerPool == nullptr) {
+        LOGE("Analyzer pool is null");
+        return 0;
+    }
+    return reinterpret_cast<jlong>(analyzerPool->acquire());
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzerPool_nativeRelease(JNIEnv *env, jobject thiz, jlong pool,
+                                                                                 jlong handle) {
+    auto* analyzerPool = reinterpret_cast<AnalyzerPool*>(pool);
+    if (analyzerPool != nullptr) {
+        analyzerPool->release(reinterpret_cast<AnalyzerHandle>(handle));
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzerPool_nativeDestroy(JNIEnv *env, jobject thiz, jlong pool) {
+    delete reinterpret_cast<AnalyzerPool*>(pool);
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativeCreate(JNIEnv *env, jobject thiz, jlong analyzerHandle,
+                                                                          jint capacitySamples) {
+    AnalyzerStreamHandle stream = createAnalyzerStream(reinterpret_cast<AnalyzerHandle>(analyzerHandle),
+                                                       static_cast<int>(capacitySamples));
+    return reinterpret_cast<jlong>(stream);
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativePush(JNIEnv *env, jobject thiz, jlong handle,
+                                                                        jfloatArray samples, jint count) {
+    auto stream = reinterpret_cast<AnalyzerStreamHandle>(handle);
+    if (stream == nullptr || samples == nullptr) {
+        LOGE("Invalid stream push");
+        return;
+    }
+
+    jsize arrayLength = env->GetArrayLength(samples);
+    if (count < 0 || count > arrayLength) {
+        LOGE("Push count (%d) out of range for array length (%d)", count, arrayLength);
+        return;
+    }
+
+    jfloat* buffer = env->GetFloatArrayElements(samples, nullptr);
+    if (buffer == nullptr) {
+        LOGE("Failed to get audio buffer");
+        return;
+    }
+
+    pushAnalyzerStream(stream, buffer, static_cast<int>(count));
+    env->ReleaseFloatArrayElements(samples, buffer, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativePushPcm16(JNIEnv *env, jobject thiz, jlong handle,
+                                                                             jshortArray samples, jint count) {
+    auto stream = reinterpret_cast<AnalyzerStreamHandle>(handle);
+    if (stream == nullptr || samples == nullptr) {
+        LOGE("Invalid stream push");
+        return;
+    }
+
+    jsize arrayLength = env->GetArrayLength(samples);
+    if (count < 0 || count > arrayLength) {
+        LOGE("Push count (%d) out of range for array length (%d)", count, arrayLength);
+        return;
+    }
+
+    // Copied out a block at a time; the stream lock is only taken with no
+    // array held
+    jshort block[kPcmCopyBlock];
+    for (jint offset = 0; offset < count; offset += kPcmCopyBlock) {
+        const jint n = std::min(kPcmCopyBlock, count - offset);
+        env->GetShortArrayRegion(samples, offset, n, block);
+        if (env->ExceptionCheck()) {
+            LOGE("Failed to copy PCM array");
+            return;
+        }
+        pushAnalyzerStreamPcm16(stream, block, static_cast<int>(n));
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativePushPcm16Direct(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                   jobject samples, jint count) {
+    auto stream = reinterpret_cast<AnalyzerStreamHandle>(handle);
+    const int16_t* pcm = directPcm16(env, samples, count);
+    if (stream == nullptr || pcm == nullptr) {
+        LOGE("Invalid stream push");
+        return;
+    }
+
+    pushAnalyzerStreamPcm16(stream, pcm, static_cast<int>(count));
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativePull(JNIEnv *env, jobject thiz, jlong handle) {
+    auto stream = reinterpret_cast<AnalyzerStreamHandle>(handle);
+    if (stream == nullptr) {
+        LOGE("Invalid stream pull");
+        return nullptr;
+    }
+
+    try {
+        StreamFrame frame;
+        if (!pullAnalyzerStream(stream, &frame)) {
+            return nullptr;
+        }
+        return createStreamFeaturesObject(env, frame);
+    } catch (const std::exception& e) {
+        LOGE("Exception during stream analysis: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaStream_nativeDestroy(JNIEnv *env, jobject thiz, jlong handle) {
+    destroyAnalyzerStream(reinterpret_cast<AnalyzerStreamHandle>(handle));
+}
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_NativeTrace_nativeIsAvailable(JNIEnv *env, jobject thiz) {
+    return traceIsAvailable() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_NativeTrace_nativeSetEnabled(JNIEnv *env, jobject thiz, jboolean enabled) {
+    traceSetEnabled(enabled == JNI_TRUE);
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_NativeTrace_nativeClear(JNIEnv *env, jobject thiz) {
+    traceClear();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_NativeTrace_nativeWriteChromeJson(JNIEnv *env, jobject thiz, jstring path) {
+    if (path == nullptr) return JNI_FALSE;
+
+    const char* filePath = env->GetStringUTFChars(path, nullptr);
+    if (filePath == nullptr) return JNI_FALSE;
+
+    const bool ok = traceWriteChromeJson(filePath);
+    env->ReleaseStringUTFChars(path, filePath);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_AudioFeatureExtractor_nativeExtractLogMel(JNIEnv *env, jobject thiz,
+                                                                                        jfloatArray samples, jint channels,
+                                                                                        jboolean normalize, jint fixedLength,
+                                                                                        jobject output) {
+    // One engine for the process; embeddings are rare enough that a lock is cheaper than per-thread tables
+    static std::mutex extractorMutex;
+    static LogMelExtractor extractor;
+
+    if (samples == nullptr || output == nullptr || channels < 1) {
+        LOGE("Samples or output is null, or channel count is invalid");
+        return JNI_FALSE;
+    }
+
+    // The spectrogram is written straight into the caller's direct buffer (the ONNX input)
+    void* out = env->GetDirectBufferAddress(output);
+    jlong outCapacity = env->GetDirectBufferCapacity(output);
+    if (out == nullptr || outCapacity < kLogMelOutputSize) {
+        LOGE("Log-mel output must be a direct FloatBuffer of at least %d floats", kLogMelOutputSize);
+        return JNI_FALSE;
+    }
+
+    jsize length = env->GetArrayLength(samples);
+    jfloat* input = env->GetFloatArrayElements(samples, nullptr);
+    if (input == nullptr) {
+        LOGE("Failed to get samples");
+        return JNI_FALSE;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(extractorMutex);
+        extractor.compute(input, length / channels, channels, normalize == JNI_TRUE, fixedLength,
+                          static_cast<float*>(out));
+    }
+    env->ReleaseFloatArrayElements(samples, input, JNI_ABORT);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_EssentiaAnalyzer_nativeAnalyzeRing(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                 jlong ringHandle) {
+    auto analyzer = reinterpret_cast<AnalyzerHandle>(handle);
+    auto ring = reinterpret_cast<PcmRingInstance*>(ringHandle);
+    if (analyzer == nullptr || ring == nullptr) {
+        LOGE("Analyzer or ring is invalid");
+        return nullptr;
+    }
+
+    try {
+        std::vector<AudioFeatures> featuresList = ring->pcm16
+                ? analyzeRingPcm16WithAnalyzer(analyzer, ring->pcm16.get(), &ring->history)
+                : analyzeRingFloatWithAnalyzer(analyzer, ring->pcmFloat.get());
+        return createAudioFeaturesArray(env, featuresList);
+    } catch (const std::exception& e) {
+        LOGE("Exception during ring analysis: %s", e.what());
+        return nullptr;
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeCreate(JNIEnv *env, jobject thiz, jint capacity,
+                                                                   jint maxSpan, jboolean floatSamples) {
+    if (capacity <= 0 || maxSpan <= 0 || maxSpan > capacity) {
+        LOGE("Invalid ring size: capacity=%d, maxSpan=%d", capacity, maxSpan);
+        return 0;
+    }
+
+    try {
+        auto ring = std::make_unique<PcmRingInstance>();
+        if (floatSamples == JNI_TRUE) {
+            ring->pcmFloat = std::make_unique<PcmRingFloat>(capacity, maxSpan);
+        } else {
+            ring->pcm16 = std::make_unique<PcmRing16>(capacity, maxSpan);
+        }
+        return reinterpret_cast<jlong>(ring.release());
+    } catch (const std::exception& e) {
+        LOGE("Exception creating PCM ring: %s", e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeBuffer(JNIEnv *env, jobject thiz, jlong handle) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return nullptr;
+
+    // The producer writes samples straight into the ring's storage
+    return withRing(ring, [env](auto& r) {
+        return env->NewDirectByteBuffer(r.data(), static_cast<jlong>(r.storageBytes()));
+    });
+}
+
+JNIEXPORT jint JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeCapacity(JNIEnv *env, jobject thiz, jlong handle) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return 0;
+    return withRing(ring, [](auto& r) { return static_cast<jint>(r.getCapacity()); });
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeWriteSpan(JNIEnv *env, jobject thiz, jlong handle) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return 0;
+
+    // Position in the high word, length in the low word: one call per span
+    return withRing(ring, [](auto& r) {
+        int length = 0;
+        const int position = r.writeSpan(length);
+        return (static_cast<jlong>(position) << 32) | static_cast<jlong>(static_cast<uint32_t>(length));
+    });
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeCommit(JNIEnv *env, jobject thiz, jlong handle,
+                                                                   jint count, jint dropped) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return;
+    withRing(ring, [count, dropped](auto& r) {
+        // Never publish past the free span: that would expose unwritten
+        // slots to the consumer and overwrite unread ones
+        int length = 0;
+        r.writeSpan(length);
+        if (count > length) {
+            LOGE("Commit of %d samples exceeds the free span of %d", count, length);
+            return;
+        }
+        if (count > 0) r.commit(count);
+        r.drop(dropped);
+    });
+}
+
+JNIEXPORT jint JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeReadable(JNIEnv *env, jobject thiz, jlong handle) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return 0;
+    return withRing(ring, [](auto& r) { return static_cast<jint>(r.readable()); });
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeDropped(JNIEnv *env, jobject thiz, jlong handle) {
+    auto ring = reinterpret_cast<PcmRingInstance*>(handle);
+    if (ring == nullptr) return 0;
+    return withRing(ring, [](auto& r) { return static_cast<jlong>(r.getDropped()); });
+}
+
+JNIEXPORT void JNICALL
+Java_com_juliejohnson_voicegenderpavlok_audio_PcmRing_nativeDestroy(JNIEnv *env, jobject thiz, jlong handle) {
+    delete reinterpret_cast<PcmRingInstance*>(handle);
+}
+}
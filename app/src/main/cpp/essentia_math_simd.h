@@ -0,0 +1,60 @@
+#ifndef ESSENTIA_MATH_SIMD_H
+#define ESSENTIA_MATH_SIMD_H
+
+/**
+ * std::vector<float> overloads of the essentiamath reductions, routed to
+ * the vectorized kernels in simd_kernels.h.
+ *
+ * They are plain (non-template) functions in namespace essentia, so an
+ * unqualified call such as energy(spectrum) in code that includes this
+ * header resolves to them rather than to the templates, with the same
+ * name, arguments and empty-input exceptions. Include it instead of
+ * <essentia/essentiamath.h>. Essentia's own compiled algorithms are not
+ * affected.
+ */
+
+#include <essentia/essentiamath.h>
+
+#include "simd_kernels.h"
+
+namespace essentia {
+
+inline float energy(const std::vector<float>& array) {
+    if (array.empty())
+        throw EssentiaException("trying to calculate energy of empty array");
+    return simdSumSquares(array.data(), static_cast<int>(array.size()));
+}
+
+inline float instantPower(const std::vector<float>& array) {
+    return energy(array) / array.size();
+}
+
+inline float sumSquare(const std::vector<float>& array) {
+    return simdSumSquares(array.data(), static_cast<int>(array.size()));
+}
+
+inline float norm(const std::vector<float>& array) {
+    if (array.empty())
+        throw EssentiaException("trying to calculate norm of empty array");
+    return std::sqrt(simdSumSquares(array.data(), static_cast<int>(array.size())));
+}
+
+inline float sum(const std::vector<float>& array) {
+    return simdSum(array.data(), static_cast<int>(array.size()));
+}
+
+inline float mean(const std::vector<float>& array) {
+    if (array.empty())
+        throw EssentiaException("trying to calculate mean of empty array");
+    return simdSum(array.data(), static_cast<int>(array.size())) / array.size();
+}
+
+inline float variance(const std::vector<float>& array, const float mean) {
+    if (array.empty())
+        throw EssentiaException("trying to calculate variance of empty array");
+    return simdSumSquaredDeviations(array.data(), static_cast<int>(array.size()), mean) / array.size();
+}
+
+} // namespace essentia
+
+#endif // ESSENTIA_MATH_SIMD_H
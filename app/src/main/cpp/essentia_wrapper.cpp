@@ -1,14 +1,19 @@
 #include "essentia_wrapper.h"
-#include "unsupported/Eigen/Polynomials"
+#include "harmonic_model.h"
+#include "pcm_convert.h"
+#include "simd_kernels.h"
+#include "spectral_moments.h"
+#include "trace_events.h"
 #include <android/log.h>
 #include <memory>
 #include <algorithm>
 #include <cmath>
+#include <mutex>
 
 // Include Essentia headers
 #include <essentia/essentia.h>
 #include <essentia/algorithmfactory.h>
-#include <essentia/essentiamath.h>
+#include "essentia_math_simd.h"
 #include <essentia/pool.h>
 
 #define LOG_TAG "EssentiaWrapper"
@@ -19,13 +24,59 @@
 using namespace essentia;
 using namespace essentia::standard;
 
-// Global instance
-std::unique_ptr<EssentiaWrapper> g_essentiaWrapper = nullptr;
+// essentia::init()/shutdown() are process-wide, so they are reference counted
+// across wrapper instances. The same mutex serializes AlgorithmFactory access.
+static std::mutex s_essentiaMutex;
+static int s_essentiaUsers = 0;
+
+// Processing stages behind the public feature bits
+static const uint32_t kStagePitch    = 1u << 0;  // Pitch estimator (+ Windowing for time-domain YIN), always on
+static const uint32_t kStageSpectrum = 1u << 1;  // Shared STFT, Hann magnitude
+static const uint32_t kStageHarmonics = 1u << 2; // Harmonic peak matching for HNR
+static const uint32_t kStageMfcc     = 1u << 3;
+static const uint32_t kStageLpc      = 1u << 4;  // LPC from the spectrum + formant solver
+
+// f0 range searched by the pitch tracker (voice fundamental)
+static const float kTrackerMinHz = 50.0f;
+static const float kTrackerMaxHz = 1000.0f;
+
+// Voice band mode resamples to the lowest rate of at least this much
+// reachable as up/down with both factors <= kVoiceBandMaxFactor. The
+// resampler keeps 0.4 of it flat: 4 kHz, above f0 and the formants.
+static const int kVoiceBandMinRate = 10000;
+static const int kVoiceBandMaxFactor = 8;
+
+// Frame energy below which a frame is treated as silence, for frames of
+// the input size; scaled with the analysis frame length
+static const float kEnergyThreshold = 0.001f;
+
+// Default peak band lower edge and peak threshold, the SpectralPeaks
+// settings the analyzer used
+static const float kPeakMinHz = 40.0f;
+static const float kPeakMagnitudeThreshold = 1e-5f;
+
+// MFCC mel bank upper edge, capped at the analysis Nyquist frequency
+static const int kMfccHighFrequency = 11000;
 
 EssentiaWrapper::EssentiaWrapper()
         : sampleRate(44100)
         , frameSize(1024)
         , hopSize(512)
+        , analysisRate(44100)
+        , analysisFrameSize(1024)
+        , energyThreshold(kEnergyThreshold)
+        , mfccCount(13)
+        , lpcOrder(0)
+        , featureSet(kFeatureAll)
+        , pitchMethod(kPitchYinFft)
+        , harmonicMethod(kHarmonicModel)
+        , peakMinHz(kPeakMinHz)
+        , peakMaxHz(0.0f)
+        , pitchTracking(false)
+        , voiceBand(false)
+        , stages(0)
+        , frameCounter(0)
+        , essentiaAcquired(false)
         , initialized(false) {
 }
 
@@ -33,64 +84,41 @@ EssentiaWrapper::~EssentiaWrapper() {
     cleanup();
 }
 
-bool EssentiaWrapper::initialize(int sr, int fs, int hs) {
+bool EssentiaWrapper::initialize(int sr, int fs, int hs, FeatureSet features) {
     if (initialized) {
         LOGD("EssentiaWrapper already initialized");
         return true;
     }
 
     try {
-        LOGI("Initializing Essentia with sampleRate=%d, frameSize=%d, hopSize=%d", sr, fs, hs);
+        LOGI("Initializing Essentia with sampleRate=%d, frameSize=%d, hopSize=%d, features=0x%x, pitch=%s%s",
+             sr, fs, hs, features, pitchMethod == kPitchYinFft ? "yinfft" : "yin", voiceBand ? ", voice band" : "");
 
-        // Initialize Essentia
-        essentia::init();
+        std::lock_guard<std::mutex> lock(s_essentiaMutex);
+
+        // Initialize Essentia (first instance only)
+        if (s_essentiaUsers++ == 0) {
+            essentia::init();
+        }
+        essentiaAcquired = true;
 
         sampleRate = sr;
         frameSize = fs;
         hopSize = hs;
+        configureAnalysisRate();
 
-        // Create algorithm factory
-        AlgorithmFactory& factory = AlgorithmFactory::instance();
-
-        /////////////////////////
-        // Initialize algorithms
-        /////////////////////////
-
-        //Energy algorithm
-        energyAlg.reset(factory.create("Energy"));
-
-        pitchYin.reset(factory.create("PitchYin",
-                                      "frameSize", frameSize,
-                                      "sampleRate", sampleRate));
-
-        centroidAlg.reset(factory.create("Centroid"));
-
-        mfccAlg.reset(factory.create("MFCC",
-                                     "inputSize", frameSize/2 + 1,
-                                     "numberCoefficients", 13));
-
-        windowAlg.reset(factory.create("Windowing",
-                                       "type", "hann"));
-
-        spectrumAlg.reset(factory.create("Spectrum"));
+        featureSet = features | kFeaturePitch;
+        stages = 0;
+        createAlgorithms(stagesFor(featureSet, pitchMethod));
 
-        spectralPeaksAlg.reset(factory.create("SpectralPeaks",
-                                              "magnitudeThreshold", 0.00001,
-                                              "minFrequency", 40,
-                                              "maxFrequency", sampleRate/2,
-                                              "maxPeaks", 100));
-
-        harmonicPeaksAlg.reset(factory.create("HarmonicPeaks"));
-
-        stochasticModelAnalAlg.reset(factory.create("StochasticModelAnal", "sampleRate", sampleRate));
-
-        // Implement LPC algorithm
-        int lpcOrder = 2 + (int)(this->sampleRate / 1000.0);
-        lpcAlg.reset(factory.create("LPC",
-                                    "order", lpcOrder));
+        pcmBuffer.assign(frameSize, 0.0f);
+        bufferFeatures.mfcc.reserve(mfccCount);
+        bufferFeatures.formants.reserve(lpcOrder);
+        bufferFeatures.formantBandwidths.reserve(lpcOrder);
 
         initialized = true;
-        LOGI("Essentia initialization completed successfully");
+        LOGI("Essentia initialization completed: %d algorithms, %zu workspace bytes",
+             getAlgorithmCount(), getWorkspaceBytes());
         return true;
 
     } catch (const EssentiaException& e) {
@@ -108,357 +136,808 @@ bool EssentiaWrapper::initialize(int sr, int fs, int hs) {
     }
 }
 
-AudioFeatures EssentiaWrapper::analyzeFrame(const float* audioData, int length) {
+bool EssentiaWrapper::setFeatureSet(FeatureSet features) {
     if (!initialized) {
         LOGE("EssentiaWrapper not initialized");
-        return {};
+        return false;
     }
 
-    if (audioData == nullptr || length < frameSize) {
-        LOGE("Invalid audio data: data=%p, length=%d, required=%d", audioData, length, frameSize);
-        return {};
+    features |= kFeaturePitch;
+    const uint32_t required = stagesFor(features, pitchMethod);
+    if ((required & ~stages) != 0) {
+        try {
+            std::lock_guard<std::mutex> lock(s_essentiaMutex);
+            createAlgorithms(required);
+        } catch (const std::exception& e) {
+            LOGE("Exception while enabling features 0x%x: %s", features, e.what());
+            return false;
+        }
+        LOGI("Feature set 0x%x: %d algorithms, %zu workspace bytes",
+             features, getAlgorithmCount(), getWorkspaceBytes());
+    }
+
+    featureSet = features;
+    return true;
+}
+
+bool EssentiaWrapper::setPitchMethod(PitchMethod method) {
+    if (method == pitchMethod) {
+        return true;
+    }
+    if (!initialized) {
+        pitchMethod = method;
+        return true;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(s_essentiaMutex);
+        pitchMethod = method;
+        // Rebuild the pitch stage (and the spectrum stage if YinFFT now needs it)
+        stages &= ~kStagePitch;
+        createAlgorithms(stagesFor(featureSet, pitchMethod));
+    } catch (const std::exception& e) {
+        LOGE("Exception while switching pitch method: %s", e.what());
+        return false;
+    }
+    LOGI("Pitch method %s", method == kPitchYinFft ? "yinfft" : "yin");
+    return true;
+}
+
+bool EssentiaWrapper::setVoiceBand(bool enabled) {
+    if (enabled == voiceBand) {
+        return true;
+    }
+    if (!initialized) {
+        voiceBand = enabled;
+        return true;
     }
 
     try {
-        // Preprocess audio data
-        std::vector<float> audioFrame = preprocessAudio(audioData, std::min(length, frameSize));
-
-        AudioFeatures features;
-
-        float frameEnergy;
-        energyAlg->input("array").set(audioFrame);
-        energyAlg->output("energy").set(frameEnergy);
-        energyAlg->compute();
-
-        // --- NEW: VAD Step 2 - The "Gate" ---
-        // If the energy is below a certain threshold, it's silence.
-        // We stop here and return an empty vector to save resources.
-        // This threshold may need tuning, but it's a good starting point.
-        const float energyThreshold = 0.001;
-        if (frameEnergy < energyThreshold) {
-            LOGD("Frame energy below threshold, returning empty features");
-            return {};
+        std::lock_guard<std::mutex> lock(s_essentiaMutex);
+        voiceBand = enabled;
+        // Every stage is sized for the analysis rate, so all are rebuilt
+        releaseAlgorithms();
+        configureAnalysisRate();
+        createAlgorithms(stagesFor(featureSet, pitchMethod));
+    } catch (const std::exception& e) {
+        LOGE("Exception while switching voice band mode: %s", e.what());
+        return false;
+    }
+    bufferFeatures.formants.reserve(lpcOrder);
+    bufferFeatures.formantBandwidths.reserve(lpcOrder);
+    return true;
+}
+
+void EssentiaWrapper::setPitchTracking(bool enabled) {
+    if (enabled != pitchTracking) {
+        pitchTracker.reset();
+    }
+    pitchTracking = enabled;
+}
+
+void EssentiaWrapper::setHarmonicMethod(HarmonicMethod method) {
+    if (method != harmonicMethod) {
+        workspace.peaks.count = 0;
+        LOGI("Harmonic method %s", method == kHarmonicModel ? "model" : "peak list");
+    }
+    harmonicMethod = method;
+}
+
+bool EssentiaWrapper::setPeakBand(float minHz, float maxHz) {
+    if (minHz < 0.0f || maxHz < 0.0f || (maxHz > 0.0f && maxHz <= minHz)) {
+        LOGE("Invalid peak band: %.1f-%.1f Hz", minHz, maxHz);
+        return false;
+    }
+    peakMinHz = minHz;
+    peakMaxHz = maxHz;
+    return true;
+}
+
+uint32_t EssentiaWrapper::stagesFor(FeatureSet features, PitchMethod method) {
+    uint32_t required = kStagePitch;
+    if (method == kPitchYinFft ||
+        (features & (kFeatureCentroid | kFeatureMfcc | kFeatureHnr | kFeatureBrightness | kFeatureResonance |
+                     kFeatureFormants))) {
+        required |= kStageSpectrum;
+    }
+    if (features & kFeatureMfcc) required |= kStageMfcc;
+    if (features & kFeatureHnr) required |= kStageSpectrum | kStageHarmonics;
+    if (features & kFeatureFormants) required |= kStageSpectrum | kStageLpc;
+    return required;
+}
+
+void EssentiaWrapper::configureAnalysisRate() {
+    int up = 1;
+    int down = 1;
+    if (voiceBand) {
+        chooseResampleRatio(sampleRate, kVoiceBandMinRate, kVoiceBandMaxFactor, up, down);
+    }
+
+    analysisRate = static_cast<int>(static_cast<long long>(sampleRate) * up / down);
+    // Even, as the spectrum algorithms expect
+    analysisFrameSize = static_cast<int>(static_cast<long long>(frameSize) * up / down) & ~1;
+    energyThreshold = kEnergyThreshold * analysisFrameSize / frameSize;
+    lpcOrder = 2 + (int)(analysisRate / 1000.0);
+    pitchTracker.configure(static_cast<float>(analysisRate), analysisFrameSize, kTrackerMinHz, kTrackerMaxHz);
+
+    if (analysisRate != sampleRate) {
+        resampler.configure(sampleRate, analysisRate);
+        workspace.inputFrame.assign(frameSize, 0.0f);
+        LOGI("Voice band: %d Hz -> %d Hz, frame %d -> %d samples, LPC order %d",
+             sampleRate, analysisRate, frameSize, analysisFrameSize, lpcOrder);
+    } else {
+        std::vector<float>().swap(workspace.inputFrame);
+        std::vector<float>().swap(voiceBuffer);
+    }
+}
+
+void EssentiaWrapper::createAlgorithms(uint32_t requiredStages) {
+    // Caller holds s_essentiaMutex. Each stage sizes its buffers for the
+    // largest output its algorithms can produce, so the resize() calls
+    // inside compute() never reallocate, and binds its ports once so the
+    // frame path neither allocates nor looks up ports by name.
+    AlgorithmFactory& factory = AlgorithmFactory::instance();
+    Workspace& ws = workspace;
+    const uint32_t missing = requiredStages & ~stages;
+
+    if (missing & kStagePitch) {
+        ws.frame.assign(analysisFrameSize, 0.0f);
+
+        // Only time-domain YIN reads a windowed frame; everything else
+        // windows in the frequency domain off the shared STFT
+        if (pitchMethod == kPitchYin && !windowAlg) {
+            ws.windowedFrame.assign(analysisFrameSize, 0.0f);
+            windowAlg.reset(factory.create("Windowing",
+                                           "type", "hann"));
+            windowAlg->input("frame").set(ws.frame);
+            windowAlg->output("frame").set(ws.windowedFrame);
+        }
+    }
+
+    if (missing & kStageSpectrum) {
+        ws.spectrum.assign(analysisFrameSize / 2 + 1, 0.0f);
+        if (!stft.configure(analysisFrameSize)) {
+            throw EssentiaException("STFT does not support frame size ", analysisFrameSize);
         }
+    }
 
-        // Apply windowing
-        std::vector<float> windowedFrame;
-        windowAlg->input("frame").set(audioFrame);
-        windowAlg->output("frame").set(windowedFrame);
-        windowAlg->compute();
+    if (missing & kStagePitch) {
+        // YinFFT squares the magnitude spectrum and inverse transforms it to
+        // get the autocorrelation, so it reuses the Hann-windowed spectrum
+        // the other spectral features already need
+        if (pitchMethod == kPitchYinFft) {
+            pitchYin.reset(factory.create("PitchYinFFT",
+                                          "frameSize", analysisFrameSize,
+                                          "sampleRate", analysisRate));
+            pitchYin->input("spectrum").set(ws.spectrum);
+        } else {
+            pitchYin.reset(factory.create("PitchYin",
+                                          "frameSize", analysisFrameSize,
+                                          "sampleRate", analysisRate));
+            pitchYin->input("signal").set(ws.windowedFrame);
+        }
+        pitchYin->output("pitch").set(ws.pitch);
+        pitchYin->output("pitchConfidence").set(ws.pitchConfidence);
+    }
 
-        // Compute spectrum
-        std::vector<float> spectrum;
-        spectrumAlg->input("frame").set(windowedFrame);
-        spectrumAlg->output("spectrum").set(spectrum);
-        spectrumAlg->compute();
-
-        std::vector<float> peak_freqs, peak_mags;
-        // 3. Find all spectral peaks (frequencies and magnitudes)
-        spectralPeaksAlg->input("spectrum").set(spectrum);
-        spectralPeaksAlg->output("frequencies").set(peak_freqs);
-        spectralPeaksAlg->output("magnitudes").set(peak_mags);
-        spectralPeaksAlg->compute();
-
-        // Extract pitch using YIN algorithm
-        float pitch, pitchConfidence;
-        pitchYin->input("signal").set(windowedFrame);
-        pitchYin->output("pitch").set(pitch);
-        pitchYin->output("pitchConfidence").set(pitchConfidence);
-        pitchYin->compute();
-
-        LOGD("Pitch analysis complete: pitch=%.2f, confidence=%.2f",
-             pitch, pitchConfidence);
-
-        // Only use pitch if confidence is reasonable
-        features.pitch = (pitchConfidence > 0.5) ? pitch : 0.0f;
+    if (missing & kStageHarmonics) {
+        ws.harmonicFrequencies.assign(kMaxHarmonics, 0.0f);
+        ws.harmonicMagnitudes.assign(kMaxHarmonics, 0.0f);
+        ws.peaks.count = 0;
+        peakPicker.configure(analysisFrameSize / 2 + 1, static_cast<float>(analysisRate) / analysisFrameSize,
+                             kPeakMagnitudeThreshold);
+    }
 
-        if (features.pitch == 0.0f) {
-            LOGD("Pitch confidence too low, returning empty features");
-            return features;
+    if (missing & kStageMfcc) {
+        ws.mfccBands.reserve(64);
+        ws.mfccCoeffs.reserve(mfccCount);
+
+        mfccAlg.reset(factory.create("MFCC",
+                                     "inputSize", analysisFrameSize/2 + 1,
+                                     "sampleRate", analysisRate,
+                                     "highFrequencyBound", std::min(kMfccHighFrequency, analysisRate/2),
+                                     "numberCoefficients", mfccCount));
+        mfccAlg->input("spectrum").set(ws.spectrum);
+        mfccAlg->output("bands").set(ws.mfccBands);
+        mfccAlg->output("mfcc").set(ws.mfccCoeffs);
+    }
+
+    if (missing & kStageLpc) {
+        ws.lpcCoeffs.assign(lpcOrder + 1, 0.0f);
+        ws.reflection.assign(lpcOrder, 0.0f);
+        formantSolver.configure(lpcOrder, static_cast<float>(analysisRate));
+
+        // Autocorrelation from the Hann-windowed frame's spectrum (the same
+        // frame Essentia's LPC would correlate), then Levinson-Durbin
+        if (!spectralLpc.configure(analysisFrameSize, lpcOrder)) {
+            throw EssentiaException("LPC order ", lpcOrder, " does not fit frame size ", analysisFrameSize);
         }
+    }
 
-        // Compute spectral centroid
-        float centroid;
-        centroidAlg->input("array").set(spectrum);
-        centroidAlg->output("centroid").set(centroid);
-        centroidAlg->compute();
-        features.centroid = centroid;
-
-        // Compute MFCC
-        std::vector<float> mfccBands, mfccCoeffs;
-        mfccAlg->input("spectrum").set(spectrum);
-        mfccAlg->output("bands").set(mfccBands);
-        mfccAlg->output("mfcc").set(mfccCoeffs);
-        mfccAlg->compute();
-        features.mfcc = mfccCoeffs;
-
-        //LPC
-        std::vector<float> lpcCoeffs, reflection;
-        lpcAlg->input("frame").set(windowedFrame);
-        lpcAlg->output("lpc").set(lpcCoeffs);
-        lpcAlg->output("reflection").set(reflection);
-        lpcAlg->compute();
-
-        std::vector<float> harmonic_peaks_freq, harmonic_peaks_mag;
-        float harmonic_energy, total_energy;
-        harmonicPeaksAlg->input("pitch").set(pitch);
-        harmonicPeaksAlg->input("frequencies").set(peak_freqs);
-        harmonicPeaksAlg->input("magnitudes").set(peak_mags);
-        harmonicPeaksAlg->output("harmonicMagnitudes").set(harmonic_peaks_mag);
-        harmonicPeaksAlg->output("harmonicFrequencies").set(harmonic_peaks_freq);
-        harmonicPeaksAlg->compute();
-
-        energyAlg->input("array").set(spectrum);
-        energyAlg->output("energy").set(total_energy);
-        energyAlg->compute();
-
-        // 6. Calculate the energy of JUST the harmonic part
-        energyAlg->input("array").set(harmonic_peaks_mag);
-        energyAlg->output("energy").set(harmonic_energy);
-        energyAlg->compute();
-
-        // Calculate HNR in Decibels
-        // --- Calculate HNR in decibels ---
-        float noise_energy = total_energy - harmonic_energy;
-        float hnr = 10 * log10(harmonic_energy / noise_energy);
-        if (noise_energy <= 0) hnr = 100.0f; // If no noise, HNR is effectively infinite
-        if (harmonic_energy <= 0) hnr = 0.0f; // If no harmonics, HNR is zero
-        features.hnr = hnr;
-
-        // Calculate brightness (high frequency energy ratio)
-        features.brightness = calculateBrightness(spectrum);
-
-        // Calculate resonance (simplified)
-        features.resonance = calculateResonance(spectrum, features.pitch);
-
-        // Calculate formants
-        features.formants = calculateFormants(lpcCoeffs);
+    stages |= missing;
+}
 
-        features.isValid = true;
+void EssentiaWrapper::releaseAlgorithms() {
+    // Caller holds s_essentiaMutex
+    pitchYin.reset();
+    mfccAlg.reset();
+    windowAlg.reset();
+    stages = 0;
+}
+
+size_t EssentiaWrapper::getWorkspaceBytes() const {
+    const Workspace& ws = workspace;
+    size_t bytes = 0;
+    for (const std::vector<float>* v : {&ws.inputFrame, &ws.frame, &ws.windowedFrame, &ws.spectrum,
+                                        &ws.harmonicFrequencies, &ws.harmonicMagnitudes,
+                                        &ws.mfccBands, &ws.mfccCoeffs, &ws.lpcCoeffs,
+                                        &ws.reflection, &ws.logMelPower, &pcmBuffer, &voiceBuffer}) {
+        bytes += v->capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+int EssentiaWrapper::getAlgorithmCount() const {
+    int count = 0;
+    for (const std::unique_ptr<Algorithm>* alg : {&pitchYin, &mfccAlg, &windowAlg}) {
+        count += (*alg != nullptr);
+    }
+    return count;
+}
+
+AudioFeatures EssentiaWrapper::analyzeFrame(const float* audioData, int length) {
+    AudioFeatures features;
+    analyzeFrame(audioData, length, features);
+    return features;
+}
+
+bool EssentiaWrapper::analyzeFrame(const float* audioData, int length, AudioFeatures& features) {
+    float dcOffset = 0.0f;
+    if (audioData != nullptr && length >= frameSize) {
+        dcOffset = frameMean(audioData);
+    }
+    return analyzeFrame(audioData, length, dcOffset, features);
+}
+
+bool EssentiaWrapper::analyzeFrame(const float* audioData, int length, float dcOffset, AudioFeatures& features) {
+    features.clear();
 
-        LOGD("Analysis complete: pitch=%.2f, centroid=%.2f, brightness=%.3f, formants=%zu, hnr=%.2f, resonance=%.2f",
-             features.pitch, features.centroid, features.brightness, features.formants.size(), features.hnr, features.resonance);
+    if (!initialized) {
+        LOGE("EssentiaWrapper not initialized");
+        return false;
+    }
 
-        return features;
+    if (audioData == nullptr || length < frameSize) {
+        LOGE("Invalid audio data: data=%p, length=%d, required=%d", audioData, length, frameSize);
+        return false;
+    }
+
+    // Preprocess audio data
+    preprocessAudio(audioData, dcOffset);
+    return analyzePreparedFrame(features);
+}
+
+bool EssentiaWrapper::analyzePreparedFrame(AudioFeatures& features) {
+    // workspace.frame holds analysisFrameSize samples at analysisRate, DC removed
+    try {
+        ++frameCounter;
+        TRACE_SCOPE(kTraceFrame, frameCounter);
+
+        if (!frontEndStage()) {
+            if (pitchTracking) pitchTracker.markUnvoiced();
+            return false;
+        }
+        if (!spectralStage(features)) {
+            return false;
+        }
+        envelopeStage(features);
+
+        features.isValid = true;
+        return true;
 
     } catch (const EssentiaException& e) {
         LOGE("Essentia exception during analysis: %s", e.what());
-        return {};
+        features.clear();
+        return false;
     } catch (const std::exception& e) {
         LOGE("Standard exception during analysis: %s", e.what());
-        return {};
+        features.clear();
+        return false;
     } catch (...) {
         LOGE("Unknown exception during analysis");
-        return {};
+        features.clear();
+        return false;
     }
 }
 
-std::vector<AudioFeatures> EssentiaWrapper::analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize) {
-    std::vector<AudioFeatures> results;
+bool EssentiaWrapper::frontEndStage() {
+    Workspace& ws = workspace;
 
-    if (!initialized || audioBuffer == nullptr || bufferLength < frameSize) {
-        LOGE("Invalid parameters for buffer analysis");
-        return results;
+    float frameEnergy = energy(ws.frame);
+    TRACE_VALUE(kTraceEnergyGate, frameCounter, frameEnergy);
+
+    // --- NEW: VAD Step 2 - The "Gate" ---
+    // If the energy is below a certain threshold, it's silence.
+    // We stop here and return an empty vector to save resources.
+    // This threshold may need tuning, but it's a good starting point.
+    if (frameEnergy < energyThreshold) {
+        return false;
     }
 
-    // Process buffer with sliding window
-    for (int i = 0; i <= bufferLength - frameSize; i += hopSize) {
-        AudioFeatures features = analyzeFrame(audioBuffer + i, frameSize);
-        if (features.isValid) {
-            results.push_back(features);
+    // Apply windowing (time-domain YIN input only)
+    if (pitchMethod == kPitchYin) {
+        TRACE_SCOPE(kTraceWindow, frameCounter);
+        windowAlg->compute();
+    }
+
+    // Compute spectrum, unless the buffer loop already transformed this frame
+    if (stages & kStageSpectrum) {
+        TRACE_SCOPE(kTraceSpectrum, frameCounter);
+        if (!ws.transformed) {
+            stft.transform(ws.frame.data());
         }
+        stft.hannMagnitude(ws.spectrum.data());
     }
+    return true;
+}
 
-    LOGD("Buffer analysis complete: %zu frames processed", results.size());
-    return results;
+bool EssentiaWrapper::spectralStage(AudioFeatures& features) {
+    Workspace& ws = workspace;
+
+    // Extract pitch (YinFFT on the spectrum, or time-domain YIN)
+    {
+        TRACE_SCOPE(kTracePitch, frameCounter);
+        if (!pitchTracking) {
+            pitchYin->compute();
+            // Only use pitch if confidence is reasonable
+            if (ws.pitchConfidence <= 0.5) ws.pitch = 0.0f;
+        } else {
+            // The full-range estimator only seeds the tracker when the
+            // track is lost or weak; the tracker applies its own voicing
+            float seedHz = 0.0f;
+            if (pitchTracker.needsSeed()) {
+                pitchYin->compute();
+                seedHz = (ws.pitchConfidence > 0.5) ? ws.pitch : 0.0f;
+            }
+            ws.pitch = pitchTracker.update(ws.frame.data(), seedHz, ws.pitchConfidence);
+        }
+    }
+    TRACE_VALUE(kTracePitch, frameCounter, ws.pitch);
+    TRACE_VALUE(kTracePitchConfidence, frameCounter, ws.pitchConfidence);
+
+    features.pitch = ws.pitch;
+
+    if (features.pitch == 0.0f) {
+        return false;
+    }
+
+    spectralFeatures(ws.spectrum, features);
+    return true;
 }
 
-void EssentiaWrapper::cleanup() {
-    if (initialized) {
-        LOGI("Cleaning up Essentia resources");
+void EssentiaWrapper::spectralFeatures(const std::vector<float>& spectrum, AudioFeatures& features) {
+    Workspace& ws = workspace;
 
-        // Reset all algorithm pointers
-        pitchYin.reset();
-        centroidAlg.reset();
-        mfccAlg.reset();
-        windowAlg.reset();
-        spectrumAlg.reset();
-        spectralPeaksAlg.reset();
-        harmonicPeaksAlg.reset();
-        stochasticModelAnalAlg.reset();
-        lpcAlg.reset();
-        energyAlg.reset();
-
-        // Shutdown Essentia
-        try {
-            essentia::shutdown();
-        } catch (...) {
-            LOGE("Exception during Essentia shutdown");
+    // Centroid, energy split, harmonic samples: one pass over the spectrum
+    if (featureSet & (kFeatureCentroid | kFeatureHnr | kFeatureBrightness | kFeatureResonance)) {
+        TRACE_SCOPE(kTraceSpectralMoments, frameCounter);
+        computeMoments(spectrum, features.pitch);
+        if (featureSet & kFeatureCentroid) features.centroid = ws.moments.centroid;
+        if (featureSet & kFeatureBrightness) features.brightness = ws.moments.brightness;
+        if (featureSet & kFeatureResonance) features.resonance = ws.moments.resonance;
+    }
+
+    if (featureSet & kFeatureHnr) {
+        TRACE_SCOPE(kTraceHnr, frameCounter);
+
+        // Harmonic peaks against the moments' total energy
+        HarmonicModel model;
+        if (harmonicMethod == kHarmonicPeakList) {
+            // Nothing past the last harmonic's tolerance can match
+            float maxHz = std::min(0.5f * analysisRate, (kMaxHarmonics + 0.5f) * features.pitch);
+            if (peakMaxHz > 0.0f) maxHz = std::min(maxHz, peakMaxHz);
+            peakPicker.pick(spectrum.data(), peakMinHz, maxHz, ws.peaks);
+            matchHarmonicPeaks(ws.peaks, features.pitch, ws.moments.energy, ws.harmonicFrequencies.data(),
+                               ws.harmonicMagnitudes.data(), model);
+        } else {
+            // Peaks near each harmonic of f0 only
+            computeHarmonicModel(spectrum.data(), static_cast<int>(spectrum.size()),
+                                 static_cast<float>(analysisRate) / analysisFrameSize, features.pitch,
+                                 ws.moments.energy, ws.harmonicFrequencies.data(), ws.harmonicMagnitudes.data(),
+                                 model);
         }
+        features.hnr = harmonicToNoiseDb(model);
+    }
+}
 
-        initialized = false;
-        LOGI("Essentia cleanup completed");
+void EssentiaWrapper::envelopeStage(AudioFeatures& features) {
+    Workspace& ws = workspace;
+
+    // Compute MFCC
+    if (featureSet & kFeatureMfcc) {
+        TRACE_SCOPE(kTraceMfcc, frameCounter);
+        mfccAlg->compute();
+        features.mfcc.assign(ws.mfccCoeffs.begin(), ws.mfccCoeffs.end());
+    }
+
+    // LPC and formants
+    if (featureSet & kFeatureFormants) {
+        {
+            TRACE_SCOPE(kTraceLpc, frameCounter);
+            spectralLpc.compute(ws.spectrum.data(), ws.lpcCoeffs.data(), ws.reflection.data());
+        }
+        TRACE_SCOPE(kTraceFormants, frameCounter);
+        calculateFormants(ws.lpcCoeffs, features);
     }
 }
 
-float EssentiaWrapper::calculateBrightness(const std::vector<float>& spectrum) {
-    if (spectrum.empty()) return 0.0f;
+bool EssentiaWrapper::completeFrame(const std::vector<float>& frame, const std::vector<float>& spectrum, float pitch,
+                                    float pitchConfidence, const std::vector<float>& mfcc,
+                                    const std::vector<float>& lpcCoeffs, AudioFeatures& features) {
+    features.clear();
+
+    if (!initialized || frame.size() != static_cast<size_t>(analysisFrameSize)
+        || spectrum.size() != static_cast<size_t>(analysisFrameSize / 2 + 1)) {
+        LOGE("Frame does not match this analyzer: %zu samples, %zu bins", frame.size(), spectrum.size());
+        return false;
+    }
 
-    // Calculate brightness as ratio of high frequency energy to total energy
-    const size_t cutoffBin = spectrum.size() / 4; // Rough cutoff at 1/4 of Nyquist
+    ++frameCounter;
+    TRACE_SCOPE(kTraceFrame, frameCounter);
 
-    float totalEnergy = 0.0f;
-    float highFreqEnergy = 0.0f;
+    const float frameEnergy = energy(frame);
+    TRACE_VALUE(kTraceEnergyGate, frameCounter, frameEnergy);
+    if (frameEnergy < energyThreshold) {
+        if (pitchTracking) pitchTracker.markUnvoiced();
+        return false;
+    }
 
-    for (size_t i = 0; i < spectrum.size(); ++i) {
-        float energy = spectrum[i] * spectrum[i];
-        totalEnergy += energy;
-        if (i >= cutoffBin) {
-            highFreqEnergy += energy;
-        }
+    // The estimator already ran; apply the same voicing as spectralStage
+    if (!pitchTracking) {
+        features.pitch = (pitchConfidence > 0.5) ? pitch : 0.0f;
+    } else {
+        const float seedHz = (pitchTracker.needsSeed() && pitchConfidence > 0.5) ? pitch : 0.0f;
+        features.pitch = pitchTracker.update(frame.data(), seedHz, pitchConfidence);
     }
+    TRACE_VALUE(kTracePitch, frameCounter, features.pitch);
+    TRACE_VALUE(kTracePitchConfidence, frameCounter, pitchConfidence);
 
-    return (totalEnergy > 0.0f) ? (highFreqEnergy / totalEnergy) : 0.0f;
+    if (features.pitch == 0.0f) {
+        return false;
+    }
+
+    spectralFeatures(spectrum, features);
+
+    if (featureSet & kFeatureMfcc) {
+        features.mfcc.assign(mfcc.begin(), mfcc.end());
+    }
+    if (featureSet & kFeatureFormants) {
+        TRACE_SCOPE(kTraceFormants, frameCounter);
+        calculateFormants(lpcCoeffs, features);
+    }
+
+    features.isValid = true;
+    return true;
 }
 
-float EssentiaWrapper::calculateResonance(const std::vector<float>& spectrum, float pitch) {
-    if (spectrum.empty() || pitch <= 0.0f) return 0.0f;
+std::unique_lock<std::mutex> EssentiaWrapper::lockFactory() {
+    return std::unique_lock<std::mutex>(s_essentiaMutex);
+}
 
-    // Simplified resonance calculation based on harmonic strength
-    const float binWidth = static_cast<float>(sampleRate) / (2.0f * spectrum.size());
-    float resonance = 0.0f;
+void EssentiaWrapper::prepareStageFrame(StageFrame& frame) const {
+    const Workspace& ws = workspace;
+    frame.input.assign(frameSize, 0.0f);
+    frame.frame.assign(ws.frame.size(), 0.0f);
+    frame.windowedFrame.assign(ws.windowedFrame.size(), 0.0f);
+    frame.spectrum.assign(ws.spectrum.size(), 0.0f);
+    frame.features.clear();
+    frame.features.mfcc.reserve(mfccCount);
+    frame.features.formants.reserve(lpcOrder);
+    frame.features.formantBandwidths.reserve(lpcOrder);
+    frame.active = false;
+}
 
-    // Look for harmonics
-    for (int harmonic = 1; harmonic <= 5; ++harmonic) {
-        float harmonicFreq = pitch * harmonic;
-        if (harmonicFreq >= sampleRate / 2.0f) break;
+bool EssentiaWrapper::runStage(AnalysisStage stage, StageFrame& frame) {
+    if (!initialized || frame.input.size() != static_cast<size_t>(frameSize)
+        || frame.frame.size() != workspace.frame.size() || frame.spectrum.size() != workspace.spectrum.size()) {
+        LOGE("Stage frame not prepared for this analyzer");
+        frame.active = false;
+        return false;
+    }
+
+    // The algorithms are bound to the workspace vectors, not their storage,
+    // so swapping the frame's buffers in hands them this frame's data
+    // without a copy. They are swapped back out below.
+    Workspace& ws = workspace;
+    ws.frame.swap(frame.frame);
+    ws.windowedFrame.swap(frame.windowedFrame);
+    ws.spectrum.swap(frame.spectrum);
+    ws.transformed = false;
 
-        int bin = static_cast<int>(harmonicFreq / binWidth);
-        if (bin < static_cast<int>(spectrum.size())) {
-            resonance += spectrum[bin] / harmonic; // Weight by inverse harmonic number
+    try {
+        switch (stage) {
+            case kAnalysisFrontEnd:
+                frame.features.clear();
+                frameCounter = frame.sequence - 1;
+                preprocessAudio(frame.input.data(), frameMean(frame.input.data()));
+                frameCounter = frame.sequence;
+                frame.active = frontEndStage();
+                break;
+            case kAnalysisSpectral:
+                frameCounter = frame.sequence;
+                if (frame.restartTrack) pitchTracker.reset();
+                if (frame.active) {
+                    frame.active = spectralStage(frame.features);
+                } else if (pitchTracking) {
+                    pitchTracker.markUnvoiced();
+                }
+                break;
+            case kAnalysisEnvelope:
+                frameCounter = frame.sequence;
+                if (frame.active) {
+                    envelopeStage(frame.features);
+                    frame.features.isValid = true;
+                }
+                break;
         }
+    } catch (const EssentiaException& e) {
+        LOGE("Essentia exception during analysis stage %d: %s", stage, e.what());
+        frame.features.clear();
+        frame.active = false;
+    } catch (const std::exception& e) {
+        LOGE("Standard exception during analysis stage %d: %s", stage, e.what());
+        frame.features.clear();
+        frame.active = false;
+    } catch (...) {
+        LOGE("Unknown exception during analysis stage %d", stage);
+        frame.features.clear();
+        frame.active = false;
     }
 
-    return resonance;
+    ws.frame.swap(frame.frame);
+    ws.windowedFrame.swap(frame.windowedFrame);
+    ws.spectrum.swap(frame.spectrum);
+    return frame.active;
 }
 
-std::vector<float> EssentiaWrapper::calculateFormants(
-        std::vector<float> lpcCoeffs) {
+std::vector<AudioFeatures> EssentiaWrapper::analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize) {
+    std::vector<AudioFeatures> results;
+
+    if (!initialized || audioBuffer == nullptr || bufferLength < frameSize) {
+        LOGE("Invalid parameters for buffer analysis");
+        return results;
+    }
+
+    TRACE_SCOPE(kTraceBuffer, frameCounter);
+    pitchTracker.reset();
+
+    results.reserve((bufferLength - frameSize) / hopSize + 1);
 
-    if (!lpcCoeffs.empty()) {
-        // Create a string stream to build our log message
-        std::stringstream ss;
-        ss << "LPC Coeffs (Size: " << lpcCoeffs.size() << "): [";
-        for (size_t i = 0; i < lpcCoeffs.size(); ++i) {
-            ss << lpcCoeffs[i] << (i == lpcCoeffs.size() - 1 ? "" : ", ");
+    if (analysisRate != sampleRate) {
+        // Voice band: resample the whole buffer once rather than every
+        // overlapping frame, then take the same frames at the analysis rate
+        const int voiceLength = resampler.outputLength(bufferLength);
+        if (static_cast<int>(voiceBuffer.size()) < voiceLength) {
+            voiceBuffer.resize(voiceLength);
+        }
+        {
+            TRACE_SCOPE(kTraceResample, frameCounter);
+            resampler.resample(audioBuffer, bufferLength, voiceBuffer.data(), voiceLength);
         }
-        ss << "]";
 
-        // Print the full string to Logcat with our "EssentiaWrapper" tag
-        __android_log_print(ANDROID_LOG_DEBUG, "EssentiaWrapper", "%s", ss.str().c_str());
-    } else {
-        __android_log_print(ANDROID_LOG_DEBUG, "EssentiaWrapper", "LPC Coeffs vector is empty.");
+        const int up = resampler.getUpFactor();
+        const int down = resampler.getDownFactor();
+        for (int i = 0; i <= bufferLength - frameSize; i += hopSize) {
+            const float* frame = voiceBuffer.data() + static_cast<long long>(i) * up / down;
+            const float dcOffset = simdSum(frame, analysisFrameSize) / analysisFrameSize;
+            simdSubtract(frame, dcOffset, workspace.frame.data(), analysisFrameSize);
+            if (analyzePreparedFrame(bufferFeatures)) {
+                results.push_back(bufferFeatures);
+            }
+        }
+
+        LOGD("Buffer analysis complete: %zu frames processed", results.size());
+        return results;
     }
 
-    // --- Part 2: Find Formants from LPC Coefficients ---
-    if (lpcCoeffs.empty()) {
-        return {};
+    // Process buffer with sliding window
+    for (int i = 0; i <= bufferLength - frameSize; i += hopSize) {
+        if (analyzeFrame(audioBuffer + i, frameSize, bufferFeatures)) {
+            results.push_back(bufferFeatures);
+        }
     }
 
-    // THE FIX: The first coefficient from Essentia's LPC is always 1 and must be excluded.
-    // We create a new vector starting from the second element.
-    std::vector<float> polyCoeffs(lpcCoeffs.begin() + 1, lpcCoeffs.end());
+    LOGD("Buffer analysis complete: %zu frames processed", results.size());
+    return results;
+}
 
-    // --- Part 2: Find Formants using Eigen's PolynomialSolver ---
-    // The LPC coefficients need to be reversed for the polynomial solver.
-    std::reverse(polyCoeffs.begin(), polyCoeffs.end());
-    Eigen::VectorXcf coeffs = Eigen::Map<Eigen::VectorXf>(polyCoeffs.data(), polyCoeffs.size()).cast<std::complex<float>>();
+bool EssentiaWrapper::sharesLogMelGrid() const {
+    const long long scaledHop = static_cast<long long>(hopSize) * analysisRate;
+    return analysisRate == kLogMelSampleRate && analysisFrameSize == kLogMelFftSize &&
+           scaledHop % sampleRate == 0 && scaledHop / sampleRate == kLogMelHopSize;
+}
 
-    Eigen::PolynomialSolver<std::complex<float>, Eigen::Dynamic> solver;
-    solver.compute(coeffs);
-    const Eigen::VectorXcf& roots = solver.roots();
+std::vector<AudioFeatures> EssentiaWrapper::analyzeBufferWithLogMel(const float* audioBuffer, int bufferLength,
+                                                                    float* logMel) {
+    std::vector<AudioFeatures> results;
 
-    std::vector<float> formantFrequencies;
+    if (!initialized || audioBuffer == nullptr || bufferLength < 0 || logMel == nullptr) {
+        LOGE("Invalid parameters for buffer analysis with log-mel");
+        return results;
+    }
+    if (!sharesLogMelGrid()) {
+        LOGE("Log-mel fan-out needs %d-sample frames every %d samples at %d Hz; analysis is %d every %d at %d Hz",
+             kLogMelFftSize, kLogMelHopSize, kLogMelSampleRate,
+             analysisFrameSize, hopSize * analysisRate / sampleRate, analysisRate);
+        return results;
+    }
 
-    for (int i = 0; i < roots.size(); ++i) {
-        // We are only interested in the roots with a positive imaginary part
-        if (std::imag(roots[i]) >= 0) {
-            // The angle of the root gives us the frequency
-            float angle = std::arg(roots[i]);
-            float freq = angle * (this->sampleRate / (2.0 * M_PI));
+    Workspace& ws = workspace;
+    if (!logMelBands) {
+        logMelBands.reset(new LogMelExtractor());
+        ws.logMelPower.assign(kLogMelFftSize / 2 + 1, 0.0f);
+    }
+    if (stft.getFrameSize() != analysisFrameSize) {
+        // Pitch-only feature sets have no spectrum stage
+        stft.configure(analysisFrameSize);
+    }
 
-            // Filter for typical human formant frequencies
-            if (freq > 90 && freq < 4000) {
-                formantFrequencies.push_back(freq);
-            }
+    TRACE_SCOPE(kTraceBuffer, frameCounter);
+    pitchTracker.reset();
+
+    // Frames come from the analysis-rate signal
+    const float* signal = audioBuffer;
+    int length = bufferLength;
+    if (analysisRate != sampleRate) {
+        length = resampler.outputLength(bufferLength);
+        if (static_cast<int>(voiceBuffer.size()) < length) {
+            voiceBuffer.resize(length);
         }
+        TRACE_SCOPE(kTraceResample, frameCounter);
+        resampler.resample(audioBuffer, bufferLength, voiceBuffer.data(), length);
+        signal = voiceBuffer.data();
     }
 
-    // Sort the formants by frequency to get F1, F2, etc. in order
-    std::sort(formantFrequencies.begin(), formantFrequencies.end());
+    const int analyzed = length >= kLogMelFftSize ? (length - kLogMelFftSize) / kLogMelHopSize + 1 : 0;
+    results.reserve(analyzed);
+
+    for (int t = 0; t < std::max(analyzed, kLogMelFrames); ++t) {
+        const int start = t * kLogMelHopSize;
+        float dcOffset = 0.0f;
+        if (t < analyzed) {
+            dcOffset = simdSum(signal + start, kLogMelFftSize) / kLogMelFftSize;
+            simdSubtract(signal + start, dcOffset, ws.frame.data(), kLogMelFftSize);
+        } else {
+            // Past the end: the log-mel's zero padding, not analyzed
+            const int available = std::max(0, std::min(length - start, kLogMelFftSize));
+            if (available > 0) {
+                std::copy(signal + start, signal + start + available, ws.frame.begin());
+            }
+            std::fill(ws.frame.begin() + available, ws.frame.end(), 0.0f);
+        }
+
+        if (t < kLogMelFrames) {
+            // The embedding sees the frame with its mean, as recorded
+            TRACE_SCOPE(kTraceSpectrum, frameCounter + 1);
+            stft.transform(ws.frame.data());
+            stft.hammingPower(dcOffset, ws.logMelPower.data());
+            logMelBands->computeRow(ws.logMelPower.data(), logMel + t * kLogMelBands);
+            ws.transformed = true;
+        }
+
+        if (t < analyzed && analyzePreparedFrame(bufferFeatures)) {
+            results.push_back(bufferFeatures);
+        }
+        ws.transformed = false;
+    }
 
-    return formantFrequencies;
+    LOGD("Buffer analysis with log-mel complete: %zu frames processed", results.size());
+    return results;
 }
 
+bool EssentiaWrapper::analyzeFramePcm16(const int16_t* pcm, int length, AudioFeatures& features) {
+    if (!initialized || pcm == nullptr || length < frameSize) {
+        features.clear();
+        LOGE("Invalid PCM data: data=%p, length=%d, required=%d", pcm, length, frameSize);
+        return false;
+    }
 
-std::vector<float> EssentiaWrapper::preprocessAudio(const float* audioData, int length) {
-    std::vector<float> processed(audioData, audioData + length);
+    convertPcm16ToFloat(pcm, pcmBuffer.data(), frameSize);
+    return analyzeFrame(pcmBuffer.data(), frameSize, features);
+}
 
-    // Ensure we have the right frame size
-    if (processed.size() < static_cast<size_t>(frameSize)) {
-        processed.resize(frameSize, 0.0f); // Zero-pad if necessary
-    } else if (processed.size() > static_cast<size_t>(frameSize)) {
-        processed.resize(frameSize); // Truncate if necessary
+std::vector<AudioFeatures> EssentiaWrapper::analyzeBufferPcm16(const int16_t* pcm, int bufferLength, int hopSize) {
+    if (!initialized || pcm == nullptr || bufferLength < frameSize) {
+        LOGE("Invalid parameters for PCM buffer analysis");
+        return std::vector<AudioFeatures>();
     }
 
-    // Simple DC removal
-    float mean = 0.0f;
-    for (float sample : processed) {
-        mean += sample;
+    if (static_cast<int>(pcmBuffer.size()) < bufferLength) {
+        pcmBuffer.resize(bufferLength);
     }
-    mean /= processed.size();
+    convertPcm16ToFloat(pcm, pcmBuffer.data(), bufferLength);
+    return analyzeBuffer(pcmBuffer.data(), bufferLength, hopSize);
+}
 
-    for (float& sample : processed) {
-        sample -= mean;
-    }
+void EssentiaWrapper::cleanup() {
+    if (initialized || essentiaAcquired) {
+        LOGI("Cleaning up Essentia resources");
 
-    return processed;
-}
+        std::lock_guard<std::mutex> lock(s_essentiaMutex);
 
-// C-style functions for JNI
-extern "C" {
-bool initEssentia(int sampleRate) {
-    try {
-        if (!g_essentiaWrapper) {
-            g_essentiaWrapper = std::make_unique<EssentiaWrapper>();
+        // Reset all algorithm pointers
+        releaseAlgorithms();
+
+        // Shutdown Essentia once the last instance is gone
+        if (essentiaAcquired && --s_essentiaUsers == 0) {
+            try {
+                essentia::shutdown();
+            } catch (...) {
+                LOGE("Exception during Essentia shutdown");
+            }
         }
-        return g_essentiaWrapper->initialize(sampleRate);
-    } catch (...) {
-        LOGE("Exception in initEssentia");
-        return false;
+        essentiaAcquired = false;
+
+        initialized = false;
+        LOGI("Essentia cleanup completed");
     }
 }
 
-AudioFeatures analyzeAudioFrame(const float* audioData, int length) {
-    if (g_essentiaWrapper && g_essentiaWrapper->isReady()) {
-        return g_essentiaWrapper->analyzeFrame(audioData, length);
+void EssentiaWrapper::computeMoments(const std::vector<float>& spectrum, float pitch) {
+    // Harmonic bins for resonance: the first five harmonics below Nyquist
+    const float binWidth = static_cast<float>(analysisRate) / (2.0f * spectrum.size());
+    int harmonicBins[kMaxHarmonicSamples];
+    int harmonicCount = 0;
+    for (int harmonic = 1; harmonic <= kMaxHarmonicSamples && pitch > 0.0f; ++harmonic) {
+        const float harmonicFreq = pitch * harmonic;
+        if (harmonicFreq >= analysisRate / 2.0f) break;
+        harmonicBins[harmonicCount++] = static_cast<int>(harmonicFreq / binWidth);
     }
-    LOGE("EssentiaWrapper not initialized in analyzeAudioFrame");
-    return AudioFeatures();
+
+    // Brightness splits the energy at 1/4 of Nyquist
+    computeSpectralMoments(spectrum.data(), static_cast<int>(spectrum.size()), static_cast<int>(spectrum.size() / 4),
+                           harmonicBins, harmonicCount, false, workspace.moments);
 }
 
-std::vector<AudioFeatures> analyzeAudioBuffer(const float* audioBuffer, int bufferLength, int hopSize) {
-    if (g_essentiaWrapper && g_essentiaWrapper->isReady()) {
-        return g_essentiaWrapper->analyzeBuffer(audioBuffer, bufferLength, hopSize);
+void EssentiaWrapper::calculateFormants(const std::vector<float>& lpcCoeffs, AudioFeatures& features) {
+    features.formants.clear();
+    features.formantBandwidths.clear();
+
+    if (static_cast<int>(lpcCoeffs.size()) != lpcOrder + 1) {
+        return;
+    }
+
+    // Roots of the full LPC polynomial A(z), lpc[0] == 1 included, in the
+    // typical range of human formants. Both vectors keep their capacity
+    // between frames, so this does not allocate in steady state.
+    features.formants.resize(lpcOrder);
+    features.formantBandwidths.resize(lpcOrder);
+    int count = formantSolver.solve(lpcCoeffs.data(), 90.0f, 4000.0f,
+                                    features.formants.data(), features.formantBandwidths.data(), lpcOrder);
+    TRACE_VALUE(kTraceFormantSweeps, frameCounter, formantSolver.getIterations());
+    if (count < 0) {
+        count = 0;
     }
-    LOGE("EssentiaWrapper not initialized in analyzeAudioBuffer");
-    return std::vector<AudioFeatures>();
+    features.formants.resize(count);
+    features.formantBandwidths.resize(count);
 }
 
-void cleanupEssentia() {
-    if (g_essentiaWrapper) {
-        g_essentiaWrapper->cleanup();
-        g_essentiaWrapper.reset();
+float EssentiaWrapper::frameMean(const float* audioData) const {
+    return simdSum(audioData, frameSize) / frameSize;
+}
+
+void EssentiaWrapper::preprocessAudio(const float* audioData, float dcOffset) {
+    std::vector<float>& processed = workspace.frame;
+
+    if (analysisRate != sampleRate) {
+        // DC removal first so the block edges do not ring, then resample.
+        // Traced under the frame number analyzePreparedFrame is about to use.
+        TRACE_SCOPE(kTraceResample, frameCounter + 1);
+        simdSubtract(audioData, dcOffset, workspace.inputFrame.data(), frameSize);
+        resampler.resample(workspace.inputFrame.data(), frameSize, processed.data(), analysisFrameSize);
+        return;
     }
+
+    // Copy one frame into the workspace with simple DC removal
+    simdSubtract(audioData, dcOffset, processed.data(), frameSize);
 }
-}
\ No newline at end of file
@@ -3,6 +3,17 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "formant_solver.h"
+#include "log_mel.h"
+#include "pitch_tracker.h"
+#include "resampler.h"
+#include "spectral_lpc.h"
+#include "spectral_moments.h"
+#include "spectral_peaks.h"
+#include "stft.h"
 
 // Forward declarations for Essentia classes
 namespace essentia {
@@ -14,6 +25,42 @@ namespace essentia {
     }
 }
 
+/**
+ * Bitmask selecting which features analyzeFrame computes. Features outside
+ * the set are left at zero/empty. Pitch is always computed because it
+ * decides whether a frame is valid.
+ */
+typedef uint32_t FeatureSet;
+static const FeatureSet kFeaturePitch      = 1u << 0;
+static const FeatureSet kFeatureCentroid   = 1u << 1;
+static const FeatureSet kFeatureMfcc       = 1u << 2;
+static const FeatureSet kFeatureFormants   = 1u << 3;
+static const FeatureSet kFeatureHnr        = 1u << 4;
+static const FeatureSet kFeatureBrightness = 1u << 5;
+static const FeatureSet kFeatureResonance  = 1u << 6;
+static const FeatureSet kFeatureAll        = (1u << 7) - 1;
+
+/**
+ * Pitch estimator. Both are YIN; the FFT variant derives the difference
+ * function from the frame's magnitude spectrum (O(N log N)) instead of
+ * computing it in the time domain (O(N * maxLag)).
+ */
+enum PitchMethod {
+    kPitchYinFft = 0,   // PitchYinFFT on the shared spectrum (default)
+    kPitchYin = 1       // Time-domain PitchYin on the windowed frame
+};
+
+/**
+ * How the HNR stage finds harmonic peaks. The harmonic model only reads
+ * the bins near each k * f0; the peak list picks every peak of the peak
+ * band first (SpectralPeaks) and matches harmonics against it
+ * (HarmonicPeaks), and leaves the list readable via getSpectralPeaks().
+ */
+enum HarmonicMethod {
+    kHarmonicModel = 0,     // computeHarmonicModel (default)
+    kHarmonicPeakList = 1   // SpectralPeakPicker + matchHarmonicPeaks
+};
+
 /**
  * Struct to hold extracted audio features
  */
@@ -24,6 +71,7 @@ struct AudioFeatures {
     float centroid  = 0.0f;
     std::vector<float> mfcc;
     std::vector<float> formants;
+    std::vector<float> formantBandwidths;   // -3 dB bandwidth of each formant, Hz
     float hnr = 0.0f;
     bool isValid = false;
 
@@ -31,6 +79,46 @@ struct AudioFeatures {
 
     AudioFeatures(float p, float b, float r, float sc, const std::vector<float>& m, const std::vector<float>& f, float hnr, bool valid)
             : pitch(p), brightness(b), resonance(r), centroid (sc), mfcc(m), formants(f), hnr(hnr), isValid(valid) {}
+
+    /**
+     * Reset to the empty state without releasing vector capacity
+     */
+    void clear() {
+        pitch = brightness = resonance = centroid = hnr = 0.0f;
+        mfcc.clear();
+        formants.clear();
+        formantBandwidths.clear();
+        isValid = false;
+    }
+};
+
+/**
+ * The parts of analyzeFrame, in order. Each reads what the previous one
+ * left in a StageFrame, so consecutive frames can be in different stages
+ * at once on different threads (PipelinedAnalyzer).
+ */
+enum AnalysisStage {
+    kAnalysisFrontEnd = 0,  // DC removal, resampling, energy gate, window, FFT
+    kAnalysisSpectral = 1,  // Pitch, spectral moments, harmonic peaks and HNR
+    kAnalysisEnvelope = 2   // MFCC, LPC and formants
+};
+
+static const int kAnalysisStageCount = 3;
+
+/**
+ * One frame on its way through the analysis stages: the input samples and
+ * everything a stage hands to the next. Sized once by prepareStageFrame()
+ * and reused, so running the stages does not allocate.
+ */
+struct StageFrame {
+    std::vector<float> input;           // frameSize samples at the input rate, filled by the caller
+    std::vector<float> frame;           // Analysis frame, DC removed
+    std::vector<float> windowedFrame;   // Time-domain YIN input (kPitchYin only)
+    std::vector<float> spectrum;        // Hann magnitude spectrum
+    uint32_t sequence = 0;              // Trace frame id
+    bool restartTrack = false;          // First frame of a new stream: forget the pitch track
+    bool active = false;                // Still being analyzed (not silent, not unvoiced, no error)
+    AudioFeatures features;
 };
 
 /**
@@ -39,48 +127,266 @@ struct AudioFeatures {
 class EssentiaWrapper {
 private:
     // Essentia algorithms
-    std::unique_ptr<essentia::standard::Algorithm> energyAlg;
     std::unique_ptr<essentia::standard::Algorithm> pitchYin;
-    std::unique_ptr<essentia::standard::Algorithm> centroidAlg;
     std::unique_ptr<essentia::standard::Algorithm> mfccAlg;
     std::unique_ptr<essentia::standard::Algorithm> windowAlg;
-    std::unique_ptr<essentia::standard::Algorithm> spectrumAlg;
-    std::unique_ptr<essentia::standard::Algorithm> spectralPeaksAlg;
-    std::unique_ptr<essentia::standard::Algorithm> lpcAlg;
-    std::unique_ptr<essentia::standard::Algorithm> harmonicPeaksAlg;
-    std::unique_ptr<essentia::standard::Algorithm> stochasticModelAnalAlg;
 
-    // Analysis parameters
+    /**
+     * Per-instance intermediate buffers. Algorithm inputs/outputs are bound to
+     * these once in initialize(), so the steady-state frame path neither
+     * allocates nor looks up ports by name.
+     */
+    struct Workspace {
+        std::vector<float> inputFrame;      // DC-removed frame at the input rate (voice band only)
+        std::vector<float> frame;
+        std::vector<float> windowedFrame;
+        std::vector<float> spectrum;
+        std::vector<float> harmonicFrequencies;     // kMaxHarmonics, from the HNR stage
+        std::vector<float> harmonicMagnitudes;
+        std::vector<float> mfccBands;
+        std::vector<float> mfccCoeffs;
+        std::vector<float> lpcCoeffs;
+        std::vector<float> reflection;
+        std::vector<float> logMelPower;     // Hamming power spectrum (analyzeBufferWithLogMel only)
+        float pitch = 0.0f;
+        float pitchConfidence = 0.0f;
+        SpectralMoments moments = {};
+        SpectralPeakList peaks = {};        // Peak band of the last HNR frame (kHarmonicPeakList)
+        bool transformed = false;           // stft already holds this frame's FFT
+    };
+
+    Workspace workspace;
+    AudioFeatures bufferFeatures;
+    std::vector<float> pcmBuffer;   // int16 input converted to float, grown on demand
+    std::vector<float> voiceBuffer; // Whole buffer at the analysis rate (voice band), grown on demand
+    PolyphaseResampler resampler;   // Input rate to analysis rate (voice band)
+    SpectralLpc spectralLpc;        // LPC from the shared spectrum's inverse FFT
+    StftFrontEnd stft;              // One FFT per frame; each consumer windows in the frequency domain
+    std::unique_ptr<LogMelExtractor> logMelBands;   // Embedding filterbank, built on first use
+    FormantSolver formantSolver;    // Warm-started from the previous frame's roots
+    PitchTracker pitchTracker;      // Cross-frame f0 track, used when pitchTracking is set
+    SpectralPeakPicker peakPicker;  // Band-limited peaks for kHarmonicPeakList
+
+    // Analysis parameters. sampleRate/frameSize/hopSize describe the input;
+    // the algorithms run at analysisRate on analysisFrameSize samples, which
+    // differ from them only in voice band mode.
     int sampleRate;
     int frameSize;
     int hopSize;
+    int analysisRate;
+    int analysisFrameSize;
+    float energyThreshold;  // Silence gate on the analysis frame's energy
+    int mfccCount;
+    int lpcOrder;
+    FeatureSet featureSet;  // Requested features, pitch always included
+    PitchMethod pitchMethod;
+    HarmonicMethod harmonicMethod;
+    float peakMinHz;        // Peak band for kHarmonicPeakList
+    float peakMaxHz;        // 0 for the analysis Nyquist frequency
+    bool pitchTracking;     // Track f0 across frames instead of estimating each frame alone
+    bool voiceBand;         // Resample to the voice band before framing
+    uint32_t stages;        // Processing stages featureSet depends on
+    uint32_t frameCounter;  // Frames analyzed, used as the trace frame id
+    bool essentiaAcquired;
     bool initialized;
 
     // Helper methods
-    float calculateBrightness(const std::vector<float>& spectrum);
-    float calculateResonance(const std::vector<float>& spectrum, float pitch);
-    std::vector<float> calculateFormants(std::vector<float> lpcCoeffs);
-    std::vector<float> preprocessAudio(const float* audioData, int length);
+    static uint32_t stagesFor(FeatureSet features, PitchMethod method);
+    void configureAnalysisRate();
+    void createAlgorithms(uint32_t requiredStages);
+    void releaseAlgorithms();
+    bool analyzePreparedFrame(AudioFeatures& features);
+    bool frontEndStage();
+    bool spectralStage(AudioFeatures& features);
+    void spectralFeatures(const std::vector<float>& spectrum, AudioFeatures& features);
+    void envelopeStage(AudioFeatures& features);
+    void computeMoments(const std::vector<float>& spectrum, float pitch);
+    void calculateFormants(const std::vector<float>& lpcCoeffs, AudioFeatures& features);
+    float frameMean(const float* audioData) const;
+    void preprocessAudio(const float* audioData, float dcOffset);
 
 public:
     EssentiaWrapper();
     ~EssentiaWrapper();
 
     /**
-     * Initialize Essentia and create algorithms
+     * Initialize Essentia and create the algorithms the feature set needs
      */
-    bool initialize(int sampleRate = 44100, int frameSize = 1024, int hopSize = 512);
+    bool initialize(int sampleRate = 44100, int frameSize = 1024, int hopSize = 512,
+                    FeatureSet features = kFeatureAll);
+
+    /**
+     * Change the features computed by later analyzeFrame calls. Algorithms
+     * a wider set needs are created on first use and kept afterwards, so
+     * switching back and forth only pays for instantiation once.
+     */
+    bool setFeatureSet(FeatureSet features);
+
+    /**
+     * Get the active feature set (always includes kFeaturePitch)
+     */
+    FeatureSet getFeatureSet() const { return featureSet; }
+
+    /**
+     * Select the pitch estimator. May be called before initialize(); after
+     * it, the pitch algorithm is recreated on the spot.
+     */
+    bool setPitchMethod(PitchMethod method);
+
+    /**
+     * Get the active pitch estimator
+     */
+    PitchMethod getPitchMethod() const { return pitchMethod; }
+
+    /**
+     * Enable cross-frame pitch tracking. While the track holds, frames only
+     * search a narrow lag window around the previous period and the full
+     * estimator is skipped; it runs again to re-acquire after the track is
+     * lost. Consecutive analyzeFrame calls must then be consecutive hops of
+     * one stream; call resetPitchTrack() at any discontinuity.
+     */
+    void setPitchTracking(bool enabled);
+
+    /**
+     * Select how HNR finds harmonic peaks. Takes effect from the next frame.
+     */
+    void setHarmonicMethod(HarmonicMethod method);
+
+    HarmonicMethod getHarmonicMethod() const { return harmonicMethod; }
+
+    /**
+     * Band kHarmonicPeakList picks peaks in, default 40 Hz to the analysis
+     * Nyquist frequency. Each frame it is further capped just above the
+     * last harmonic of that frame's f0, since higher peaks never match.
+     * Harmonics outside the band count as noise.
+     * @param maxHz Upper edge, or 0 for the analysis Nyquist frequency
+     */
+    bool setPeakBand(float minHz, float maxHz);
+
+    bool isPitchTracking() const { return pitchTracking; }
+
+    /**
+     * Forget the pitch track (start of a new buffer or stream)
+     */
+    void resetPitchTrack() { pitchTracker.reset(); }
+
+    /**
+     * Analyze in the voice band: frames are resampled to the lowest rate of
+     * at least 10 kHz reachable by a small rational factor (44.1 kHz ->
+     * 11025 Hz, 16 kHz -> 10 kHz) before any algorithm runs, and every
+     * stage (FFT, pitch, LPC order) is sized for that rate. Everything
+     * below about 4 kHz, which covers f0 and the formants, is kept.
+     * Inputs are still given at the input rate and frame size.
+     * May be called before initialize(); after it, all algorithms are
+     * recreated.
+     */
+    bool setVoiceBand(bool enabled);
+
+    bool isVoiceBand() const { return voiceBand; }
+
+    /**
+     * Bytes held by this instance's analysis buffers; excludes Essentia's
+     * own algorithm state
+     */
+    size_t getWorkspaceBytes() const;
+
+    /**
+     * Number of Essentia algorithms instantiated so far
+     */
+    int getAlgorithmCount() const;
 
     /**
      * Analyze a single audio frame
      */
     AudioFeatures analyzeFrame(const float* audioData, int length);
 
+    /**
+     * Analyze a single audio frame into caller-owned features.
+     * Reuses the capacity of features.mfcc/formants, so repeated calls with
+     * the same object do not allocate. Returns features.isValid.
+     */
+    bool analyzeFrame(const float* audioData, int length, AudioFeatures& features);
+
+    /**
+     * Same as above, with the frame's DC offset supplied by the caller
+     * (e.g. maintained incrementally by StreamingAnalyzer) instead of
+     * being recomputed from the samples.
+     */
+    bool analyzeFrame(const float* audioData, int length, float dcOffset, AudioFeatures& features);
+
+    /**
+     * Size a StageFrame's buffers for this analyzer's configuration.
+     * Frames prepared by one analyzer can run through the stages of any
+     * other with the same configuration.
+     */
+    void prepareStageFrame(StageFrame& frame) const;
+
+    /**
+     * Run one stage of analyzeFrame on a frame. Running kAnalysisFrontEnd,
+     * kAnalysisSpectral and kAnalysisEnvelope in that order gives the same
+     * features as analyzeFrame on frame.input, and the three may run on
+     * three analyzers (one stage each) for consecutive frames at once.
+     * Frames must reach the spectral stage in stream order for pitch
+     * tracking. Returns frame.active; after the envelope stage that is
+     * frame.features.isValid.
+     */
+    bool runStage(AnalysisStage stage, StageFrame& frame);
+
+    /**
+     * Finish a frame whose front end, pitch estimate, MFCC and LPC were
+     * computed elsewhere (the host-only NetworkAnalyzer's streaming network):
+     * energy gate, voicing (through the pitch tracker if enabled), spectral
+     * moments, HNR and formants, as analyzeFrame does after those steps.
+     * Consecutive calls are consecutive hops of one stream.
+     * @param frame getAnalysisFrameSize() samples, DC removed
+     * @param spectrum Hann magnitude spectrum of frame
+     * @param mfcc Used if the feature set has kFeatureMfcc
+     * @param lpcCoeffs getMaxFormants() + 1 coefficients, used if it has kFeatureFormants
+     */
+    bool completeFrame(const std::vector<float>& frame, const std::vector<float>& spectrum, float pitch,
+                       float pitchConfidence, const std::vector<float>& mfcc, const std::vector<float>& lpcCoeffs,
+                       AudioFeatures& features);
+
+    /**
+     * Lock serializing Essentia's algorithm factories across instances.
+     * Hold it while creating Essentia algorithms outside the wrapper.
+     */
+    static std::unique_lock<std::mutex> lockFactory();
+
     /**
      * Analyze audio buffer with windowing
      */
     std::vector<AudioFeatures> analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize);
 
+    /**
+     * Whether the analysis grid is the speaker embedding's log-mel grid
+     * (kLogMelSampleRate, kLogMelFftSize-sample frames every kLogMelHopSize
+     * samples), so analyzeBufferWithLogMel can serve both from one STFT.
+     * E.g. initialize(16000, 512, 160) without voice band.
+     */
+    bool sharesLogMelGrid() const;
+
+    /**
+     * analyzeBuffer at the configured hop, also writing the embedding's
+     * log-mel spectrogram (as LogMelExtractor, no normalization or
+     * trimming) from the same FFTs. Frames 0..kLogMelFrames-1 start every
+     * kLogMelHopSize samples; those past the end of the buffer are zero
+     * padded. Requires sharesLogMelGrid().
+     * @param logMel kLogMelOutputSize values, frame-major
+     */
+    std::vector<AudioFeatures> analyzeBufferWithLogMel(const float* audioBuffer, int bufferLength, float* logMel);
+
+    /**
+     * Analyze a single frame of int16 PCM, converting to float internally
+     */
+    bool analyzeFramePcm16(const int16_t* pcm, int length, AudioFeatures& features);
+
+    /**
+     * Analyze an int16 PCM buffer with windowing. Each sample is converted
+     * once, not once per overlapping frame.
+     */
+    std::vector<AudioFeatures> analyzeBufferPcm16(const int16_t* pcm, int bufferLength, int hopSize);
+
     /**
      * Clean up resources
      */
@@ -100,17 +406,46 @@ public:
      * Get current frame size
      */
     int getFrameSize() const { return frameSize; }
-};
 
-// Global instance for JNI access
-extern std::unique_ptr<EssentiaWrapper> g_essentiaWrapper;
+    /**
+     * Get the rate the algorithms run at (sample rate unless voice band)
+     */
+    int getAnalysisSampleRate() const { return analysisRate; }
 
-// C-style functions for JNI
-extern "C" {
-bool initEssentia(int sampleRate);
-AudioFeatures analyzeAudioFrame(const float* audioData, int length);
-std::vector<AudioFeatures> analyzeAudioBuffer(const float* audioBuffer, int bufferLength, int hopSize);
-void cleanupEssentia();
-}
+    /**
+     * Get the frame length the algorithms see (frame size unless voice band)
+     */
+    int getAnalysisFrameSize() const { return analysisFrameSize; }
+
+    /**
+     * Get configured hop size
+     */
+    int getHopSize() const { return hopSize; }
+
+    /**
+     * Harmonic peaks of the last frame whose HNR was computed: frequency and
+     * magnitude of harmonics 1..kMaxHarmonics, magnitude 0 where no peak
+     * matched (as Essentia's HarmonicPeaks). Empty unless kFeatureHnr was
+     * ever enabled.
+     */
+    const std::vector<float>& getHarmonicFrequencies() const { return workspace.harmonicFrequencies; }
+    const std::vector<float>& getHarmonicMagnitudes() const { return workspace.harmonicMagnitudes; }
+
+    /**
+     * Peaks of the peak band in the last frame whose HNR was computed with
+     * kHarmonicPeakList, sorted by frequency. Empty otherwise.
+     */
+    const SpectralPeakList& getSpectralPeaks() const { return workspace.peaks; }
+
+    /**
+     * Get number of MFCC coefficients per frame
+     */
+    int getMfccCount() const { return mfccCount; }
+
+    /**
+     * Get upper bound on formants reported per frame
+     */
+    int getMaxFormants() const { return lpcOrder; }
+};
 
 #endif // ESSENTIA_WRAPPER_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef FAST_LOG_H
+#define FAST_LOG_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * log2 accurate to about 2.4e-7 for positive normal x, without a libm
+ * call. Splits x into 2^e * m with m in [sqrt(1/2), sqrt(2)), then
+ * log2(m) = 2/ln(2) * atanh(t) with t = (m - 1) / (m + 1), |t| < 0.172.
+ *
+ * The range reduction is integer-only (no branch), so loops calling it
+ * vectorize.
+ */
+inline float fastLog2(float x) {
+    // Offsetting by the bits of sqrt(1/2) makes the exponent field round
+    // to the nearest power of two
+    const uint32_t kSqrtHalfBits = 0x3F3504F3u;
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int32_t exponent = static_cast<int32_t>(bits - kSqrtHalfBits) >> 23;
+    bits -= static_cast<uint32_t>(exponent) << 23;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    const float t = (m - 1.0f) / (m + 1.0f);
+    const float t2 = t * t;
+    const float series = t * (2.0f + t2 * (2.0f / 3.0f + t2 * (2.0f / 5.0f + t2 * (2.0f / 7.0f))));
+    return static_cast<float>(exponent) + series * 1.44269504f;
+}
+
+/**
+ * Natural log with the accuracy of fastLog2
+ */
+inline float fastLn(float x) {
+    return fastLog2(x) * 0.693147181f;
+}
+
+#endif // FAST_LOG_H
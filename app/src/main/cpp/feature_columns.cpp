@@ -0,0 +1,200 @@
+#include "feature_columns.h"
+#include "essentia_wrapper.h"
+#include <android/log.h>
+#include <cstring>
+
+#define LOG_TAG "FeatureColumns"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Lay the columns out back to back after the header for the given sizes
+static void computeLayout(int frames, int mfccValues, int formantValues, FeatureColumnsHeader& header) {
+    size_t offset = sizeof(FeatureColumnsHeader);
+    auto column = [&offset](size_t count) {
+        const size_t start = offset;
+        offset += count * 4;
+        return static_cast<int32_t>(start);
+    };
+
+    header.frameIndexOffset = column(frames);
+    header.pitchOffset = column(frames);
+    header.brightnessOffset = column(frames);
+    header.resonanceOffset = column(frames);
+    header.centroidOffset = column(frames);
+    header.hnrOffset = column(frames);
+    header.mfccIndexOffset = column(frames + 1);
+    header.mfccValuesOffset = column(mfccValues);
+    header.formantIndexOffset = column(frames + 1);
+    header.formantValuesOffset = column(formantValues);
+    header.bandwidthValuesOffset = column(formantValues);
+    header.totalBytes = static_cast<int32_t>(offset);
+}
+
+static int frameCountFor(const EssentiaWrapper& wrapper, int bufferLength, int hopSize) {
+    if (hopSize <= 0 || bufferLength < wrapper.getFrameSize()) return 0;
+    return (bufferLength - wrapper.getFrameSize()) / hopSize + 1;
+}
+
+size_t featureColumnsCapacity(const EssentiaWrapper& wrapper, int bufferLength, int hopSize) {
+    const int frames = frameCountFor(wrapper, bufferLength, hopSize);
+    if (frames == 0) return 0;
+
+    FeatureColumnsHeader header = {};
+    computeLayout(frames, frames * wrapper.getMfccCount(), frames * wrapper.getMaxFormants(), header);
+    return static_cast<size_t>(header.totalBytes);
+}
+
+long analyzeBufferColumnar(EssentiaWrapper& wrapper, const float* audioBuffer, int bufferLength, int hopSize,
+                           void* out, size_t outCapacity) {
+    const int maxFrames = frameCountFor(wrapper, bufferLength, hopSize);
+    if (!wrapper.isReady() || audioBuffer == nullptr || out == nullptr || maxFrames == 0) {
+        LOGE("Invalid parameters for columnar buffer analysis");
+        return -1;
+    }
+
+    const size_t required = featureColumnsCapacity(wrapper, bufferLength, hopSize);
+    if (outCapacity < required) {
+        LOGE("Columnar output too small: %zu bytes, need %zu", outCapacity, required);
+        return -1;
+    }
+
+    // Fill at worst-case offsets first, then compact once the sizes are known
+    auto* base = static_cast<uint8_t*>(out);
+    FeatureColumnsHeader full = {};
+    computeLayout(maxFrames, maxFrames * wrapper.getMfccCount(), maxFrames * wrapper.getMaxFormants(), full);
+
+    auto* frameIndex = reinterpret_cast<int32_t*>(base + full.frameIndexOffset);
+    auto* pitch = reinterpret_cast<float*>(base + full.pitchOffset);
+    auto* brightness = reinterpret_cast<float*>(base + full.brightnessOffset);
+    auto* resonance = reinterpret_cast<float*>(base + full.resonanceOffset);
+    auto* centroid = reinterpret_cast<float*>(base + full.centroidOffset);
+    auto* hnr = reinterpret_cast<float*>(base + full.hnrOffset);
+    auto* mfccIndex = reinterpret_cast<int32_t*>(base + full.mfccIndexOffset);
+    auto* mfccValues = reinterpret_cast<float*>(base + full.mfccValuesOffset);
+    auto* formantIndex = reinterpret_cast<int32_t*>(base + full.formantIndexOffset);
+    auto* formantValues = reinterpret_cast<float*>(base + full.formantValuesOffset);
+    auto* bandwidthValues = reinterpret_cast<float*>(base + full.bandwidthValuesOffset);
+
+    AudioFeatures features;
+    int frames = 0;
+    int32_t mfccCursor = 0;
+    int32_t formantCursor = 0;
+
+    for (int i = 0; i < maxFrames; ++i) {
+        if (!wrapper.analyzeFrame(audioBuffer + static_cast<size_t>(i) * hopSize, wrapper.getFrameSize(), features)) {
+            continue;
+        }
+
+        frameIndex[frames] = i;
+        pitch[frames] = features.pitch;
+        brightness[frames] = features.brightness;
+        resonance[frames] = features.resonance;
+        centroid[frames] = features.centroid;
+        hnr[frames] = features.hnr;
+
+        mfccIndex[frames] = mfccCursor;
+        std::memcpy(mfccValues + mfccCursor, features.mfcc.data(), features.mfcc.size() * sizeof(float));
+        mfccCursor += static_cast<int32_t>(features.mfcc.size());
+
+        formantIndex[frames] = formantCursor;
+        std::memcpy(formantValues + formantCursor, features.formants.data(), features.formants.size() * sizeof(float));
+        std::memcpy(bandwidthValues + formantCursor, features.formantBandwidths.data(),
+                    features.formantBandwidths.size() * sizeof(float));
+        formantCursor += static_cast<int32_t>(features.formants.size());
+
+        ++frames;
+    }
+    mfccIndex[frames] = mfccCursor;
+    formantIndex[frames] = formantCursor;
+
+    // Every compacted column starts at or before its worst-case position and
+    // columns keep their order, so moving them front to back is safe
+    FeatureColumnsHeader header = {};
+    computeLayout(frames, mfccCursor, formantCursor, header);
+    header.version = kFeatureColumnsVersion;
+    header.frameCount = frames;
+
+    const int32_t FeatureColumnsHeader::* columns[] = {
+            &FeatureColumnsHeader::frameIndexOffset,
+            &FeatureColumnsHeader::pitchOffset,
+            &FeatureColumnsHeader::brightnessOffset,
+            &FeatureColumnsHeader::resonanceOffset,
+            &FeatureColumnsHeader::centroidOffset,
+            &FeatureColumnsHeader::hnrOffset,
+            &FeatureColumnsHeader::mfccIndexOffset,
+            &FeatureColumnsHeader::mfccValuesOffset,
+            &FeatureColumnsHeader::formantIndexOffset,
+            &FeatureColumnsHeader::formantValuesOffset,
+            &FeatureColumnsHeader::bandwidthValuesOffset,
+    };
+    const size_t columnBytes[] = {
+            frames * 4u, frames * 4u, frames * 4u, frames * 4u, frames * 4u, frames * 4u,
+            (frames + 1) * 4u, mfccCursor * 4u,
+            (frames + 1) * 4u, formantCursor * 4u,
+            formantCursor * 4u,
+    };
+    for (size_t c = 0; c < sizeof(columns) / sizeof(columns[0]); ++c) {
+        std::memmove(base + header.*columns[c], base + full.*columns[c], columnBytes[c]);
+    }
+
+    std::memcpy(base, &header, sizeof(header));
+    return header.totalBytes;
+}
+
+void encodeFeatureColumns(const AudioFeatures* frames, const uint8_t* valid, int count, std::vector<uint8_t>& out) {
+    int validFrames = 0;
+    int32_t mfccValues = 0;
+    int32_t formantValues = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!valid[i]) continue;
+        ++validFrames;
+        mfccValues += static_cast<int32_t>(frames[i].mfcc.size());
+        formantValues += static_cast<int32_t>(frames[i].formants.size());
+    }
+
+    FeatureColumnsHeader header = {};
+    computeLayout(validFrames, mfccValues, formantValues, header);
+    header.version = kFeatureColumnsVersion;
+    header.frameCount = validFrames;
+    out.assign(header.totalBytes, 0);
+
+    uint8_t* base = out.data();
+    std::memcpy(base, &header, sizeof(header));
+    auto* frameIndex = reinterpret_cast<int32_t*>(base + header.frameIndexOffset);
+    auto* pitch = reinterpret_cast<float*>(base + header.pitchOffset);
+    auto* brightness = reinterpret_cast<float*>(base + header.brightnessOffset);
+    auto* resonance = reinterpret_cast<float*>(base + header.resonanceOffset);
+    auto* centroid = reinterpret_cast<float*>(base + header.centroidOffset);
+    auto* hnr = reinterpret_cast<float*>(base + header.hnrOffset);
+    auto* mfccIndex = reinterpret_cast<int32_t*>(base + header.mfccIndexOffset);
+    auto* mfcc = reinterpret_cast<float*>(base + header.mfccValuesOffset);
+    auto* formantIndex = reinterpret_cast<int32_t*>(base + header.formantIndexOffset);
+    auto* formants = reinterpret_cast<float*>(base + header.formantValuesOffset);
+    auto* bandwidths = reinterpret_cast<float*>(base + header.bandwidthValuesOffset);
+
+    int frame = 0;
+    int32_t mfccCursor = 0;
+    int32_t formantCursor = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!valid[i]) continue;
+        const AudioFeatures& features = frames[i];
+        frameIndex[frame] = i;
+        pitch[frame] = features.pitch;
+        brightness[frame] = features.brightness;
+        resonance[frame] = features.resonance;
+        centroid[frame] = features.centroid;
+        hnr[frame] = features.hnr;
+
+        mfccIndex[frame] = mfccCursor;
+        std::memcpy(mfcc + mfccCursor, features.mfcc.data(), features.mfcc.size() * sizeof(float));
+        mfccCursor += static_cast<int32_t>(features.mfcc.size());
+
+        formantIndex[frame] = formantCursor;
+        std::memcpy(formants + formantCursor, features.formants.data(), features.formants.size() * sizeof(float));
+        std::memcpy(bandwidths + formantCursor, features.formantBandwidths.data(),
+                    features.formantBandwidths.size() * sizeof(float));
+        formantCursor += static_cast<int32_t>(features.formants.size());
+        ++frame;
+    }
+    mfccIndex[frame] = mfccCursor;
+    formantIndex[frame] = formantCursor;
+}
@@ -0,0 +1,59 @@
+#ifndef FEATURE_COLUMNS_H
+#define FEATURE_COLUMNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class EssentiaWrapper;
+struct AudioFeatures;
+
+static const int32_t kFeatureColumnsVersion = 2;
+
+/**
+ * Header at the start of a columnar (struct-of-arrays) result block.
+ *
+ * Every field is a native-endian int32; the *Offset fields are byte offsets
+ * from the start of the block. Scalar columns hold frameCount floats each.
+ * MFCC and formant values are flattened per frame, with frameCount + 1
+ * int32 offsets into the value column (frame i spans [offsets[i], offsets[i+1])).
+ * Only valid frames are written; frameIndex gives each one's hop index.
+ */
+struct FeatureColumnsHeader {
+    int32_t version;
+    int32_t frameCount;
+    int32_t totalBytes;
+    int32_t frameIndexOffset;     // int32[frameCount]
+    int32_t pitchOffset;          // float[frameCount]
+    int32_t brightnessOffset;     // float[frameCount]
+    int32_t resonanceOffset;      // float[frameCount]
+    int32_t centroidOffset;       // float[frameCount]
+    int32_t hnrOffset;            // float[frameCount]
+    int32_t mfccIndexOffset;      // int32[frameCount + 1]
+    int32_t mfccValuesOffset;     // float[mfccIndex[frameCount]]
+    int32_t formantIndexOffset;   // int32[frameCount + 1]
+    int32_t formantValuesOffset;  // float[formantIndex[frameCount]]
+    int32_t bandwidthValuesOffset; // float[formantIndex[frameCount]], indexed like formants
+};
+
+/**
+ * Bytes needed to hold the columnar result for a buffer of the given length,
+ * assuming every frame is valid. Returns 0 if no frame fits.
+ */
+size_t featureColumnsCapacity(const EssentiaWrapper& wrapper, int bufferLength, int hopSize);
+
+/**
+ * Analyze a buffer with windowing and write the valid frames as columns
+ * into out. Returns the number of bytes written, or -1 if out is too small
+ * (see featureColumnsCapacity) or the parameters are invalid.
+ */
+long analyzeBufferColumnar(EssentiaWrapper& wrapper, const float* audioBuffer, int bufferLength, int hopSize,
+                           void* out, size_t outCapacity);
+
+/**
+ * Lay out frames analyzed elsewhere as a columnar block in out (resized to
+ * fit). Frame i is written, with frameIndex i, only if valid[i] is set.
+ */
+void encodeFeatureColumns(const AudioFeatures* frames, const uint8_t* valid, int count, std::vector<uint8_t>& out);
+
+#endif // FEATURE_COLUMNS_H
@@ -0,0 +1,193 @@
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+
+RealFft::RealFft()
+        : size(0)
+        , half(0) {
+}
+
+bool RealFft::configure(int newSize) {
+    if (newSize < 2 || (newSize & 1) != 0) {
+        return false;
+    }
+    size = newSize;
+    half = newSize / 2;
+
+    // Radix 4 while it divides, then 2, then odd factors in increasing order
+    factors.clear();
+    int largestOdd = 0;
+    int n = half;
+    int radix = 4;
+    while (n > 1) {
+        while (n % radix != 0) {
+            radix = (radix == 4) ? 2 : (radix == 2) ? 3 : radix + 2;
+            if (radix * radix > n) radix = n;
+        }
+        n /= radix;
+        factors.push_back(radix);
+        factors.push_back(n);
+        if (radix != 2 && radix != 4) largestOdd = std::max(largestOdd, radix);
+    }
+    if (factors.empty()) {
+        // half == 1: a single-point complex transform
+        factors.push_back(1);
+        factors.push_back(1);
+    }
+
+    twiddles.resize(half);
+    for (int k = 0; k < half; ++k) {
+        const double phase = -2.0 * M_PI * k / half;
+        twiddles[k] = {static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase))};
+    }
+    splitTwiddles.resize(half / 2 + 1);
+    for (int k = 0; k <= half / 2; ++k) {
+        const double phase = -M_PI * (static_cast<double>(k) / half + 0.5);
+        splitTwiddles[k] = {static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase))};
+    }
+
+    buffer.assign(half, {0.0f, 0.0f});
+    packed.assign(half, {0.0f, 0.0f});
+    scratch.assign(std::max(largestOdd, 1), {0.0f, 0.0f});
+    return true;
+}
+
+void RealFft::complexForward(const Cpx* in, Cpx* out) {
+    transform(out, in, 1, factors.data());
+}
+
+void RealFft::transform(Cpx* out, const Cpx* in, int stride, const int* factor) {
+    // Decimation in time: split into `radix` interleaved sub-transforms of
+    // length m, then combine them with one butterfly pass
+    const int radix = factor[0];
+    const int m = factor[1];
+    Cpx* const begin = out;
+    Cpx* const end = out + radix * m;
+
+    if (m == 1) {
+        do {
+            *out = *in;
+            in += stride;
+        } while (++out != end);
+    } else {
+        do {
+            transform(out, in, stride * radix, factor + 2);
+            in += stride;
+            out += m;
+        } while (out != end);
+    }
+
+    switch (radix) {
+        case 1: break;
+        case 2: butterfly2(begin, stride, m); break;
+        case 4: butterfly4(begin, stride, m); break;
+        default: butterflyGeneric(begin, stride, m, radix); break;
+    }
+}
+
+void RealFft::butterfly2(Cpx* out, int stride, int m) const {
+    Cpx* out2 = out + m;
+    const Cpx* tw = twiddles.data();
+    for (int k = 0; k < m; ++k) {
+        const Cpx t = {out2[k].re * tw->re - out2[k].im * tw->im,
+                       out2[k].re * tw->im + out2[k].im * tw->re};
+        out2[k] = {out[k].re - t.re, out[k].im - t.im};
+        out[k] = {out[k].re + t.re, out[k].im + t.im};
+        tw += stride;
+    }
+}
+
+void RealFft::butterfly4(Cpx* out, int stride, int m) const {
+    const Cpx* tw1 = twiddles.data();
+    const Cpx* tw2 = tw1;
+    const Cpx* tw3 = tw1;
+    for (int k = 0; k < m; ++k, ++out) {
+        const Cpx a = out[m], b = out[2 * m], c = out[3 * m];
+        const Cpx s0 = {a.re * tw1->re - a.im * tw1->im, a.re * tw1->im + a.im * tw1->re};
+        const Cpx s1 = {b.re * tw2->re - b.im * tw2->im, b.re * tw2->im + b.im * tw2->re};
+        const Cpx s2 = {c.re * tw3->re - c.im * tw3->im, c.re * tw3->im + c.im * tw3->re};
+        tw1 += stride;
+        tw2 += 2 * stride;
+        tw3 += 3 * stride;
+
+        const Cpx s5 = {out[0].re - s1.re, out[0].im - s1.im};
+        const Cpx s3 = {s0.re + s2.re, s0.im + s2.im};
+        const Cpx s4 = {s0.re - s2.re, s0.im - s2.im};
+        const Cpx x0 = {out[0].re + s1.re, out[0].im + s1.im};
+
+        out[2 * m] = {x0.re - s3.re, x0.im - s3.im};
+        out[0] = {x0.re + s3.re, x0.im + s3.im};
+        out[m] = {s5.re + s4.im, s5.im - s4.re};
+        out[3 * m] = {s5.re - s4.im, s5.im + s4.re};
+    }
+}
+
+void RealFft::butterflyGeneric(Cpx* out, int stride, int m, int radix) {
+    Cpx* s = scratch.data();
+    for (int u = 0; u < m; ++u) {
+        for (int q = 0, k = u; q < radix; ++q, k += m) {
+            s[q] = out[k];
+        }
+        for (int q1 = 0, k = u; q1 < radix; ++q1, k += m) {
+            int index = 0;
+            Cpx sum = s[0];
+            for (int q = 1; q < radix; ++q) {
+                index += stride * k;
+                if (index >= half) index -= half;
+                const Cpx& tw = twiddles[index];
+                sum.re += s[q].re * tw.re - s[q].im * tw.im;
+                sum.im += s[q].re * tw.im + s[q].im * tw.re;
+            }
+            out[k] = sum;
+        }
+    }
+}
+
+void RealFft::forward(const float* input, float* spectrum) {
+    // Pack even/odd samples as one complex sequence of half the length
+    for (int n = 0; n < half; ++n) {
+        packed[n] = {input[2 * n], input[2 * n + 1]};
+    }
+    complexForward(packed.data(), buffer.data());
+
+    // Split the two interleaved real spectra apart
+    Cpx* out = reinterpret_cast<Cpx*>(spectrum);
+    const Cpx z0 = buffer[0];
+    out[0] = {z0.re + z0.im, 0.0f};
+    out[half] = {z0.re - z0.im, 0.0f};
+    for (int k = 1; k <= half / 2; ++k) {
+        const Cpx fk = buffer[k];
+        const Cpx fnk = {buffer[half - k].re, -buffer[half - k].im};
+        const Cpx f1 = {fk.re + fnk.re, fk.im + fnk.im};
+        const Cpx f2 = {fk.re - fnk.re, fk.im - fnk.im};
+        const Cpx& w = splitTwiddles[k];
+        const Cpx tw = {f2.re * w.re - f2.im * w.im, f2.re * w.im + f2.im * w.re};
+        out[k] = {0.5f * (f1.re + tw.re), 0.5f * (f1.im + tw.im)};
+        out[half - k] = {0.5f * (f1.re - tw.re), 0.5f * (tw.im - f1.im)};
+    }
+}
+
+void RealFft::inverse(const float* spectrum, float* output) {
+    // Merge the spectrum back into the packed even/odd form (conjugated,
+    // so the forward complex transform computes the inverse)
+    const Cpx* in = reinterpret_cast<const Cpx*>(spectrum);
+    packed[0] = {in[0].re + in[half].re, -(in[0].re - in[half].re)};
+    for (int k = 1; k <= half / 2; ++k) {
+        const Cpx fk = in[k];
+        const Cpx fnk = {in[half - k].re, -in[half - k].im};
+        const Cpx fe = {fk.re + fnk.re, fk.im + fnk.im};
+        const Cpx t = {fk.re - fnk.re, fk.im - fnk.im};
+        // Conjugate split twiddle
+        const Cpx& w = splitTwiddles[k];
+        const Cpx fo = {t.re * w.re + t.im * w.im, t.im * w.re - t.re * w.im};
+        packed[k] = {fe.re + fo.re, -(fe.im + fo.im)};
+        packed[half - k] = {fe.re - fo.re, fe.im - fo.im};
+    }
+    complexForward(packed.data(), buffer.data());
+
+    const float scale = 1.0f / size;
+    for (int n = 0; n < half; ++n) {
+        output[2 * n] = buffer[n].re * scale;
+        output[2 * n + 1] = -buffer[n].im * scale;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+/**
+ * Real-input FFT of a fixed even size.
+ *
+ * A size-N real transform runs as one complex FFT of size N/2 plus a
+ * split step. The complex FFT is mixed radix (4, 2, then any odd
+ * factors), so sizes such as 640 or 1536 that voice band analysis
+ * produces work as well as powers of two, just less quickly.
+ *
+ * Spectra are interleaved complex, N/2 + 1 bins (DC to Nyquist):
+ * re0, im0, re1, im1, ...
+ *
+ * forward() and inverse() do not allocate. Not thread-safe: each
+ * instance has its own scratch space.
+ */
+class RealFft {
+private:
+    struct Cpx {
+        float re;
+        float im;
+    };
+
+    int size;
+    int half;                       // size / 2, the complex FFT length
+    std::vector<int> factors;       // (radix, remaining length) pairs
+    std::vector<Cpx> twiddles;      // exp(-2 pi i k / half)
+    std::vector<Cpx> splitTwiddles; // exp(-i pi (k / half + 1/2)), k = 0..half/2
+    std::vector<Cpx> buffer;        // half
+    std::vector<Cpx> packed;        // half
+    std::vector<Cpx> scratch;       // Largest odd radix
+
+    void transform(Cpx* out, const Cpx* in, int stride, const int* factor);
+    void butterfly2(Cpx* out, int stride, int m) const;
+    void butterfly4(Cpx* out, int stride, int m) const;
+    void butterflyGeneric(Cpx* out, int stride, int m, int radix);
+    void complexForward(const Cpx* in, Cpx* out);
+
+public:
+    RealFft();
+
+    /**
+     * Prepare for transforms of the given size. Returns false unless size is
+     * even and at least 2.
+     */
+    bool configure(int size);
+
+    int getSize() const { return size; }
+
+    /**
+     * Spectrum of size real samples
+     * @param spectrum 2 * (size / 2 + 1) floats, interleaved complex
+     */
+    void forward(const float* input, float* spectrum);
+
+    /**
+     * Inverse of forward(), including the 1/size scaling, so
+     * inverse(forward(x)) == x. The imaginary parts of the DC and Nyquist
+     * bins are ignored.
+     * @param spectrum 2 * (size / 2 + 1) floats, interleaved complex
+     * @param output size real samples
+     */
+    void inverse(const float* spectrum, float* output);
+};
+
+#endif // FFT_H
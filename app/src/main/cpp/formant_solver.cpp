@@ -0,0 +1,177 @@
+#include "formant_solver.h"
+#include <algorithm>
+#include <cmath>
+
+// Sweep budgets. On speech at LPC order 46 a warm start settles in about
+// 8 sweeps and a cold start from the circle in about 12 (host/formant_bench).
+static const int kWarmSweeps = 12;
+static const int kColdSweeps = 100;
+
+// Largest root correction accepted as converged. Roots of a stable LPC
+// polynomial lie near the unit circle, so this is close to an absolute
+// angle tolerance (1e-7 rad is well below 0.01 Hz at any sample rate).
+static const double kTolerance = 1e-7;
+
+FormantSolver::FormantSolver()
+        : order(0)
+        , sampleRate(0.0f)
+        , warm(false)
+        , iterations(0) {
+}
+
+bool FormantSolver::configure(int newOrder, float newSampleRate) {
+    if (newOrder < 1 || newOrder > kMaxFormantOrder || newSampleRate <= 0.0f) {
+        return false;
+    }
+    order = newOrder;
+    sampleRate = newSampleRate;
+    warm = false;
+    return true;
+}
+
+void FormantSolver::coldStart() {
+    // The product of the roots is +-a_p, so |a_p|^(1/p) is their geometric
+    // mean radius. Spread the guesses evenly on that circle, rotated off the
+    // real axis so no two start as a conjugate pair of equal points.
+    double radius = std::pow(std::abs(coeffs[order]), 1.0 / order);
+    radius = std::min(std::max(radius, 0.5), 1.0);
+
+    const double step = 2.0 * M_PI / order;
+    for (int i = 0; i < order; ++i) {
+        roots[i] = std::polar(radius, step * i + 0.4);
+    }
+}
+
+bool FormantSolver::iterate(int maxSweeps) {
+    // Roots whose last correction was below tolerance are frozen and only
+    // take part in the repulsion terms of the others
+    bool settled[kMaxFormantOrder];
+    std::fill(settled, settled + order, false);
+    int remaining = order;
+
+    for (int sweep = 0; sweep < maxSweeps && remaining > 0; ++sweep) {
+        // Gauss-Seidel form: each root's update uses the already updated
+        // positions of the roots before it, which converges faster than
+        // updating all roots from the previous sweep
+        for (int i = 0; i < order; ++i) {
+            if (settled[i]) continue;
+
+            const double zr = roots[i].real();
+            const double zi = roots[i].imag();
+
+            // Evaluate p(z) and p'(z) together with Horner's scheme
+            double pr = 1.0, pi = 0.0;
+            double dr = 0.0, di = 0.0;
+            for (int k = 1; k <= order; ++k) {
+                const double ndr = dr * zr - di * zi + pr;
+                const double ndi = dr * zi + di * zr + pi;
+                dr = ndr;
+                di = ndi;
+                const double npr = pr * zr - pi * zi + coeffs[k];
+                const double npi = pr * zi + pi * zr;
+                pr = npr;
+                pi = npi;
+            }
+
+            // Newton step p / p'
+            double nr = pr, ni = pi;
+            const double dNorm = dr * dr + di * di;
+            if (dNorm > 0.0) {
+                nr = (pr * dr + pi * di) / dNorm;
+                ni = (pi * dr - pr * di) / dNorm;
+            }
+
+            // Repulsion from the other roots: sum of 1 / (z - z_j)
+            double sr = 0.0, si = 0.0;
+            for (int j = 0; j < order; ++j) {
+                if (j == i) continue;
+                const double ddr = zr - roots[j].real();
+                const double ddi = zi - roots[j].imag();
+                const double norm = ddr * ddr + ddi * ddi;
+                if (norm > 0.0) {
+                    sr += ddr / norm;
+                    si -= ddi / norm;
+                }
+            }
+
+            // Aberth correction: newton / (1 - newton * repulsion)
+            const double den_r = 1.0 - (nr * sr - ni * si);
+            const double den_i = -(nr * si + ni * sr);
+            const double denNorm = den_r * den_r + den_i * den_i;
+            double cr = nr, ci = ni;
+            if (denNorm > 0.0) {
+                cr = (nr * den_r + ni * den_i) / denNorm;
+                ci = (ni * den_r - nr * den_i) / denNorm;
+            }
+
+            roots[i] = std::complex<double>(zr - cr, zi - ci);
+
+            const double step = cr * cr + ci * ci;
+            if (!std::isfinite(step)) return false;
+            if (step < kTolerance * kTolerance) {
+                settled[i] = true;
+                --remaining;
+            }
+        }
+        ++iterations;
+    }
+    return remaining == 0;
+}
+
+int FormantSolver::solve(const float* lpc, float minHz, float maxHz,
+                         float* frequencies, float* bandwidths, int maxFormants) {
+    iterations = 0;
+    if (order == 0 || lpc == nullptr || lpc[0] == 0.0f) {
+        return -1;
+    }
+
+    // Roots of A(z) are the roots of z^p + a1 z^(p-1) + ... + ap
+    for (int k = 0; k <= order; ++k) {
+        coeffs[k] = static_cast<double>(lpc[k]) / lpc[0];
+    }
+
+    bool converged = warm && iterate(kWarmSweeps);
+    if (!converged) {
+        coldStart();
+        converged = iterate(kColdSweeps);
+    }
+    warm = converged;
+    if (!converged) {
+        return -1;
+    }
+
+    // Each conjugate pair is one resonance; keep the upper half-plane root.
+    // Insertion sort by frequency, the set is small.
+    float foundHz[kMaxFormantOrder];
+    float foundBw[kMaxFormantOrder];
+    int found = 0;
+    const double hzPerRadian = sampleRate / (2.0 * M_PI);
+
+    for (int i = 0; i < order; ++i) {
+        if (roots[i].imag() <= 0.0) continue;
+
+        const float hz = static_cast<float>(std::arg(roots[i]) * hzPerRadian);
+        if (hz <= minHz || hz >= maxHz) continue;
+
+        const double magnitude = std::abs(roots[i]);
+        if (magnitude >= 1.0) continue;
+        const float bw = static_cast<float>(-std::log(magnitude) * sampleRate / M_PI);
+        if (bw > kMaxFormantBandwidthHz) continue;
+
+        int pos = found++;
+        while (pos > 0 && foundHz[pos - 1] > hz) {
+            foundHz[pos] = foundHz[pos - 1];
+            foundBw[pos] = foundBw[pos - 1];
+            --pos;
+        }
+        foundHz[pos] = hz;
+        foundBw[pos] = bw;
+    }
+
+    const int count = std::min(found, maxFormants);
+    for (int i = 0; i < count; ++i) {
+        frequencies[i] = foundHz[i];
+        if (bandwidths != nullptr) bandwidths[i] = foundBw[i];
+    }
+    return count;
+}
@@ -0,0 +1,84 @@
+#ifndef FORMANT_SOLVER_H
+#define FORMANT_SOLVER_H
+
+#include <complex>
+
+/**
+ * Largest LPC order the solver accepts (2 + sampleRate/1000 up to 96 kHz)
+ */
+static const int kMaxFormantOrder = 128;
+
+/**
+ * Widest resonance reported as a formant. Vocal tract formants stay well
+ * below this; wider roots model the spectral tilt or noise floor.
+ */
+static const float kMaxFormantBandwidthHz = 400.0f;
+
+/**
+ * Formant estimator for one LPC stream.
+ *
+ * Finds all roots of the LPC polynomial A(z) = 1 + a1 z^-1 + ... + ap z^-p
+ * with Aberth-Ehrlich iteration, which converges cubically from good
+ * starting points. Successive frames of a voice have nearly the same roots,
+ * so each solve starts from the previous frame's roots and typically
+ * converges in a few sweeps; a cold start on the circle is used for the
+ * first frame or whenever the warm start fails to converge.
+ *
+ * All state lives in fixed-size arrays: solve() never allocates.
+ * Not thread-safe; use one solver per analyzer.
+ */
+class FormantSolver {
+private:
+    int order;
+    float sampleRate;
+    bool warm;
+    int iterations;
+
+    double coeffs[kMaxFormantOrder + 1];             // Monic, highest power first
+    std::complex<double> roots[kMaxFormantOrder];
+
+    void coldStart();
+    bool iterate(int maxSweeps);
+
+public:
+    FormantSolver();
+
+    /**
+     * Set the LPC order and sample rate. Drops any warm-start state.
+     * Returns false if order is outside [1, kMaxFormantOrder].
+     */
+    bool configure(int order, float sampleRate);
+
+    /**
+     * Forget the previous frame's roots (e.g. after a gap in the audio)
+     */
+    void reset() { warm = false; }
+
+    /**
+     * Solve for the roots of the LPC polynomial and report the resonances
+     * in [minHz, maxHz], sorted by frequency. Roots on or outside the unit
+     * circle (not a damped resonance) and roots wider than
+     * kMaxFormantBandwidthHz are skipped, so every bandwidth is positive.
+     *
+     * @param lpc order + 1 coefficients with lpc[0] == 1, as produced by LPC
+     * @param frequencies Receives up to maxFormants centre frequencies in Hz
+     * @param bandwidths Receives the matching -3 dB bandwidths in Hz; may be null
+     * @return Number of formants written, or -1 if the roots did not converge
+     */
+    int solve(const float* lpc, float minHz, float maxHz,
+              float* frequencies, float* bandwidths, int maxFormants);
+
+    /**
+     * Roots of the last solve, order() entries
+     */
+    const std::complex<double>* getRoots() const { return roots; }
+
+    int getOrder() const { return order; }
+
+    /**
+     * Aberth sweeps used by the last solve (including any cold restart)
+     */
+    int getIterations() const { return iterations; }
+};
+
+#endif // FORMANT_SOLVER_H
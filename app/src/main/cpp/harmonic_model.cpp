@@ -0,0 +1,113 @@
+#include "harmonic_model.h"
+#include <algorithm>
+#include <cmath>
+
+// SpectralPeaks and HarmonicPeaks settings the analyzer used
+static const float kMinPeakHz = 40.0f;
+static const float kMagnitudeThreshold = 1e-5f;
+static const float kRatioTolerance = 0.2f;
+
+void computeHarmonicModel(const float* spectrum, int size, float binHz, float f0, float totalEnergy,
+                          float* frequencies, float* magnitudes, HarmonicModel& out) {
+    out.harmonicEnergy = 0.0f;
+    out.harmonicCount = 0;
+
+    // Interior bins only: a peak needs both neighbours for the parabola
+    const int firstBin = std::max(1, static_cast<int>(std::ceil(kMinPeakHz / binHz)));
+    const int lastBin = size - 2;
+    const float nyquist = binHz * (size - 1);
+
+    for (int h = 1; h <= kMaxHarmonics; ++h) {
+        float bestFrequency = h * f0;
+        float bestMagnitude = 0.0f;
+        float bestDistance = 0.0f;
+        bool matched = false;
+
+        // Bins whose interpolated peak (within half a bin) can land inside the tolerance
+        const float lowHz = (h - kRatioTolerance) * f0;
+        const float highHz = (h + kRatioTolerance) * f0;
+        if (lowHz <= nyquist) {
+            const int lo = std::max(firstBin, static_cast<int>(std::floor(lowHz / binHz - 0.5f)));
+            const int hi = std::min(lastBin, static_cast<int>(std::ceil(highHz / binHz + 0.5f)));
+
+            for (int k = lo; k <= hi; ++k) {
+                const float middle = spectrum[k];
+                const float left = spectrum[k - 1];
+                const float right = spectrum[k + 1];
+                if (middle <= kMagnitudeThreshold || middle <= left || middle < right) {
+                    continue;
+                }
+
+                // Parabola through the three bins, as Essentia's PeakDetection
+                const float curvature = left - 2.0f * middle + right;
+                const float offset = curvature != 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+                const float frequency = (k + offset) * binHz;
+                const float magnitude = middle - 0.25f * (left - right) * offset;
+                if (frequency < kMinPeakHz) {
+                    continue;
+                }
+
+                // Nearest to the ideal ratio wins; ties go to the louder peak
+                const float distance = std::fabs(frequency / f0 - h);
+                if (distance > kRatioTolerance) {
+                    continue;
+                }
+                if (!matched || distance < bestDistance || (distance == bestDistance && magnitude > bestMagnitude)) {
+                    bestDistance = distance;
+                    bestFrequency = frequency;
+                    bestMagnitude = magnitude;
+                    matched = true;
+                }
+            }
+        }
+
+        if (matched) {
+            out.harmonicEnergy += bestMagnitude * bestMagnitude;
+            ++out.harmonicCount;
+        }
+        if (frequencies != nullptr) frequencies[h - 1] = bestFrequency;
+        if (magnitudes != nullptr) magnitudes[h - 1] = bestMagnitude;
+    }
+
+    out.noiseEnergy = totalEnergy - out.harmonicEnergy;
+}
+
+void matchHarmonicPeaks(const SpectralPeakList& peaks, float f0, float totalEnergy,
+                        float* frequencies, float* magnitudes, HarmonicModel& out) {
+    int best[kMaxHarmonics];
+    float bestDistance[kMaxHarmonics];
+    std::fill(best, best + kMaxHarmonics, -1);
+
+    for (int i = 0; i < peaks.count; ++i) {
+        const float ratio = peaks.frequencies[i] / f0;
+        const int h = static_cast<int>(std::lround(ratio));
+        const float distance = std::fabs(ratio - h);
+        if (h < 1 || h > kMaxHarmonics || distance > kRatioTolerance) {
+            continue;
+        }
+        if (best[h - 1] < 0 || distance < bestDistance[h - 1]) {
+            best[h - 1] = i;
+            bestDistance[h - 1] = distance;
+        }
+    }
+
+    out.harmonicEnergy = 0.0f;
+    out.harmonicCount = 0;
+    for (int h = 1; h <= kMaxHarmonics; ++h) {
+        const int i = best[h - 1];
+        const float magnitude = i >= 0 ? peaks.magnitudes[i] : 0.0f;
+        if (i >= 0) {
+            out.harmonicEnergy += magnitude * magnitude;
+            ++out.harmonicCount;
+        }
+        if (frequencies != nullptr) frequencies[h - 1] = i >= 0 ? peaks.frequencies[i] : h * f0;
+        if (magnitudes != nullptr) magnitudes[h - 1] = magnitude;
+    }
+    out.noiseEnergy = totalEnergy - out.harmonicEnergy;
+}
+
+float harmonicToNoiseDb(const HarmonicModel& model) {
+    if (model.harmonicEnergy <= 0.0f) return 0.0f;
+    if (model.noiseEnergy <= 0.0f) return 100.0f;
+    return 10.0f * std::log10(model.harmonicEnergy / model.noiseEnergy);
+}
@@ -0,0 +1,58 @@
+#ifndef HARMONIC_MODEL_H
+#define HARMONIC_MODEL_H
+
+#include "spectral_peaks.h"
+
+/**
+ * Harmonics matched by the HNR measure (Essentia HarmonicPeaks' default)
+ */
+static const int kMaxHarmonics = 20;
+
+/**
+ * Harmonic/noise split of one magnitude spectrum, filled by computeHarmonicModel
+ */
+struct HarmonicModel {
+    float harmonicEnergy;   // Sum of squared harmonic peak magnitudes
+    float noiseEnergy;      // Total energy minus harmonicEnergy
+    int harmonicCount;      // Harmonics with a matching peak
+};
+
+/**
+ * Match spectral peaks to the harmonics of f0 and split the energy.
+ *
+ * Same result as Essentia's SpectralPeaks (parabolic interpolation, 40 Hz
+ * up, magnitudes above 1e-5) followed by HarmonicPeaks (tolerance 0.2,
+ * kMaxHarmonics) and two Energy calls, but only the bins within the
+ * tolerance of each k * f0 are examined: for each harmonic the local
+ * maximum whose interpolated frequency is nearest k * f0 is taken. The
+ * full-band peak list, its sort and the 100-peak cap are never built, so
+ * when more than 100 peaks are present a weak harmonic SpectralPeaks would
+ * have dropped is still matched here.
+ *
+ * @param spectrum Magnitude spectrum, size bins (DC to Nyquist)
+ * @param binHz Bin spacing in Hz (sample rate / FFT size)
+ * @param f0 Fundamental in Hz, > 0
+ * @param totalEnergy Sum of |X|^2 over the spectrum (SpectralMoments::energy)
+ * @param frequencies kMaxHarmonics frequencies, or null. Unmatched
+ *        harmonics get k * f0 with magnitude 0, as HarmonicPeaks reports them.
+ * @param magnitudes kMaxHarmonics magnitudes, or null
+ */
+void computeHarmonicModel(const float* spectrum, int size, float binHz, float f0, float totalEnergy,
+                          float* frequencies, float* magnitudes, HarmonicModel& out);
+
+/**
+ * Same split from a picked peak list, as Essentia's HarmonicPeaks: each
+ * harmonic takes the peak whose frequency ratio to f0 is nearest it,
+ * within the tolerance. Harmonics above the peaks' band find no match.
+ * Arguments as computeHarmonicModel.
+ */
+void matchHarmonicPeaks(const SpectralPeakList& peaks, float f0, float totalEnergy,
+                        float* frequencies, float* magnitudes, HarmonicModel& out);
+
+/**
+ * 10 log10(harmonic / noise) in dB; 100 if there is no noise energy, 0 if
+ * there is no harmonic energy
+ */
+float harmonicToNoiseDb(const HarmonicModel& model);
+
+#endif // HARMONIC_MODEL_H
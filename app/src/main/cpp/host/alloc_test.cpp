@@ -0,0 +1,143 @@
+// Steady-state allocation check for the analysis engine.
+//
+// For each analyzer configuration the app can select (feature subsets,
+// YIN / YinFFT, pitch tracking, voice band, HNR method), runs one warm-up
+// pass of analyzeFrame(..., AudioFeatures&) over a synthetic voice so
+// every reusable buffer reaches its size, then counts global operator new
+// calls over further passes of the same loop, on float and on int16 input.
+//
+// Exits with status 1 if any configuration allocates after warm-up.
+//
+// Usage: alloc_test [seconds=2] [passes=2]
+
+#include "essentia_wrapper.h"
+#include "host_audio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+
+static std::atomic<bool> s_countAllocations(false);
+static std::atomic<uint64_t> s_allocations(0);
+
+static void* countedAlloc(size_t size) {
+    if (s_countAllocations.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+
+static const int kSampleRate = 16000;
+static const int kFrameSize = 1024;
+static const int kHopSize = 256;
+
+struct Config {
+    const char* name;
+    FeatureSet features;
+    PitchMethod pitch;
+    HarmonicMethod harmonics;
+    bool pitchTracking;
+    bool voiceBand;
+};
+
+static const Config kConfigs[] = {
+    { "all",             kFeatureAll, kPitchYinFft, kHarmonicModel, false, false },
+    { "all yin",         kFeatureAll, kPitchYin, kHarmonicModel, false, false },
+    { "all tracking",    kFeatureAll, kPitchYinFft, kHarmonicModel, true, false },
+    { "all voice-band",  kFeatureAll, kPitchYinFft, kHarmonicModel, false, true },
+    { "all peak-list",   kFeatureAll, kPitchYinFft, kHarmonicPeakList, false, false },
+    { "pitch",           kFeaturePitch, kPitchYinFft, kHarmonicModel, false, false },
+    { "pitch+formants",  kFeaturePitch | kFeatureFormants, kPitchYinFft, kHarmonicModel, false, false },
+    { "pitch+mfcc",      kFeaturePitch | kFeatureMfcc, kPitchYinFft, kHarmonicModel, false, false },
+};
+
+/**
+ * One pass of analyzeFrame over every hop of the input
+ */
+static int runPass(EssentiaWrapper& wrapper, const std::vector<float>& samples,
+                   const std::vector<int16_t>& pcm, bool usePcm, AudioFeatures& features) {
+    const int frames = static_cast<int>((samples.size() - kFrameSize) / kHopSize + 1);
+    int valid = 0;
+    wrapper.resetPitchTrack();
+    for (int i = 0; i < frames; ++i) {
+        const size_t offset = static_cast<size_t>(i) * kHopSize;
+        const bool ok = usePcm ? wrapper.analyzeFramePcm16(pcm.data() + offset, kFrameSize, features)
+                               : wrapper.analyzeFrame(samples.data() + offset, kFrameSize, features);
+        valid += ok;
+    }
+    return valid;
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    const int passes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 2;
+
+    const HostAudio audio = synthesizeVoice(kSampleRate, seconds);
+    std::vector<int16_t> pcm(audio.samples.size());
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        const float s = std::max(-1.0f, std::min(1.0f, audio.samples[i]));
+        pcm[i] = static_cast<int16_t>(s * 32767.0f);
+    }
+
+    bool ok = true;
+    std::printf("%-16s %-6s %8s %12s\n", "config", "input", "valid", "allocations");
+    for (const Config& config : kConfigs) {
+        EssentiaWrapper wrapper;
+        wrapper.setPitchMethod(config.pitch);
+        wrapper.setHarmonicMethod(config.harmonics);
+        wrapper.setPitchTracking(config.pitchTracking);
+        wrapper.setVoiceBand(config.voiceBand);
+        if (!wrapper.initialize(kSampleRate, kFrameSize, kHopSize, config.features)) {
+            std::fprintf(stderr, "%s: initialization failed\n", config.name);
+            return 1;
+        }
+
+        for (int usePcm = 0; usePcm < 2; ++usePcm) {
+            AudioFeatures features;
+            const int valid = runPass(wrapper, audio.samples, pcm, usePcm != 0, features);
+
+            s_allocations = 0;
+            s_countAllocations = true;
+            for (int p = 0; p < passes; ++p) {
+                runPass(wrapper, audio.samples, pcm, usePcm != 0, features);
+            }
+            s_countAllocations = false;
+
+            const uint64_t allocations = s_allocations.load();
+            // A pass with no voiced frame never reaches the later stages
+            const bool good = allocations == 0 && valid > 0;
+            ok = ok && good;
+            std::printf("%-16s %-6s %8d %12llu%s\n", config.name, usePcm ? "int16" : "float", valid,
+                        static_cast<unsigned long long>(allocations), good ? "" : "  <-- FAILED");
+        }
+        wrapper.cleanup();
+    }
+
+    std::printf("\n%s\n", ok ? "no allocations after warm-up" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+// Host benchmark for the native analysis engine.
+//
+// Runs EssentiaWrapper::analyzeFrame / analyzeBuffer over a WAV/raw file or
+// a synthetic voice and prints one JSON document with, per feature set:
+//   ns/frame and frames/sec (untraced pass), heap allocations and bytes per
+//   frame (global operator new counting), ns/frame per stage (traced pass),
+//   workspace bytes, RSS growth from initialization, and process peak RSS.
+//
+// Usage: analyzer_bench [--input=path.wav|.s16|.f32] [--seconds=10]
+//                       [--sample-rate=44100] [--frame-size=1024] [--hop=512]
+//                       [--features=all|pitch|voice|spectral|sweep|0xNN]
+//                       [--pitch=yinfft|yin] [--mode=frame|buffer] [--repeats=3]
+//                       [--voice-band=0|1] [--output=path]
+
+#include "essentia_wrapper.h"
+#include "host_audio.h"
+#include "trace_events.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+
+static std::atomic<bool> s_countAllocations(false);
+static std::atomic<uint64_t> s_allocations(0);
+static std::atomic<uint64_t> s_allocatedBytes(0);
+
+static void* countedAlloc(size_t size) {
+    if (s_countAllocations.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+struct Options {
+    std::string input;
+    double seconds = 10.0;
+    int sampleRate = 44100;
+    int frameSize = 1024;
+    int hopSize = 512;
+    std::string features = "all";
+    std::string mode = "frame";
+    std::string pitch = "yinfft";
+    bool voiceBand = false;
+    int repeats = 3;
+    std::string output;
+};
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        if (std::strncmp(arg, "--", 2) != 0 || eq == nullptr) {
+            std::fprintf(stderr, "unrecognized argument %s\n", arg);
+            return false;
+        }
+        const std::string key(arg + 2, eq);
+        const std::string value(eq + 1);
+
+        if (key == "input") opt.input = value;
+        else if (key == "seconds") opt.seconds = std::atof(value.c_str());
+        else if (key == "sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "features") opt.features = value;
+        else if (key == "mode") opt.mode = value;
+        else if (key == "pitch") opt.pitch = value;
+        else if (key == "voice-band") opt.voiceBand = std::atoi(value.c_str()) != 0;
+        else if (key == "repeats") opt.repeats = std::max(1, std::atoi(value.c_str()));
+        else if (key == "output") opt.output = value;
+        else {
+            std::fprintf(stderr, "unknown option --%s\n", key.c_str());
+            return false;
+        }
+    }
+    if (opt.mode != "frame" && opt.mode != "buffer") {
+        std::fprintf(stderr, "--mode must be frame or buffer\n");
+        return false;
+    }
+    if (opt.pitch != "yinfft" && opt.pitch != "yin") {
+        std::fprintf(stderr, "--pitch must be yinfft or yin\n");
+        return false;
+    }
+    return true;
+}
+
+struct NamedFeatureSet {
+    std::string name;
+    FeatureSet mask;
+};
+
+static bool resolveFeatureSets(const std::string& spec, std::vector<NamedFeatureSet>& sets) {
+    const NamedFeatureSet presets[] = {
+            {"pitch", kFeaturePitch},
+            {"voice", kFeaturePitch | kFeatureFormants | kFeatureHnr},
+            {"spectral", kFeaturePitch | kFeatureCentroid | kFeatureMfcc | kFeatureBrightness | kFeatureResonance},
+            {"all", kFeatureAll},
+    };
+
+    if (spec == "sweep") {
+        sets.assign(std::begin(presets), std::end(presets));
+        return true;
+    }
+    for (const NamedFeatureSet& preset : presets) {
+        if (spec == preset.name) {
+            sets.push_back(preset);
+            return true;
+        }
+    }
+    char* end = nullptr;
+    const unsigned long mask = std::strtoul(spec.c_str(), &end, 0);
+    if (end == spec.c_str() || *end != '\0' || mask == 0 || mask > kFeatureAll) {
+        std::fprintf(stderr, "invalid --features %s\n", spec.c_str());
+        return false;
+    }
+    sets.push_back({spec, static_cast<FeatureSet>(mask)});
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Measurement
+// ---------------------------------------------------------------------------
+
+static long currentRssKb() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f == nullptr) return 0;
+    long pages = 0, resident = 0;
+    if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    std::fclose(f);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;   // Kilobytes on Linux
+}
+
+struct StageStats {
+    uint64_t totalNs = 0;
+    uint64_t calls = 0;
+};
+
+struct Result {
+    NamedFeatureSet features;
+    int frames = 0;
+    int validFrames = 0;
+    double nsPerFrame = 0.0;
+    double framesPerSec = 0.0;
+    double allocationsPerFrame = 0.0;
+    double bytesPerFrame = 0.0;
+    size_t workspaceBytes = 0;
+    int algorithms = 0;
+    long initRssKb = 0;
+    std::map<std::string, StageStats> stages;
+};
+
+static int frameCount(const HostAudio& audio, const Options& opt) {
+    const int length = static_cast<int>(audio.samples.size());
+    return length < opt.frameSize ? 0 : (length - opt.frameSize) / opt.hopSize + 1;
+}
+
+// One untraced pass over the input; returns the number of valid frames
+static int runPass(EssentiaWrapper& wrapper, const HostAudio& audio, const Options& opt, AudioFeatures& features) {
+    const int frames = frameCount(audio, opt);
+    int valid = 0;
+    if (opt.mode == "buffer") {
+        valid = static_cast<int>(wrapper.analyzeBuffer(audio.samples.data(),
+                                                       static_cast<int>(audio.samples.size()), opt.hopSize).size());
+    } else {
+        for (int i = 0; i < frames; ++i) {
+            valid += wrapper.analyzeFrame(audio.samples.data() + static_cast<size_t>(i) * opt.hopSize,
+                                          opt.frameSize, features);
+        }
+    }
+    return valid;
+}
+
+static bool benchmark(const NamedFeatureSet& set, const HostAudio& audio, const Options& opt, Result& result) {
+    result.features = set;
+    result.frames = frameCount(audio, opt);
+
+    const long rssBefore = currentRssKb();
+    EssentiaWrapper wrapper;
+    wrapper.setPitchMethod(opt.pitch == "yin" ? kPitchYin : kPitchYinFft);
+    wrapper.setVoiceBand(opt.voiceBand);
+    if (!wrapper.initialize(audio.sampleRate, opt.frameSize, opt.hopSize, set.mask)) {
+        return false;
+    }
+    result.initRssKb = currentRssKb() - rssBefore;
+    result.workspaceBytes = wrapper.getWorkspaceBytes();
+    result.algorithms = wrapper.getAlgorithmCount();
+
+    // Warm-up pass sizes every reusable buffer
+    AudioFeatures features;
+    runPass(wrapper, audio, opt, features);
+
+    // Timed pass, tracing off, counting allocations
+    traceSetEnabled(false);
+    s_allocations = 0;
+    s_allocatedBytes = 0;
+    s_countAllocations = true;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < opt.repeats; ++r) {
+        result.validFrames = runPass(wrapper, audio, opt, features);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    s_countAllocations = false;
+
+    const double totalFrames = static_cast<double>(result.frames) * opt.repeats;
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    if (totalFrames > 0) {
+        result.nsPerFrame = ns / totalFrames;
+        result.framesPerSec = totalFrames / (ns * 1e-9);
+        result.allocationsPerFrame = s_allocations.load() / totalFrames;
+        result.bytesPerFrame = s_allocatedBytes.load() / totalFrames;
+    }
+
+    // Traced pass for the per-stage breakdown, collected in batches small
+    // enough that the per-thread ring never wraps
+    if (traceIsAvailable()) {
+        const int batch = static_cast<int>(kTraceRingCapacity / (2 * kTraceStageCount));
+        std::vector<TraceEvent> events;
+        traceClear();
+        traceSetEnabled(true);
+        for (int first = 0; first < result.frames; first += batch) {
+            const int last = std::min(result.frames, first + batch);
+            for (int i = first; i < last; ++i) {
+                wrapper.analyzeFrame(audio.samples.data() + static_cast<size_t>(i) * opt.hopSize,
+                                     opt.frameSize, features);
+            }
+            traceCollect(events);
+            traceClear();
+            for (const TraceEvent& e : events) {
+                if (e.phase != kTracePhaseSpan) continue;
+                StageStats& stats = result.stages[traceStageName(e.stage)];
+                stats.totalNs += e.durationNs;
+                ++stats.calls;
+            }
+        }
+        traceSetEnabled(false);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+static void writeJson(FILE* out, const Options& opt, const HostAudio& audio, const std::vector<Result>& results) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"input\": \"%s\",\n", opt.input.empty() ? "synthetic" : opt.input.c_str());
+    std::fprintf(out, "  \"sampleRate\": %d,\n", audio.sampleRate);
+    std::fprintf(out, "  \"samples\": %zu,\n", audio.samples.size());
+    std::fprintf(out, "  \"frameSize\": %d,\n", opt.frameSize);
+    std::fprintf(out, "  \"hopSize\": %d,\n", opt.hopSize);
+    std::fprintf(out, "  \"mode\": \"%s\",\n", opt.mode.c_str());
+    std::fprintf(out, "  \"pitch\": \"%s\",\n", opt.pitch.c_str());
+    std::fprintf(out, "  \"voiceBand\": %s,\n", opt.voiceBand ? "true" : "false");
+    std::fprintf(out, "  \"repeats\": %d,\n", opt.repeats);
+    std::fprintf(out, "  \"tracing\": %s,\n", traceIsAvailable() ? "true" : "false");
+    std::fprintf(out, "  \"results\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out, "    {\n");
+        std::fprintf(out, "      \"features\": \"%s\",\n", r.features.name.c_str());
+        std::fprintf(out, "      \"featureMask\": %u,\n", r.features.mask);
+        std::fprintf(out, "      \"frames\": %d,\n", r.frames);
+        std::fprintf(out, "      \"validFrames\": %d,\n", r.validFrames);
+        std::fprintf(out, "      \"nsPerFrame\": %.1f,\n", r.nsPerFrame);
+        std::fprintf(out, "      \"framesPerSec\": %.1f,\n", r.framesPerSec);
+        std::fprintf(out, "      \"allocationsPerFrame\": %.3f,\n", r.allocationsPerFrame);
+        std::fprintf(out, "      \"bytesAllocatedPerFrame\": %.1f,\n", r.bytesPerFrame);
+        std::fprintf(out, "      \"algorithms\": %d,\n", r.algorithms);
+        std::fprintf(out, "      \"workspaceBytes\": %zu,\n", r.workspaceBytes);
+        std::fprintf(out, "      \"initRssKb\": %ld,\n", r.initRssKb);
+        std::fprintf(out, "      \"stages\": {");
+
+        bool first = true;
+        for (const auto& stage : r.stages) {
+            const StageStats& s = stage.second;
+            std::fprintf(out, "%s\n        \"%s\": {\"calls\": %llu, \"nsPerCall\": %.1f, \"nsPerFrame\": %.1f}",
+                         first ? "" : ",", stage.first.c_str(), static_cast<unsigned long long>(s.calls),
+                         s.calls ? static_cast<double>(s.totalNs) / s.calls : 0.0,
+                         r.frames ? static_cast<double>(s.totalNs) / r.frames : 0.0);
+            first = false;
+        }
+        std::fprintf(out, "%s}\n", first ? "" : "\n      ");
+        std::fprintf(out, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    std::fprintf(out, "  ],\n");
+    std::fprintf(out, "  \"peakRssKb\": %ld\n", peakRssKb());
+    std::fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    std::vector<NamedFeatureSet> sets;
+    if (!resolveFeatureSets(opt.features, sets)) {
+        return 2;
+    }
+
+    HostAudio audio;
+    if (opt.input.empty()) {
+        audio = synthesizeVoice(opt.sampleRate, opt.seconds);
+    } else {
+        std::string error;
+        if (!loadAudio(opt.input, opt.sampleRate, audio, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    if (frameCount(audio, opt) == 0) {
+        std::fprintf(stderr, "input shorter than one frame\n");
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (const NamedFeatureSet& set : sets) {
+        Result result;
+        if (!benchmark(set, audio, opt, result)) {
+            std::fprintf(stderr, "failed to initialize analyzer for features %s\n", set.name.c_str());
+            return 1;
+        }
+        results.push_back(result);
+    }
+
+    FILE* out = stdout;
+    if (!opt.output.empty()) {
+        out = std::fopen(opt.output.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.output.c_str());
+            return 1;
+        }
+    }
+    writeJson(out, opt, audio, results);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,227 @@
+// BatchAnalyzer vs serial analysis of the same recordings.
+//
+// Writes synthetic recordings to a work directory: continuous voice and
+// voice with pauses, at the analysis rate and at 44.1 / 48 kHz (which the
+// batch resamples). Runs BatchAnalyzer over them with small chunks, so
+// there are many chunk boundaries and stolen chunks, then analyzes each
+// recording serially (resampled the same way, one frame per hop, as
+// analyzeBuffer) and compares the feature files with the serial result.
+//
+// Exits with status 1 if a recording fails, or if without pitch tracking
+// any feature file differs from the serial one, or if with pitch tracking
+// more than 1% of a recording's frames differ in voicing or in pitch by
+// more than 1%.
+//
+// Usage: batch_bench [--seconds=20] [--threads=4] [--chunk-frames=32]
+//                    [--sample-rate=16000] [--frame-size=1024] [--hop=256]
+//                    [--pitch-tracking=0|1] [--work-dir=batch_bench_work]
+
+#include "batch_analyzer.h"
+#include "feature_columns.h"
+#include "host_audio.h"
+#include "resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+// Allowed fraction of frames whose voicing or pitch differs, with tracking
+static const double kMaxTrackMismatchFraction = 0.01;
+
+struct Options {
+    double seconds = 20.0;
+    int threads = 4;
+    int chunkFrames = 32;
+    int sampleRate = 16000;
+    int frameSize = 1024;
+    int hopSize = 256;
+    bool pitchTracking = false;
+    std::string workDir = "batch_bench_work";
+};
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        const std::string key = eq ? std::string(arg, eq - arg) : std::string(arg);
+        const std::string value = eq ? std::string(eq + 1) : std::string();
+
+        if (key == "--seconds") opt.seconds = std::atof(value.c_str());
+        else if (key == "--threads") opt.threads = std::atoi(value.c_str());
+        else if (key == "--chunk-frames") opt.chunkFrames = std::atoi(value.c_str());
+        else if (key == "--sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "--frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "--hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "--pitch-tracking") opt.pitchTracking = std::atoi(value.c_str()) != 0;
+        else if (key == "--work-dir") opt.workDir = value;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Synthetic voice, optionally silenced for 0.4 s out of every 1.5 s
+ */
+static HostAudio recording(int sampleRate, double seconds, bool pauses) {
+    HostAudio audio = synthesizeVoice(sampleRate, seconds);
+    if (pauses) insertPauses(audio, 1.5, 0.4);
+    return audio;
+}
+
+/**
+ * Serial reference: the recording resampled as the batch does, then one
+ * analyzeFrame per hop with the pitch track started once
+ */
+static std::vector<uint8_t> analyzeSerially(EssentiaWrapper& wrapper, const HostAudio& audio, const Options& opt,
+                                            double& ms) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<float> samples = audio.samples;
+    if (audio.sampleRate != opt.sampleRate) {
+        PolyphaseResampler resampler;
+        resampler.configure(audio.sampleRate, opt.sampleRate);
+        samples.assign(resampler.outputLength(static_cast<int>(audio.samples.size())), 0.0f);
+        resampler.resample(audio.samples.data(), static_cast<int>(audio.samples.size()), samples.data(),
+                           static_cast<int>(samples.size()));
+    }
+
+    const int length = static_cast<int>(samples.size());
+    const int frames = length >= opt.frameSize ? (length - opt.frameSize) / opt.hopSize + 1 : 0;
+    std::vector<AudioFeatures> features(frames);
+    std::vector<uint8_t> valid(frames, 0);
+    wrapper.resetPitchTrack();
+    for (int i = 0; i < frames; ++i) {
+        valid[i] = wrapper.analyzeFrame(samples.data() + static_cast<size_t>(i) * opt.hopSize, opt.frameSize,
+                                        features[i]);
+    }
+
+    std::vector<uint8_t> block;
+    encodeFeatureColumns(features.data(), valid.data(), frames, block);
+    ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return block;
+}
+
+/**
+ * Per-hop pitch from a columnar block, 0 for frames not written
+ */
+static std::vector<float> pitchPerFrame(const std::vector<uint8_t>& block, int frames) {
+    std::vector<float> pitch(frames, 0.0f);
+    if (block.size() < sizeof(FeatureColumnsHeader)) return pitch;
+    FeatureColumnsHeader header;
+    std::memcpy(&header, block.data(), sizeof(header));
+    for (int i = 0; i < header.frameCount; ++i) {
+        int32_t index = 0;
+        float hz = 0.0f;
+        std::memcpy(&index, block.data() + header.frameIndexOffset + 4 * i, 4);
+        std::memcpy(&hz, block.data() + header.pitchOffset + 4 * i, 4);
+        if (index >= 0 && index < frames) pitch[index] = hz;
+    }
+    return pitch;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    struct Recording {
+        const char* name;
+        int sampleRate;
+        bool pauses;
+    };
+    const Recording recordings[] = {
+        { "voice", opt.sampleRate, false },
+        { "voice_pauses", opt.sampleRate, true },
+        { "voice_44k", 44100, false },
+        { "voice_pauses_48k", 48000, true },
+    };
+
+    mkdir(opt.workDir.c_str(), 0755);
+    const std::string outputDir = opt.workDir + "/out";
+    mkdir(outputDir.c_str(), 0755);
+
+    std::vector<HostAudio> audio;
+    std::vector<std::string> inputs;
+    for (const Recording& r : recordings) {
+        audio.push_back(recording(r.sampleRate, opt.seconds, r.pauses));
+        inputs.push_back(opt.workDir + "/" + r.name + ".wav");
+        std::string error;
+        if (!saveWav(inputs.back(), audio.back(), error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    AnalyzerConfig config;
+    config.sampleRate = opt.sampleRate;
+    config.frameSize = opt.frameSize;
+    config.hopSize = opt.hopSize;
+    config.pitchTracking = opt.pitchTracking;
+
+    BatchAnalyzer batch;
+    EssentiaWrapper serial;
+    serial.setPitchTracking(opt.pitchTracking);
+    if (!batch.initialize(config, opt.threads, opt.chunkFrames, kBatchColumns)
+        || !serial.initialize(opt.sampleRate, opt.frameSize, opt.hopSize)) {
+        std::fprintf(stderr, "failed to initialize analyzers\n");
+        return 1;
+    }
+
+    std::vector<BatchFileResult> results;
+    const BatchStats stats = batch.run(inputs, outputDir, &results);
+
+    std::printf("%d recordings of %.0f s, analyzed at %d Hz, frame %d, hop %d, pitch tracking %s\n",
+                stats.files, opt.seconds, opt.sampleRate, opt.frameSize, opt.hopSize,
+                opt.pitchTracking ? "on" : "off");
+    std::printf("%d threads, %d-frame chunks, %lld chunks, %lld stolen\n\n", batch.getThreadCount(),
+                batch.getChunkFrames(), static_cast<long long>(stats.chunks),
+                static_cast<long long>(stats.stolenChunks));
+    std::printf("%-18s %8s %8s %8s %10s %10s\n", "recording", "rate", "frames", "valid", "identical",
+                "differ");
+
+    bool ok = stats.failedFiles == 0;
+    double serialMs = 0.0;
+    for (size_t f = 0; f < results.size(); ++f) {
+        const BatchFileResult& result = results[f];
+        if (result.output.empty()) {
+            std::printf("%-18s FAILED %s\n", recordings[f].name, result.error.c_str());
+            continue;
+        }
+
+        std::ifstream in(result.output, std::ios::binary);
+        const std::vector<uint8_t> batchBlock((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const std::vector<uint8_t> serialBlock = analyzeSerially(serial, audio[f], opt, serialMs);
+
+        const int frames = static_cast<int>(result.frames);
+        const bool identical = batchBlock == serialBlock;
+        int differ = 0;
+        if (!identical) {
+            const std::vector<float> a = pitchPerFrame(serialBlock, frames);
+            const std::vector<float> b = pitchPerFrame(batchBlock, frames);
+            for (int i = 0; i < frames; ++i) {
+                differ += (a[i] > 0.0f) != (b[i] > 0.0f) || std::fabs(a[i] - b[i]) > 0.01f * a[i];
+            }
+        }
+        const bool good = opt.pitchTracking ? differ <= kMaxTrackMismatchFraction * frames : identical;
+        ok = ok && good;
+        std::printf("%-18s %8d %8d %8lld %10s %10d%s\n", recordings[f].name, result.sampleRate, frames,
+                    static_cast<long long>(result.validFrames), identical ? "yes" : "no", differ,
+                    good ? "" : "  <-- FAILED");
+    }
+
+    std::printf("\nbatch %.1f ms (%.0f frames/sec), serial %.1f ms, speedup %.2fx\n", 1e3 * stats.wallSeconds,
+                stats.framesPerSecond, serialMs, serialMs / (1e3 * stats.wallSeconds));
+    std::printf("\n%s\n", ok ? "batch features match serial analysis" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Reanalysis of archived session recordings.
+//
+// Analyzes every .wav file in a directory with BatchAnalyzer, on all cores,
+// and writes one feature file per recording to the output directory
+// (columnar .features blocks, or .csv). Prints any failed files and the
+// aggregate throughput.
+//
+// Exits with status 1 if any recording could not be analyzed or written.
+//
+// Usage: batch_tool --input-dir=sessions --output-dir=features
+//                   [--threads=0] [--chunk-frames=256] [--format=columns|csv]
+//                   [--sample-rate=16000] [--frame-size=1024] [--hop=256]
+//                   [--pitch-tracking=0|1]
+
+#include "batch_analyzer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Options {
+    std::string inputDir;
+    std::string outputDir;
+    int threads = 0;
+    int chunkFrames = 0;
+    BatchOutputFormat format = kBatchColumns;
+    int sampleRate = 16000;
+    int frameSize = 1024;
+    int hopSize = 256;
+    bool pitchTracking = false;
+};
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        const std::string key = eq ? std::string(arg, eq - arg) : std::string(arg);
+        const std::string value = eq ? std::string(eq + 1) : std::string();
+
+        if (key == "--input-dir") opt.inputDir = value;
+        else if (key == "--output-dir") opt.outputDir = value;
+        else if (key == "--threads") opt.threads = std::atoi(value.c_str());
+        else if (key == "--chunk-frames") opt.chunkFrames = std::atoi(value.c_str());
+        else if (key == "--format" && (value == "columns" || value == "csv")) {
+            opt.format = value == "csv" ? kBatchCsv : kBatchColumns;
+        }
+        else if (key == "--sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "--frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "--hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "--pitch-tracking") opt.pitchTracking = std::atoi(value.c_str()) != 0;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    if (opt.inputDir.empty() || opt.outputDir.empty()) {
+        std::fprintf(stderr, "--input-dir and --output-dir are required\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    std::string error;
+    const std::vector<std::string> inputs = BatchAnalyzer::listRecordings(opt.inputDir, error);
+    if (!error.empty()) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (inputs.empty()) {
+        std::fprintf(stderr, "no .wav files in %s\n", opt.inputDir.c_str());
+        return 1;
+    }
+
+    AnalyzerConfig config;
+    config.sampleRate = opt.sampleRate;
+    config.frameSize = opt.frameSize;
+    config.hopSize = opt.hopSize;
+    config.pitchTracking = opt.pitchTracking;
+
+    BatchAnalyzer batch;
+    if (!batch.initialize(config, opt.threads, opt.chunkFrames, opt.format)) {
+        std::fprintf(stderr, "failed to initialize analyzers\n");
+        return 1;
+    }
+
+    std::vector<BatchFileResult> results;
+    const BatchStats stats = batch.run(inputs, opt.outputDir, &results);
+
+    for (const BatchFileResult& result : results) {
+        if (result.output.empty()) {
+            std::printf("FAILED %s\n", result.error.c_str());
+        }
+    }
+
+    std::printf("%d recordings (%d failed), %.1f s of audio at %d Hz, frame %d, hop %d\n",
+                stats.files, stats.failedFiles, stats.audioSeconds, opt.sampleRate, opt.frameSize,
+                opt.hopSize);
+    std::printf("%d threads, %d-frame chunks, %lld chunks, %lld stolen\n", batch.getThreadCount(),
+                batch.getChunkFrames(), static_cast<long long>(stats.chunks),
+                static_cast<long long>(stats.stolenChunks));
+    std::printf("%lld frames (%lld valid) in %.2f s: %.0f frames/sec, %.1fx realtime\n",
+                static_cast<long long>(stats.frames), static_cast<long long>(stats.validFrames),
+                stats.wallSeconds, stats.framesPerSecond, stats.realtimeFactor);
+
+    std::printf("\n%s\n", stats.failedFiles == 0 ? "all recordings analyzed" : "FAILED");
+    return stats.failedFiles == 0 ? 0 : 1;
+}
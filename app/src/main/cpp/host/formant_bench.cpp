@@ -0,0 +1,362 @@
+// Benchmark and accuracy comparison for FormantSolver.
+//
+// Synthesizes a gliding vowel (impulse train through formant resonators),
+// derives LPC coefficients per frame the way the analyzer does, and finds
+// formants with:
+//   - Eigen PolynomialSolver in double precision on A(z) (reference)
+//   - the previous analyzer path (Eigen, complex<float>, lpc[0] dropped)
+//   - FormantSolver cold-started every frame
+//   - FormantSolver warm-started from the previous frame
+// and checks the root filtering on an A(z) built from known roots: one
+// formant, one root outside the unit circle, one root too wide to be a
+// formant.
+//
+// Exits with status 1 if a solve fails, a solver frequency differs from
+// the reference by more than kHzTolerance, any reported bandwidth is not
+// in (0, kMaxFormantBandwidthHz], or the known-root case reports anything
+// but its one formant.
+//
+// Usage: formant_bench [sampleRate=44100] [frames=400] [repeats=5]
+
+#include "formant_solver.h"
+#include "unsupported/Eigen/Polynomials"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const int kFrameSize = 1024;
+static const int kHopSize = 512;
+static const float kMinHz = 90.0f;
+static const float kMaxHz = 4000.0f;
+// Largest solver vs reference frequency difference accepted
+static const double kHzTolerance = 1.0;
+// Frames whose formant count may differ from the reference, for roots
+// that sit right on the bandwidth limit in one precision but not the other
+static const double kCountMismatchFraction = 0.01;
+
+struct Formants {
+    std::vector<float> hz;
+    std::vector<float> bw;
+};
+
+// Two-pole resonator at centre frequency f and bandwidth b
+struct Resonator {
+    double a1 = 0.0, a2 = 0.0, gain = 1.0, y1 = 0.0, y2 = 0.0;
+
+    void set(double f, double b, double sr) {
+        const double r = std::exp(-M_PI * b / sr);
+        a1 = -2.0 * r * std::cos(2.0 * M_PI * f / sr);
+        a2 = r * r;
+        gain = 1.0 + a1 + a2;
+    }
+
+    double process(double x) {
+        const double y = gain * x - a1 * y1 - a2 * y2;
+        y2 = y1;
+        y1 = y;
+        return y;
+    }
+};
+
+// Vowel glide /a/ -> /i/ -> /u/ with a slowly varying pitch
+static std::vector<float> synthesize(int sampleRate, int samples) {
+    std::vector<float> out(samples);
+    Resonator res[4];
+    std::mt19937 rng(1234);
+    std::normal_distribution<double> noise(0.0, 0.01);
+
+    double phase = 0.0;
+    for (int n = 0; n < samples; ++n) {
+        const double t = static_cast<double>(n) / samples;
+        const double f0 = 140.0 + 40.0 * std::sin(2.0 * M_PI * t * 1.5);
+        const double blend = 0.5 - 0.5 * std::cos(2.0 * M_PI * t);
+        const double f1 = 750.0 - 450.0 * blend;
+        const double f2 = 1200.0 + 1000.0 * std::sin(M_PI * t) - 300.0 * t;
+        if (n % 64 == 0) {
+            res[0].set(f1, 80.0, sampleRate);
+            res[1].set(f2, 100.0, sampleRate);
+            res[2].set(2600.0, 140.0, sampleRate);
+            res[3].set(3400.0, 200.0, sampleRate);
+        }
+
+        phase += f0 / sampleRate;
+        double x = noise(rng);
+        if (phase >= 1.0) {
+            phase -= 1.0;
+            x += 1.0;
+        }
+        for (Resonator& r : res) x = r.process(x);
+        out[n] = static_cast<float>(x);
+    }
+    return out;
+}
+
+// Hann window, autocorrelation and Levinson-Durbin, as Essentia's LPC does
+static bool lpcForFrame(const float* frame, int order, std::vector<float>& lpc) {
+    std::vector<double> w(kFrameSize);
+    for (int i = 0; i < kFrameSize; ++i) {
+        w[i] = frame[i] * (0.5 - 0.5 * std::cos(2.0 * M_PI * i / (kFrameSize - 1)));
+    }
+
+    std::vector<double> r(order + 1, 0.0);
+    for (int lag = 0; lag <= order; ++lag) {
+        for (int i = lag; i < kFrameSize; ++i) r[lag] += w[i] * w[i - lag];
+    }
+    if (r[0] <= 0.0) return false;
+
+    std::vector<double> a(order + 1, 0.0), tmp(order + 1);
+    a[0] = 1.0;
+    double err = r[0];
+    for (int i = 1; i <= order; ++i) {
+        double acc = r[i];
+        for (int j = 1; j < i; ++j) acc += a[j] * r[i - j];
+        const double k = -acc / err;
+        tmp = a;
+        for (int j = 1; j < i; ++j) a[j] = tmp[j] + k * tmp[i - j];
+        a[i] = k;
+        err *= (1.0 - k * k);
+    }
+
+    lpc.assign(order + 1, 0.0f);
+    for (int i = 0; i <= order; ++i) lpc[i] = static_cast<float>(a[i]);
+    return true;
+}
+
+// Same selection as FormantSolver::solve
+static void collect(const std::complex<double>& root, double sampleRate, Formants& out) {
+    if (root.imag() <= 0.0) return;
+    const float hz = static_cast<float>(std::arg(root) * sampleRate / (2.0 * M_PI));
+    if (hz <= kMinHz || hz >= kMaxHz) return;
+    if (std::abs(root) >= 1.0) return;
+    const float bw = static_cast<float>(-std::log(std::abs(root)) * sampleRate / M_PI);
+    if (bw > kMaxFormantBandwidthHz) return;
+    out.hz.push_back(hz);
+    out.bw.push_back(bw);
+}
+
+static void sortFormants(Formants& f) {
+    std::vector<size_t> idx(f.hz.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return f.hz[a] < f.hz[b]; });
+    Formants sorted;
+    for (size_t i : idx) {
+        sorted.hz.push_back(f.hz[i]);
+        sorted.bw.push_back(f.bw[i]);
+    }
+    f = sorted;
+}
+
+static Formants eigenReference(const std::vector<float>& lpc, double sampleRate) {
+    const int order = static_cast<int>(lpc.size()) - 1;
+    Eigen::VectorXd coeffs(order + 1);
+    for (int i = 0; i <= order; ++i) coeffs[i] = lpc[order - i];
+
+    Eigen::PolynomialSolver<double, Eigen::Dynamic> solver;
+    solver.compute(coeffs);
+
+    Formants out;
+    for (int i = 0; i < solver.roots().size(); ++i) collect(solver.roots()[i], sampleRate, out);
+    sortFormants(out);
+    return out;
+}
+
+// The analyzer's previous implementation, kept for timing
+static int eigenLegacy(const std::vector<float>& lpc, double sampleRate, float* hz) {
+    const size_t polySize = lpc.size() - 1;
+    std::vector<std::complex<float>> polyCoeffs(polySize);
+    for (size_t i = 0; i < polySize; ++i) {
+        polyCoeffs[i] = std::complex<float>(lpc[lpc.size() - 1 - i], 0.0f);
+    }
+    Eigen::Map<const Eigen::VectorXcf> coeffs(polyCoeffs.data(), polySize);
+    Eigen::PolynomialSolver<std::complex<float>, Eigen::Dynamic> solver;
+    solver.compute(coeffs);
+
+    int count = 0;
+    for (int i = 0; i < solver.roots().size(); ++i) {
+        if (std::imag(solver.roots()[i]) >= 0) {
+            const float freq = std::arg(solver.roots()[i]) * (sampleRate / (2.0 * M_PI));
+            if (freq > kMinHz && freq < kMaxHz) hz[count++] = freq;
+        }
+    }
+    return count;
+}
+
+struct Accuracy {
+    int frames = 0;
+    int countMismatches = 0;
+    int failures = 0;
+    int badBandwidths = 0;
+    double maxHzError = 0.0;
+    double sumHzError = 0.0;
+    double maxBwError = 0.0;
+    int compared = 0;
+
+    bool passed() const {
+        return failures == 0 && badBandwidths == 0 && maxHzError <= kHzTolerance
+               && countMismatches <= kCountMismatchFraction * frames;
+    }
+};
+
+static void compare(const Formants& ref, const float* hz, const float* bw, int count, Accuracy& acc) {
+    ++acc.frames;
+    if (count < 0) {
+        ++acc.failures;
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        acc.badBandwidths += !(bw[i] > 0.0f && bw[i] <= kMaxFormantBandwidthHz);
+    }
+    if (count != static_cast<int>(ref.hz.size())) {
+        ++acc.countMismatches;
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        const double dHz = std::fabs(hz[i] - ref.hz[i]);
+        const double dBw = std::fabs(bw[i] - ref.bw[i]);
+        acc.maxHzError = std::max(acc.maxHzError, dHz);
+        acc.maxBwError = std::max(acc.maxBwError, dBw);
+        acc.sumHzError += dHz;
+        ++acc.compared;
+    }
+}
+
+static void printAccuracy(const char* name, const Accuracy& acc) {
+    std::printf("  %-12s frames=%d failures=%d count_mismatch=%d bad_bw=%d max_hz_err=%.4g mean_hz_err=%.4g "
+                "max_bw_err=%.4g%s\n",
+                name, acc.frames, acc.failures, acc.countMismatches, acc.badBandwidths, acc.maxHzError,
+                acc.compared ? acc.sumHzError / acc.compared : 0.0, acc.maxBwError, acc.passed() ? "" : "  <-- FAILED");
+}
+
+// A(z) with a formant at 500 Hz (bandwidth 60 Hz), a root pair outside the
+// unit circle at 1500 Hz and a pair at 2500 Hz with a 1 kHz bandwidth,
+// padded to the analyzer's order with real roots. Only the 500 Hz
+// resonance may be reported.
+static bool knownRootsCase(int sampleRate, int order) {
+    std::vector<std::complex<double>> roots;
+    auto pair = [&](double hz, double radius) {
+        const std::complex<double> z = std::polar(radius, 2.0 * M_PI * hz / sampleRate);
+        roots.push_back(z);
+        roots.push_back(std::conj(z));
+    };
+    pair(500.0, std::exp(-M_PI * 60.0 / sampleRate));
+    pair(1500.0, 1.02);
+    pair(2500.0, std::exp(-M_PI * 1000.0 / sampleRate));
+    while (static_cast<int>(roots.size()) < order) {
+        roots.push_back(std::complex<double>(0.3 - 0.05 * roots.size(), 0.0));
+    }
+
+    // Expand prod (1 - r z^-1)
+    std::vector<std::complex<double>> poly(1, 1.0);
+    for (const std::complex<double>& r : roots) {
+        poly.push_back(0.0);
+        for (size_t k = poly.size() - 1; k > 0; --k) poly[k] -= r * poly[k - 1];
+    }
+    std::vector<float> lpc(poly.size());
+    for (size_t k = 0; k < poly.size(); ++k) lpc[k] = static_cast<float>(poly[k].real());
+
+    FormantSolver solver;
+    solver.configure(order, static_cast<float>(sampleRate));
+    float hz[kMaxFormantOrder], bw[kMaxFormantOrder];
+    const int count = solver.solve(lpc.data(), kMinHz, kMaxHz, hz, bw, kMaxFormantOrder);
+
+    const bool ok = count == 1 && std::fabs(hz[0] - 500.0f) < 1.0f && std::fabs(bw[0] - 60.0f) < 1.0f;
+    std::printf("known roots: %d formant(s)", count);
+    for (int i = 0; i < count; ++i) std::printf(" %.1f Hz (bw %.1f)", hz[i], bw[i]);
+    std::printf("%s\n", ok ? "" : "  <-- FAILED, expected 500 Hz (bw 60) only");
+    return ok;
+}
+
+template <typename Fn>
+static double nsPerFrame(int frames, int repeats, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (int f = 0; f < frames; ++f) fn(f);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(frames) * repeats);
+}
+
+int main(int argc, char** argv) {
+    const int sampleRate = argc > 1 ? std::atoi(argv[1]) : 44100;
+    const int frames = argc > 2 ? std::atoi(argv[2]) : 400;
+    const int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+    const int order = 2 + static_cast<int>(sampleRate / 1000.0);
+
+    std::vector<float> audio = synthesize(sampleRate, (frames - 1) * kHopSize + kFrameSize);
+    std::vector<std::vector<float>> lpcs;
+    for (int f = 0; f < frames; ++f) {
+        std::vector<float> lpc;
+        if (lpcForFrame(audio.data() + static_cast<size_t>(f) * kHopSize, order, lpc)) {
+            lpcs.push_back(lpc);
+        }
+    }
+    const int n = static_cast<int>(lpcs.size());
+    std::printf("formant_bench: sampleRate=%d order=%d frames=%d repeats=%d\n", sampleRate, order, n, repeats);
+
+    // Accuracy against the double-precision Eigen reference
+    std::vector<Formants> reference(n);
+    for (int f = 0; f < n; ++f) reference[f] = eigenReference(lpcs[f], sampleRate);
+
+    FormantSolver warmSolver, coldSolver;
+    warmSolver.configure(order, static_cast<float>(sampleRate));
+    coldSolver.configure(order, static_cast<float>(sampleRate));
+
+    float hz[kMaxFormantOrder], bw[kMaxFormantOrder];
+    Accuracy warmAcc, coldAcc;
+    long warmIterations = 0, coldIterations = 0;
+    for (int f = 0; f < n; ++f) {
+        int count = warmSolver.solve(lpcs[f].data(), kMinHz, kMaxHz, hz, bw, kMaxFormantOrder);
+        warmIterations += warmSolver.getIterations();
+        compare(reference[f], hz, bw, count, warmAcc);
+
+        coldSolver.reset();
+        count = coldSolver.solve(lpcs[f].data(), kMinHz, kMaxHz, hz, bw, kMaxFormantOrder);
+        coldIterations += coldSolver.getIterations();
+        compare(reference[f], hz, bw, count, coldAcc);
+    }
+
+    std::printf("accuracy vs Eigen<double> on A(z):\n");
+    printAccuracy("warm", warmAcc);
+    printAccuracy("cold", coldAcc);
+    std::printf("  mean sweeps: warm=%.2f cold=%.2f\n",
+                static_cast<double>(warmIterations) / n, static_cast<double>(coldIterations) / n);
+    const bool knownRoots = knownRootsCase(sampleRate, order);
+    if (n > 0) {
+        const Formants& mid = reference[n / 2];
+        std::printf("  frame %d reference:", n / 2);
+        for (size_t i = 0; i < mid.hz.size() && i < 4; ++i) std::printf(" %.0f Hz (bw %.0f)", mid.hz[i], mid.bw[i]);
+        std::printf("\n");
+    }
+
+    // Timing
+    volatile float sink = 0.0f;
+    const double legacyNs = nsPerFrame(n, repeats, [&](int f) {
+        sink = sink + static_cast<float>(eigenLegacy(lpcs[f], sampleRate, hz));
+    });
+    const double eigenNs = nsPerFrame(n, repeats, [&](int f) {
+        sink = sink + static_cast<float>(eigenReference(lpcs[f], sampleRate).hz.size());
+    });
+    const double coldNs = nsPerFrame(n, repeats, [&](int f) {
+        coldSolver.reset();
+        sink = sink + static_cast<float>(coldSolver.solve(lpcs[f].data(), kMinHz, kMaxHz, hz, bw, kMaxFormantOrder));
+    });
+    warmSolver.reset();
+    const double warmNs = nsPerFrame(n, repeats, [&](int f) {
+        sink = sink + static_cast<float>(warmSolver.solve(lpcs[f].data(), kMinHz, kMaxHz, hz, bw, kMaxFormantOrder));
+    });
+
+    std::printf("timing (ns/frame):\n");
+    std::printf("  eigen_legacy_cf   %10.0f\n", legacyNs);
+    std::printf("  eigen_double      %10.0f\n", eigenNs);
+    std::printf("  solver_cold       %10.0f  (%.1fx vs legacy)\n", coldNs, legacyNs / coldNs);
+    std::printf("  solver_warm       %10.0f  (%.1fx vs legacy)\n", warmNs, legacyNs / warmNs);
+
+    const bool ok = warmAcc.passed() && coldAcc.passed() && knownRoots;
+    std::printf("\n%s\n", ok ? "formants within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// Accuracy check and benchmark for the harmonic-model HNR kernel.
+//
+// Synthesizes voiced frames (harmonics of a random f0 with a 1/h rolloff,
+// white noise at a random level), takes their Hann magnitude spectra and
+// computes HNR two ways: the path the analyzer took through Essentia
+// (SpectralPeaks: every local maximum from 40 Hz up, interpolated, the 100
+// loudest kept and sorted by frequency; HarmonicPeaks: the peak nearest
+// each k * f0 within a 0.2 ratio; two energy sums), re-implemented here,
+// and computeHarmonicModel. Reports the HNR differences and the cost per
+// frame of each.
+//
+// Exits with status 1 if the mean HNR difference exceeds kMeanToleranceDb.
+// Single frames can differ when the 100-peak cap drops a weak harmonic
+// that the kernel still matches; the largest difference is reported.
+//
+// Usage: hnr_bench [frames=500] [repeats=20]
+
+#include "harmonic_model.h"
+#include "stft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const double kMeanToleranceDb = 0.05;
+
+struct Peak {
+    float frequency;
+    float magnitude;
+};
+
+// SpectralPeaks + HarmonicPeaks + Energy, with the analyzer's settings
+static float referenceHnr(const std::vector<float>& spectrum, float binHz, float f0, float total,
+                         std::vector<Peak>& peaks) {
+    const int size = static_cast<int>(spectrum.size());
+    peaks.clear();
+    for (int k = std::max(1, static_cast<int>(std::ceil(40.0f / binHz))); k < size - 1; ++k) {
+        const float left = spectrum[k - 1], middle = spectrum[k], right = spectrum[k + 1];
+        if (middle <= 1e-5f || middle <= left || middle < right) continue;
+        const float offset = 0.5f * (left - right) / (left - 2.0f * middle + right);
+        peaks.push_back({(k + offset) * binHz, middle - 0.25f * (left - right) * offset});
+    }
+    const size_t wanted = std::min<size_t>(100, peaks.size());
+    std::partial_sort(peaks.begin(), peaks.begin() + wanted, peaks.end(),
+                      [](const Peak& a, const Peak& b) { return a.magnitude > b.magnitude; });
+    peaks.resize(wanted);
+    std::sort(peaks.begin(), peaks.end(), [](const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+
+    int best[kMaxHarmonics];
+    float bestDistance[kMaxHarmonics];
+    std::fill(best, best + kMaxHarmonics, -1);
+    for (size_t i = 0; i < peaks.size(); ++i) {
+        const float ratio = peaks[i].frequency / f0;
+        const int h = static_cast<int>(std::lround(ratio));
+        const float distance = std::fabs(ratio - h);
+        if (h < 1 || h > kMaxHarmonics || distance > 0.2f) continue;
+        if (best[h - 1] < 0 || distance < bestDistance[h - 1]) {
+            best[h - 1] = static_cast<int>(i);
+            bestDistance[h - 1] = distance;
+        }
+    }
+
+    float harmonic = 0.0f;
+    for (int h = 0; h < kMaxHarmonics; ++h) {
+        if (best[h] >= 0) harmonic += peaks[best[h]].magnitude * peaks[best[h]].magnitude;
+    }
+    const HarmonicModel model = {harmonic, total - harmonic, 0};
+    return harmonicToNoiseDb(model);
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    // Analysis rate and frame size: voice band from 16 kHz and 44.1 kHz, and full band
+    struct Config {
+        int sampleRate, frameSize;
+    } configs[] = {{10000, 640}, {11025, 256}, {44100, 1024}};
+
+    std::printf("%-12s %12s %12s %14s %14s\n", "rate/frame", "mean |dHNR|", "max |dHNR|", "peaks ns", "kernel ns");
+
+    bool ok = true;
+    std::mt19937 rng(19);
+    for (const Config& c : configs) {
+        const int n = c.frameSize;
+        const int bins = n / 2 + 1;
+        const float binHz = static_cast<float>(c.sampleRate) / n;
+        std::uniform_real_distribution<float> f0Dist(90.0f, 300.0f);
+        std::uniform_real_distribution<float> noiseDb(-50.0f, -5.0f);
+
+        StftFrontEnd stft;
+        stft.configure(n);
+        std::vector<std::vector<float>> spectra(frames, std::vector<float>(bins));
+        std::vector<float> f0s(frames), totals(frames), frame(n);
+        for (int f = 0; f < frames; ++f) {
+            f0s[f] = f0Dist(rng);
+            std::normal_distribution<float> noise(0.0f, 0.3f * std::pow(10.0f, noiseDb(rng) / 20.0f));
+            for (int i = 0; i < n; ++i) {
+                double sample = 0.0;
+                for (int h = 1; h * f0s[f] < c.sampleRate / 2.0f; ++h) {
+                    sample += std::sin(2.0 * M_PI * f0s[f] * h * i / c.sampleRate + h) / h;
+                }
+                frame[i] = static_cast<float>(0.3 * sample) + noise(rng);
+            }
+            stft.transform(frame.data());
+            stft.hannMagnitude(spectra[f].data());
+            totals[f] = 0.0f;
+            for (float m : spectra[f]) totals[f] += m * m;
+        }
+
+        std::vector<Peak> peaks;
+        peaks.reserve(bins);
+        std::vector<float> frequencies(kMaxHarmonics), magnitudes(kMaxHarmonics);
+        HarmonicModel model;
+        double meanDiff = 0.0, worstDiff = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            const float expected = referenceHnr(spectra[f], binHz, f0s[f], totals[f], peaks);
+            computeHarmonicModel(spectra[f].data(), bins, binHz, f0s[f], totals[f], frequencies.data(),
+                                 magnitudes.data(), model);
+            const double diff = std::fabs(expected - harmonicToNoiseDb(model));
+            meanDiff += diff / frames;
+            worstDiff = std::max(worstDiff, diff);
+        }
+
+        // The total energy is shared with the spectral moments pass, so neither path pays for it
+        volatile float sink = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (int f = 0; f < frames; ++f) sink = sink + referenceHnr(spectra[f], binHz, f0s[f], totals[f], peaks);
+        }
+        const double peaksNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (int f = 0; f < frames; ++f) {
+                computeHarmonicModel(spectra[f].data(), bins, binHz, f0s[f], totals[f], frequencies.data(),
+                                     magnitudes.data(), model);
+                sink = sink + harmonicToNoiseDb(model);
+            }
+        }
+        const double kernelNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        const bool pass = meanDiff <= kMeanToleranceDb;
+        ok = ok && pass;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d/%d", c.sampleRate, n);
+        std::printf("%-12s %12.4f %12.4f %14.0f %14.0f%s\n", name, meanDiff, worstDiff, peaksNs, kernelNs,
+                    pass ? "" : "  FAIL");
+    }
+
+    std::printf("\n%s\n", ok ? "harmonic-model HNR within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include "host_audio.h"
+#include "audio_source.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& bytes, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool loadWav(const std::string& path, HostAudio& audio, std::string& error) {
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes, error)) return false;
+    if (!decodeWav(bytes.data(), bytes.size(), audio.samples, audio.sampleRate, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool loadRaw(const std::string& path, const std::string& format, int sampleRate,
+             HostAudio& audio, std::string& error) {
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes, error)) return false;
+
+    audio.sampleRate = sampleRate;
+    return decodeRawPcm(bytes.data(), bytes.size(), format, audio.samples, error);
+}
+
+bool loadAudio(const std::string& path, int rawSampleRate, HostAudio& audio, std::string& error) {
+    const size_t dot = path.rfind('.');
+    const std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    if (ext == "wav" || ext == "WAV") {
+        return loadWav(path, audio, error);
+    }
+    return loadRaw(path, ext == "f32" ? "f32" : "s16", rawSampleRate, audio, error);
+}
+
+static void putLe(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+bool saveWav(const std::string& path, const HostAudio& audio, std::string& error) {
+    const uint32_t dataBytes = static_cast<uint32_t>(audio.samples.size() * sizeof(float));
+    std::vector<uint8_t> header = {'R', 'I', 'F', 'F'};
+    putLe(header, 36 + dataBytes, 4);
+    for (char c : std::string("WAVEfmt ")) header.push_back(c);
+    putLe(header, 16, 4);
+    putLe(header, 3, 2);            // IEEE float
+    putLe(header, 1, 2);
+    putLe(header, audio.sampleRate, 4);
+    putLe(header, audio.sampleRate * 4, 4);
+    putLe(header, 4, 2);
+    putLe(header, 32, 2);
+    for (char c : std::string("data")) header.push_back(c);
+    putLe(header, dataBytes, 4);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out.write(reinterpret_cast<const char*>(audio.samples.data()), dataBytes);
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+HostAudio synthesizeVoice(int sampleRate, double seconds) {
+    HostAudio audio;
+    audio.sampleRate = sampleRate;
+    audio.samples.resize(static_cast<size_t>(seconds * sampleRate));
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+
+    double phase = 0.0;
+    const size_t n = audio.samples.size();
+    for (size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i) / sampleRate;
+        const double f0 = 120.0 + 80.0 * (static_cast<double>(i) / n) + 4.0 * std::sin(2.0 * M_PI * 5.5 * t);
+        phase += 2.0 * M_PI * f0 / sampleRate;
+
+        double v = 0.0;
+        for (int h = 1; h <= 20; ++h) {
+            const double hz = h * f0;
+            if (hz >= sampleRate / 2.0) break;
+            // Crude vocal-tract envelope: peaks near 700 and 1800 Hz
+            const double env = 1.0 / h
+                    + 0.6 * std::exp(-std::pow((hz - 700.0) / 250.0, 2.0))
+                    + 0.4 * std::exp(-std::pow((hz - 1800.0) / 350.0, 2.0));
+            v += env * std::sin(h * phase);
+        }
+        audio.samples[i] = static_cast<float>(0.2 * v) + noise(rng);
+    }
+    return audio;
+}
+
+void insertPauses(HostAudio& audio, double periodSeconds, double gapSeconds) {
+    const size_t period = static_cast<size_t>(periodSeconds * audio.sampleRate);
+    const size_t gap = static_cast<size_t>(gapSeconds * audio.sampleRate);
+    if (period == 0 || gap == 0) return;
+    for (size_t i = 0; i < audio.samples.size(); ++i) {
+        if (i % period >= period - std::min(gap, period)) audio.samples[i] = 0.0f;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef HOST_AUDIO_H
+#define HOST_AUDIO_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Mono float audio loaded or generated for host tools
+ */
+struct HostAudio {
+    int sampleRate = 0;
+    std::vector<float> samples;
+};
+
+/**
+ * Load a RIFF/WAVE file (16-bit PCM or 32-bit float, any channel count,
+ * mixed down to mono). Returns false and fills error on failure.
+ */
+bool loadWav(const std::string& path, HostAudio& audio, std::string& error);
+
+/**
+ * Load headerless mono PCM: format "s16" (little-endian int16) or "f32"
+ */
+bool loadRaw(const std::string& path, const std::string& format, int sampleRate,
+             HostAudio& audio, std::string& error);
+
+/**
+ * Load by extension: .wav through loadWav, anything else as raw s16
+ */
+bool loadAudio(const std::string& path, int rawSampleRate, HostAudio& audio, std::string& error);
+
+/**
+ * Write mono 32-bit float RIFF/WAVE, so loadWav reads back the exact
+ * samples. Returns false and fills error on failure.
+ */
+bool saveWav(const std::string& path, const HostAudio& audio, std::string& error);
+
+/**
+ * Deterministic voiced test signal: a gliding harmonic tone with vibrato,
+ * formant-like spectral tilt and a little noise
+ */
+HostAudio synthesizeVoice(int sampleRate, double seconds);
+
+/**
+ * Silence the last gapSeconds of every periodSeconds, so an analyzer sees
+ * frames below its energy gate between voiced stretches
+ */
+void insertPauses(HostAudio& audio, double periodSeconds, double gapSeconds);
+
+#endif // HOST_AUDIO_H
@@ -0,0 +1,179 @@
+// Accuracy check and benchmark for the native log-mel engine.
+//
+// Reference: a double-precision transcription of the Kotlin
+// AudioFeatureExtractor.extractLogMelSpectrogram (direct DFT, dense
+// filterbank, ln), with the periodic Hamming window the engine shares with
+// the analyzer's STFT in place of the Kotlin code's symmetric one. Timing baseline: the Kotlin structure in C++ (window
+// and dense 80x257 filterbank rebuilt per call, dense triple loop, std::log)
+// on the same FFT, so the difference is the engine's caching and sparsity
+// rather than the JVM.
+//
+// Exits with status 1 if any output differs from the reference by more
+// than kTolerance (natural log units).
+//
+// Usage: log_mel_bench [repeats=200]
+
+#include "fft.h"
+#include "log_mel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const double kTolerance = 1e-3;
+
+static double hzToMel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+static double melToHz(double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); }
+
+static std::vector<std::vector<double>> denseFilterbank() {
+    const int bins = kLogMelFftSize / 2 + 1;
+    const double melMin = hzToMel(20.0), melMax = hzToMel(7600.0);
+    std::vector<int> points(kLogMelBands + 2);
+    for (int i = 0; i < kLogMelBands + 2; ++i) {
+        const double hz = melToHz(melMin + i * (melMax - melMin) / (kLogMelBands + 1));
+        points[i] = static_cast<int>(std::floor((kLogMelFftSize + 1) * hz / kLogMelSampleRate));
+    }
+    std::vector<std::vector<double>> bank(kLogMelBands, std::vector<double>(bins, 0.0));
+    for (int m = 1; m <= kLogMelBands; ++m) {
+        const int f0 = points[m - 1], f1 = points[m], f2 = points[m + 1];
+        for (int k = f0; k < f1; ++k) if (k >= 0 && k < bins) bank[m - 1][k] = double(k - f0) / (f1 - f0);
+        for (int k = f1; k < f2; ++k) if (k >= 0 && k < bins) bank[m - 1][k] = double(f2 - k) / (f2 - f1);
+    }
+    return bank;
+}
+
+// The Kotlin pipeline in double precision, with a direct DFT
+static void reference(const std::vector<float>& waveform, std::vector<double>& out) {
+    const int bins = kLogMelFftSize / 2 + 1;
+    const auto bank = denseFilterbank();
+    std::vector<double> cosTable(kLogMelFftSize), sinTable(kLogMelFftSize), frame(kLogMelFftSize), power(bins);
+    for (int i = 0; i < kLogMelFftSize; ++i) {
+        cosTable[i] = std::cos(2.0 * M_PI * i / kLogMelFftSize);
+        sinTable[i] = std::sin(2.0 * M_PI * i / kLogMelFftSize);
+    }
+    out.assign(kLogMelOutputSize, 0.0);
+    for (int t = 0; t < kLogMelFrames; ++t) {
+        for (int j = 0; j < kLogMelFftSize; ++j) {
+            const size_t index = static_cast<size_t>(t) * kLogMelHopSize + j;
+            const double x = index < waveform.size() ? waveform[index] : 0.0;
+            frame[j] = x * (0.54 - 0.46 * std::cos(2.0 * M_PI * j / kLogMelFftSize));
+        }
+        for (int k = 0; k < bins; ++k) {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < kLogMelFftSize; ++j) {
+                const int phase = (k * j) % kLogMelFftSize;
+                re += frame[j] * cosTable[phase];
+                im -= frame[j] * sinTable[phase];
+            }
+            power[k] = re * re + im * im;
+        }
+        for (int m = 0; m < kLogMelBands; ++m) {
+            double sum = 0.0;
+            for (int k = 0; k < bins; ++k) sum += power[k] * bank[m][k];
+            out[t * kLogMelBands + m] = std::log(sum + 1e-6);
+        }
+    }
+}
+
+// The Kotlin structure: everything rebuilt per call, dense filterbank
+static void perCallDense(const std::vector<float>& waveform, std::vector<float>& out) {
+    const int bins = kLogMelFftSize / 2 + 1;
+    std::vector<float> window(kLogMelFftSize);
+    for (int i = 0; i < kLogMelFftSize; ++i) {
+        window[i] = static_cast<float>(0.54 - 0.46 * std::cos(2.0 * M_PI * i / kLogMelFftSize));
+    }
+    RealFft fft;
+    fft.configure(kLogMelFftSize);
+    std::vector<std::vector<float>> spectrogram(kLogMelFrames, std::vector<float>(bins));
+    std::vector<float> frame(kLogMelFftSize), spectrum(2 * bins);
+    for (int t = 0; t < kLogMelFrames; ++t) {
+        for (int j = 0; j < kLogMelFftSize; ++j) {
+            const size_t index = static_cast<size_t>(t) * kLogMelHopSize + j;
+            frame[j] = (index < waveform.size() ? waveform[index] : 0.0f) * window[j];
+        }
+        fft.forward(frame.data(), spectrum.data());
+        for (int k = 0; k < bins; ++k) {
+            const float magnitude = std::sqrt(spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1]);
+            spectrogram[t][k] = magnitude * magnitude;
+        }
+    }
+    const auto bank = denseFilterbank();
+    out.assign(kLogMelOutputSize, 0.0f);
+    for (int t = 0; t < kLogMelFrames; ++t) {
+        for (int m = 0; m < kLogMelBands; ++m) {
+            float sum = 0.0f;
+            for (int k = 0; k < bins; ++k) sum += spectrogram[t][k] * static_cast<float>(bank[m][k]);
+            out[t * kLogMelBands + m] = std::log(sum + 1e-6f);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+    // One second of a voice-like signal plus noise, peak about 0.6
+    std::mt19937 rng(17);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<float> waveform(kLogMelSampleRate);
+    for (size_t i = 0; i < waveform.size(); ++i) {
+        const double t = static_cast<double>(i) / kLogMelSampleRate;
+        const double f0 = 140.0 + 30.0 * std::sin(2.0 * M_PI * 1.5 * t);
+        double sample = 0.0;
+        for (int h = 1; h <= 20; ++h) sample += std::sin(2.0 * M_PI * f0 * h * t) / h;
+        waveform[i] = static_cast<float>(0.3 * sample) + noise(rng);
+    }
+
+    LogMelExtractor extractor;
+    std::vector<float> out(kLogMelOutputSize), dense;
+    std::vector<double> expected;
+    extractor.compute(waveform.data(), static_cast<int>(waveform.size()), 1, false, 0, out.data());
+    reference(waveform, expected);
+    double worst = 0.0;
+    for (int i = 0; i < kLogMelOutputSize; ++i) worst = std::max(worst, std::fabs(out[i] - expected[i]));
+
+    // The AudioUtils steps: stereo in, peak-normalized, trimmed to 16000
+    std::vector<float> stereo(2 * waveform.size());
+    std::vector<float> prepared(kLogMelSampleRate, 0.0f);
+    float peak = 0.0f;
+    for (size_t i = 0; i < waveform.size(); ++i) {
+        stereo[2 * i] = waveform[i];
+        stereo[2 * i + 1] = 0.5f * waveform[i];
+        peak = std::max(peak, std::fabs((stereo[2 * i] + stereo[2 * i + 1]) / 2.0f));
+    }
+    for (size_t i = 0; i < prepared.size() && i < waveform.size(); ++i) {
+        prepared[i] = ((stereo[2 * i] + stereo[2 * i + 1]) / 2.0f) / peak;
+    }
+    extractor.compute(stereo.data(), static_cast<int>(waveform.size()), 2, true, kLogMelSampleRate, out.data());
+    reference(prepared, expected);
+    double worstPrepared = 0.0;
+    for (int i = 0; i < kLogMelOutputSize; ++i) worstPrepared = std::max(worstPrepared, std::fabs(out[i] - expected[i]));
+
+    volatile float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        perCallDense(waveform, dense);
+        sink = sink + dense[r % kLogMelOutputSize];
+    }
+    const double denseUs = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count() / repeats;
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        extractor.compute(waveform.data(), static_cast<int>(waveform.size()), 1, false, 0, out.data());
+        sink = sink + out[r % kLogMelOutputSize];
+    }
+    const double engineUs = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count() / repeats;
+
+    const bool ok = worst <= kTolerance && worstPrepared <= kTolerance;
+    std::printf("max |difference| vs double reference: %.2e (mono), %.2e (stereo, normalized, trimmed)\n",
+                worst, worstPrepared);
+    std::printf("per-call dense (Kotlin structure): %8.1f us\n", denseUs);
+    std::printf("cached sparse engine:              %8.1f us\n", engineUs);
+    std::printf("\n%s\n", ok ? "log-mel within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// Accuracy check and benchmark for LPC from the power spectrum.
+//
+// For each (frame size, order) the analyzer uses, synthesizes Hann-windowed
+// vowel frames and compares SpectralLpc (inverse FFT of the frame's power
+// spectrum) with the time-domain path Essentia's LPC takes (linear
+// autocorrelation over the frame, then the same Levinson-Durbin). Reports
+// the largest coefficient differences and the autocorrelation cost of each
+// path; the spectrum itself is shared with other features, so it is not
+// counted.
+//
+// Exits with status 1 if a reflection coefficient differs by more than
+// kTolerance.
+//
+// Usage: lpc_bench [frames=500] [repeats=20]
+
+#include "fft.h"
+#include "spectral_lpc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const double kTolerance = 1e-3;
+
+// Time-domain autocorrelation, as Essentia's LPC computes it
+static void autocorrelation(const float* x, int n, int lags, float* r) {
+    for (int lag = 0; lag < lags; ++lag) {
+        float sum = 0.0f;
+        for (int i = 0; i + lag < n; ++i) sum += x[i] * x[i + lag];
+        r[lag] = sum;
+    }
+}
+
+// Glottal pulse train through three formant resonators, plus a noise
+// floor like a phone microphone's (without one, orders above 20 are
+// numerically singular in float for either path)
+static void vowelFrame(std::mt19937& rng, int sampleRate, int n, std::vector<float>& out) {
+    std::uniform_real_distribution<float> f0Dist(90.0f, 300.0f);
+    std::uniform_real_distribution<float> shift(0.85f, 1.15f);
+    std::normal_distribution<float> noise(0.0f, 1e-3f);
+    const float f0 = f0Dist(rng);
+    const float formants[3] = {600.0f * shift(rng), 1500.0f * shift(rng), 2600.0f * shift(rng)};
+    const float bandwidths[3] = {80.0f, 110.0f, 160.0f};
+
+    out.assign(n, 0.0f);
+    double phase = 0.0;
+    for (int i = 0; i < n; ++i) {
+        phase += f0 / sampleRate;
+        if (phase >= 1.0) phase -= 1.0;
+        out[i] = phase < 0.05 ? 1.0f : 0.0f;
+    }
+    for (int f = 0; f < 3; ++f) {
+        const double r = std::exp(-M_PI * bandwidths[f] / sampleRate);
+        const double a1 = 2.0 * r * std::cos(2.0 * M_PI * formants[f] / sampleRate);
+        const double a2 = -r * r;
+        double y1 = 0.0, y2 = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double y = out[i] + a1 * y1 + a2 * y2;
+            y2 = y1;
+            y1 = y;
+            out[i] = static_cast<float>(y * (1.0 - r));
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        out[i] = (out[i] + noise(rng)) * (0.5f - 0.5f * std::cos(2.0f * static_cast<float>(M_PI) * i / n));
+    }
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    struct Config {
+        int sampleRate, frameSize;
+    } configs[] = {{44100, 1024}, {44100, 2048}, {11025, 256}, {10000, 640}, {16000, 1024}};
+
+    std::printf("%-14s %5s %12s %12s %14s %14s\n", "rate/frame", "order", "max d(lpc)", "max d(refl)",
+                "time-domain ns", "spectral ns");
+
+    bool ok = true;
+    std::mt19937 rng(11);
+    for (const Config& c : configs) {
+        const int n = c.frameSize;
+        const int order = 2 + c.sampleRate / 1000;
+        const int bins = n / 2 + 1;
+
+        // Frames and their magnitude spectra (what Spectrum hands the LPC stage)
+        RealFft fft;
+        fft.configure(n);
+        std::vector<std::vector<float>> signal(frames), magnitudes(frames, std::vector<float>(bins));
+        std::vector<float> complexSpectrum(2 * bins);
+        for (int f = 0; f < frames; ++f) {
+            vowelFrame(rng, c.sampleRate, n, signal[f]);
+            fft.forward(signal[f].data(), complexSpectrum.data());
+            for (int k = 0; k < bins; ++k) {
+                magnitudes[f][k] = std::hypot(complexSpectrum[2 * k], complexSpectrum[2 * k + 1]);
+            }
+        }
+
+        SpectralLpc spectral;
+        spectral.configure(n, order);
+        std::vector<float> r(order + 1), lpcA(order + 1), reflA(order), lpcB(order + 1), reflB(order);
+        double worstLpc = 0.0, worstRefl = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            autocorrelation(signal[f].data(), n, order + 1, r.data());
+            levinsonDurbin(r.data(), order, lpcA.data(), reflA.data());
+            spectral.compute(magnitudes[f].data(), lpcB.data(), reflB.data());
+            for (int i = 0; i <= order; ++i) {
+                worstLpc = std::max(worstLpc, static_cast<double>(std::fabs(lpcA[i] - lpcB[i])));
+            }
+            for (int i = 0; i < order; ++i) {
+                worstRefl = std::max(worstRefl, static_cast<double>(std::fabs(reflA[i] - reflB[i])));
+            }
+        }
+
+        volatile float sink = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < repeats; ++rep) {
+            for (int f = 0; f < frames; ++f) {
+                autocorrelation(signal[f].data(), n, order + 1, r.data());
+                levinsonDurbin(r.data(), order, lpcA.data(), reflA.data());
+                sink = sink + lpcA[order];
+            }
+        }
+        const double timeNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < repeats; ++rep) {
+            for (int f = 0; f < frames; ++f) {
+                spectral.compute(magnitudes[f].data(), lpcB.data(), reflB.data());
+                sink = sink + lpcB[order];
+            }
+        }
+        const double spectralNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        const bool pass = worstRefl <= kTolerance;
+        ok = ok && pass;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d/%d", c.sampleRate, n);
+        std::printf("%-14s %5d %12.2e %12.2e %14.0f %14.0f%s\n", name, order, worstLpc, worstRefl, timeNs,
+                    spectralNs, pass ? "" : "  FAIL");
+    }
+
+    std::printf("\n%s\n", ok ? "spectral LPC within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
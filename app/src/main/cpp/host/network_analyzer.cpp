@@ -0,0 +1,357 @@
+#include "network_analyzer.h"
+#include "pcm_convert.h"
+#include "simd_kernels.h"
+#include <android/log.h>
+#include <algorithm>
+#include <memory>
+
+// Include Essentia headers
+#include <essentia/essentia.h>
+#include <essentia/algorithmfactory.h>
+#include <essentia/scheduler/network.h>
+#include <essentia/streaming/algorithms/ringbufferinput.h>
+
+#define LOG_TAG "NetworkAnalyzer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+using namespace essentia;
+using namespace essentia::streaming;
+
+// RingBufferInput capacity. Each runStep() drains what the preceding add()
+// wrote, so it only needs to hold one feed block.
+static const int kRingCapacity = 8192;
+
+// int16 samples converted per block by pushPcm16
+static const int kPcmBlock = 1024;
+
+// MFCC mel bank upper edge, as EssentiaWrapper's, capped at Nyquist
+static const int kMfccHighFrequency = 11000;
+
+/**
+ * Subtracts each frame's mean, as EssentiaWrapper does before windowing.
+ * Writes into the output token in place, so its buffer is reused.
+ */
+class FrameDcRemover : public Algorithm {
+protected:
+    Sink<std::vector<Real>> frameIn;
+    Source<std::vector<Real>> frameOut;
+
+public:
+    FrameDcRemover() {
+        setName("FrameDcRemover");
+        declareInput(frameIn, 1, "frame", "the input frame");
+        declareOutput(frameOut, 1, "frame", "the frame minus its mean");
+    }
+
+    void declareParameters() {}
+
+    AlgorithmStatus process() {
+        AlgorithmStatus status = acquireData();
+        if (status != OK) {
+            return status;
+        }
+
+        const std::vector<Real>& frame = frameIn.firstToken();
+        std::vector<Real>& out = frameOut.firstToken();
+        const int n = static_cast<int>(frame.size());
+        out.resize(n);
+        if (n > 0) {
+            simdSubtract(frame.data(), simdSum(frame.data(), n) / n, out.data(), n);
+        }
+
+        releaseData();
+        return OK;
+    }
+};
+
+/**
+ * End of the network: takes one token from every branch per frame and
+ * hands them to NetworkAnalyzer::completeFrame
+ */
+class NetworkFrameCollector : public Algorithm {
+protected:
+    Sink<std::vector<Real>> frameIn;
+    Sink<std::vector<Real>> spectrumIn;
+    Sink<Real> pitchIn;
+    Sink<Real> confidenceIn;
+    Sink<std::vector<Real>> mfccIn;
+    Sink<std::vector<Real>> lpcIn;
+    NetworkAnalyzer& owner;
+    bool withMfcc;
+    bool withLpc;
+    std::vector<Real> none;     // Stands in for branches the network lacks
+
+public:
+    NetworkFrameCollector(NetworkAnalyzer& analyzer, bool mfcc, bool lpc)
+            : owner(analyzer)
+            , withMfcc(mfcc)
+            , withLpc(lpc) {
+        setName("NetworkFrameCollector");
+        declareInput(frameIn, 1, "frame", "the DC-removed frame");
+        declareInput(spectrumIn, 1, "spectrum", "its magnitude spectrum");
+        declareInput(pitchIn, 1, "pitch", "the PitchYinFFT estimate");
+        declareInput(confidenceIn, 1, "pitchConfidence", "the PitchYinFFT confidence");
+        if (withMfcc) declareInput(mfccIn, 1, "mfcc", "the MFCC coefficients");
+        if (withLpc) declareInput(lpcIn, 1, "lpc", "the LPC coefficients");
+    }
+
+    void declareParameters() {}
+
+    AlgorithmStatus process() {
+        AlgorithmStatus status = acquireData();
+        if (status != OK) {
+            return status;
+        }
+
+        owner.completeFrame(frameIn.firstToken(), spectrumIn.firstToken(), pitchIn.firstToken(),
+                            confidenceIn.firstToken(), withMfcc ? mfccIn.firstToken() : none,
+                            withLpc ? lpcIn.firstToken() : none);
+
+        releaseData();
+        return OK;
+    }
+};
+
+NetworkAnalyzer::NetworkAnalyzer()
+        : input(nullptr)
+        , readyCount(0)
+        , readIndex(0)
+        , sampleRate(0)
+        , frameSize(0)
+        , hopSize(0)
+        , feedBlock(0)
+        , samplesPushed(0)
+        , framesCompleted(0)
+        , steps(0)
+        , initialized(false) {
+}
+
+NetworkAnalyzer::~NetworkAnalyzer() {
+    cleanup();
+}
+
+bool NetworkAnalyzer::initialize(int sr, int fs, int hs, FeatureSet features, bool pitchTracking) {
+    if (initialized) {
+        LOGD("NetworkAnalyzer already initialized");
+        return true;
+    }
+
+    finisher.setPitchTracking(pitchTracking);
+    if (!finisher.initialize(sr, fs, hs, features)) {
+        LOGE("Failed to initialize frame finisher");
+        return false;
+    }
+    features = finisher.getFeatureSet();
+    const bool withMfcc = (features & kFeatureMfcc) != 0;
+    const bool withLpc = (features & kFeatureFormants) != 0;
+
+    try {
+        std::unique_lock<std::mutex> lock = EssentiaWrapper::lockFactory();
+        streaming::AlgorithmFactory& factory = streaming::AlgorithmFactory::instance();
+
+        // Held here until the network takes them over, so a failure while
+        // building deletes whatever was created
+        std::vector<std::unique_ptr<Algorithm>> created;
+        auto keep = [&created](Algorithm* algorithm) {
+            created.emplace_back(algorithm);
+            return algorithm;
+        };
+
+        RingBufferInput* ring = static_cast<RingBufferInput*>(keep(factory.create("RingBufferInput",
+                                                                                  "bufferSize", kRingCapacity)));
+        Algorithm* cutter = keep(factory.create("FrameCutter",
+                                                "frameSize", fs,
+                                                "hopSize", hs,
+                                                "startFromZero", true,
+                                                "silentFrames", "keep"));
+        Algorithm* dcRemover = keep(new FrameDcRemover());
+        Algorithm* window = keep(factory.create("Windowing",
+                                                "type", "hann"));
+        Algorithm* spectrum = keep(factory.create("Spectrum",
+                                                  "size", fs));
+        Algorithm* pitch = keep(factory.create("PitchYinFFT",
+                                               "frameSize", fs,
+                                               "sampleRate", sr));
+        Algorithm* collector = keep(new NetworkFrameCollector(*this, withMfcc, withLpc));
+
+        connect(ring->output("signal"), cutter->input("signal"));
+        connect(cutter->output("frame"), dcRemover->input("frame"));
+        connect(dcRemover->output("frame"), window->input("frame"));
+        connect(dcRemover->output("frame"), collector->input("frame"));
+        connect(window->output("frame"), spectrum->input("frame"));
+        connect(spectrum->output("spectrum"), pitch->input("spectrum"));
+        connect(spectrum->output("spectrum"), collector->input("spectrum"));
+        connect(pitch->output("pitch"), collector->input("pitch"));
+        connect(pitch->output("pitchConfidence"), collector->input("pitchConfidence"));
+
+        if (withMfcc) {
+            Algorithm* mfcc = keep(factory.create("MFCC",
+                                                  "inputSize", fs / 2 + 1,
+                                                  "sampleRate", sr,
+                                                  "highFrequencyBound", std::min(kMfccHighFrequency, sr / 2),
+                                                  "numberCoefficients", finisher.getMfccCount()));
+            connect(spectrum->output("spectrum"), mfcc->input("spectrum"));
+            connect(mfcc->output("mfcc"), collector->input("mfcc"));
+            connect(mfcc->output("bands"), NOWHERE);
+        }
+
+        if (withLpc) {
+            // Essentia's LPC correlates the windowed frame; the wrapper gets
+            // the same autocorrelation from the spectrum
+            Algorithm* lpc = keep(factory.create("LPC",
+                                                 "order", finisher.getMaxFormants(),
+                                                 "sampleRate", sr));
+            connect(window->output("frame"), lpc->input("frame"));
+            connect(lpc->output("lpc"), collector->input("lpc"));
+            connect(lpc->output("reflection"), NOWHERE);
+        }
+
+        // Built once everything is connected; from here the network owns
+        // every algorithm reachable from the ring, DevNulls included
+        network.reset(new scheduler::Network(ring));
+        for (std::unique_ptr<Algorithm>& algorithm : created) {
+            algorithm.release();
+        }
+        input = ring;
+
+        network->runPrepare();
+        feedBlock = std::max(1, std::min(input->output("signal").acquireSize(), kRingCapacity));
+
+    } catch (const EssentiaException& e) {
+        LOGE("Essentia exception while building the network: %s", e.what());
+        cleanup();
+        return false;
+    } catch (const std::exception& e) {
+        LOGE("Standard exception while building the network: %s", e.what());
+        cleanup();
+        return false;
+    }
+
+    sampleRate = sr;
+    frameSize = fs;
+    hopSize = hs;
+    pcmBlock.assign(kPcmBlock, 0.0f);
+    samplesPushed = 0;
+    framesCompleted = 0;
+    steps = 0;
+    readyCount = readIndex = 0;
+    initialized = true;
+
+    LOGI("Streaming network ready: sampleRate=%d, frameSize=%d, hopSize=%d, features=0x%x, %zu algorithms, "
+         "%d samples per step", sr, fs, hs, features, network->linearExecutionOrder().size(), feedBlock);
+    return true;
+}
+
+void NetworkAnalyzer::completeFrame(const std::vector<float>& frame, const std::vector<float>& spectrum, float pitch,
+                                    float pitchConfidence, const std::vector<float>& mfcc,
+                                    const std::vector<float>& lpcCoeffs) {
+    if (readyCount == ready.size()) {
+        ready.emplace_back();
+    }
+    StreamFrame& out = ready[readyCount++];
+    out.sampleIndex = framesCompleted * hopSize;
+    out.timestamp = static_cast<double>(out.sampleIndex) / sampleRate;
+    finisher.completeFrame(frame, spectrum, pitch, pitchConfidence, mfcc, lpcCoeffs, out.features);
+    ++framesCompleted;
+}
+
+void NetworkAnalyzer::push(const float* samples, int n) {
+    if (!initialized || samples == nullptr || n <= 0) {
+        return;
+    }
+
+    try {
+        // One input acquire per step. runStep() is only called after add(),
+        // as RingBufferInput blocks on an empty ring.
+        for (int offset = 0; offset < n; offset += feedBlock) {
+            const int count = std::min(feedBlock, n - offset);
+            // add() only reads, despite its non-const signature
+            input->add(const_cast<float*>(samples + offset), count);
+            network->runStep();
+            ++steps;
+        }
+    } catch (const EssentiaException& e) {
+        LOGE("Essentia exception while running the network: %s", e.what());
+    } catch (const std::exception& e) {
+        LOGE("Standard exception while running the network: %s", e.what());
+    }
+    samplesPushed += n;
+}
+
+void NetworkAnalyzer::pushPcm16(const int16_t* samples, int n) {
+    if (!initialized || samples == nullptr) {
+        return;
+    }
+    for (int offset = 0; offset < n; offset += kPcmBlock) {
+        const int count = std::min(kPcmBlock, n - offset);
+        convertPcm16ToFloat(samples + offset, pcmBlock.data(), count);
+        push(pcmBlock.data(), count);
+    }
+}
+
+bool NetworkAnalyzer::pull(StreamFrame& frame) {
+    if (readIndex == readyCount) {
+        return false;
+    }
+    StreamFrame& next = ready[readIndex++];
+    frame.sampleIndex = next.sampleIndex;
+    frame.timestamp = next.timestamp;
+    std::swap(frame.features, next.features);
+    if (readIndex == readyCount) {
+        readIndex = readyCount = 0;
+    }
+    return true;
+}
+
+void NetworkAnalyzer::reset() {
+    if (!initialized) {
+        return;
+    }
+    try {
+        network->reset();
+    } catch (const std::exception& e) {
+        LOGE("Exception while resetting the network: %s", e.what());
+    }
+    finisher.resetPitchTrack();
+    readyCount = readIndex = 0;
+    samplesPushed = 0;
+    framesCompleted = 0;
+}
+
+std::vector<AudioFeatures> NetworkAnalyzer::analyzeBuffer(const float* audioBuffer, int bufferLength) {
+    std::vector<AudioFeatures> results;
+
+    if (!initialized || audioBuffer == nullptr || bufferLength < frameSize) {
+        LOGE("Invalid parameters for network buffer analysis");
+        return results;
+    }
+
+    reset();
+    results.reserve((bufferLength - frameSize) / hopSize + 1);
+
+    // Pull as we go so the ready queue stays short
+    StreamFrame frame;
+    for (int offset = 0; offset < bufferLength; offset += hopSize) {
+        push(audioBuffer + offset, std::min(hopSize, bufferLength - offset));
+        while (pull(frame)) {
+            if (frame.features.isValid) results.push_back(frame.features);
+        }
+    }
+
+    LOGD("Network buffer analysis complete: %zu frames processed", results.size());
+    return results;
+}
+
+void NetworkAnalyzer::cleanup() {
+    if (initialized) {
+        LOGI("Deleting streaming network after %lld steps", static_cast<long long>(steps));
+    }
+    network.reset();
+    input = nullptr;
+    finisher.cleanup();
+    ready.clear();
+    readyCount = readIndex = 0;
+    initialized = false;
+}
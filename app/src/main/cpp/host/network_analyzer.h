@@ -0,0 +1,143 @@
+#ifndef NETWORK_ANALYZER_H
+#define NETWORK_ANALYZER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "essentia_wrapper.h"
+#include "streaming_analyzer.h"
+
+// Forward declarations for Essentia's streaming classes
+namespace essentia {
+    namespace scheduler {
+        class Network;
+    }
+    namespace streaming {
+        class RingBufferInput;
+    }
+}
+
+class NetworkFrameCollector;
+
+/**
+ * Experimental analysis backend on Essentia's streaming mode, built only
+ * into network_bench on the host. It is not part of the app and is not
+ * selectable through analyzer_api: every frame runs the whole graph before
+ * the energy gate can reject it, so it does more work than EssentiaWrapper
+ * on the silence that dominates a monitoring session. The voice
+ * feature graph is built once as a scheduler::Network:
+ *
+ *   RingBufferInput -> FrameCutter -> DC removal -> Windowing(hann) -> Spectrum
+ *     -> PitchYinFFT
+ *     -> MFCC                       (kFeatureMfcc)
+ *   Windowing -> LPC                (kFeatureFormants)
+ *   all of the above -> collector
+ *
+ * push() writes samples into the RingBufferInput and calls runStep(), so
+ * frames are cut and analyzed incrementally as audio arrives, in the
+ * network's own preallocated buffers. The collector at the end finishes
+ * each frame on an EssentiaWrapper (energy gate, voicing, spectral
+ * moments, HNR, formants) and queues it for pull().
+ *
+ * Same frames and timestamps as a StreamingAnalyzer over an EssentiaWrapper
+ * with the same configuration; features agree up to the FFT and LPC
+ * implementations. Pitch is always YinFFT and HNR always the harmonic
+ * model. Unlike the wrapper, every frame runs the whole graph, silent ones
+ * included, since the energy gate can only be applied at the end. Not
+ * thread-safe.
+ */
+class NetworkAnalyzer {
+private:
+    EssentiaWrapper finisher;       // Completes frames; also holds the Essentia reference
+    std::unique_ptr<essentia::scheduler::Network> network;
+    essentia::streaming::RingBufferInput* input;    // Owned by network
+    std::vector<float> pcmBlock;    // int16 input converted to float
+
+    // Frames completed by the collector. Slots are reused from the front
+    // once all have been pulled, so their feature vectors keep capacity.
+    std::vector<StreamFrame> ready;
+    size_t readyCount;
+    size_t readIndex;
+
+    int sampleRate;
+    int frameSize;
+    int hopSize;
+    int feedBlock;          // Samples per runStep(): the input's acquire size
+    int64_t samplesPushed;
+    int64_t framesCompleted;
+    int64_t steps;
+    bool initialized;
+
+    friend class NetworkFrameCollector;
+    void completeFrame(const std::vector<float>& frame, const std::vector<float>& spectrum, float pitch,
+                       float pitchConfidence, const std::vector<float>& mfcc, const std::vector<float>& lpcCoeffs);
+
+public:
+    NetworkAnalyzer();
+    ~NetworkAnalyzer();
+
+    /**
+     * Build and prepare the network
+     */
+    bool initialize(int sampleRate = 44100, int frameSize = 1024, int hopSize = 512,
+                    FeatureSet features = kFeatureAll, bool pitchTracking = false);
+
+    /**
+     * Append n samples and run the network over them. Every frame they
+     * complete is analyzed before this returns and waits for pull().
+     */
+    void push(const float* samples, int n);
+
+    /**
+     * Append n int16 PCM samples, converting to float on the way in
+     */
+    void pushPcm16(const int16_t* samples, int n);
+
+    /**
+     * Take the next analyzed frame, valid or not.
+     * Returns false when none is waiting.
+     */
+    bool pull(StreamFrame& frame);
+
+    /**
+     * Number of frames pull() can currently return
+     */
+    int available() const { return static_cast<int>(readyCount - readIndex); }
+
+    /**
+     * Discard buffered audio and queued frames, forget the pitch track and
+     * restart timestamps at zero
+     */
+    void reset();
+
+    /**
+     * Analyze a buffer as one stream from a reset network. Same contract
+     * as EssentiaWrapper::analyzeBuffer at the configured hop: valid frames
+     * only, in order.
+     */
+    std::vector<AudioFeatures> analyzeBuffer(const float* audioBuffer, int bufferLength);
+
+    /**
+     * Delete the network and release Essentia
+     */
+    void cleanup();
+
+    bool isReady() const { return initialized; }
+
+    int getSampleRate() const { return sampleRate; }
+    int getFrameSize() const { return frameSize; }
+    int getHopSize() const { return hopSize; }
+
+    /**
+     * Total samples pushed since initialize() or the last reset()
+     */
+    int64_t getSamplesPushed() const { return samplesPushed; }
+
+    /**
+     * runStep() calls since initialize()
+     */
+    int64_t getSteps() const { return steps; }
+};
+
+#endif // NETWORK_ANALYZER_H
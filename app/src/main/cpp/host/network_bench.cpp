@@ -0,0 +1,210 @@
+// Essentia streaming network vs the standard-mode analyzer.
+//
+// Analyzes the same audio with EssentiaWrapper (standard algorithms, one
+// frame at a time) and with NetworkAnalyzer (a scheduler::Network fed
+// through RingBufferInput), first as whole buffers for sustained
+// frames/sec, then incrementally in capture-sized blocks through
+// StreamingAnalyzer and NetworkAnalyzer::push for the cost of each block.
+// The incremental runs are compared frame by frame: voicing, pitch, MFCC
+// and first formant.
+//
+// Exits with status 1 if the frame grids differ, or if voicing or pitch
+// (within 1%) disagree on more than 1% of frames. MFCC and formant
+// differences are reported only, as the two backends use different FFT
+// and LPC implementations.
+//
+// NetworkAnalyzer lives here with the bench; the app analyzes through
+// EssentiaWrapper only.
+//
+// Usage: network_bench [--input=path.wav|.s16|.f32] [--seconds=30]
+//                      [--sample-rate=16000] [--frame-size=1024] [--hop=256]
+//                      [--block=160] [--repeats=3] [--pitch-tracking=0|1]
+
+#include "essentia_wrapper.h"
+#include "host_audio.h"
+#include "network_analyzer.h"
+#include "streaming_analyzer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Options {
+    std::string input;
+    double seconds = 30.0;
+    int sampleRate = 16000;
+    int frameSize = 1024;
+    int hopSize = 256;
+    int blockSize = 160;
+    int repeats = 3;
+    bool pitchTracking = false;
+};
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        const std::string key = eq ? std::string(arg, eq - arg) : std::string(arg);
+        const std::string value = eq ? std::string(eq + 1) : std::string();
+
+        if (key == "--input") opt.input = value;
+        else if (key == "--seconds") opt.seconds = std::atof(value.c_str());
+        else if (key == "--sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "--frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "--hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "--block") opt.blockSize = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--repeats") opt.repeats = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--pitch-tracking") opt.pitchTracking = std::atoi(value.c_str()) != 0;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Per-block cost of one incremental run
+ */
+struct BlockTiming {
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    int blocks = 0;
+
+    void add(double ms) {
+        totalMs += ms;
+        maxMs = std::max(maxMs, ms);
+        ++blocks;
+    }
+};
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    HostAudio audio;
+    if (opt.input.empty()) {
+        audio = synthesizeVoice(opt.sampleRate, opt.seconds);
+    } else {
+        std::string error;
+        if (!loadAudio(opt.input, opt.sampleRate, audio, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+    const int length = static_cast<int>(audio.samples.size());
+    if (length < opt.frameSize) {
+        std::fprintf(stderr, "input shorter than one frame\n");
+        return 1;
+    }
+    const int frames = (length - opt.frameSize) / opt.hopSize + 1;
+
+    EssentiaWrapper standard;
+    standard.setPitchTracking(opt.pitchTracking);
+    NetworkAnalyzer network;
+    if (!standard.initialize(audio.sampleRate, opt.frameSize, opt.hopSize)
+        || !network.initialize(audio.sampleRate, opt.frameSize, opt.hopSize, kFeatureAll, opt.pitchTracking)) {
+        std::fprintf(stderr, "failed to initialize analyzers\n");
+        return 1;
+    }
+
+    // Sustained throughput, best of repeats
+    size_t standardValid = 0, networkValid = 0;
+    double standardMs = 1e30, networkMs = 1e30;
+    for (int r = 0; r < opt.repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        standardValid = standard.analyzeBuffer(audio.samples.data(), length, opt.hopSize).size();
+        standardMs = std::min(standardMs, elapsedMs(start));
+
+        start = std::chrono::steady_clock::now();
+        networkValid = network.analyzeBuffer(audio.samples.data(), length).size();
+        networkMs = std::min(networkMs, elapsedMs(start));
+    }
+
+    // Incremental: the same capture-sized blocks into both, every frame
+    // pulled as soon as it is complete
+    std::vector<StreamFrame> standardFrames, networkFrames;
+    standardFrames.reserve(frames);
+    networkFrames.reserve(frames);
+    BlockTiming standardBlocks, networkBlocks;
+    StreamFrame frame;
+
+    standard.resetPitchTrack();
+    StreamingAnalyzer session(standard, opt.frameSize + 2 * std::max(opt.blockSize, opt.hopSize));
+    network.reset();
+    for (int offset = 0; offset < length; offset += opt.blockSize) {
+        const float* block = audio.samples.data() + offset;
+        const int count = std::min(opt.blockSize, length - offset);
+
+        auto start = std::chrono::steady_clock::now();
+        session.push(block, count);
+        while (session.pull(frame)) standardFrames.push_back(frame);
+        standardBlocks.add(elapsedMs(start));
+
+        start = std::chrono::steady_clock::now();
+        network.push(block, count);
+        while (network.pull(frame)) networkFrames.push_back(frame);
+        networkBlocks.add(elapsedMs(start));
+    }
+
+    // Frame by frame agreement
+    const bool sameGrid = standardFrames.size() == networkFrames.size();
+    int voicingMismatches = 0, pitchMismatches = 0, bothVoiced = 0;
+    float maxMfccDiff = 0.0f;
+    std::vector<float> f1Diffs;
+    for (size_t i = 0; i < std::min(standardFrames.size(), networkFrames.size()); ++i) {
+        const AudioFeatures& a = standardFrames[i].features;
+        const AudioFeatures& b = networkFrames[i].features;
+        if (standardFrames[i].sampleIndex != networkFrames[i].sampleIndex || a.isValid != b.isValid) {
+            ++voicingMismatches;
+            continue;
+        }
+        if (!a.isValid) continue;
+
+        ++bothVoiced;
+        pitchMismatches += std::fabs(a.pitch - b.pitch) > 0.01f * a.pitch;
+        for (size_t k = 0; k < std::min(a.mfcc.size(), b.mfcc.size()); ++k) {
+            maxMfccDiff = std::max(maxMfccDiff, std::fabs(a.mfcc[k] - b.mfcc[k]));
+        }
+        if (!a.formants.empty() && !b.formants.empty()) {
+            f1Diffs.push_back(std::fabs(a.formants[0] - b.formants[0]));
+        }
+    }
+    float medianF1Diff = 0.0f;
+    if (!f1Diffs.empty()) {
+        std::nth_element(f1Diffs.begin(), f1Diffs.begin() + f1Diffs.size() / 2, f1Diffs.end());
+        medianF1Diff = f1Diffs[f1Diffs.size() / 2];
+    }
+
+    std::printf("%d frames of %d at %d Hz, hop %d, %d-sample blocks, pitch tracking %s\n",
+                frames, opt.frameSize, audio.sampleRate, opt.hopSize, opt.blockSize,
+                opt.pitchTracking ? "on" : "off");
+    std::printf("%-10s %12s %14s %8s %14s %14s\n", "", "buffer ms", "frames/sec", "valid", "block mean ms",
+                "block max ms");
+    std::printf("%-10s %12.1f %14.0f %8zu %14.4f %14.3f\n", "standard", standardMs, 1e3 * frames / standardMs,
+                standardValid, standardBlocks.totalMs / standardBlocks.blocks, standardBlocks.maxMs);
+    std::printf("%-10s %12.1f %14.0f %8zu %14.4f %14.3f\n", "network", networkMs, 1e3 * frames / networkMs,
+                networkValid, networkBlocks.totalMs / networkBlocks.blocks, networkBlocks.maxMs);
+    std::printf("network/standard time %.2fx, %lld runStep calls\n", networkMs / standardMs,
+                static_cast<long long>(network.getSteps()));
+    std::printf("incremental frames: %zu standard, %zu network\n", standardFrames.size(), networkFrames.size());
+    std::printf("voicing differs on %d frames; of %d voiced in both, pitch differs by >1%% on %d\n",
+                voicingMismatches, bothVoiced, pitchMismatches);
+    std::printf("max MFCC difference %.4f, median F1 difference %.1f Hz\n", maxMfccDiff, medianF1Diff);
+
+    const int tolerance = static_cast<int>(0.01 * standardFrames.size());
+    const bool ok = sameGrid && voicingMismatches <= tolerance && pitchMismatches <= tolerance;
+    std::printf("\n%s\n", ok ? "network features agree" : "FAILED");
+    return ok ? 0 : 1;
+}
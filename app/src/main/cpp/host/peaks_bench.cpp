@@ -0,0 +1,220 @@
+// Accuracy check and benchmark for the band-limited spectral peak picker.
+//
+// Synthesizes voiced frames (harmonics of a random f0 over a white noise
+// floor, enough for more than 100 local maxima at full band), takes their
+// Hann magnitude spectra and checks:
+//   - the local-maximum kernel of every compiled-in instruction set
+//     against the scalar one (identical bin lists)
+//   - SpectralPeakPicker over 40 Hz..Nyquist against SpectralPeaks as the
+//     analyzer configured it, re-implemented here (every local maximum,
+//     interpolated, the 100 loudest kept with partial_sort and sorted by
+//     frequency): identical peak lists
+//   - HNR from the picked list with matchHarmonicPeaks against the same
+//     list matched as in hnr_bench
+// and reports the cost per frame of the reference, the picker at full band
+// and the picker on the band the analyzer asks for (up to just above the
+// 20th harmonic).
+//
+// Exits with status 1 if any list differs.
+//
+// Usage: peaks_bench [frames=500] [repeats=20]
+
+#include "harmonic_model.h"
+#include "simd_kernels.h"
+#include "spectral_peaks.h"
+#include "stft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const float kMinHz = 40.0f;
+static const float kThreshold = 1e-5f;
+
+struct Peak {
+    float frequency;
+    float magnitude;
+};
+
+// SpectralPeaks with the analyzer's settings: full scan, partial_sort, sort
+static void referencePeaks(const std::vector<float>& spectrum, float binHz, std::vector<Peak>& peaks) {
+    const int size = static_cast<int>(spectrum.size());
+    peaks.clear();
+    for (int k = std::max(1, static_cast<int>(std::floor(kMinHz / binHz - 0.5f))); k < size - 1; ++k) {
+        const float left = spectrum[k - 1], middle = spectrum[k], right = spectrum[k + 1];
+        if (middle <= kThreshold || middle <= left || middle < right) continue;
+        const float curvature = left - 2.0f * middle + right;
+        const float offset = curvature != 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+        const float frequency = (k + offset) * binHz;
+        if (frequency < kMinHz) continue;
+        peaks.push_back({frequency, middle - 0.25f * (left - right) * offset});
+    }
+    const size_t wanted = std::min<size_t>(kMaxSpectralPeaks, peaks.size());
+    std::partial_sort(peaks.begin(), peaks.begin() + wanted, peaks.end(),
+                      [](const Peak& a, const Peak& b) { return a.magnitude > b.magnitude; });
+    peaks.resize(wanted);
+    std::sort(peaks.begin(), peaks.end(), [](const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+}
+
+// HarmonicPeaks on the reference list
+static float referenceHnr(const std::vector<Peak>& peaks, float f0, float total) {
+    int best[kMaxHarmonics];
+    float bestDistance[kMaxHarmonics];
+    std::fill(best, best + kMaxHarmonics, -1);
+    for (size_t i = 0; i < peaks.size(); ++i) {
+        const float ratio = peaks[i].frequency / f0;
+        const int h = static_cast<int>(std::lround(ratio));
+        const float distance = std::fabs(ratio - h);
+        if (h < 1 || h > kMaxHarmonics || distance > 0.2f) continue;
+        if (best[h - 1] < 0 || distance < bestDistance[h - 1]) {
+            best[h - 1] = static_cast<int>(i);
+            bestDistance[h - 1] = distance;
+        }
+    }
+    float harmonic = 0.0f;
+    for (int h = 0; h < kMaxHarmonics; ++h) {
+        if (best[h] >= 0) harmonic += peaks[best[h]].magnitude * peaks[best[h]].magnitude;
+    }
+    const HarmonicModel model = {harmonic, total - harmonic, 0};
+    return harmonicToNoiseDb(model);
+}
+
+static bool samePeaks(const std::vector<Peak>& expected, const SpectralPeakList& actual) {
+    if (static_cast<int>(expected.size()) != actual.count) return false;
+    for (int i = 0; i < actual.count; ++i) {
+        if (expected[i].frequency != actual.frequencies[i] || expected[i].magnitude != actual.magnitudes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    struct Config {
+        int sampleRate, frameSize;
+    } configs[] = {{10000, 640}, {11025, 256}, {44100, 1024}, {44100, 2048}};
+
+    const SimdKernels* scalar = simdKernelsForIsa("scalar");
+    std::vector<const SimdKernels*> sets;
+    for (const char* isa : {"scalar", "sse2", "avx2", "neon"}) {
+        if (const SimdKernels* k = simdKernelsForIsa(isa)) sets.push_back(k);
+    }
+
+    std::printf("%-12s %8s %10s %8s %12s %12s %12s\n", "rate/frame", "maxima", "mismatch", "dHNR",
+                "ref ns", "full ns", "band ns");
+
+    bool ok = true;
+    std::mt19937 rng(20);
+    for (const Config& c : configs) {
+        const int n = c.frameSize;
+        const int bins = n / 2 + 1;
+        const float binHz = static_cast<float>(c.sampleRate) / n;
+        const float nyquist = 0.5f * c.sampleRate;
+        std::uniform_real_distribution<float> f0Dist(90.0f, 300.0f);
+        std::uniform_real_distribution<float> noiseDb(-40.0f, -10.0f);
+
+        StftFrontEnd stft;
+        stft.configure(n);
+        std::vector<std::vector<float>> spectra(frames, std::vector<float>(bins));
+        std::vector<float> f0s(frames), totals(frames), frame(n);
+        for (int f = 0; f < frames; ++f) {
+            f0s[f] = f0Dist(rng);
+            std::normal_distribution<float> noise(0.0f, 0.3f * std::pow(10.0f, noiseDb(rng) / 20.0f));
+            for (int i = 0; i < n; ++i) {
+                double sample = 0.0;
+                for (int h = 1; h * f0s[f] < nyquist; ++h) {
+                    sample += std::sin(2.0 * M_PI * f0s[f] * h * i / c.sampleRate + h) / h;
+                }
+                frame[i] = static_cast<float>(0.3 * sample) + noise(rng);
+            }
+            stft.transform(frame.data());
+            stft.hannMagnitude(spectra[f].data());
+            totals[f] = 0.0f;
+            for (float m : spectra[f]) totals[f] += m * m;
+        }
+
+        // Kernel: every ISA must find the same bins as the scalar loop
+        std::vector<int> expectedBins(bins), actualBins(bins);
+        int mismatches = 0;
+        double meanMaxima = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            const int expected = scalar->localMaxima(spectra[f].data(), 1, bins - 1, kThreshold, expectedBins.data());
+            meanMaxima += static_cast<double>(expected) / frames;
+            for (const SimdKernels* k : sets) {
+                const int actual = k->localMaxima(spectra[f].data(), 1, bins - 1, kThreshold, actualBins.data());
+                if (actual != expected || !std::equal(expectedBins.begin(), expectedBins.begin() + expected,
+                                                      actualBins.begin())) {
+                    std::printf("  %s local maxima differ in frame %d\n", k->isa, f);
+                    ++mismatches;
+                }
+            }
+        }
+
+        // Picker at full band vs the reference, and HNR from both lists
+        SpectralPeakPicker picker;
+        picker.configure(bins, binHz, kThreshold);
+        SpectralPeakList list;
+        std::vector<Peak> peaks;
+        peaks.reserve(bins);
+        HarmonicModel model;
+        double worstHnr = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            referencePeaks(spectra[f], binHz, peaks);
+            picker.pick(spectra[f].data(), kMinHz, nyquist, list);
+            if (!samePeaks(peaks, list)) ++mismatches;
+            matchHarmonicPeaks(list, f0s[f], totals[f], nullptr, nullptr, model);
+            worstHnr = std::max(worstHnr, static_cast<double>(
+                    std::fabs(harmonicToNoiseDb(model) - referenceHnr(peaks, f0s[f], totals[f]))));
+        }
+
+        volatile float sink = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (int f = 0; f < frames; ++f) {
+                referencePeaks(spectra[f], binHz, peaks);
+                sink = sink + static_cast<float>(peaks.size());
+            }
+        }
+        const double referenceNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (int f = 0; f < frames; ++f) {
+                picker.pick(spectra[f].data(), kMinHz, nyquist, list);
+                sink = sink + static_cast<float>(list.count);
+            }
+        }
+        const double fullNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (int f = 0; f < frames; ++f) {
+                picker.pick(spectra[f].data(), kMinHz, std::min(nyquist, (kMaxHarmonics + 0.5f) * f0s[f]), list);
+                sink = sink + static_cast<float>(list.count);
+            }
+        }
+        const double bandNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+        const bool pass = mismatches == 0 && worstHnr == 0.0;
+        ok = ok && pass;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d/%d", c.sampleRate, n);
+        std::printf("%-12s %8.1f %10d %8.1e %12.0f %12.0f %12.0f%s\n", name, meanMaxima, mismatches, worstHnr,
+                    referenceNs, fullNs, bandNs, pass ? "" : "  FAIL");
+    }
+
+    std::printf("\nlocal-maximum kernels:");
+    for (const SimdKernels* k : sets) std::printf(" %s", k->isa);
+    std::printf("\n%s\n", ok ? "spectral peaks match" : "FAILED");
+    return ok ? 0 : 1;
+}
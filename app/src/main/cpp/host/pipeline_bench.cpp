@@ -0,0 +1,160 @@
+// Pipelined analysis vs the serial analyzer.
+//
+// Analyzes the same audio with EssentiaWrapper::analyzeBuffer and with
+// PipelinedAnalyzer::analyzeBuffer, checks that both return the same
+// frames with the same features, and reports sustained frames/sec for each.
+// Then submits frames one at a time and waits for each result, to show the
+// per-frame latency of an idle pipeline against one serial analyzeFrame.
+//
+// The synthetic input is silenced for 0.4 s out of every 1.5 s unless
+// --pauses=0, so frames below the energy gate, and the pitch-track resets
+// they cause, pass through the pipeline between voiced ones.
+//
+// Exits with status 1 if any frame's features differ.
+//
+// Usage: pipeline_bench [--input=path.wav|.s16|.f32] [--seconds=30]
+//                       [--sample-rate=16000] [--frame-size=1024] [--hop=256]
+//                       [--repeats=3] [--pitch-tracking=0|1] [--pauses=0|1]
+
+#include "essentia_wrapper.h"
+#include "host_audio.h"
+#include "pipelined_analyzer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Options {
+    std::string input;
+    double seconds = 30.0;
+    int sampleRate = 16000;
+    int frameSize = 1024;
+    int hopSize = 256;
+    int repeats = 3;
+    bool pitchTracking = false;
+    bool pauses = true;
+};
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        const std::string key = eq ? std::string(arg, eq - arg) : std::string(arg);
+        const std::string value = eq ? std::string(eq + 1) : std::string();
+
+        if (key == "--input") opt.input = value;
+        else if (key == "--seconds") opt.seconds = std::atof(value.c_str());
+        else if (key == "--sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "--frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "--hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "--repeats") opt.repeats = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--pitch-tracking") opt.pitchTracking = std::atoi(value.c_str()) != 0;
+        else if (key == "--pauses") opt.pauses = std::atoi(value.c_str()) != 0;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sameFeatures(const AudioFeatures& a, const AudioFeatures& b) {
+    return a.pitch == b.pitch && a.centroid == b.centroid && a.brightness == b.brightness
+           && a.resonance == b.resonance && a.hnr == b.hnr && a.mfcc == b.mfcc
+           && a.formants == b.formants && a.formantBandwidths == b.formantBandwidths;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    HostAudio audio;
+    if (opt.input.empty()) {
+        audio = synthesizeVoice(opt.sampleRate, opt.seconds);
+        if (opt.pauses) insertPauses(audio, 1.5, 0.4);
+    } else {
+        std::string error;
+        if (!loadAudio(opt.input, opt.sampleRate, audio, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+    const int length = static_cast<int>(audio.samples.size());
+    if (length < opt.frameSize) {
+        std::fprintf(stderr, "input shorter than one frame\n");
+        return 1;
+    }
+    const int frames = (length - opt.frameSize) / opt.hopSize + 1;
+
+    EssentiaWrapper serial;
+    serial.setPitchTracking(opt.pitchTracking);
+    PipelinedAnalyzer pipeline;
+    if (!serial.initialize(audio.sampleRate, opt.frameSize, opt.hopSize)
+        || !pipeline.initialize(audio.sampleRate, opt.frameSize, opt.hopSize, kFeatureAll, kPitchYinFft,
+                                opt.pitchTracking)) {
+        std::fprintf(stderr, "failed to initialize analyzers\n");
+        return 1;
+    }
+
+    // Sustained throughput, best of repeats
+    std::vector<AudioFeatures> serialResults, pipelinedResults;
+    double serialMs = 1e30, pipelinedMs = 1e30;
+    for (int r = 0; r < opt.repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        serialResults = serial.analyzeBuffer(audio.samples.data(), length, opt.hopSize);
+        serialMs = std::min(serialMs, elapsedMs(start));
+
+        start = std::chrono::steady_clock::now();
+        pipelinedResults = pipeline.analyzeBuffer(audio.samples.data(), length, opt.hopSize);
+        pipelinedMs = std::min(pipelinedMs, elapsedMs(start));
+    }
+
+    int mismatches = static_cast<int>(std::max(serialResults.size(), pipelinedResults.size())
+                                       - std::min(serialResults.size(), pipelinedResults.size()));
+    for (size_t i = 0; i < std::min(serialResults.size(), pipelinedResults.size()); ++i) {
+        mismatches += !sameFeatures(serialResults[i], pipelinedResults[i]);
+    }
+
+    // Latency of one frame through an idle pipeline vs one serial frame
+    const int latencyFrames = std::min(frames, 500);
+    AudioFeatures features;
+    bool valid = false;
+    double serialFrameMs = 0.0, pipelinedFrameMs = 0.0;
+    serial.resetPitchTrack();
+    pipeline.restartStream();
+    for (int i = 0; i < latencyFrames; ++i) {
+        const float* frame = audio.samples.data() + static_cast<size_t>(i) * opt.hopSize;
+        auto start = std::chrono::steady_clock::now();
+        serial.analyzeFrame(frame, opt.frameSize, features);
+        serialFrameMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        pipeline.submit(frame);
+        pipeline.receive(features, valid);
+        pipelinedFrameMs += elapsedMs(start);
+    }
+
+    std::printf("%d frames of %d at %d Hz, hop %d, %zu valid, pitch tracking %s\n",
+                frames, opt.frameSize, audio.sampleRate, opt.hopSize, serialResults.size(),
+                opt.pitchTracking ? "on" : "off");
+    std::printf("%-10s %12s %14s %16s\n", "", "buffer ms", "frames/sec", "idle frame ms");
+    std::printf("%-10s %12.1f %14.0f %16.3f\n", "serial", serialMs, 1e3 * frames / serialMs,
+                serialFrameMs / latencyFrames);
+    std::printf("%-10s %12.1f %14.0f %16.3f\n", "pipelined", pipelinedMs, 1e3 * frames / pipelinedMs,
+                pipelinedFrameMs / latencyFrames);
+    std::printf("speedup %.2fx, %d of %zu frames differ\n", serialMs / pipelinedMs, mismatches,
+                serialResults.size());
+
+    std::printf("\n%s\n", mismatches == 0 ? "pipelined features identical" : "FAILED");
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+// Benchmark and accuracy comparison for PitchTracker.
+//
+// Synthesizes a voice with a known f0 track (glide with vibrato, a weak
+// fundamental so the octave below/above is ambiguous, noise and unvoiced
+// gaps) and estimates pitch per frame with:
+//   - a full-range NSDF search every frame (McLeod peak picking), which is
+//     what the tracker falls back to when it loses the track
+//   - PitchTracker, seeded by the full-range search only when the track is
+//     lost or weak
+//
+// Reports ns/frame, lags evaluated per frame, gross errors (> 20% from the
+// true f0 on voiced frames) and octave jumps between consecutive frames.
+// Then checks reset(): a tracker reset after one stream must follow a
+// second, discontinuous stream exactly as a new tracker does.
+//
+// Exits with status 1 if the tracker detects fewer voiced frames than the
+// full-range search, has more than kMaxGrossFraction gross errors, jumps
+// octaves more often than the full-range search plus that fraction, or
+// carries state across reset().
+//
+// Usage: pitch_bench [sampleRate=44100] [seconds=10] [repeats=3]
+
+#include "pitch_tracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const int kFrameSize = 1024;
+static const int kHopSize = 512;
+static const float kMinHz = 50.0f;
+static const float kMaxHz = 1000.0f;
+// Share of voiced frames allowed to be gross errors (and extra octave jumps)
+static const double kMaxGrossFraction = 0.01;
+
+struct Signal {
+    std::vector<float> samples;
+    std::vector<float> f0;      // True f0 per sample, 0 when unvoiced
+};
+
+static Signal synthesize(int sampleRate, double seconds) {
+    Signal s;
+    const size_t n = static_cast<size_t>(seconds * sampleRate);
+    s.samples.resize(n);
+    s.f0.resize(n);
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.02);
+
+    double phase = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i) / sampleRate;
+        // 0.25 s of silence-like noise every 1.5 s
+        const bool voiced = std::fmod(t, 1.5) < 1.25;
+        const double f0 = 100.0 + 150.0 * (0.5 - 0.5 * std::cos(2.0 * M_PI * t / seconds))
+                + 3.0 * std::sin(2.0 * M_PI * 5.0 * t);
+        phase += 2.0 * M_PI * f0 / sampleRate;
+
+        double v = 0.0;
+        if (voiced) {
+            for (int h = 1; h <= 12; ++h) {
+                if (h * f0 >= sampleRate / 2.0) break;
+                // Second harmonic dominates the fundamental
+                const double amp = (h == 1 ? 0.3 : h == 2 ? 1.0 : 0.8 / h);
+                v += amp * std::sin(h * phase);
+            }
+        }
+        s.samples[i] = static_cast<float>(0.15 * v + noise(rng));
+        s.f0[i] = voiced ? static_cast<float>(f0) : 0.0f;
+    }
+    return s;
+}
+
+// Full-range per-frame estimate: NSDF over every lag, first peak within
+// 90% of the highest one (McLeod & Wyvill). Returns 0 below clarity 0.5.
+struct FullSearch {
+    int sampleRate;
+    int minLag;
+    int maxLag;
+    std::vector<float> nsdf;
+    std::vector<double> energy;
+
+    FullSearch(int sr) : sampleRate(sr) {
+        minLag = static_cast<int>(sr / kMaxHz);
+        maxLag = std::min(kFrameSize / 2, static_cast<int>(std::ceil(sr / kMinHz)));
+        nsdf.assign(maxLag + 2, 0.0f);
+    }
+
+    float estimate(const float* x, int& lags) {
+        // Same inner loop as the tracker: energies from a running sum, four
+        // accumulators for the cross term
+        std::vector<double>& e = energy;
+        e.assign(kFrameSize + 1, 0.0);
+        for (int i = 0; i < kFrameSize; ++i) e[i + 1] = e[i] + static_cast<double>(x[i]) * x[i];
+
+        for (int lag = minLag; lag <= maxLag + 1; ++lag) {
+            const int n = kFrameSize - lag;
+            float r0 = 0.0f, r1 = 0.0f, r2 = 0.0f, r3 = 0.0f;
+            int i = 0;
+            for (; i + 4 <= n; i += 4) {
+                r0 += x[i] * x[i + lag];
+                r1 += x[i + 1] * x[i + 1 + lag];
+                r2 += x[i + 2] * x[i + 2 + lag];
+                r3 += x[i + 3] * x[i + 3 + lag];
+            }
+            for (; i < n; ++i) r0 += x[i] * x[i + lag];
+            const double m = e[n] + (e[kFrameSize] - e[lag]);
+            nsdf[lag] = m > 0.0 ? static_cast<float>(2.0 * ((r0 + r1) + (r2 + r3)) / m) : 0.0f;
+        }
+        lags = maxLag - minLag + 2;
+
+        float highest = 0.0f;
+        for (int lag = minLag + 1; lag <= maxLag; ++lag) {
+            highest = std::max(highest, nsdf[lag]);
+        }
+        if (highest < 0.5f) return 0.0f;
+
+        for (int lag = minLag + 1; lag <= maxLag; ++lag) {
+            if (nsdf[lag] >= 0.9f * highest && nsdf[lag] >= nsdf[lag - 1] && nsdf[lag] > nsdf[lag + 1]) {
+                const float a = nsdf[lag - 1], b = nsdf[lag], c = nsdf[lag + 1];
+                const float den = a - 2.0f * b + c;
+                const float offset = den < 0.0f ? 0.5f * (a - c) / den : 0.0f;
+                return sampleRate / (lag + offset);
+            }
+        }
+        return 0.0f;
+    }
+};
+
+struct Score {
+    double nsPerFrame = 0.0;
+    double lagsPerFrame = 0.0;
+    int voicedFrames = 0;
+    int detected = 0;
+    int grossErrors = 0;
+    int octaveJumps = 0;
+};
+
+static void scoreTrack(const Signal& s, const std::vector<float>& track, Score& score) {
+    float last = 0.0f;
+    for (size_t f = 0; f < track.size(); ++f) {
+        const float truth = s.f0[f * kHopSize + kFrameSize / 2];
+        const float hz = track[f];
+        if (truth > 0.0f) {
+            ++score.voicedFrames;
+            if (hz > 0.0f) {
+                ++score.detected;
+                if (std::fabs(hz - truth) > 0.2f * truth) ++score.grossErrors;
+            }
+        }
+        if (hz > 0.0f && last > 0.0f && (hz / last > 1.8f || last / hz > 1.8f)) ++score.octaveJumps;
+        last = hz;
+    }
+}
+
+static void print(const char* name, const Score& s) {
+    std::printf("%-12s %10.0f %10.1f %9d/%-6d %8d %8d\n", name, s.nsPerFrame, s.lagsPerFrame,
+                s.detected, s.voicedFrames, s.grossErrors, s.octaveJumps);
+}
+
+int main(int argc, char** argv) {
+    const int sampleRate = argc > 1 ? std::atoi(argv[1]) : 44100;
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 10.0;
+    const int repeats = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    const Signal s = synthesize(sampleRate, seconds);
+    const int frames = static_cast<int>((s.samples.size() - kFrameSize) / kHopSize + 1);
+    std::vector<float> track(frames);
+
+    FullSearch full(sampleRate);
+    PitchTracker tracker;
+    if (!tracker.configure(static_cast<float>(sampleRate), kFrameSize, kMinHz, kMaxHz)) {
+        std::fprintf(stderr, "tracker configuration failed\n");
+        return 1;
+    }
+
+    Score fullScore;
+    Score trackScore;
+    long fullLags = 0;
+    long trackLags = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        fullLags = 0;
+        for (int f = 0; f < frames; ++f) {
+            int lags = 0;
+            track[f] = full.estimate(&s.samples[static_cast<size_t>(f) * kHopSize], lags);
+            fullLags += lags;
+        }
+    }
+    fullScore.nsPerFrame = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+    fullScore.lagsPerFrame = static_cast<double>(fullLags) / frames;
+    scoreTrack(s, track, fullScore);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        trackLags = 0;
+        tracker.reset();
+        for (int f = 0; f < frames; ++f) {
+            const float* x = &s.samples[static_cast<size_t>(f) * kHopSize];
+            float seed = 0.0f;
+            if (tracker.needsSeed()) {
+                int lags = 0;
+                seed = full.estimate(x, lags);
+                trackLags += lags;
+            }
+            float confidence = 0.0f;
+            track[f] = tracker.update(x, seed, confidence);
+            trackLags += tracker.getLagsSearched();
+        }
+    }
+    trackScore.nsPerFrame = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+    trackScore.lagsPerFrame = static_cast<double>(trackLags) / frames;
+    scoreTrack(s, track, trackScore);
+
+    std::printf("sampleRate=%d frames=%d frameSize=%d hop=%d\n", sampleRate, frames, kFrameSize, kHopSize);
+    std::printf("%-12s %10s %10s %16s %8s %8s\n", "method", "ns/frame", "lags", "voiced found", "gross", "octave");
+    print("full-range", fullScore);
+    print("tracker", trackScore);
+
+    // reset(): the second half of the signal, entered mid-glide right after
+    // the tracker has followed the whole signal, against a new tracker
+    const int offsetFrames = frames / 2;
+    PitchTracker fresh;
+    fresh.configure(static_cast<float>(sampleRate), kFrameSize, kMinHz, kMaxHz);
+    tracker.reset();
+    int resetMismatches = 0;
+    for (int f = offsetFrames; f < frames; ++f) {
+        const float* x = &s.samples[static_cast<size_t>(f) * kHopSize];
+        float seedA = 0.0f, seedB = 0.0f;
+        int lags = 0;
+        if (tracker.needsSeed()) seedA = full.estimate(x, lags);
+        if (fresh.needsSeed()) seedB = full.estimate(x, lags);
+        float confidenceA = 0.0f, confidenceB = 0.0f;
+        const float a = tracker.update(x, seedA, confidenceA);
+        const float b = fresh.update(x, seedB, confidenceB);
+        resetMismatches += a != b || confidenceA != confidenceB;
+    }
+    std::printf("after reset: %d of %d frames differ from a new tracker\n", resetMismatches, frames - offsetFrames);
+
+    const double allowed = kMaxGrossFraction * trackScore.voicedFrames;
+    const bool ok = trackScore.detected >= fullScore.detected
+                    && trackScore.grossErrors <= allowed
+                    && trackScore.octaveJumps <= fullScore.octaveJumps + allowed
+                    && resetMismatches == 0;
+    std::printf("\n%s\n", ok ? "pitch tracker within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
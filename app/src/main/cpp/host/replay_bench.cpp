@@ -0,0 +1,198 @@
+// Correctness and pacing check for the native audio sources.
+//
+// Decodes an in-memory stereo 16-bit WAV and a raw float image and checks
+// the samples; replays a recording in realtime, scaled and unthrottled
+// pacing and checks that every sample arrives once, in order, and that the
+// wall time and block arrival times follow the schedule; finally feeds the
+// live source from a producer thread through the capture ring.
+//
+// Exits with status 1 if any sample is wrong or missing, or a paced replay
+// misses its schedule by more than the tolerance.
+//
+// Usage: replay_bench [seconds=1.0] [speed=8]
+
+#include "audio_source.h"
+#include "pcm_convert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static const int kSampleRate = 16000;
+static const int kBlockSize = 160;
+
+// Paced replays may end this late (sleep granularity, scheduler) or not at all early
+static const double kPacingTolerance = 0.05;
+
+// 95% of block arrivals may trail their release time by this much
+static const double kArrivalToleranceMs = 5.0;
+
+// No block may trail its release time by more than this; a single block is
+// allowed to miss kArrivalToleranceMs when the scheduler preempts the reader
+static const double kWorstArrivalToleranceMs = 50.0;
+
+static void putU16(std::vector<uint8_t>& out, int v) {
+    out.push_back(static_cast<uint8_t>(v & 0xff));
+    out.push_back(static_cast<uint8_t>((v >> 8) & 0xff));
+}
+
+static void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    putU16(out, v & 0xffff);
+    putU16(out, v >> 16);
+}
+
+static std::vector<uint8_t> stereoWav(const std::vector<int16_t>& left, const std::vector<int16_t>& right) {
+    std::vector<uint8_t> out = {'R', 'I', 'F', 'F'};
+    putU32(out, static_cast<uint32_t>(36 + 4 * left.size()));
+    for (char c : std::string("WAVEfmt ")) out.push_back(c);
+    putU32(out, 16);
+    putU16(out, 1);
+    putU16(out, 2);
+    putU32(out, kSampleRate);
+    putU32(out, kSampleRate * 4);
+    putU16(out, 4);
+    putU16(out, 16);
+    for (char c : std::string("data")) out.push_back(c);
+    putU32(out, static_cast<uint32_t>(4 * left.size()));
+    for (size_t i = 0; i < left.size(); ++i) {
+        putU16(out, static_cast<uint16_t>(left[i]));
+        putU16(out, static_cast<uint16_t>(right[i]));
+    }
+    return out;
+}
+
+struct ReplayRun {
+    double wallSeconds = 0.0;
+    double p95ArrivalMs = 0.0;      // 95th percentile of block arrival relative to its schedule
+    double worstArrivalMs = 0.0;    // Latest block arrival relative to its schedule
+    bool samplesExact = false;
+};
+
+static ReplayRun replay(ReplayAudioSource& source, double speed) {
+    ReplayRun run;
+    std::vector<float> received;
+    std::vector<float> block(source.getBlockSize());
+    std::vector<double> lateMs;
+    AudioBlock info;
+    int64_t startNs = 0;
+    bool ordered = true;
+
+    const auto start = std::chrono::steady_clock::now();
+    int n;
+    while ((n = source.read(block.data(), static_cast<int>(block.size()), info)) > 0) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (startNs == 0) {
+            startNs = info.arrivalNs - static_cast<int64_t>(1e9 * n / (kSampleRate * speed));
+        }
+        ordered &= info.firstSample == static_cast<int64_t>(received.size());
+        const double dueMs = 1e3 * (info.firstSample + n) / (kSampleRate * speed);
+        lateMs.push_back((now - startNs) * 1e-6 - dueMs);
+        received.insert(received.end(), block.begin(), block.begin() + n);
+    }
+    run.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.samplesExact = ordered && received == source.getSamples();
+    if (!lateMs.empty()) {
+        std::sort(lateMs.begin(), lateMs.end());
+        run.p95ArrivalMs = lateMs[lateMs.size() * 95 / 100];
+        run.worstArrivalMs = lateMs.back();
+    }
+    return run;
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::max(0.1, std::atof(argv[1])) : 1.0;
+    const double speed = argc > 2 ? std::max(1.0, std::atof(argv[2])) : 8.0;
+    const int total = static_cast<int>(seconds * kSampleRate);
+    bool ok = true;
+
+    // Decoders: stereo WAV mixes down to the channel mean, raw f32 is bit-exact
+    std::vector<int16_t> left(total), right(total);
+    std::vector<float> expected(total);
+    for (int i = 0; i < total; ++i) {
+        left[i] = static_cast<int16_t>(12000.0 * std::sin(2.0 * M_PI * 220.0 * i / kSampleRate));
+        right[i] = static_cast<int16_t>(i % 2000 - 1000);
+        expected[i] = (left[i] * kPcm16Scale + right[i] * kPcm16Scale) / 2.0f;
+    }
+    const std::vector<uint8_t> wav = stereoWav(left, right);
+    std::vector<float> decoded;
+    int rate = 0;
+    std::string error;
+    const bool wavOk = decodeWav(wav.data(), wav.size(), decoded, rate, error)
+            && rate == kSampleRate && decoded == expected;
+    std::vector<uint8_t> raw(expected.size() * sizeof(float));
+    std::memcpy(raw.data(), expected.data(), raw.size());
+    const bool rawOk = decodeRawPcm(raw.data(), raw.size(), "f32", decoded, error) && decoded == expected;
+    ok &= wavOk && rawOk;
+    std::printf("decode: stereo s16 WAV %s, raw f32 %s\n", wavOk ? "ok" : "WRONG", rawOk ? "ok" : "WRONG");
+
+    // Replay in the three pacings; the last block is deliberately partial
+    std::vector<float> recording(expected.begin(), expected.end() - kBlockSize / 2);
+    const double audioSeconds = static_cast<double>(recording.size()) / kSampleRate;
+    ReplayAudioSource source;
+    source.setSamples(recording, kSampleRate);
+
+    std::printf("\n%-12s %10s %10s %12s %12s %14s %8s\n",
+                "pacing", "expected s", "wall s", "x realtime", "p95 late ms", "worst late ms", "samples");
+    const struct { ReplayPacing pacing; double speed; const char* name; } runs[] = {
+            {kReplayRealtime, 1.0, "realtime"},
+            {kReplayScaled, speed, "scaled"},
+            {kReplayUnthrottled, 0.0, "unthrottled"},
+    };
+    for (const auto& r : runs) {
+        source.configure(kBlockSize, r.pacing, r.pacing == kReplayUnthrottled ? 1.0 : r.speed);
+        const ReplayRun run = replay(source, r.pacing == kReplayUnthrottled ? 1.0 : r.speed);
+        bool good = run.samplesExact;
+        double expectedSeconds = 0.0;
+        if (r.pacing != kReplayUnthrottled) {
+            expectedSeconds = audioSeconds / r.speed;
+            good &= run.wallSeconds >= expectedSeconds * (1.0 - kPacingTolerance)
+                    && run.wallSeconds <= expectedSeconds * (1.0 + kPacingTolerance)
+                    && run.p95ArrivalMs <= kArrivalToleranceMs
+                    && run.worstArrivalMs <= kWorstArrivalToleranceMs;
+        }
+        ok &= good;
+        std::printf("%-12s %10.3f %10.3f %12.1f %12.2f %14.2f %8s%s\n", r.name, expectedSeconds, run.wallSeconds,
+                    audioSeconds / std::max(1e-9, run.wallSeconds),
+                    r.pacing == kReplayUnthrottled ? 0.0 : run.p95ArrivalMs,
+                    r.pacing == kReplayUnthrottled ? 0.0 : run.worstArrivalMs,
+                    run.samplesExact ? "exact" : "WRONG", good ? "" : "  <-- FAILED");
+    }
+
+    // Live source: a producer thread writes s16 chunks into the ring
+    PcmRing16 ring(4096, kBlockSize);
+    LiveAudioSource live(ring, kSampleRate);
+    std::thread producer([&] {
+        for (int sent = 0; sent < total;) {
+            const int n = std::min(total - sent, 37 + sent % 300);
+            int done = 0;
+            while (done < n) {
+                done += ring.write(left.data() + sent + done, std::min(n - done, ring.writable()));
+                if (done < n) std::this_thread::yield();
+            }
+            sent += n;
+        }
+        live.stop();
+    });
+    std::vector<float> block(kBlockSize), received;
+    AudioBlock info;
+    bool ordered = true;
+    int n;
+    while ((n = live.read(block.data(), kBlockSize, info)) > 0) {
+        ordered &= info.firstSample == static_cast<int64_t>(received.size());
+        received.insert(received.end(), block.begin(), block.begin() + n);
+    }
+    producer.join();
+    bool liveOk = ordered && static_cast<int>(received.size()) == total;
+    for (int i = 0; liveOk && i < total; ++i) liveOk = received[i] == left[i] * kPcm16Scale;
+    ok &= liveOk;
+    std::printf("\nlive source: %zu of %d samples, %s\n", received.size(), total, liveOk ? "in order" : "WRONG");
+
+    std::printf("\n%s\n", ok ? "sources delivered every sample on schedule" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Replays a recording through the streaming analyzer as the live pipeline
+// would run it, with realtime, scaled or unthrottled pacing, and prints
+// throughput and per-frame latency (block arrival to result).
+//
+// When no frame is dropped, the valid streamed frames are compared in order
+// with analyzeBuffer over the whole recording on a second analyzer (which
+// returns valid frames only), so unthrottled replay doubles as a regression
+// check; paced replay shows whether the engine keeps up at a given speed
+// (dropped frames > 0 means it did not).
+//
+// Exits with status 1 if frames were dropped, if the numbers of valid
+// frames differ, or if more than 1% of them differ from analyzeBuffer by
+// more than 1% in pitch, centroid, brightness, resonance or HNR.
+//
+// Usage: replay_tool [--input=path.wav|.s16|.f32] [--seconds=10]
+//                    [--sample-rate=16000] [--frame-size=1024] [--hop=256]
+//                    [--block=160] [--pacing=realtime|scaled|unthrottled]
+//                    [--speed=4] [--frames=path.csv]
+
+#include "audio_source.h"
+#include "essentia_wrapper.h"
+#include "host_audio.h"
+#include "streaming_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Relative difference allowed in each scalar feature of a frame
+static const float kFeatureTolerance = 0.01f;
+
+// Allowed fraction of frames that differ from analyzeBuffer
+static const double kMaxMismatchFraction = 0.01;
+
+struct Options {
+    std::string input;
+    double seconds = 10.0;
+    int sampleRate = 16000;
+    int frameSize = 1024;
+    int hopSize = 256;
+    int blockSize = 160;
+    ReplayPacing pacing = kReplayUnthrottled;
+    double speed = 4.0;
+    std::string framesPath;
+};
+
+/**
+ * Whether a and b agree within kFeatureTolerance of the larger magnitude
+ */
+static bool within(float a, float b) {
+    return std::fabs(a - b) <= kFeatureTolerance * std::max(std::fabs(a), std::fabs(b)) + 1e-6f;
+}
+
+/**
+ * Whether a streamed frame matches the analyzeBuffer frame
+ */
+static bool sameFrame(const AudioFeatures& a, const AudioFeatures& b) {
+    return within(a.pitch, b.pitch) && within(a.centroid, b.centroid)
+           && within(a.brightness, b.brightness) && within(a.resonance, b.resonance) && within(a.hnr, b.hnr);
+}
+
+static bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* eq = std::strchr(arg, '=');
+        const std::string key = eq ? std::string(arg, eq - arg) : std::string(arg);
+        const std::string value = eq ? std::string(eq + 1) : std::string();
+
+        if (key == "--input") opt.input = value;
+        else if (key == "--seconds") opt.seconds = std::atof(value.c_str());
+        else if (key == "--sample-rate") opt.sampleRate = std::atoi(value.c_str());
+        else if (key == "--frame-size") opt.frameSize = std::atoi(value.c_str());
+        else if (key == "--hop") opt.hopSize = std::atoi(value.c_str());
+        else if (key == "--block") opt.blockSize = std::atoi(value.c_str());
+        else if (key == "--speed") opt.speed = std::atof(value.c_str());
+        else if (key == "--frames") opt.framesPath = value;
+        else if (key == "--pacing") {
+            if (value == "realtime") opt.pacing = kReplayRealtime;
+            else if (value == "scaled") opt.pacing = kReplayScaled;
+            else if (value == "unthrottled") opt.pacing = kReplayUnthrottled;
+            else {
+                std::fprintf(stderr, "unknown pacing %s\n", value.c_str());
+                return false;
+            }
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    HostAudio audio;
+    if (opt.input.empty()) {
+        audio = synthesizeVoice(opt.sampleRate, opt.seconds);
+    } else {
+        std::string error;
+        if (!loadAudio(opt.input, opt.sampleRate, audio, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    ReplayAudioSource source;
+    source.setSamples(audio.samples, audio.sampleRate);
+    if (!source.configure(opt.blockSize, opt.pacing, opt.speed)) {
+        std::fprintf(stderr, "invalid block size or speed\n");
+        return 2;
+    }
+
+    EssentiaWrapper wrapper;
+    if (!wrapper.initialize(audio.sampleRate, opt.frameSize, opt.hopSize)) {
+        std::fprintf(stderr, "failed to initialize analyzer\n");
+        return 1;
+    }
+    StreamingAnalyzer stream(wrapper);
+
+    FILE* frames = nullptr;
+    if (!opt.framesPath.empty()) {
+        frames = std::fopen(opt.framesPath.c_str(), "w");
+        if (frames == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.framesPath.c_str());
+            return 1;
+        }
+        std::fprintf(frames, "sample,timestamp,valid,pitch,centroid,hnr\n");
+    }
+
+    // Valid frames, reserved up front so the list does not regrow while timed
+    std::vector<AudioFeatures> streamed;
+    const size_t expectedFrames = audio.samples.size() >= static_cast<size_t>(opt.frameSize)
+            ? (audio.samples.size() - opt.frameSize) / opt.hopSize + 1 : 0;
+    streamed.reserve(expectedFrames);
+
+    const SourceRunStats stats = runAudioSource(source, stream, opt.blockSize, [&](const StreamFrame& f) {
+        if (f.features.isValid) streamed.push_back(f.features);
+        if (frames != nullptr) {
+            std::fprintf(frames, "%lld,%.4f,%d,%.3f,%.2f,%.2f\n", static_cast<long long>(f.sampleIndex),
+                         f.timestamp, f.features.isValid ? 1 : 0, f.features.pitch,
+                         f.features.centroid, f.features.hnr);
+        }
+    });
+    if (frames != nullptr) std::fclose(frames);
+
+    std::printf("audio:      %.2f s at %d Hz, block %d, frame %d, hop %d\n",
+                static_cast<double>(stats.samples) / audio.sampleRate, audio.sampleRate,
+                opt.blockSize, opt.frameSize, opt.hopSize);
+    std::printf("frames:     %lld (%lld valid, %lld dropped)\n", static_cast<long long>(stats.frames),
+                static_cast<long long>(stats.validFrames), static_cast<long long>(stats.droppedFrames));
+    std::printf("throughput: %.3f s wall, %.1fx realtime\n", stats.wallSeconds, stats.realtimeFactor);
+    std::printf("latency ms: mean %.3f, p50 %.3f, p95 %.3f, max %.3f\n",
+                stats.meanLatencyMs, stats.p50LatencyMs, stats.p95LatencyMs, stats.maxLatencyMs);
+    if (stats.droppedFrames != 0) {
+        std::printf("\nFAILED: frames dropped, not compared with analyzeBuffer\n");
+        return 1;
+    }
+
+    EssentiaWrapper reference;
+    if (!reference.initialize(audio.sampleRate, opt.frameSize, opt.hopSize)) {
+        std::fprintf(stderr, "failed to initialize reference analyzer\n");
+        return 1;
+    }
+    const std::vector<AudioFeatures> buffered = reference.analyzeBuffer(
+            audio.samples.data(), static_cast<int>(audio.samples.size()), opt.hopSize);
+
+    int differ = 0;
+    const size_t compared = std::min(streamed.size(), buffered.size());
+    for (size_t i = 0; i < compared; ++i) {
+        differ += !sameFrame(streamed[i], buffered[i]);
+    }
+    const bool ok = streamed.size() == buffered.size() && differ <= kMaxMismatchFraction * compared;
+    std::printf("vs buffer:  %zu valid streamed, %zu valid buffered, %d differ\n", streamed.size(),
+                buffered.size(), differ);
+    std::printf("\n%s\n", ok ? "streamed features match analyzeBuffer" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Accuracy check and benchmark for the polyphase resampler.
+//
+// For each conversion, resamples test tones and measures the passband gain
+// (tones below 0.4 of the output rate), the rejection of tones that would
+// alias (above 0.55 of the output rate) and the throughput. Also prints the
+// voice-band rate chosen for each input rate.
+//
+// Exits with status 1 if the passband deviates by more than kMaxRippleDb
+// or an aliasing tone is attenuated by less than kMinRejectionDb.
+//
+// Usage: resample_bench [seconds=10]
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const double kMaxRippleDb = 0.1;
+static const double kMinRejectionDb = 55.0;
+
+// Voice band analysis rate floor, as in the analyzer
+static const int kVoiceBandMinRate = 10000;
+static const int kVoiceBandMaxFactor = 8;
+
+// RMS amplitude of the steady-state middle of a signal
+static double rms(const std::vector<float>& x) {
+    const size_t begin = x.size() / 4;
+    const size_t end = x.size() - x.size() / 4;
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i) sum += static_cast<double>(x[i]) * x[i];
+    return std::sqrt(sum / (end - begin));
+}
+
+static double toneGainDb(const PolyphaseResampler& resampler, int inputRate, double hz) {
+    const int n = inputRate / 2;
+    std::vector<float> tone(n);
+    for (int i = 0; i < n; ++i) tone[i] = static_cast<float>(std::sin(2.0 * M_PI * hz * i / inputRate));
+    std::vector<float> out(resampler.outputLength(n));
+    resampler.resample(tone.data(), n, out.data(), static_cast<int>(out.size()));
+    return 20.0 * std::log10(std::max(rms(out) / std::sqrt(0.5), 1e-12));
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::max(0.1, std::atof(argv[1])) : 10.0;
+
+    const int voiceRates[] = {8000, 16000, 22050, 44100, 48000};
+    std::printf("voice band rates:");
+    for (int rate : voiceRates) {
+        int up, down;
+        chooseResampleRatio(rate, kVoiceBandMinRate, kVoiceBandMaxFactor, up, down);
+        std::printf("  %d -> %d (%d/%d)", rate, rate * up / down, up, down);
+    }
+    std::printf("\n\n");
+
+    struct Conversion {
+        int inputRate, outputRate;
+    } conversions[] = {{44100, 11025}, {16000, 10000}, {48000, 12000}, {44100, 16000}, {16000, 44100}};
+
+    std::printf("%-14s %6s %10s %12s %14s %12s\n", "conversion", "taps", "ripple dB", "rejection dB",
+                "ns/out sample", "x realtime");
+
+    bool ok = true;
+    for (const Conversion& c : conversions) {
+        PolyphaseResampler resampler;
+        resampler.configure(c.inputRate, c.outputRate);
+        const int lowerRate = std::min(c.inputRate, c.outputRate);
+
+        double ripple = 0.0;
+        for (double f = 50.0; f <= 0.4 * lowerRate; f += 0.4 * lowerRate / 37.0) {
+            ripple = std::max(ripple, std::fabs(toneGainDb(resampler, c.inputRate, f)));
+        }
+
+        // Only downsampling can alias; upsampling images sit above the input band
+        double rejection = INFINITY;
+        if (c.outputRate < c.inputRate) {
+            for (double f = 0.55 * c.outputRate; f < 0.5 * c.inputRate; f += 0.5 * c.inputRate / 61.0) {
+                rejection = std::min(rejection, -toneGainDb(resampler, c.inputRate, f));
+            }
+        }
+
+        const int n = static_cast<int>(seconds * c.inputRate);
+        std::vector<float> input(n);
+        for (int i = 0; i < n; ++i) input[i] = static_cast<float>(std::sin(0.01 * i) + 0.1 * std::sin(1.3 * i));
+        std::vector<float> out(resampler.outputLength(n));
+        const auto start = std::chrono::steady_clock::now();
+        resampler.resample(input.data(), n, out.data(), static_cast<int>(out.size()));
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const bool pass = ripple <= kMaxRippleDb && rejection >= kMinRejectionDb;
+        ok = ok && pass;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d->%d", c.inputRate, c.outputRate);
+        std::printf("%-14s %6d %10.4f %12.1f %14.1f %12.0f%s\n", name, resampler.getTapsPerOutput(), ripple,
+                    rejection, elapsed * 1e9 / out.size(), seconds / elapsed, pass ? "" : "  FAIL");
+    }
+
+    std::printf("\n%s\n", ok ? "all conversions within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
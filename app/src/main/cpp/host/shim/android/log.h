@@ -0,0 +1,40 @@
+// Host stand-in for the NDK logging header, so the analysis sources build
+// unchanged on Linux. Messages go to stderr; debug and verbose output is
+// dropped unless HOST_LOG_VERBOSE is defined.
+
+#ifndef HOST_SHIM_ANDROID_LOG_H
+#define HOST_SHIM_ANDROID_LOG_H
+
+#include <cstdarg>
+#include <cstdio>
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...)
+        __attribute__((format(printf, 3, 4)));
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+#ifndef HOST_LOG_VERBOSE
+    if (prio < ANDROID_LOG_INFO) return 0;
+#endif
+    static const char kLevels[] = "??VDIWEFS";
+    std::fprintf(stderr, "%c/%s: ", (prio >= 0 && prio <= ANDROID_LOG_SILENT) ? kLevels[prio] : '?', tag);
+    va_list args;
+    va_start(args, fmt);
+    const int n = std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return n;
+}
+
+#endif // HOST_SHIM_ANDROID_LOG_H
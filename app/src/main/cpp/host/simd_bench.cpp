@@ -0,0 +1,143 @@
+// Accuracy check and benchmark for the SIMD reduction kernels.
+//
+// For every instruction set available on this machine, runs each kernel on
+// random frames of several sizes and compares it with a double-precision
+// reference. A kernel passes when its relative error is within
+// kTolerance or no worse than twice the sequential scalar loop's error
+// (summation order is the only difference). Also reports ns per call.
+//
+// Exits with status 1 if any kernel fails, so it can gate changes.
+//
+// Usage: simd_bench [repeats=20000]
+
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const double kTolerance = 1e-6;
+static const int kSizes[] = {7, 64, 513, 1024, 4096, 65536};
+
+struct Reference {
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    double sumSquaredDeviations = 0.0;
+    double dot = 0.0;
+};
+
+static Reference reference(const std::vector<float>& x, const std::vector<float>& y, float mean) {
+    Reference r;
+    for (size_t i = 0; i < x.size(); ++i) {
+        r.sum += x[i];
+        r.sumSquares += static_cast<double>(x[i]) * x[i];
+        const double d = static_cast<double>(x[i]) - mean;
+        r.sumSquaredDeviations += d * d;
+        r.dot += static_cast<double>(x[i]) * y[i];
+    }
+    return r;
+}
+
+// Error relative to the magnitude of the terms, so sums that cancel to
+// near zero are not judged against a tiny denominator
+static double relativeError(double value, double exact, double scale) {
+    return std::fabs(value - exact) / std::max(scale, 1e-30);
+}
+
+template <typename F>
+static double nsPerCall(int repeats, F&& f) {
+    volatile float sink = 0.0f;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        sink = sink + f();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / repeats;
+}
+
+int main(int argc, char** argv) {
+    const int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+
+    std::mt19937 rng(99);
+    std::normal_distribution<float> dist(0.01f, 0.3f);
+
+    const SimdKernels* scalar = simdKernelsForIsa("scalar");
+    std::vector<const SimdKernels*> sets;
+    for (const char* isa : {"scalar", "sse2", "avx2", "neon"}) {
+        if (const SimdKernels* k = simdKernelsForIsa(isa)) sets.push_back(k);
+    }
+
+    std::printf("dispatch selects: %s\n\n", simdKernels().isa);
+    std::printf("%-7s %6s %-16s %12s %12s %10s\n", "isa", "n", "kernel", "rel.error", "scalar err", "ns/call");
+
+    bool ok = true;
+    for (int n : kSizes) {
+        std::vector<float> x(n), y(n), out(n);
+        for (int i = 0; i < n; ++i) {
+            x[i] = dist(rng);
+            y[i] = dist(rng);
+        }
+        const float mean = static_cast<float>(reference(x, y, 0.0f).sum / n);
+        const Reference ref = reference(x, y, mean);
+
+        // Scale of each reduction's terms
+        double absSum = 0.0, absDot = 0.0;
+        for (int i = 0; i < n; ++i) {
+            absSum += std::fabs(x[i]);
+            absDot += std::fabs(static_cast<double>(x[i]) * y[i]);
+        }
+
+        const int calls = std::max(1, repeats * 64 / n);
+        for (const SimdKernels* k : sets) {
+            struct Case {
+                const char* name;
+                double value, scalarValue, exact, scale, ns;
+            } cases[] = {
+                    {"sum", k->sum(x.data(), n), scalar->sum(x.data(), n), ref.sum, absSum,
+                     nsPerCall(calls, [&] { return k->sum(x.data(), n); })},
+                    {"sumSquares", k->sumSquares(x.data(), n), scalar->sumSquares(x.data(), n),
+                     ref.sumSquares, ref.sumSquares,
+                     nsPerCall(calls, [&] { return k->sumSquares(x.data(), n); })},
+                    {"sumSqDeviations", k->sumSquaredDeviations(x.data(), n, mean),
+                     scalar->sumSquaredDeviations(x.data(), n, mean),
+                     ref.sumSquaredDeviations, ref.sumSquaredDeviations,
+                     nsPerCall(calls, [&] { return k->sumSquaredDeviations(x.data(), n, mean); })},
+                    {"dot", k->dot(x.data(), y.data(), n), scalar->dot(x.data(), y.data(), n), ref.dot, absDot,
+                     nsPerCall(calls, [&] { return k->dot(x.data(), y.data(), n); })},
+            };
+
+            for (const Case& c : cases) {
+                const double err = relativeError(c.value, c.exact, c.scale);
+                const double scalarErr = relativeError(c.scalarValue, c.exact, c.scale);
+                const bool pass = err <= kTolerance || err <= 2.0 * scalarErr;
+                ok = ok && pass;
+                std::printf("%-7s %6d %-16s %12.3g %12.3g %10.1f%s\n", k->isa, n, c.name, err, scalarErr, c.ns,
+                            pass ? "" : "  FAIL");
+            }
+
+            // subtract is elementwise: it must match the scalar result exactly
+            k->subtract(x.data(), mean, out.data(), n);
+            for (int i = 0; i < n; ++i) {
+                if (out[i] != x[i] - mean) {
+                    std::printf("%-7s %6d subtract mismatch at %d  FAIL\n", k->isa, n, i);
+                    ok = false;
+                    break;
+                }
+            }
+            // In place
+            std::vector<float> inPlace = x;
+            k->subtract(inPlace.data(), mean, inPlace.data(), n);
+            if (inPlace != out) {
+                std::printf("%-7s %6d subtract in place differs  FAIL\n", k->isa, n);
+                ok = false;
+            }
+        }
+    }
+
+    std::printf("\n%s\n", ok ? "all kernels within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// Accuracy check and benchmark for the shared STFT front end.
+//
+// On the embedding's log-mel grid (16 kHz, 512-sample frames, hop 160),
+// compares one FFT per frame with both windows applied in the frequency
+// domain against windowing each copy of the frame in the time domain and
+// transforming it separately, which is what the analyzer (Windowing +
+// Spectrum) and the embedding extractor did before:
+//   - Hann magnitude vs the time-windowed periodic Hann, and for reference
+//     vs Essentia's symmetric Hann (relative to the frame's peak)
+//   - log-mel rows from the shared STFT vs LogMelExtractor::compute, with
+//     the analyzer's per-frame DC removal undone in the frequency domain
+// and reports the cost per frame of each path.
+//
+// Exits with status 1 if a shared-path result differs from its
+// time-domain equivalent by more than the tolerances.
+//
+// Usage: stft_bench [repeats=200]
+
+#include "fft.h"
+#include "log_mel.h"
+#include "stft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const double kHannTolerance = 1e-4;     // Relative to the frame's peak magnitude
+static const double kLogMelTolerance = 1e-3;   // Natural log units
+
+// Raised cosine a - (1 - a) cos(2 pi i / period), scaled to sum to 2 if normalize
+static std::vector<float> raisedCosineWindow(int n, double a, int period, bool normalize) {
+    std::vector<double> w(n);
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        w[i] = a - (1.0 - a) * std::cos(2.0 * M_PI * i / period);
+        sum += w[i];
+    }
+    std::vector<float> out(n);
+    for (int i = 0; i < n; ++i) out[i] = static_cast<float>(normalize ? w[i] * 2.0 / sum : w[i]);
+    return out;
+}
+
+int main(int argc, char** argv) {
+    const int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    const int n = kLogMelFftSize;
+    const int bins = n / 2 + 1;
+
+    // One second of a voice-like signal with a DC offset and a noise floor
+    std::mt19937 rng(18);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    std::vector<float> signal(kLogMelSampleRate);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        const double t = static_cast<double>(i) / kLogMelSampleRate;
+        const double f0 = 180.0 + 40.0 * std::sin(2.0 * M_PI * 2.0 * t);
+        double sample = 0.0;
+        for (int h = 1; h <= 25; ++h) sample += std::sin(2.0 * M_PI * f0 * h * t) / (h * h);
+        signal[i] = static_cast<float>(0.4 * sample) + 0.02f + noise(rng);
+    }
+    const int frames = (static_cast<int>(signal.size()) - n) / kLogMelHopSize + 1;
+
+    const std::vector<float> hann = raisedCosineWindow(n, 0.5, n, true);
+    const std::vector<float> essentiaHann = raisedCosineWindow(n, 0.5, n - 1, true);
+    const std::vector<float> hamming = raisedCosineWindow(n, 0.54, n, false);
+
+    RealFft fft;
+    fft.configure(n);
+    StftFrontEnd stft;
+    stft.configure(n);
+    LogMelExtractor extractor;
+
+    std::vector<float> frame(n), windowed(n), spectrum(2 * bins), magnitude(bins), shared(bins), power(bins);
+    std::vector<float> logMelA(kLogMelOutputSize), logMelB(kLogMelOutputSize);
+
+    // Accuracy, frame by frame as EssentiaWrapper::analyzeBufferWithLogMel
+    extractor.compute(signal.data(), static_cast<int>(signal.size()), 1, false, 0, logMelA.data());
+    double worstHann = 0.0, worstEssentiaHann = 0.0;
+    for (int t = 0; t < kLogMelFrames; ++t) {
+        const int start = t * kLogMelHopSize;
+        const int available = std::max(0, std::min(static_cast<int>(signal.size()) - start, n));
+        float mean = 0.0f;
+        if (t < frames) {
+            for (int i = 0; i < n; ++i) mean += signal[start + i];
+            mean /= n;
+        }
+        for (int i = 0; i < n; ++i) frame[i] = (i < available ? signal[start + i] : 0.0f) - mean;
+
+        stft.transform(frame.data());
+        stft.hammingPower(mean, power.data());
+        extractor.computeRow(power.data(), logMelB.data() + t * kLogMelBands);
+        if (t >= frames) continue;
+        stft.hannMagnitude(shared.data());
+
+        for (const std::vector<float>* window : {&hann, &essentiaHann}) {
+            for (int i = 0; i < n; ++i) windowed[i] = frame[i] * (*window)[i];
+            fft.forward(windowed.data(), spectrum.data());
+            float peak = 0.0f;
+            double worst = 0.0;
+            for (int k = 0; k < bins; ++k) {
+                magnitude[k] = std::hypot(spectrum[2 * k], spectrum[2 * k + 1]);
+                peak = std::max(peak, magnitude[k]);
+            }
+            for (int k = 0; k < bins; ++k) {
+                worst = std::max(worst, static_cast<double>(std::fabs(magnitude[k] - shared[k])) / peak);
+            }
+            double& target = (window == &hann) ? worstHann : worstEssentiaHann;
+            target = std::max(target, worst);
+        }
+    }
+    double worstLogMel = 0.0;
+    for (int i = 0; i < kLogMelOutputSize; ++i) {
+        worstLogMel = std::max(worstLogMel, static_cast<double>(std::fabs(logMelA[i] - logMelB[i])));
+    }
+
+    // Cost per frame: two windows and two FFTs vs one FFT and two kernels
+    volatile float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (int t = 0; t < frames; ++t) {
+            const float* x = signal.data() + t * kLogMelHopSize;
+            for (int i = 0; i < n; ++i) windowed[i] = x[i] * hann[i];
+            fft.forward(windowed.data(), spectrum.data());
+            for (int k = 0; k < bins; ++k) {
+                magnitude[k] = std::sqrt(spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1]);
+            }
+            for (int i = 0; i < n; ++i) windowed[i] = x[i] * hamming[i];
+            fft.forward(windowed.data(), spectrum.data());
+            for (int k = 0; k < bins; ++k) {
+                power[k] = spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+            }
+            sink = sink + magnitude[t % bins] + power[t % bins];
+        }
+    }
+    const double separateNs = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (int t = 0; t < frames; ++t) {
+            stft.transform(signal.data() + t * kLogMelHopSize);
+            stft.hannMagnitude(shared.data());
+            stft.hammingPower(0.0f, power.data());
+            sink = sink + shared[t % bins] + power[t % bins];
+        }
+    }
+    const double sharedNs = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / (static_cast<double>(frames) * repeats);
+
+    const bool ok = worstHann <= kHannTolerance && worstLogMel <= kLogMelTolerance;
+    std::printf("Hann magnitude, max |difference| / frame peak: %.2e (vs Essentia's symmetric window: %.2e)\n",
+                worstHann, worstEssentiaHann);
+    std::printf("log-mel, max |difference|:                     %.2e\n", worstLogMel);
+    std::printf("two windows, two FFTs:   %8.0f ns/frame\n", separateNs);
+    std::printf("one FFT, two kernels:    %8.0f ns/frame\n", sharedNs);
+    std::printf("\n%s\n", ok ? "shared STFT within tolerance" : "FAILED");
+    return ok ? 0 : 1;
+}
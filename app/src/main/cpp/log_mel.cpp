@@ -0,0 +1,111 @@
+#include "log_mel.h"
+#include "fast_log.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+// Filterbank edges and the log floor, as in AudioFeatureExtractor.kt
+static const double kMelMinHz = 20.0;
+static const double kMelMaxHz = 7600.0;
+static const float kLogFloor = 1e-6f;
+
+// Below this peak the input is left unscaled (AudioUtils.normalizeVolume)
+static const float kNormalizeMinPeak = 0.01f;
+
+static double hzToMel(double hz) {
+    return 2595.0 * std::log10(1.0 + hz / 700.0);
+}
+
+static double melToHz(double mel) {
+    return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0);
+}
+
+LogMelExtractor::LogMelExtractor() {
+    const int bins = kLogMelFftSize / 2 + 1;
+    stft.configure(kLogMelFftSize);
+
+    // Band edges evenly spaced in mel, mapped to FFT bins
+    const double melMin = hzToMel(kMelMinHz);
+    const double melMax = hzToMel(kMelMaxHz);
+    int edges[kLogMelBands + 2];
+    for (int i = 0; i < kLogMelBands + 2; ++i) {
+        const double hz = melToHz(melMin + i * (melMax - melMin) / (kLogMelBands + 1));
+        edges[i] = static_cast<int>(std::floor((kLogMelFftSize + 1) * hz / kLogMelSampleRate));
+    }
+
+    // Keep each triangle's nonzero range [left, right) only
+    bands.resize(kLogMelBands);
+    weights.clear();
+    for (int m = 0; m < kLogMelBands; ++m) {
+        const int left = edges[m];
+        const int centre = edges[m + 1];
+        const int right = edges[m + 2];
+        const int first = std::max(left, 0);
+        const int last = std::min(right, bins);
+
+        Band& band = bands[m];
+        band.firstBin = first;
+        band.binCount = std::max(0, last - first);
+        band.weightOffset = static_cast<int>(weights.size());
+        for (int k = first; k < last; ++k) {
+            weights.push_back(k < centre ? static_cast<float>(k - left) / (centre - left)
+                                         : static_cast<float>(right - k) / (right - centre));
+        }
+    }
+
+    waveform.assign(paddedLength(), 0.0f);
+    power.assign(bins, 0.0f);
+}
+
+void LogMelExtractor::prepareWaveform(const float* samples, int frameCount, int channels, bool normalize,
+                                      int fixedLength) {
+    // Mono mix, averaging channels ((l + r) / 2 for stereo)
+    const int length = fixedLength > 0 ? std::min(frameCount, fixedLength) : frameCount;
+    const int used = std::min(length, paddedLength());
+    auto mono = [&](int i) {
+        if (channels == 1) return samples[i];
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) sum += samples[i * channels + c];
+        return sum / channels;
+    };
+
+    // Peak over the whole signal, before any trimming
+    float peak = 0.0f;
+    if (normalize) {
+        for (int i = 0; i < frameCount; ++i) {
+            peak = std::max(peak, std::fabs(mono(i)));
+        }
+    }
+
+    if (normalize && peak >= kNormalizeMinPeak) {
+        for (int i = 0; i < used; ++i) waveform[i] = mono(i) / peak;
+    } else {
+        for (int i = 0; i < used; ++i) waveform[i] = mono(i);
+    }
+    std::fill(waveform.begin() + used, waveform.end(), 0.0f);
+}
+
+void LogMelExtractor::compute(const float* samples, int frameCount, int channels, bool normalize, int fixedLength,
+                              float* out) {
+    if (samples == nullptr || frameCount < 0 || channels < 1) {
+        frameCount = 0;
+        channels = 1;
+    }
+    prepareWaveform(samples, frameCount, channels, normalize, fixedLength);
+
+    for (int t = 0; t < kLogMelFrames; ++t) {
+        stft.transform(waveform.data() + t * kLogMelHopSize);
+        stft.hammingPower(0.0f, power.data());
+        computeRow(power.data(), out + t * kLogMelBands);
+    }
+}
+
+void LogMelExtractor::computeRow(const float* powerSpectrum, float* row) const {
+    for (int m = 0; m < kLogMelBands; ++m) {
+        const Band& band = bands[m];
+        row[m] = simdDot(weights.data() + band.weightOffset, powerSpectrum + band.firstBin, band.binCount);
+    }
+    for (int m = 0; m < kLogMelBands; ++m) {
+        row[m] = fastLn(row[m] + kLogFloor);
+    }
+}
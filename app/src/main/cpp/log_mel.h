@@ -0,0 +1,80 @@
+#ifndef LOG_MEL_H
+#define LOG_MEL_H
+
+#include <vector>
+
+#include "stft.h"
+
+// Speaker embedding model input: 100 frames of 80 log-mel bands from
+// 16 kHz audio, 512-point FFT every 10 ms, mel range 20-7600 Hz
+static const int kLogMelSampleRate = 16000;
+static const int kLogMelFftSize = 512;
+static const int kLogMelHopSize = 160;
+static const int kLogMelBands = 80;
+static const int kLogMelFrames = 100;
+static const int kLogMelOutputSize = kLogMelFrames * kLogMelBands;
+
+/**
+ * Log-mel spectrogram engine for the speaker embedding model.
+ *
+ * Same pipeline as the original Kotlin
+ * AudioFeatureExtractor.extractLogMelSpectrogram: Hamming window, power
+ * spectrum, triangular HTK-mel filters on bins
+ * floor((fftSize + 1) * hz / sampleRate), ln(energy + 1e-6). The window
+ * is the periodic Hamming StftFrontEnd applies, so spectrograms computed
+ * here and by the analyzer's shared STFT are identical (the Kotlin code
+ * used the symmetric form; the two differ by 6e-3 on average, more in
+ * deep valleys between harmonics). The FFT plan and filterbank are built
+ * once; each filter is stored as its nonzero bin range only, so a band
+ * costs a few multiply-adds instead of a pass over all 257 bins.
+ *
+ * compute() does not allocate. Not thread-safe; callers share one
+ * instance under a lock or keep one per thread.
+ */
+class LogMelExtractor {
+private:
+    struct Band {
+        int firstBin;
+        int binCount;
+        int weightOffset;   // Into weights
+    };
+
+    StftFrontEnd stft;
+    std::vector<Band> bands;        // kLogMelBands
+    std::vector<float> weights;     // Nonzero filter weights, band after band
+    std::vector<float> waveform;    // Prepared mono input, zero padded to cover every frame
+    std::vector<float> power;       // kLogMelFftSize / 2 + 1
+
+    void prepareWaveform(const float* samples, int frameCount, int channels, bool normalize, int fixedLength);
+
+public:
+    LogMelExtractor();
+
+    /**
+     * Samples needed to fill every frame (shorter input is zero padded)
+     */
+    static int paddedLength() { return kLogMelFftSize + (kLogMelFrames - 1) * kLogMelHopSize; }
+
+    /**
+     * Mono mixing, optional peak normalization and pad/trim (the AudioUtils
+     * steps), then the spectrogram, in one call.
+     *
+     * @param samples frameCount * channels interleaved samples at 16 kHz
+     * @param normalize Divide by the peak magnitude unless it is below 0.01,
+     *        as AudioUtils.normalizeVolume
+     * @param fixedLength If > 0, pad or trim the mono signal to this many
+     *        samples first, as AudioUtils.prepareAudio
+     * @param out kLogMelOutputSize values, frame-major ([1, 100, 80])
+     */
+    void compute(const float* samples, int frameCount, int channels, bool normalize, int fixedLength, float* out);
+
+    /**
+     * One spectrogram row from a power spectrum computed elsewhere (the
+     * analyzer's shared STFT); compute() runs this per frame
+     * @param power kLogMelFftSize / 2 + 1 values, from StftFrontEnd::hammingPower
+     * @param row kLogMelBands values
+     */
+    void computeRow(const float* power, float* row) const;
+};
+
+#endif // LOG_MEL_H
@@ -0,0 +1,187 @@
+#include "parallel_analyzer.h"
+#include <android/log.h>
+#include <algorithm>
+
+#define LOG_TAG "ParallelAnalyzer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+// Chunks handed out per worker per job; more chunks balance better, fewer
+// chunks touch the shared cursor less often
+static const int kChunksPerWorker = 8;
+
+ParallelBufferAnalyzer::ParallelBufferAnalyzer()
+        : generation(0)
+        , busyWorkers(0)
+        , stopping(false)
+        , jobBuffer(nullptr)
+        , jobHopSize(0)
+        , jobFrames(0)
+        , jobChunkSize(1)
+        , nextChunk(0)
+        , frameSize(0)
+        , initialized(false) {
+}
+
+ParallelBufferAnalyzer::~ParallelBufferAnalyzer() {
+    cleanup();
+}
+
+bool ParallelBufferAnalyzer::initialize(int numThreads, int sampleRate, int fs, int hopSize, FeatureSet features,
+                                        PitchMethod pitchMethod, bool pitchTracking, bool voiceBand,
+                                        HarmonicMethod harmonicMethod) {
+    if (initialized) {
+        LOGD("ParallelBufferAnalyzer already initialized");
+        return true;
+    }
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    LOGI("Starting %d analysis workers (sampleRate=%d, frameSize=%d)", numThreads, sampleRate, fs);
+
+    for (int i = 0; i < numThreads; ++i) {
+        auto wrapper = std::make_unique<EssentiaWrapper>();
+        wrapper->setPitchMethod(pitchMethod);
+        wrapper->setHarmonicMethod(harmonicMethod);
+        wrapper->setPitchTracking(pitchTracking);
+        wrapper->setVoiceBand(voiceBand);
+        if (!wrapper->initialize(sampleRate, fs, hopSize, features)) {
+            LOGE("Failed to initialize analyzer for worker %d", i);
+            wrappers.clear();
+            return false;
+        }
+        wrappers.push_back(std::move(wrapper));
+    }
+
+    frameSize = fs;
+    stopping = false;
+    generation = 0;
+    busyWorkers = 0;
+    initialized = true;
+
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(&ParallelBufferAnalyzer::workerLoop, this, i);
+    }
+
+    return true;
+}
+
+void ParallelBufferAnalyzer::workerLoop(int index) {
+    EssentiaWrapper& wrapper = *wrappers[index];
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            workReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        processChunks(wrapper);
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--busyWorkers == 0) {
+                workDone.notify_one();
+            }
+        }
+    }
+}
+
+void ParallelBufferAnalyzer::processChunks(EssentiaWrapper& wrapper) {
+    const int numChunks = (jobFrames + jobChunkSize - 1) / jobChunkSize;
+
+    for (int chunk = nextChunk.fetch_add(1); chunk < numChunks; chunk = nextChunk.fetch_add(1)) {
+        const int first = chunk * jobChunkSize;
+        const int last = std::min(first + jobChunkSize, jobFrames);
+
+        // Chunks are contiguous, so the pitch track only restarts per chunk
+        wrapper.resetPitchTrack();
+
+        for (int frame = first; frame < last; ++frame) {
+            frameValid[frame] = wrapper.analyzeFrame(jobBuffer + static_cast<size_t>(frame) * jobHopSize,
+                                                     frameSize, frameResults[frame]);
+        }
+    }
+}
+
+std::vector<AudioFeatures> ParallelBufferAnalyzer::analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize) {
+    std::vector<AudioFeatures> results;
+
+    if (!initialized || audioBuffer == nullptr || bufferLength < frameSize || hopSize <= 0) {
+        LOGE("Invalid parameters for parallel buffer analysis");
+        return results;
+    }
+
+    std::lock_guard<std::mutex> jobLock(jobMutex);
+
+    const int numFrames = (bufferLength - frameSize) / hopSize + 1;
+    const int numWorkers = getThreadCount();
+
+    // Result slots persist between jobs so their vectors keep their capacity
+    if (static_cast<int>(frameResults.size()) < numFrames) {
+        frameResults.resize(numFrames);
+    }
+    frameValid.assign(numFrames, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        jobBuffer = audioBuffer;
+        jobHopSize = hopSize;
+        jobFrames = numFrames;
+        jobChunkSize = std::max(1, numFrames / (numWorkers * kChunksPerWorker));
+        nextChunk.store(0);
+        busyWorkers = numWorkers;
+        ++generation;
+    }
+    workReady.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workDone.wait(lock, [&] { return busyWorkers == 0; });
+        jobBuffer = nullptr;
+    }
+
+    // Compact the valid frames, preserving frame order
+    int validCount = 0;
+    for (int i = 0; i < numFrames; ++i) {
+        validCount += frameValid[i];
+    }
+    results.reserve(validCount);
+    for (int i = 0; i < numFrames; ++i) {
+        if (frameValid[i]) {
+            results.push_back(frameResults[i]);
+        }
+    }
+
+    LOGD("Parallel buffer analysis complete: %d/%d frames valid on %d workers",
+         validCount, numFrames, numWorkers);
+    return results;
+}
+
+void ParallelBufferAnalyzer::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+
+    for (std::thread& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads.clear();
+
+    if (initialized) {
+        LOGI("Stopping analysis workers");
+    }
+    wrappers.clear();
+    frameResults.clear();
+    frameValid.clear();
+    initialized = false;
+}
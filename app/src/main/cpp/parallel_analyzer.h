@@ -0,0 +1,89 @@
+#ifndef PARALLEL_ANALYZER_H
+#define PARALLEL_ANALYZER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "essentia_wrapper.h"
+
+/**
+ * Fixed worker pool for buffer analysis.
+ *
+ * Essentia standard algorithms are stateful, so every worker owns its own
+ * EssentiaWrapper with an identical configuration. Frames are handed out in
+ * chunks through an atomic cursor and written to per-frame result slots, so
+ * the returned features are in frame order regardless of which worker
+ * produced them.
+ */
+class ParallelBufferAnalyzer {
+private:
+    std::vector<std::unique_ptr<EssentiaWrapper>> wrappers;
+    std::vector<std::thread> threads;
+
+    // Serializes analyzeBuffer() callers; one job runs at a time
+    std::mutex jobMutex;
+
+    // Worker hand-off
+    std::mutex stateMutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    uint64_t generation;
+    int busyWorkers;
+    bool stopping;
+
+    // Current job
+    const float* jobBuffer;
+    int jobHopSize;
+    int jobFrames;
+    int jobChunkSize;
+    std::atomic<int> nextChunk;
+    std::vector<AudioFeatures> frameResults;
+    std::vector<uint8_t> frameValid;
+
+    int frameSize;
+    bool initialized;
+
+    void workerLoop(int index);
+    void processChunks(EssentiaWrapper& wrapper);
+
+public:
+    ParallelBufferAnalyzer();
+    ~ParallelBufferAnalyzer();
+
+    /**
+     * Create one analyzer per worker and start the pool
+     * @param numThreads Worker count; <= 0 uses std::thread::hardware_concurrency()
+     */
+    bool initialize(int numThreads, int sampleRate = 44100, int frameSize = 1024, int hopSize = 512,
+                    FeatureSet features = kFeatureAll, PitchMethod pitchMethod = kPitchYinFft,
+                    bool pitchTracking = false, bool voiceBand = false,
+                    HarmonicMethod harmonicMethod = kHarmonicModel);
+
+    /**
+     * Analyze audio buffer with windowing across all workers.
+     * Same contract as EssentiaWrapper::analyzeBuffer: valid frames only, in order.
+     */
+    std::vector<AudioFeatures> analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize);
+
+    /**
+     * Stop the workers and release their analyzers
+     */
+    void cleanup();
+
+    /**
+     * Check if the pool is running
+     */
+    bool isReady() const { return initialized; }
+
+    /**
+     * Get number of workers
+     */
+    int getThreadCount() const { return static_cast<int>(wrappers.size()); }
+};
+
+#endif // PARALLEL_ANALYZER_H
@@ -0,0 +1,38 @@
+#include "pcm_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PCM_CONVERT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PCM_CONVERT_SSE2 1
+#endif
+
+void convertPcm16ToFloat(const int16_t* in, float* out, int count) {
+    int i = 0;
+
+#if defined(PCM_CONVERT_NEON)
+    const float32x4_t scale = vdupq_n_f32(kPcm16Scale);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t s = vld1q_s16(in + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        vst1q_f32(out + i, vmulq_f32(lo, scale));
+        vst1q_f32(out + i + 4, vmulq_f32(hi, scale));
+    }
+#elif defined(PCM_CONVERT_SSE2)
+    const __m128 scale = _mm_set1_ps(kPcm16Scale);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by placing each sample in the high half and shifting back down
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * kPcm16Scale;
+    }
+}
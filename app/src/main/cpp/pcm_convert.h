@@ -0,0 +1,17 @@
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+#include <cstdint>
+
+/**
+ * Scale applied to int16 PCM so that full scale maps to [-1, 1)
+ */
+static const float kPcm16Scale = 1.0f / 32768.0f;
+
+/**
+ * Convert count int16 PCM samples to float in [-1, 1).
+ * Uses NEON or SSE2 when the target supports them; in and out must not overlap.
+ */
+void convertPcm16ToFloat(const int16_t* in, float* out, int count);
+
+#endif // PCM_CONVERT_H
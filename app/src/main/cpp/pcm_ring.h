@@ -0,0 +1,221 @@
+#ifndef PCM_RING_H
+#define PCM_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Assumed cache line size; each side's indices get a line of their own
+ */
+static const int kRingCacheLine = 64;
+
+/**
+ * Wait-free single-producer/single-consumer ring of PCM samples (int16_t
+ * or float), meant to sit between the capture thread and the analyzer.
+ *
+ * The producer either copies samples in with write() or fills the span
+ * from writeSpan() in place (e.g. straight from AudioRecord through the
+ * JNI direct buffer over data()) and publishes it with commit(). The
+ * consumer looks at any run of up to maxSpan samples as one contiguous
+ * array with peek() and releases samples with consume(), so overlapping
+ * frames are read where they lie with no copy.
+ *
+ * Contiguous reads across the wrap come from a mirror: the first maxSpan
+ * slots are duplicated after the last one, and commit() copies only what
+ * lands in that head region, at most maxSpan samples per lap.
+ *
+ * Each index is written by one side only and published with release
+ * stores. Each side keeps a cached copy of the other's index and reloads it
+ * only when the cached value leaves too little room (producer) or too few
+ * samples (consumer), so the indices' cache lines rarely move between
+ * cores. When the ring is full, write() keeps what fits and counts the rest
+ * as dropped. It never blocks and never overwrites unread samples.
+ *
+ * Exactly one thread may call the producer methods and one the consumer
+ * methods; getters of the other side's state are approximate.
+ */
+template <typename T>
+class SpscRing {
+private:
+    // Read-only after construction
+    alignas(kRingCacheLine) int capacity;   // Power of two
+    int mask;
+    int maxSpan;
+    std::vector<T> storage;                 // capacity + maxSpan; the tail mirrors the head
+
+    // Producer line
+    alignas(kRingCacheLine) std::atomic<int64_t> writeIndex;
+    int64_t cachedReadIndex;
+    std::atomic<int64_t> dropped;
+
+    // Consumer line
+    alignas(kRingCacheLine) std::atomic<int64_t> readIndex;
+    int64_t cachedWriteIndex;
+
+    // Free samples, reloading the consumer's index only if the cached one
+    // leaves fewer than wanted (producer side)
+    int freeSamples(int wanted) {
+        const int64_t w = writeIndex.load(std::memory_order_relaxed);
+        if (capacity - (w - cachedReadIndex) < wanted) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+        }
+        return capacity - static_cast<int>(w - cachedReadIndex);
+    }
+
+    // Readable samples, reloading the producer's index only if the cached
+    // one leaves fewer than wanted (consumer side)
+    int pendingSamples(int wanted) {
+        const int64_t r = readIndex.load(std::memory_order_relaxed);
+        if (cachedWriteIndex - r < wanted) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+        }
+        return static_cast<int>(cachedWriteIndex - r);
+    }
+
+public:
+    /**
+     * @param minCapacity Samples held, rounded up to a power of two
+     * @param maxSpan Longest contiguous peek(), e.g. the analysis frame size;
+     *        clamped to the capacity
+     */
+    SpscRing(int minCapacity, int maxSpan)
+            : capacity(1)
+            , mask(0)
+            , maxSpan(0)
+            , writeIndex(0)
+            , cachedReadIndex(0)
+            , dropped(0)
+            , readIndex(0)
+            , cachedWriteIndex(0) {
+        while (capacity < minCapacity) capacity <<= 1;
+        mask = capacity - 1;
+        this->maxSpan = std::max(1, std::min(maxSpan, capacity));
+        storage.assign(static_cast<size_t>(capacity) + this->maxSpan, T());
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    int getCapacity() const { return capacity; }
+    int getMaxSpan() const { return maxSpan; }
+
+    /**
+     * Backing store, capacity + maxSpan samples, for exposing to the
+     * producer (slot i holds ring position i)
+     */
+    T* data() { return storage.data(); }
+    size_t storageBytes() const { return storage.size() * sizeof(T); }
+
+    /** Samples write() could not fit, since construction */
+    int64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    /** Total samples committed / consumed since construction */
+    int64_t getWritten() const { return writeIndex.load(std::memory_order_acquire); }
+    int64_t getConsumed() const { return readIndex.load(std::memory_order_acquire); }
+
+    // --- Producer ---
+
+    /**
+     * Free samples
+     */
+    int writable() { return freeSamples(capacity); }
+
+    /**
+     * Contiguous free span at the write position, up to the end of the
+     * ring (so a full refill may take two spans)
+     * @param length Set to the span's length in samples, 0 if the ring is full
+     * @return Ring position (index into data()) of the span's first sample
+     */
+    int writeSpan(int& length) {
+        const int position = static_cast<int>(writeIndex.load(std::memory_order_relaxed) & mask);
+        length = std::min(freeSamples(1), capacity - position);
+        return position;
+    }
+
+    /**
+     * Publish n samples written into the current writeSpan()
+     */
+    void commit(int n) {
+        const int64_t w = writeIndex.load(std::memory_order_relaxed);
+        const int position = static_cast<int>(w & mask);
+        const int mirrorEnd = std::min(position + n, maxSpan);
+        if (position < mirrorEnd) {
+            T* base = storage.data();
+            std::memcpy(base + capacity + position, base + position, (mirrorEnd - position) * sizeof(T));
+        }
+        writeIndex.store(w + n, std::memory_order_release);
+    }
+
+    /**
+     * Copy in as many of n samples as fit; the rest are counted as dropped
+     * @return Samples written
+     */
+    int write(const T* samples, int n) {
+        int written = 0;
+        while (written < n) {
+            int length = 0;
+            const int position = writeSpan(length);
+            length = std::min(length, n - written);
+            if (length == 0) break;
+            std::memcpy(storage.data() + position, samples + written, length * sizeof(T));
+            commit(length);
+            written += length;
+        }
+        drop(n - written);
+        return written;
+    }
+
+    /**
+     * Count n samples the producer had no room for (write() does this
+     * itself; for producers filling writeSpan() directly)
+     */
+    void drop(int n) {
+        if (n > 0) dropped.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // --- Consumer ---
+
+    /**
+     * Samples committed and not yet consumed
+     */
+    int readable() { return pendingSamples(capacity); }
+
+    /**
+     * The next n samples as one array, without consuming them, or nullptr
+     * if fewer than n are readable or n exceeds maxSpan. Valid until the
+     * samples are consumed.
+     */
+    const T* peek(int n) {
+        if (n > maxSpan || n > pendingSamples(n)) return nullptr;
+        return storage.data() + (readIndex.load(std::memory_order_relaxed) & mask);
+    }
+
+    /**
+     * Copy out and consume up to n samples
+     * @return Samples read
+     */
+    int read(T* out, int n) {
+        n = std::min(n, pendingSamples(n));
+        const int position = static_cast<int>(readIndex.load(std::memory_order_relaxed) & mask);
+        const int first = std::min(n, capacity - position);
+        std::memcpy(out, storage.data() + position, first * sizeof(T));
+        std::memcpy(out + first, storage.data(), (n - first) * sizeof(T));
+        consume(n);
+        return n;
+    }
+
+    /**
+     * Release n readable samples to the producer
+     */
+    void consume(int n) {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+};
+
+typedef SpscRing<int16_t> PcmRing16;
+typedef SpscRing<float> PcmRingFloat;
+
+#endif // PCM_RING_H
@@ -0,0 +1,285 @@
+#include "pipelined_analyzer.h"
+#include "pcm_convert.h"
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "PipelinedAnalyzer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+// Records beyond one per stage: one being filled by the submitter and one
+// being read by the receiver, so neither holds up the stages
+static const int kExtraRecords = 2;
+
+// Empty polls (with a yield each) before a consumer goes to sleep. A stage
+// takes well under a millisecond, so the next frame usually turns up
+// within the spin and the hand-off costs no wake-up.
+static const int kSpinPolls = 64;
+
+// Upper bound on one sleep, in case a wake-up is missed
+static const int kWakeTimeoutMillis = 5;
+
+// ---------------------------------------------------------------------------
+// StageQueue
+// ---------------------------------------------------------------------------
+
+StageQueue::StageQueue(int capacity)
+        : ring(capacity, 1)
+        , sleepers(0) {
+}
+
+void StageQueue::push(int32_t index) {
+    ring.write(&index, 1);
+    // Pairs with the fence in pop(): either the consumer sees the index
+    // before sleeping, or we see it asleep and ring
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bell.notify_one();
+    }
+}
+
+bool StageQueue::tryPop(int32_t& index) {
+    return ring.read(&index, 1) == 1;
+}
+
+bool StageQueue::pop(int32_t& index, const std::atomic<bool>& stop) {
+    for (int polls = 0;; ++polls) {
+        if (tryPop(index)) return true;
+        if (stop.load(std::memory_order_acquire)) return false;
+        if (polls < kSpinPolls) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring.readable() == 0 && !stop.load(std::memory_order_acquire)) {
+            bell.wait_for(lock, std::chrono::milliseconds(kWakeTimeoutMillis));
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void StageQueue::wake() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bell.notify_all();
+}
+
+// ---------------------------------------------------------------------------
+// PipelinedAnalyzer
+// ---------------------------------------------------------------------------
+
+PipelinedAnalyzer::PipelinedAnalyzer()
+        : stopping(false)
+        , frameSize(0)
+        , hopSize(0)
+        , nextSequence(0)
+        , restartPending(true)
+        , inFlight(0)
+        , stalls(0)
+        , initialized(false) {
+}
+
+PipelinedAnalyzer::~PipelinedAnalyzer() {
+    cleanup();
+}
+
+bool PipelinedAnalyzer::initialize(int sampleRate, int fs, int hs, FeatureSet features, PitchMethod pitchMethod,
+                                   bool pitchTracking, bool voiceBand, HarmonicMethod harmonicMethod, int depth) {
+    if (initialized) {
+        LOGD("PipelinedAnalyzer already initialized");
+        return true;
+    }
+
+    depth = std::max(depth, kAnalysisStageCount + kExtraRecords);
+    LOGI("Starting %d-stage analysis pipeline (sampleRate=%d, frameSize=%d, depth=%d)",
+         kAnalysisStageCount, sampleRate, fs, depth);
+
+    for (int i = 0; i < kAnalysisStageCount; ++i) {
+        auto wrapper = std::make_unique<EssentiaWrapper>();
+        wrapper->setPitchMethod(pitchMethod);
+        wrapper->setHarmonicMethod(harmonicMethod);
+        wrapper->setPitchTracking(pitchTracking);
+        wrapper->setVoiceBand(voiceBand);
+        if (!wrapper->initialize(sampleRate, fs, hs, features)) {
+            LOGE("Failed to initialize analyzer for stage %d", i);
+            stageWrappers.clear();
+            return false;
+        }
+        stageWrappers.push_back(std::move(wrapper));
+    }
+
+    records.resize(depth);
+    for (StageFrame& record : records) {
+        stageWrappers[0]->prepareStageFrame(record);
+    }
+
+    // Every queue can hold every record, so push() never finds one full
+    for (int i = 0; i < kAnalysisStageCount + 2; ++i) {
+        queues.push_back(std::make_unique<StageQueue>(depth));
+    }
+    for (int32_t i = 0; i < depth; ++i) {
+        queues[0]->push(i);
+    }
+
+    frameSize = fs;
+    hopSize = hs;
+    nextSequence = 0;
+    restartPending = true;
+    inFlight.store(0);
+    stalls.store(0);
+    stopping.store(false);
+    initialized = true;
+
+    for (int stage = 0; stage < kAnalysisStageCount; ++stage) {
+        threads.emplace_back(&PipelinedAnalyzer::stageLoop, this, stage);
+    }
+    return true;
+}
+
+void PipelinedAnalyzer::stageLoop(int stage) {
+    EssentiaWrapper& wrapper = *stageWrappers[stage];
+    StageQueue& in = *queues[1 + stage];
+    StageQueue& out = *queues[2 + stage];
+    const AnalysisStage analysisStage = static_cast<AnalysisStage>(stage);
+
+    int32_t index;
+    while (in.pop(index, stopping)) {
+        wrapper.runStage(analysisStage, records[index]);
+        out.push(index);
+    }
+}
+
+bool PipelinedAnalyzer::claimRecord(int32_t& index, bool wait) {
+    if (!initialized) {
+        LOGE("PipelinedAnalyzer not initialized");
+        return false;
+    }
+    if (queues[0]->tryPop(index)) {
+        return true;
+    }
+    stalls.fetch_add(1, std::memory_order_relaxed);
+    return wait && queues[0]->pop(index, stopping);
+}
+
+void PipelinedAnalyzer::submitRecord(int32_t index) {
+    StageFrame& record = records[index];
+    record.sequence = ++nextSequence;
+    record.restartTrack = restartPending;
+    restartPending = false;
+    inFlight.fetch_add(1, std::memory_order_relaxed);
+    queues[1]->push(index);
+}
+
+bool PipelinedAnalyzer::submit(const float* frame) {
+    int32_t index;
+    if (frame == nullptr || !claimRecord(index, true)) {
+        return false;
+    }
+    std::copy(frame, frame + frameSize, records[index].input.begin());
+    submitRecord(index);
+    return true;
+}
+
+bool PipelinedAnalyzer::trySubmit(const float* frame) {
+    int32_t index;
+    if (frame == nullptr || !claimRecord(index, false)) {
+        return false;
+    }
+    std::copy(frame, frame + frameSize, records[index].input.begin());
+    submitRecord(index);
+    return true;
+}
+
+bool PipelinedAnalyzer::trySubmitPcm16(const int16_t* frame) {
+    int32_t index;
+    if (frame == nullptr || !claimRecord(index, false)) {
+        return false;
+    }
+    convertPcm16ToFloat(frame, records[index].input.data(), frameSize);
+    submitRecord(index);
+    return true;
+}
+
+bool PipelinedAnalyzer::receive(AudioFeatures& features, bool& valid) {
+    int32_t index;
+    if (!initialized || inFlight.load(std::memory_order_relaxed) == 0
+        || !queues[kAnalysisStageCount + 1]->pop(index, stopping)) {
+        return false;
+    }
+    const StageFrame& record = records[index];
+    features = record.features;
+    valid = record.active;
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+    queues[0]->push(index);
+    return true;
+}
+
+bool PipelinedAnalyzer::tryReceive(AudioFeatures& features, bool& valid) {
+    int32_t index;
+    if (!initialized || !queues[kAnalysisStageCount + 1]->tryPop(index)) {
+        return false;
+    }
+    const StageFrame& record = records[index];
+    features = record.features;
+    valid = record.active;
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+    queues[0]->push(index);
+    return true;
+}
+
+std::vector<AudioFeatures> PipelinedAnalyzer::analyzeBuffer(const float* audioBuffer, int bufferLength, int hs) {
+    std::vector<AudioFeatures> results;
+
+    if (!initialized || audioBuffer == nullptr || bufferLength < frameSize || hs <= 0) {
+        LOGE("Invalid parameters for pipelined buffer analysis");
+        return results;
+    }
+
+    const int numFrames = (bufferLength - frameSize) / hs + 1;
+    results.reserve(numFrames);
+    restartStream();
+
+    AudioFeatures features;
+    bool valid = false;
+    for (int i = 0; i < numFrames; ++i) {
+        // Collect finished frames whenever every record is taken
+        while (!trySubmit(audioBuffer + static_cast<size_t>(i) * hs)) {
+            if (!receive(features, valid)) return results;
+            if (valid) results.push_back(features);
+        }
+    }
+    while (receive(features, valid)) {
+        if (valid) results.push_back(features);
+    }
+
+    LOGD("Pipelined buffer analysis complete: %zu/%d frames valid", results.size(), numFrames);
+    return results;
+}
+
+void PipelinedAnalyzer::cleanup() {
+    stopping.store(true, std::memory_order_release);
+    for (std::unique_ptr<StageQueue>& queue : queues) {
+        queue->wake();
+    }
+
+    for (std::thread& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads.clear();
+
+    if (initialized) {
+        LOGI("Stopping analysis pipeline (%lld stalled submits)", static_cast<long long>(stalls.load()));
+    }
+    queues.clear();
+    records.clear();
+    stageWrappers.clear();
+    inFlight.store(0);
+    initialized = false;
+}
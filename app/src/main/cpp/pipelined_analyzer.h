@@ -0,0 +1,166 @@
+#ifndef PIPELINED_ANALYZER_H
+#define PIPELINED_ANALYZER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "essentia_wrapper.h"
+#include "pcm_ring.h"
+
+/**
+ * Bounded queue of StageFrame indices between two pipeline threads: an
+ * SPSC ring, plus a condition variable the consumer sleeps on only after
+ * finding the ring empty for a while, so the data path takes no lock.
+ */
+class StageQueue {
+private:
+    SpscRing<int32_t> ring;
+    std::atomic<int> sleepers;
+    std::mutex mutex;
+    std::condition_variable bell;
+
+public:
+    explicit StageQueue(int capacity);
+
+    /**
+     * Append an index (producer). Never fails: every queue can hold all
+     * of the pipeline's frames.
+     */
+    void push(int32_t index);
+
+    /**
+     * Take the next index if there is one (consumer)
+     */
+    bool tryPop(int32_t& index);
+
+    /**
+     * Take the next index, waiting for one (consumer)
+     * @return false if stop was set first
+     */
+    bool pop(int32_t& index, const std::atomic<bool>& stop);
+
+    /**
+     * Wake a waiting consumer so it notices stop
+     */
+    void wake();
+};
+
+/**
+ * Runs analyzeFrame as a three-stage pipeline, one thread per stage:
+ * front end (DC removal, window, FFT), spectral (pitch, moments, HNR) and
+ * envelope (MFCC, LPC, formants). Each stage owns an EssentiaWrapper with
+ * the same configuration and runs only its part of the frame, so on a
+ * multi-core device three consecutive frames are analyzed at once.
+ *
+ * Frames travel in a fixed set of preallocated StageFrame records, passed
+ * between stages through lock-free StageQueues. A frame is submitted by
+ * taking a free record; when all are in flight the submitter waits
+ * (backpressure) until the receiver returns one, so memory is bounded and
+ * the stages never allocate. Results come out in submission order. With
+ * the default depth a frame waits for at most one other frame per stage,
+ * so its latency stays near the sum of the stage times while throughput
+ * is set by the slowest stage alone.
+ *
+ * Submitting and receiving may happen on two different threads, one each.
+ * A single thread doing both must use trySubmit() and receive results
+ * whenever it fails, as analyzeBuffer() does, or it waits on itself.
+ */
+class PipelinedAnalyzer {
+private:
+    std::vector<std::unique_ptr<EssentiaWrapper>> stageWrappers;   // One per stage
+    std::vector<StageFrame> records;
+    // queues[0]: free records; queues[1 + s]: waiting for stage s;
+    // queues[kAnalysisStageCount + 1]: finished, waiting for receive()
+    std::vector<std::unique_ptr<StageQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping;
+
+    int frameSize;
+    int hopSize;
+    uint32_t nextSequence;
+    bool restartPending;    // Next submitted frame starts a new stream
+    std::atomic<int> inFlight;      // Submitted and not yet received
+    std::atomic<int64_t> stalls;    // Submits that found no free record
+    bool initialized;
+
+    void stageLoop(int stage);
+    bool claimRecord(int32_t& index, bool wait);
+    void submitRecord(int32_t index);
+
+public:
+    PipelinedAnalyzer();
+    ~PipelinedAnalyzer();
+
+    /**
+     * Create the stage analyzers and start the stage threads
+     * @param depth Frame records in flight; at least one per stage plus
+     *        one being submitted and one being received
+     */
+    bool initialize(int sampleRate = 44100, int frameSize = 1024, int hopSize = 512,
+                    FeatureSet features = kFeatureAll, PitchMethod pitchMethod = kPitchYinFft,
+                    bool pitchTracking = false, bool voiceBand = false,
+                    HarmonicMethod harmonicMethod = kHarmonicModel, int depth = 0);
+
+    /**
+     * Queue a frame of frameSize samples, waiting while all records are in
+     * flight. Returns false if the pipeline is not running.
+     */
+    bool submit(const float* frame);
+
+    /**
+     * Queue a frame if a record is free; false (and nothing queued) if not
+     */
+    bool trySubmit(const float* frame);
+    bool trySubmitPcm16(const int16_t* frame);
+
+    /**
+     * Take the next finished frame in submission order, waiting for it.
+     * Returns false if nothing is in flight; otherwise copies its features
+     * (reusing their capacity) and sets valid.
+     */
+    bool receive(AudioFeatures& features, bool& valid);
+
+    /**
+     * As receive(), but returns false instead of waiting if the next frame
+     * is not finished yet
+     */
+    bool tryReceive(AudioFeatures& features, bool& valid);
+
+    /**
+     * The next submitted frame starts a new stream: the pitch track is
+     * dropped before it is analyzed
+     */
+    void restartStream() { restartPending = true; }
+
+    /**
+     * Analyze a buffer through the pipeline. Same contract as
+     * EssentiaWrapper::analyzeBuffer: valid frames only, in order. In voice
+     * band mode frames are resampled one by one, as analyzeFrame does.
+     */
+    std::vector<AudioFeatures> analyzeBuffer(const float* audioBuffer, int bufferLength, int hopSize);
+
+    /**
+     * Stop the stage threads and release their analyzers. Frames still in
+     * flight are discarded.
+     */
+    void cleanup();
+
+    bool isReady() const { return initialized; }
+
+    int getDepth() const { return static_cast<int>(records.size()); }
+    int getInFlight() const { return inFlight.load(std::memory_order_relaxed); }
+    int getFrameSize() const { return frameSize; }
+    int getHopSize() const { return hopSize; }
+
+    /**
+     * Submits that had to wait for a free record, since initialize()
+     */
+    int64_t getStalls() const { return stalls.load(std::memory_order_relaxed); }
+};
+
+#endif // PIPELINED_ANALYZER_H
@@ -0,0 +1,211 @@
+#include "pitch_tracker.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+// Half-width of the lag window searched around the expected period, as a
+// ratio. 0.2 is about +-3 semitones per hop, well above speech glides.
+static const float kSearchSpan = 0.2f;
+
+// NSDF peaks below this clarity are not considered as candidates
+static const float kMinClarity = 0.2f;
+
+// Path costs. A voiced candidate costs 1 - clarity, the unvoiced state a
+// constant; with the voicing switch cost this starts a track at clarity
+// 0.5 (the old confidence gate) and only drops it below clarity 0.3.
+static const float kUnvoicedCost = 0.6f;
+static const float kVoicingCost = 0.1f;
+
+// Cost per octave of pitch movement between frames
+static const float kJumpCost = 1.0f;
+
+// A track held below this clarity asks for a full-range seed again
+static const float kWeakClarity = 0.8f;
+
+PitchTracker::PitchTracker()
+        : sampleRate(0.0f)
+        , frameSize(0)
+        , minLag(0)
+        , maxLag(0)
+        , locked(false)
+        , trackedLag(0.0f)
+        , trackedClarity(0.0f)
+        , lagsSearched(0)
+        , previousCount(0) {
+}
+
+bool PitchTracker::configure(float newSampleRate, int newFrameSize, float minHz, float maxHz) {
+    if (newSampleRate <= 0.0f || newFrameSize < 8 || minHz <= 0.0f || maxHz <= minHz) {
+        return false;
+    }
+
+    // Keep at least half the frame overlapping at the longest lag, the same
+    // limit YIN has
+    const int lo = std::max(2, static_cast<int>(newSampleRate / maxHz));
+    const int hi = std::min(newFrameSize / 2, static_cast<int>(std::ceil(newSampleRate / minHz)));
+    if (hi <= lo + 1) {
+        return false;
+    }
+
+    sampleRate = newSampleRate;
+    frameSize = newFrameSize;
+    minLag = lo;
+    maxLag = hi;
+    energyPrefix.assign(frameSize + 1, 0.0);
+    nsdf.assign(maxLag + 2, 0.0f);
+    reset();
+    return true;
+}
+
+void PitchTracker::reset() {
+    locked = false;
+    trackedLag = 0.0f;
+    trackedClarity = 0.0f;
+    lagsSearched = 0;
+    previous[0].hz = 0.0f;
+    previous[0].cost = 0.0f;
+    previousCount = 1;
+}
+
+bool PitchTracker::needsSeed() const {
+    return !locked || trackedClarity < kWeakClarity;
+}
+
+void PitchTracker::markUnvoiced() {
+    reset();
+}
+
+float PitchTracker::nsdfAt(const float* frame, int lag) const {
+    const int n = frameSize - lag;
+    const double r = simdDot(frame, frame + lag, n);
+
+    // Energy of both overlapping segments from the running sum
+    const double m = energyPrefix[n] + (energyPrefix[frameSize] - energyPrefix[lag]);
+    return m > 0.0 ? static_cast<float>(2.0 * r / m) : 0.0f;
+}
+
+void PitchTracker::computeEnergyPrefix(const float* frame) {
+    double sum = 0.0;
+    energyPrefix[0] = 0.0;
+    for (int i = 0; i < frameSize; ++i) {
+        sum += static_cast<double>(frame[i]) * frame[i];
+        energyPrefix[i + 1] = sum;
+    }
+}
+
+int PitchTracker::findCandidates(const float* frame, float centreLag, float* hz, float* clarity, int count) {
+    const int lo = std::max(minLag, static_cast<int>(centreLag / (1.0f + kSearchSpan)));
+    const int hi = std::min(maxLag, static_cast<int>(std::ceil(centreLag * (1.0f + kSearchSpan))));
+    if (hi - lo < 2) {
+        return count;
+    }
+
+    for (int lag = lo; lag <= hi; ++lag) {
+        nsdf[lag] = nsdfAt(frame, lag);
+    }
+    lagsSearched += hi - lo + 1;
+
+    // Local maxima strictly inside the window, merged into the candidate
+    // list strongest first
+    for (int lag = lo + 1; lag < hi; ++lag) {
+        const float a = nsdf[lag - 1];
+        const float b = nsdf[lag];
+        const float c = nsdf[lag + 1];
+        if (b < kMinClarity || b < a || b <= c) continue;
+
+        // Parabolic interpolation of the peak position and height
+        float offset = 0.0f;
+        float peak = b;
+        const float den = a - 2.0f * b + c;
+        if (den < 0.0f) {
+            offset = 0.5f * (a - c) / den;
+            peak = b - 0.25f * (a - c) * offset;
+        }
+
+        const float candidateHz = sampleRate / (lag + offset);
+        const float candidateClarity = std::min(peak, 1.0f);
+
+        int pos = std::min(count, kMaxCandidates - 1);
+        if (count == kMaxCandidates && clarity[pos] >= candidateClarity) continue;
+        while (pos > 0 && clarity[pos - 1] < candidateClarity) {
+            hz[pos] = hz[pos - 1];
+            clarity[pos] = clarity[pos - 1];
+            --pos;
+        }
+        hz[pos] = candidateHz;
+        clarity[pos] = candidateClarity;
+        count = std::min(count + 1, kMaxCandidates);
+    }
+    return count;
+}
+
+float PitchTracker::update(const float* frame, float seedHz, float& confidence) {
+    confidence = 0.0f;
+    lagsSearched = 0;
+    if (frameSize == 0 || frame == nullptr) {
+        return 0.0f;
+    }
+
+    // Narrow search around the tracked period, plus around the seed when
+    // one was supplied and it falls outside the tracked window
+    float hz[kMaxCandidates];
+    float clarity[kMaxCandidates];
+    int count = 0;
+    const float seedLag = seedHz > 0.0f ? sampleRate / seedHz : 0.0f;
+    if (locked || seedLag > 0.0f) {
+        computeEnergyPrefix(frame);
+    }
+    if (locked) {
+        count = findCandidates(frame, trackedLag, hz, clarity, count);
+    }
+    if (seedLag > 0.0f &&
+        (!locked || std::fabs(std::log2(seedLag / trackedLag)) > 2.0f * std::log2(1.0f + kSearchSpan))) {
+        count = findCandidates(frame, seedLag, hz, clarity, count);
+    }
+
+    // One Viterbi step over candidates + unvoiced. Decisions are taken on
+    // the current frame (no lookahead), so output latency is unchanged.
+    State current[kMaxCandidates + 1];
+    for (int j = 0; j <= count; ++j) {
+        const bool voiced = j < count;
+        current[j].hz = voiced ? hz[j] : 0.0f;
+        const float local = voiced ? 1.0f - clarity[j] : kUnvoicedCost;
+
+        float best = HUGE_VALF;
+        for (int i = 0; i < previousCount; ++i) {
+            float transition = 0.0f;
+            if (previous[i].hz > 0.0f && voiced) {
+                transition = kJumpCost * std::fabs(std::log2(current[j].hz / previous[i].hz));
+            } else if ((previous[i].hz > 0.0f) != voiced) {
+                transition = kVoicingCost;
+            }
+            best = std::min(best, previous[i].cost + transition);
+        }
+        current[j].cost = local + best;
+    }
+
+    int chosen = 0;
+    for (int j = 1; j <= count; ++j) {
+        if (current[j].cost < current[chosen].cost) chosen = j;
+    }
+
+    // Keep costs relative to the best path so they stay bounded
+    const float base = current[chosen].cost;
+    for (int j = 0; j <= count; ++j) {
+        previous[j].hz = current[j].hz;
+        previous[j].cost = current[j].cost - base;
+    }
+    previousCount = count + 1;
+
+    if (chosen == count) {
+        locked = false;
+        trackedClarity = 0.0f;
+        return 0.0f;
+    }
+
+    locked = true;
+    trackedLag = sampleRate / hz[chosen];
+    trackedClarity = clarity[chosen];
+    confidence = clarity[chosen];
+    return hz[chosen];
+}
@@ -0,0 +1,97 @@
+#ifndef PITCH_TRACKER_H
+#define PITCH_TRACKER_H
+
+#include <vector>
+
+/**
+ * Cross-frame f0 tracker for one audio stream.
+ *
+ * While locked onto a voice, each frame evaluates the normalized square
+ * difference function (NSDF) only over a narrow lag window around the
+ * previous period, instead of the full lag range. Peaks in that window are
+ * the frame's f0 candidates; together with an unvoiced state they are
+ * scored by an online Viterbi pass whose transition cost grows with the
+ * pitch interval, so octave jumps need sustained evidence rather than one
+ * ambiguous frame. When the best path goes unvoiced, or holds only with
+ * weak clarity (e.g. locked onto an octave error at a voicing onset), the
+ * caller supplies a full-range estimate (the seed) and the window around
+ * it is searched as well.
+ *
+ * Buffers are sized in configure(); update() never allocates.
+ * Not thread-safe; use one tracker per analyzer.
+ */
+class PitchTracker {
+public:
+    static constexpr int kMaxCandidates = 4;
+
+private:
+    struct State {
+        float hz;       // 0 for the unvoiced state
+        float cost;     // Accumulated path cost
+    };
+
+    float sampleRate;
+    int frameSize;
+    int minLag;
+    int maxLag;
+    bool locked;
+    float trackedLag;
+    float trackedClarity;
+    int lagsSearched;
+
+    State previous[kMaxCandidates + 1];
+    int previousCount;
+
+    std::vector<double> energyPrefix;   // Running sum of x^2, frameSize + 1
+    std::vector<float> nsdf;            // Indexed by lag, maxLag + 2
+
+    float nsdfAt(const float* frame, int lag) const;
+    void computeEnergyPrefix(const float* frame);
+    int findCandidates(const float* frame, float centreLag, float* hz, float* clarity, int count);
+
+public:
+    PitchTracker();
+
+    /**
+     * Set the stream parameters and the f0 range. Drops any tracking state.
+     * Returns false if the range does not fit in the frame.
+     */
+    bool configure(float sampleRate, int frameSize, float minHz, float maxHz);
+
+    /**
+     * Forget the track (e.g. at a discontinuity in the audio)
+     */
+    void reset();
+
+    /**
+     * True while the previous frame was tracked as voiced
+     */
+    bool isLocked() const { return locked; }
+
+    /**
+     * True when the next update() should get a full-range seed: the track
+     * is lost or held with weak clarity
+     */
+    bool needsSeed() const;
+
+    /**
+     * Track one frame.
+     * @param frame frameSize samples, DC removed, not windowed
+     * @param seedHz Full-range estimate, searched in addition to the track; <= 0 if none
+     * @param confidence Receives the NSDF clarity of the tracked peak, 0 if unvoiced
+     * @return Tracked f0 in Hz, or 0 for an unvoiced frame
+     */
+    float update(const float* frame, float seedHz, float& confidence);
+
+    /**
+     * Record a frame that was skipped (e.g. below the energy gate) as unvoiced
+     */
+    void markUnvoiced();
+
+    /**
+     * Lags evaluated by the last update(), for profiling
+     */
+    int getLagsSearched() const { return lagsSearched; }
+};
+
+#endif // PITCH_TRACKER_H
@@ -0,0 +1,185 @@
+#include "resampler.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Zero crossings of the sinc on each side of the centre, at the lower of
+// the two rates. With the Kaiser window below this gives a transition band
+// of about 0.15 of the output rate, centred on the cutoff.
+static const int kHalfLength = 12;
+
+// -6 dB point of the filter as a fraction of the lower Nyquist frequency.
+// Leaves the band below about 0.4 of the output rate flat and alias-free.
+static const double kCutoff = 0.95;
+
+// Kaiser window shape for about 60 dB of stopband rejection
+static const double kKaiserBeta = 5.65;
+
+struct PolyphaseResampler::FilterBank {
+    int up;
+    int down;
+    int taps;                   // Per phase
+    std::vector<float> coeffs;  // up phases of taps, each in input order (oldest sample first)
+};
+
+// Filter tables by reduced ratio, shared while any resampler holds them
+static std::mutex s_bankMutex;
+static std::map<std::pair<int, int>, std::weak_ptr<const PolyphaseResampler::FilterBank>> s_banks;
+
+// Zeroth-order modified Bessel function of the first kind
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        const double half = x / (2.0 * k);
+        term *= half * half;
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+static std::shared_ptr<const PolyphaseResampler::FilterBank> designBank(int up, int down) {
+    auto bank = std::make_shared<PolyphaseResampler::FilterBank>();
+    bank->up = up;
+    bank->down = down;
+
+    // Enough taps per phase to span kHalfLength zero crossings of the
+    // cutoff either side of the centre
+    const int ratio = std::max(1, (down + up - 1) / up);
+    bank->taps = 2 * kHalfLength * ratio;
+
+    // Prototype low-pass at the upsampled rate (up * inputRate), centred at
+    // index length / 2, with unity gain per phase
+    const int length = up * bank->taps;
+    const double centre = length / 2.0;
+    const double cutoff = kCutoff * 0.5 / std::max(up, down);   // Cycles per upsampled sample
+    const double windowNorm = besselI0(kKaiserBeta);
+    std::vector<double> prototype(length);
+    double total = 0.0;
+    for (int n = 0; n < length; ++n) {
+        const double t = n - centre;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = (t == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        const double r = t / centre;
+        const double window = (std::fabs(r) < 1.0) ? besselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / windowNorm : 0.0;
+        prototype[n] = sinc * window;
+        total += prototype[n];
+    }
+
+    // Phase p holds prototype[p + j * up]; stored reversed in j so the dot
+    // product runs over the input in increasing time
+    bank->coeffs.resize(length);
+    const double gain = up / total;
+    for (int p = 0; p < up; ++p) {
+        for (int i = 0; i < bank->taps; ++i) {
+            const int j = bank->taps - 1 - i;
+            bank->coeffs[p * bank->taps + i] = static_cast<float>(prototype[p + j * up] * gain);
+        }
+    }
+    return bank;
+}
+
+PolyphaseResampler::PolyphaseResampler()
+        : up(1)
+        , down(1) {
+}
+
+bool PolyphaseResampler::configure(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) {
+        return false;
+    }
+
+    const int divisor = std::gcd(inputRate, outputRate);
+    const int newUp = outputRate / divisor;
+    const int newDown = inputRate / divisor;
+
+    std::lock_guard<std::mutex> lock(s_bankMutex);
+    std::weak_ptr<const FilterBank>& cached = s_banks[std::make_pair(newUp, newDown)];
+    std::shared_ptr<const FilterBank> shared = cached.lock();
+    if (!shared) {
+        shared = designBank(newUp, newDown);
+        cached = shared;
+    }
+
+    bank = std::move(shared);
+    up = newUp;
+    down = newDown;
+    return true;
+}
+
+int PolyphaseResampler::getTapsPerOutput() const {
+    return bank ? bank->taps : 0;
+}
+
+int PolyphaseResampler::outputLength(int inputLength) const {
+    if (inputLength <= 0) return 0;
+    return static_cast<int>((static_cast<long long>(inputLength) * up + down - 1) / down);
+}
+
+void PolyphaseResampler::resample(const float* input, int inputLength, float* output, int outputCount) const {
+    if (!bank || input == nullptr || output == nullptr || inputLength <= 0) {
+        return;
+    }
+    outputCount = std::min(outputCount, outputLength(inputLength));
+
+    const int taps = bank->taps;
+    const float* coeffs = bank->coeffs.data();
+
+    // Output k is centred on input time k * down / up: its window starts
+    // taps / 2 - 1 samples before floor(k * down / up), with phase
+    // (k * down) mod up
+    int base = 0;
+    int phase = 0;
+    for (int k = 0; k < outputCount; ++k) {
+        const int first = base - taps / 2 + 1;
+        const float* c = coeffs + phase * taps;
+
+        if (first >= 0 && first + taps <= inputLength) {
+            output[k] = simdDot(c, input + first, taps);
+        } else {
+            // Block edge: samples outside the input are zero
+            const int begin = std::max(0, -first);
+            const int end = std::min(taps, inputLength - first);
+            float acc = 0.0f;
+            for (int i = begin; i < end; ++i) {
+                acc += c[i] * input[first + i];
+            }
+            output[k] = acc;
+        }
+
+        phase += down;
+        while (phase >= up) {
+            phase -= up;
+            ++base;
+        }
+    }
+}
+
+void chooseResampleRatio(int inputRate, int minOutputRate, int maxFactor, int& up, int& down) {
+    up = 1;
+    down = 1;
+    if (inputRate <= minOutputRate) {
+        return;
+    }
+
+    // Lowest integer output rate >= minOutputRate; on ties the smaller
+    // factors (fewer filter phases) win because they are seen first
+    long long bestRate = inputRate;
+    for (int d = 2; d <= maxFactor; ++d) {
+        for (int u = 1; u < d; ++u) {
+            if (std::gcd(u, d) != 1 || (static_cast<long long>(inputRate) * u) % d != 0) continue;
+            const long long rate = static_cast<long long>(inputRate) * u / d;
+            if (rate >= minOutputRate && rate < bestRate) {
+                bestRate = rate;
+                up = u;
+                down = d;
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <memory>
+
+/**
+ * Polyphase FIR sample-rate converter for a fixed rational ratio up/down.
+ *
+ * The anti-aliasing filter is a Kaiser-windowed sinc cut off just below
+ * the lower of the two Nyquist frequencies, split into `up` phases of
+ * equal length so each output sample is a single dot product with the
+ * input. Filter tables depend only on the reduced ratio and are shared
+ * between all resamplers using it, so configuring a second analyzer at the
+ * same rates costs nothing.
+ *
+ * resample() never allocates. Not thread-safe; use one per analyzer
+ * (the shared tables are read-only).
+ */
+class PolyphaseResampler {
+public:
+    struct FilterBank;
+
+private:
+    std::shared_ptr<const FilterBank> bank;
+    int up;
+    int down;
+
+public:
+    PolyphaseResampler();
+
+    /**
+     * Set the conversion ratio. Returns false if either rate is not positive.
+     */
+    bool configure(int inputRate, int outputRate);
+
+    bool isConfigured() const { return bank != nullptr; }
+
+    int getUpFactor() const { return up; }
+    int getDownFactor() const { return down; }
+
+    /**
+     * Filter taps evaluated per output sample
+     */
+    int getTapsPerOutput() const;
+
+    /**
+     * Number of output samples covering inputLength input samples
+     */
+    int outputLength(int inputLength) const;
+
+    /**
+     * Resample a whole block with the filter's delay compensated, so output
+     * sample k is aligned with input time k * down / up. Samples outside
+     * the block are taken as zero.
+     *
+     * @param input inputLength samples
+     * @param output outputCount samples, at most outputLength(inputLength)
+     */
+    void resample(const float* input, int inputLength, float* output, int outputCount) const;
+};
+
+/**
+ * Smallest rational conversion up/down (both at most maxFactor) that takes
+ * inputRate to at least minOutputRate. Leaves the rate unchanged (1/1)
+ * when inputRate is already at or below minOutputRate.
+ */
+void chooseResampleRatio(int inputRate, int minOutputRate, int maxFactor, int& up, int& down);
+
+#endif // RESAMPLER_H
@@ -0,0 +1,454 @@
+#include "simd_kernels.h"
+#include <cstring>
+
+#if defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_KERNELS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+static float scalarSum(const float* x, int n) {
+    float s = 0.0f;
+    for (int i = 0; i < n; ++i) s += x[i];
+    return s;
+}
+
+static float scalarSumSquares(const float* x, int n) {
+    float s = 0.0f;
+    for (int i = 0; i < n; ++i) s += x[i] * x[i];
+    return s;
+}
+
+static float scalarSumSquaredDeviations(const float* x, int n, float mean) {
+    float s = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        const float d = x[i] - mean;
+        s += d * d;
+    }
+    return s;
+}
+
+static float scalarDot(const float* a, const float* b, int n) {
+    float s = 0.0f;
+    for (int i = 0; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+static void scalarSubtract(const float* in, float value, float* out, int n) {
+    for (int i = 0; i < n; ++i) out[i] = in[i] - value;
+}
+
+static inline bool isLocalMaximum(const float* x, int k, float threshold) {
+    return x[k] > threshold && x[k] > x[k - 1] && x[k] >= x[k + 1];
+}
+
+static int scalarLocalMaxima(const float* x, int begin, int end, float threshold, int* indices) {
+    int count = 0;
+    for (int k = begin; k < end; ++k) {
+        if (isLocalMaximum(x, k, threshold)) indices[count++] = k;
+    }
+    return count;
+}
+
+static const SimdKernels kScalarKernels = {
+        "scalar",
+        scalarSum,
+        scalarSumSquares,
+        scalarSumSquaredDeviations,
+        scalarDot,
+        scalarSubtract,
+        scalarLocalMaxima,
+};
+
+// ---------------------------------------------------------------------------
+// NEON (baseline on arm64-v8a)
+// ---------------------------------------------------------------------------
+
+#if defined(SIMD_KERNELS_NEON)
+
+static inline float neonHorizontalSum(float32x4_t v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    const float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+}
+
+static inline float32x4_t neonMultiplyAdd(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    return vfmaq_f32(acc, a, b);
+#else
+    return vmlaq_f32(acc, a, b);
+#endif
+}
+
+static float neonSum(const float* x, int n) {
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = vaddq_f32(a0, vld1q_f32(x + i));
+        a1 = vaddq_f32(a1, vld1q_f32(x + i + 4));
+    }
+    float s = neonHorizontalSum(vaddq_f32(a0, a1));
+    for (; i < n; ++i) s += x[i];
+    return s;
+}
+
+static float neonSumSquares(const float* x, int n) {
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t v0 = vld1q_f32(x + i);
+        const float32x4_t v1 = vld1q_f32(x + i + 4);
+        a0 = neonMultiplyAdd(a0, v0, v0);
+        a1 = neonMultiplyAdd(a1, v1, v1);
+    }
+    float s = neonHorizontalSum(vaddq_f32(a0, a1));
+    for (; i < n; ++i) s += x[i] * x[i];
+    return s;
+}
+
+static float neonSumSquaredDeviations(const float* x, int n, float mean) {
+    const float32x4_t m = vdupq_n_f32(mean);
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t d0 = vsubq_f32(vld1q_f32(x + i), m);
+        const float32x4_t d1 = vsubq_f32(vld1q_f32(x + i + 4), m);
+        a0 = neonMultiplyAdd(a0, d0, d0);
+        a1 = neonMultiplyAdd(a1, d1, d1);
+    }
+    float s = neonHorizontalSum(vaddq_f32(a0, a1));
+    for (; i < n; ++i) {
+        const float d = x[i] - mean;
+        s += d * d;
+    }
+    return s;
+}
+
+static float neonDot(const float* a, const float* b, int n) {
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = neonMultiplyAdd(a0, vld1q_f32(a + i), vld1q_f32(b + i));
+        a1 = neonMultiplyAdd(a1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float s = neonHorizontalSum(vaddq_f32(a0, a1));
+    for (; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+static void neonSubtract(const float* in, float value, float* out, int n) {
+    const float32x4_t v = vdupq_n_f32(value);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vsubq_f32(vld1q_f32(in + i), v));
+    }
+    for (; i < n; ++i) out[i] = in[i] - value;
+}
+
+// Spectra are mostly monotone runs, so most vectors hold no maximum and
+// are skipped after one horizontal test
+static int neonLocalMaxima(const float* x, int begin, int end, float threshold, int* indices) {
+    const float32x4_t t = vdupq_n_f32(threshold);
+    int count = 0;
+    int k = begin;
+    for (; k + 4 <= end; k += 4) {
+        const float32x4_t m = vld1q_f32(x + k);
+        const uint32x4_t mask = vandq_u32(vandq_u32(vcgtq_f32(m, t), vcgtq_f32(m, vld1q_f32(x + k - 1))),
+                                          vcgeq_f32(m, vld1q_f32(x + k + 1)));
+#if defined(__aarch64__)
+        if (vmaxvq_u32(mask) == 0) continue;
+#else
+        const uint32x2_t half = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+        if ((vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) == 0) continue;
+#endif
+        uint32_t lanes[4];
+        vst1q_u32(lanes, mask);
+        for (int j = 0; j < 4; ++j) {
+            if (lanes[j] != 0) indices[count++] = k + j;
+        }
+    }
+    for (; k < end; ++k) {
+        if (isLocalMaximum(x, k, threshold)) indices[count++] = k;
+    }
+    return count;
+}
+
+static const SimdKernels kNeonKernels = {
+        "neon",
+        neonSum,
+        neonSumSquares,
+        neonSumSquaredDeviations,
+        neonDot,
+        neonSubtract,
+        neonLocalMaxima,
+};
+
+#endif // SIMD_KERNELS_NEON
+
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86_64) and AVX2+FMA (runtime detected)
+// ---------------------------------------------------------------------------
+
+#if defined(SIMD_KERNELS_X86)
+
+static inline float sseHorizontalSum(__m128 v) {
+    const __m128 high = _mm_movehl_ps(v, v);
+    const __m128 pair = _mm_add_ps(v, high);
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+
+__attribute__((target("sse2")))
+static float sseSum(const float* x, int n) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_ps(a0, _mm_loadu_ps(x + i));
+        a1 = _mm_add_ps(a1, _mm_loadu_ps(x + i + 4));
+    }
+    float s = sseHorizontalSum(_mm_add_ps(a0, a1));
+    for (; i < n; ++i) s += x[i];
+    return s;
+}
+
+__attribute__((target("sse2")))
+static float sseSumSquares(const float* x, int n) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 v0 = _mm_loadu_ps(x + i);
+        const __m128 v1 = _mm_loadu_ps(x + i + 4);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(v0, v0));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(v1, v1));
+    }
+    float s = sseHorizontalSum(_mm_add_ps(a0, a1));
+    for (; i < n; ++i) s += x[i] * x[i];
+    return s;
+}
+
+__attribute__((target("sse2")))
+static float sseSumSquaredDeviations(const float* x, int n, float mean) {
+    const __m128 m = _mm_set1_ps(mean);
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(x + i), m);
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(x + i + 4), m);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(d0, d0));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(d1, d1));
+    }
+    float s = sseHorizontalSum(_mm_add_ps(a0, a1));
+    for (; i < n; ++i) {
+        const float d = x[i] - mean;
+        s += d * d;
+    }
+    return s;
+}
+
+__attribute__((target("sse2")))
+static float sseDot(const float* a, const float* b, int n) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float s = sseHorizontalSum(_mm_add_ps(a0, a1));
+    for (; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+__attribute__((target("sse2")))
+static void sseSubtract(const float* in, float value, float* out, int n) {
+    const __m128 v = _mm_set1_ps(value);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(in + i), v));
+    }
+    for (; i < n; ++i) out[i] = in[i] - value;
+}
+
+__attribute__((target("sse2")))
+static int sseLocalMaxima(const float* x, int begin, int end, float threshold, int* indices) {
+    const __m128 t = _mm_set1_ps(threshold);
+    int count = 0;
+    int k = begin;
+    for (; k + 4 <= end; k += 4) {
+        const __m128 m = _mm_loadu_ps(x + k);
+        const __m128 mask = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(m, t), _mm_cmpgt_ps(m, _mm_loadu_ps(x + k - 1))),
+                                       _mm_cmpge_ps(m, _mm_loadu_ps(x + k + 1)));
+        for (int bits = _mm_movemask_ps(mask); bits != 0; bits &= bits - 1) {
+            indices[count++] = k + __builtin_ctz(bits);
+        }
+    }
+    for (; k < end; ++k) {
+        if (isLocalMaximum(x, k, threshold)) indices[count++] = k;
+    }
+    return count;
+}
+
+static const SimdKernels kSse2Kernels = {
+        "sse2",
+        sseSum,
+        sseSumSquares,
+        sseSumSquaredDeviations,
+        sseDot,
+        sseSubtract,
+        sseLocalMaxima,
+};
+
+__attribute__((target("avx2,fma")))
+static inline float avxHorizontalSum(__m256 v) {
+    const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    const __m128 high = _mm_movehl_ps(sum, sum);
+    const __m128 pair = _mm_add_ps(sum, high);
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+static float avxSum(const float* x, int n) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm256_add_ps(a0, _mm256_loadu_ps(x + i));
+        a1 = _mm256_add_ps(a1, _mm256_loadu_ps(x + i + 8));
+    }
+    float s = avxHorizontalSum(_mm256_add_ps(a0, a1));
+    for (; i < n; ++i) s += x[i];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static float avxSumSquares(const float* x, int n) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 v0 = _mm256_loadu_ps(x + i);
+        const __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        a0 = _mm256_fmadd_ps(v0, v0, a0);
+        a1 = _mm256_fmadd_ps(v1, v1, a1);
+    }
+    float s = avxHorizontalSum(_mm256_add_ps(a0, a1));
+    for (; i < n; ++i) s += x[i] * x[i];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static float avxSumSquaredDeviations(const float* x, int n, float mean) {
+    const __m256 m = _mm256_set1_ps(mean);
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(x + i), m);
+        const __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(x + i + 8), m);
+        a0 = _mm256_fmadd_ps(d0, d0, a0);
+        a1 = _mm256_fmadd_ps(d1, d1, a1);
+    }
+    float s = avxHorizontalSum(_mm256_add_ps(a0, a1));
+    for (; i < n; ++i) {
+        const float d = x[i] - mean;
+        s += d * d;
+    }
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static float avxDot(const float* a, const float* b, int n) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), a0);
+        a1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), a1);
+    }
+    float s = avxHorizontalSum(_mm256_add_ps(a0, a1));
+    for (; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static void avxSubtract(const float* in, float value, float* out, int n) {
+    const __m256 v = _mm256_set1_ps(value);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(in + i), v));
+    }
+    for (; i < n; ++i) out[i] = in[i] - value;
+}
+
+__attribute__((target("avx2,fma")))
+static int avxLocalMaxima(const float* x, int begin, int end, float threshold, int* indices) {
+    const __m256 t = _mm256_set1_ps(threshold);
+    int count = 0;
+    int k = begin;
+    for (; k + 8 <= end; k += 8) {
+        const __m256 m = _mm256_loadu_ps(x + k);
+        const __m256 mask = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(m, t, _CMP_GT_OQ),
+                              _mm256_cmp_ps(m, _mm256_loadu_ps(x + k - 1), _CMP_GT_OQ)),
+                _mm256_cmp_ps(m, _mm256_loadu_ps(x + k + 1), _CMP_GE_OQ));
+        for (int bits = _mm256_movemask_ps(mask); bits != 0; bits &= bits - 1) {
+            indices[count++] = k + __builtin_ctz(bits);
+        }
+    }
+    for (; k < end; ++k) {
+        if (isLocalMaximum(x, k, threshold)) indices[count++] = k;
+    }
+    return count;
+}
+
+static const SimdKernels kAvx2Kernels = {
+        "avx2",
+        avxSum,
+        avxSumSquares,
+        avxSumSquaredDeviations,
+        avxDot,
+        avxSubtract,
+        avxLocalMaxima,
+};
+
+static bool cpuHasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+#endif // SIMD_KERNELS_X86
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+const SimdKernels* simdKernelsForIsa(const char* isa) {
+    if (isa == nullptr) return nullptr;
+    if (std::strcmp(isa, "scalar") == 0) return &kScalarKernels;
+#if defined(SIMD_KERNELS_NEON)
+    if (std::strcmp(isa, "neon") == 0) return &kNeonKernels;
+#endif
+#if defined(SIMD_KERNELS_X86)
+    if (std::strcmp(isa, "sse2") == 0) return &kSse2Kernels;
+    if (std::strcmp(isa, "avx2") == 0) return cpuHasAvx2() ? &kAvx2Kernels : nullptr;
+#endif
+    return nullptr;
+}
+
+static const SimdKernels& selectKernels() {
+#if defined(SIMD_KERNELS_NEON)
+    return kNeonKernels;
+#elif defined(SIMD_KERNELS_X86)
+    return cpuHasAvx2() ? kAvx2Kernels : kSse2Kernels;
+#else
+    return kScalarKernels;
+#endif
+}
+
+const SimdKernels& simdKernels() {
+    static const SimdKernels& kernels = selectKernels();
+    return kernels;
+}
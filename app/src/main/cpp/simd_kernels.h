@@ -0,0 +1,77 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+/**
+ * Vectorized float reductions used on the per-frame path.
+ *
+ * One implementation per instruction set is compiled in (scalar always,
+ * NEON on ARM, SSE2 and AVX2+FMA on x86_64); the widest one the CPU
+ * supports is picked on first use and every call goes through the chosen
+ * table. Results differ from a sequential scalar loop only by summation
+ * order: the vector versions keep several partial sums, which is usually
+ * more accurate, not less (host/simd_bench checks both against double).
+ */
+struct SimdKernels {
+    const char* isa;
+
+    /** Sum of x[0..n) */
+    float (*sum)(const float* x, int n);
+
+    /** Sum of x[i]^2 */
+    float (*sumSquares)(const float* x, int n);
+
+    /** Sum of (x[i] - mean)^2 */
+    float (*sumSquaredDeviations)(const float* x, int n, float mean);
+
+    /** Sum of a[i] * b[i] */
+    float (*dot)(const float* a, const float* b, int n);
+
+    /** out[i] = in[i] - value; in and out may be the same array */
+    void (*subtract)(const float* in, float value, float* out, int n);
+
+    /**
+     * Local maxima of x over [begin, end): indices k with x[k] > threshold,
+     * x[k] > x[k - 1] and x[k] >= x[k + 1], written to indices in ascending
+     * order. Reads x[begin - 1] and x[end], so begin >= 1 and x must extend
+     * one past end. Returns the number written (at most (end - begin + 1) / 2).
+     */
+    int (*localMaxima)(const float* x, int begin, int end, float threshold, int* indices);
+};
+
+/**
+ * Kernels for the running CPU, resolved once (thread-safe)
+ */
+const SimdKernels& simdKernels();
+
+/**
+ * Kernels for a named instruction set ("scalar", "sse2", "avx2", "neon"),
+ * or nullptr if it is not compiled in or not supported by this CPU.
+ * For comparisons and benchmarks; analysis code uses simdKernels().
+ */
+const SimdKernels* simdKernelsForIsa(const char* isa);
+
+inline float simdSum(const float* x, int n) {
+    return simdKernels().sum(x, n);
+}
+
+inline float simdSumSquares(const float* x, int n) {
+    return simdKernels().sumSquares(x, n);
+}
+
+inline float simdSumSquaredDeviations(const float* x, int n, float mean) {
+    return simdKernels().sumSquaredDeviations(x, n, mean);
+}
+
+inline float simdDot(const float* a, const float* b, int n) {
+    return simdKernels().dot(a, b, n);
+}
+
+inline void simdSubtract(const float* in, float value, float* out, int n) {
+    simdKernels().subtract(in, value, out, n);
+}
+
+inline int simdLocalMaxima(const float* x, int begin, int end, float threshold, int* indices) {
+    return simdKernels().localMaxima(x, begin, end, threshold, indices);
+}
+
+#endif // SIMD_KERNELS_H
@@ -0,0 +1,68 @@
+#include "spectral_lpc.h"
+#include <algorithm>
+
+float levinsonDurbin(const float* autocorr, int order, float* lpc, float* reflection) {
+    std::fill(lpc, lpc + order + 1, 0.0f);
+    std::fill(reflection, reflection + order, 0.0f);
+    lpc[0] = 1.0f;
+
+    double error = autocorr[0];
+    if (error <= 0.0) {
+        return 0.0f;
+    }
+
+    for (int i = 1; i <= order; ++i) {
+        double acc = autocorr[i];
+        for (int j = 1; j < i; ++j) {
+            acc += static_cast<double>(lpc[j]) * autocorr[i - j];
+        }
+        const double k = -acc / error;
+        reflection[i - 1] = static_cast<float>(k);
+
+        // a[j] += k * a[i - j], pairwise so the update is in place
+        for (int j = 1, l = i - 1; j <= l; ++j, --l) {
+            const double aj = lpc[j];
+            const double al = lpc[l];
+            lpc[j] = static_cast<float>(aj + k * al);
+            if (j != l) {
+                lpc[l] = static_cast<float>(al + k * aj);
+            }
+        }
+        lpc[i] = static_cast<float>(k);
+
+        error *= 1.0 - k * k;
+        if (error <= 0.0) {
+            // Perfectly predictable (or numerically singular); higher orders add nothing
+            break;
+        }
+    }
+    return static_cast<float>(error);
+}
+
+SpectralLpc::SpectralLpc()
+        : frameSize(0)
+        , order(0) {
+}
+
+bool SpectralLpc::configure(int newFrameSize, int newOrder) {
+    if (newOrder < 1 || newOrder >= newFrameSize || !fft.configure(newFrameSize)) {
+        return false;
+    }
+    frameSize = newFrameSize;
+    order = newOrder;
+    power.assign(2 * (frameSize / 2 + 1), 0.0f);
+    autocorr.assign(frameSize, 0.0f);
+    return true;
+}
+
+void SpectralLpc::compute(const float* magnitudes, float* lpc, float* reflection) {
+    // |X|^2 as a real spectrum; its inverse transform is the autocorrelation
+    // scaled to match sum(x[n] * x[n + lag])
+    const int bins = frameSize / 2 + 1;
+    for (int k = 0; k < bins; ++k) {
+        power[2 * k] = magnitudes[k] * magnitudes[k];
+    }
+    fft.inverse(power.data(), autocorr.data());
+
+    levinsonDurbin(autocorr.data(), order, lpc, reflection);
+}
@@ -0,0 +1,63 @@
+#ifndef SPECTRAL_LPC_H
+#define SPECTRAL_LPC_H
+
+#include <vector>
+
+#include "fft.h"
+
+/**
+ * Levinson-Durbin recursion on an autocorrelation sequence, in place in
+ * the caller's buffers (no allocation).
+ *
+ * Same contract as Essentia's LPC algorithm: lpc[0] == 1 and
+ * A(z) = sum(lpc[i] z^-i) is the prediction error filter; reflection[i-1]
+ * is the i-th reflection coefficient, with lpc[i] == reflection[i-1] after
+ * step i. A silent frame (autocorr[0] <= 0) gives lpc = {1, 0, ...} and
+ * zero reflections.
+ *
+ * @param autocorr order + 1 lags
+ * @param lpc order + 1 coefficients
+ * @param reflection order coefficients
+ * @return Final prediction error power
+ */
+float levinsonDurbin(const float* autocorr, int order, float* lpc, float* reflection);
+
+/**
+ * LPC of a windowed frame from its magnitude spectrum.
+ *
+ * The autocorrelation is the inverse FFT of the power spectrum, so the
+ * spectrum the analyzer already computed replaces a separate O(N * order)
+ * pass over the frame. The result is the circular autocorrelation; for a
+ * tapered (e.g. Hann) frame the wrapped-around terms multiply samples the
+ * window has taken to zero, so the lags used match the linear ones.
+ *
+ * compute() does not allocate. Not thread-safe; use one per analyzer.
+ */
+class SpectralLpc {
+private:
+    RealFft fft;
+    int frameSize;
+    int order;
+    std::vector<float> power;       // Interleaved complex, frameSize / 2 + 1 bins
+    std::vector<float> autocorr;    // frameSize lags
+
+public:
+    SpectralLpc();
+
+    /**
+     * @param frameSize Length of the frame the spectrum was taken from (even)
+     * @param order LPC order, less than frameSize
+     */
+    bool configure(int frameSize, int order);
+
+    int getOrder() const { return order; }
+
+    /**
+     * @param magnitudes frameSize / 2 + 1 magnitudes, as Essentia's Spectrum outputs
+     * @param lpc order + 1 coefficients
+     * @param reflection order coefficients
+     */
+    void compute(const float* magnitudes, float* lpc, float* reflection);
+};
+
+#endif // SPECTRAL_LPC_H
@@ -0,0 +1,122 @@
+#include "spectral_moments.h"
+#include "fast_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Power floor for the flatness logarithm, so empty bins do not send the
+// geometric mean to zero (about -240 dB)
+static const float kPowerFloor = 1e-24f;
+
+// Lanes of partial sums; independent chains the compiler can keep in
+// registers or pack into vectors
+static const int kLanes = 4;
+
+namespace {
+
+struct Accumulator {
+    float magnitude[kLanes] = {};
+    float weighted[kLanes] = {};     // Sum of i * |X|
+    float weighted2[kLanes] = {};    // Sum of i^2 * |X|
+    float energy[kLanes] = {};
+    float logPower[kLanes] = {};
+
+    template <bool kWithLog>
+    void add(const float* x, int begin, int end) {
+        int i = begin;
+        for (; i + kLanes <= end; i += kLanes) {
+            for (int l = 0; l < kLanes; ++l) {
+                const float m = x[i + l];
+                const float bin = static_cast<float>(i + l);
+                const float p = m * m;
+                magnitude[l] += m;
+                weighted[l] += bin * m;
+                weighted2[l] += bin * bin * m;
+                energy[l] += p;
+                if (kWithLog) logPower[l] += fastLog2(p + kPowerFloor);
+            }
+        }
+        for (; i < end; ++i) {
+            const float m = x[i];
+            const float bin = static_cast<float>(i);
+            const float p = m * m;
+            magnitude[0] += m;
+            weighted[0] += bin * m;
+            weighted2[0] += bin * bin * m;
+            energy[0] += p;
+            if (kWithLog) logPower[0] += fastLog2(p + kPowerFloor);
+        }
+    }
+
+    static float total(const float* lanes) {
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+};
+
+} // namespace
+
+void computeSpectralMoments(const float* spectrum, int size, int bandSplitBin,
+                            const int* harmonicBins, int harmonicCount, bool withFlatness,
+                            SpectralMoments& out) {
+    std::memset(&out, 0, sizeof(out));
+    if (spectrum == nullptr || size <= 0) {
+        return;
+    }
+
+    bandSplitBin = std::min(std::max(bandSplitBin, 0), size);
+    harmonicCount = std::min(std::max(harmonicCount, 0), kMaxHarmonicSamples);
+
+    // Walk the spectrum once, stopping at the band split and at each
+    // harmonic bin to take its sample while the line is in cache
+    Accumulator acc;
+    int pos = 0;
+    int harmonic = 0;
+    bool splitDone = false;
+    while (true) {
+        const int nextHarmonic = harmonic < harmonicCount ? std::min(harmonicBins[harmonic], size) : size;
+        const int nextSplit = splitDone ? size : bandSplitBin;
+        const int stop = std::max(pos, std::min(nextHarmonic, nextSplit));
+
+        if (withFlatness) {
+            acc.add<true>(spectrum, pos, stop);
+        } else {
+            acc.add<false>(spectrum, pos, stop);
+        }
+        pos = stop;
+
+        if (!splitDone && pos >= bandSplitBin) {
+            out.lowBandEnergy = Accumulator::total(acc.energy);
+            splitDone = true;
+        } else if (harmonic < harmonicCount && pos >= nextHarmonic) {
+            out.harmonics[harmonic] = nextHarmonic < size ? spectrum[nextHarmonic] : 0.0f;
+            ++harmonic;
+        } else if (pos >= size) {
+            break;
+        }
+    }
+    out.harmonicCount = harmonicCount;
+
+    out.magnitudeSum = Accumulator::total(acc.magnitude);
+    out.energy = Accumulator::total(acc.energy);
+    out.highBandEnergy = out.energy - out.lowBandEnergy;
+    out.brightness = out.energy > 0.0f ? out.highBandEnergy / out.energy : 0.0f;
+
+    // Centroid as Essentia computes it with range 1: mean bin / (size - 1)
+    if (out.magnitudeSum > 0.0f && size > 1) {
+        const float scale = 1.0f / (size - 1);
+        const float meanBin = Accumulator::total(acc.weighted) / out.magnitudeSum;
+        const float meanBin2 = Accumulator::total(acc.weighted2) / out.magnitudeSum;
+        out.centroid = meanBin * scale;
+        out.spread = std::max(0.0f, meanBin2 - meanBin * meanBin) * scale * scale;
+    }
+
+    const float meanPower = out.energy / size;
+    if (withFlatness && meanPower > 0.0f) {
+        const float geometricMean = std::exp2(Accumulator::total(acc.logPower) / size);
+        out.flatness = std::min(1.0f, geometricMean / meanPower);
+    }
+
+    for (int h = 0; h < harmonicCount; ++h) {
+        out.resonance += out.harmonics[h] / (h + 1);
+    }
+}
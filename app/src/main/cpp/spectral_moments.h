@@ -0,0 +1,39 @@
+#ifndef SPECTRAL_MOMENTS_H
+#define SPECTRAL_MOMENTS_H
+
+/**
+ * Harmonics sampled for the resonance measure
+ */
+static const int kMaxHarmonicSamples = 5;
+
+/**
+ * Statistics of one magnitude spectrum, filled by computeSpectralMoments
+ */
+struct SpectralMoments {
+    float magnitudeSum;     // Sum of |X|
+    float energy;           // Sum of |X|^2
+    float lowBandEnergy;    // Energy of bins below the band split
+    float highBandEnergy;   // Energy of bins from the band split up
+    float brightness;       // highBandEnergy / energy
+    float centroid;         // Magnitude-weighted mean bin, normalized to [0, 1] like Essentia's Centroid
+    float spread;           // Magnitude-weighted variance of the normalized bin position
+    float flatness;         // Geometric / arithmetic mean of the power spectrum, in [0, 1]; 0 unless requested
+    float harmonics[kMaxHarmonicSamples];   // |X| at each harmonic bin
+    int harmonicCount;
+    float resonance;        // Sum of harmonics[h - 1] / h
+};
+
+/**
+ * Compute every statistic in one pass over the spectrum.
+ *
+ * @param spectrum Magnitude spectrum, size bins (DC to Nyquist)
+ * @param bandSplitBin First bin counted in highBandEnergy
+ * @param harmonicBins Bins of harmonics 1..harmonicCount, ascending; may be null if harmonicCount is 0
+ * @param harmonicCount At most kMaxHarmonicSamples
+ * @param withFlatness Also compute flatness, which costs a logarithm per bin
+ */
+void computeSpectralMoments(const float* spectrum, int size, int bandSplitBin,
+                            const int* harmonicBins, int harmonicCount, bool withFlatness,
+                            SpectralMoments& out);
+
+#endif // SPECTRAL_MOMENTS_H
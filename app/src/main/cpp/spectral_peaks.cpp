@@ -0,0 +1,95 @@
+#include "spectral_peaks.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+SpectralPeakPicker::SpectralPeakPicker()
+        : bins(0)
+        , binHz(0.0f)
+        , magnitudeThreshold(0.0f)
+        , maxPeaks(kMaxSpectralPeaks) {
+}
+
+bool SpectralPeakPicker::configure(int newBins, float newBinHz, float threshold, int newMaxPeaks) {
+    if (newBins < 3 || newBinHz <= 0.0f || newMaxPeaks < 1 || newMaxPeaks > kMaxSpectralPeaks) {
+        return false;
+    }
+    bins = newBins;
+    binHz = newBinHz;
+    magnitudeThreshold = threshold;
+    maxPeaks = newMaxPeaks;
+
+    // Local maxima are at least two bins apart
+    const size_t capacity = bins / 2 + 1;
+    candidateBins.assign(capacity, 0);
+    candidateFrequencies.assign(capacity, 0.0f);
+    candidateMagnitudes.assign(capacity, 0.0f);
+    selection.assign(capacity, 0.0f);
+    return true;
+}
+
+void SpectralPeakPicker::pick(const float* spectrum, float minHz, float maxHz, SpectralPeakList& out) {
+    out.count = 0;
+    if (bins == 0) {
+        return;
+    }
+
+    // Interior bins whose interpolated peak (within half a bin) can land in the band
+    const int firstBin = std::max(1, static_cast<int>(std::floor(minHz / binHz - 0.5f)));
+    const int endBin = std::min(bins - 1, static_cast<int>(std::ceil(maxHz / binHz + 0.5f)) + 1);
+    if (endBin <= firstBin) {
+        return;
+    }
+
+    const int maxima = simdLocalMaxima(spectrum, firstBin, endBin, magnitudeThreshold, candidateBins.data());
+
+    // Parabola through the three bins, as Essentia's PeakDetection. Maxima
+    // are two or more bins apart and move by at most half a bin, so the
+    // candidates stay in frequency order.
+    int candidates = 0;
+    for (int i = 0; i < maxima; ++i) {
+        const int k = candidateBins[i];
+        const float left = spectrum[k - 1];
+        const float middle = spectrum[k];
+        const float right = spectrum[k + 1];
+        const float curvature = left - 2.0f * middle + right;
+        const float offset = curvature != 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+        const float frequency = (k + offset) * binHz;
+        if (frequency < minHz || frequency > maxHz) {
+            continue;
+        }
+        candidateFrequencies[candidates] = frequency;
+        candidateMagnitudes[candidates] = middle - 0.25f * (left - right) * offset;
+        ++candidates;
+    }
+
+    if (candidates <= maxPeaks) {
+        std::copy(candidateFrequencies.begin(), candidateFrequencies.begin() + candidates, out.frequencies);
+        std::copy(candidateMagnitudes.begin(), candidateMagnitudes.begin() + candidates, out.magnitudes);
+        out.count = candidates;
+        return;
+    }
+
+    // Top maxPeaks by magnitude: find the cutoff, then keep everything above
+    // it plus as many ties as fit, lowest frequency first
+    std::copy(candidateMagnitudes.begin(), candidateMagnitudes.begin() + candidates, selection.begin());
+    std::nth_element(selection.begin(), selection.begin() + (maxPeaks - 1), selection.begin() + candidates,
+                     std::greater<float>());
+    const float cutoff = selection[maxPeaks - 1];
+    int ties = maxPeaks;
+    for (int i = 0; i < candidates; ++i) {
+        ties -= (candidateMagnitudes[i] > cutoff);
+    }
+
+    int count = 0;
+    for (int i = 0; i < candidates && count < maxPeaks; ++i) {
+        const float magnitude = candidateMagnitudes[i];
+        if (magnitude > cutoff || (magnitude == cutoff && ties-- > 0)) {
+            out.frequencies[count] = candidateFrequencies[i];
+            out.magnitudes[count] = magnitude;
+            ++count;
+        }
+    }
+    out.count = count;
+}
@@ -0,0 +1,63 @@
+#ifndef SPECTRAL_PEAKS_H
+#define SPECTRAL_PEAKS_H
+
+#include <vector>
+
+/**
+ * Peaks kept per frame (Essentia SpectralPeaks' maxPeaks as the analyzer
+ * configured it)
+ */
+static const int kMaxSpectralPeaks = 100;
+
+/**
+ * Fixed-capacity peak list, struct of arrays, sorted by frequency.
+ * Owned by the caller and refilled in place every frame.
+ */
+struct SpectralPeakList {
+    float frequencies[kMaxSpectralPeaks];   // Hz, ascending
+    float magnitudes[kMaxSpectralPeaks];
+    int count;
+};
+
+/**
+ * Band-limited spectral peak picking, as Essentia's SpectralPeaks
+ * (orderBy "frequency", parabolic interpolation) restricted to a band.
+ *
+ * Local maxima are found with the vector kernel (simdLocalMaxima) over
+ * the bins of the band only, interpolated, and when there are more than
+ * maxPeaks the loudest are kept by selecting the maxPeaks-th magnitude
+ * (nth_element) and compacting in one pass, so the list stays in frequency
+ * order without a sort. Steady state does not allocate.
+ *
+ * Not thread-safe; use one per analyzer.
+ */
+class SpectralPeakPicker {
+private:
+    int bins;
+    float binHz;
+    float magnitudeThreshold;
+    int maxPeaks;
+    std::vector<int> candidateBins;         // Local maxima of the band, ascending
+    std::vector<float> candidateFrequencies;
+    std::vector<float> candidateMagnitudes;
+    std::vector<float> selection;           // Scratch for the top-K threshold
+
+public:
+    SpectralPeakPicker();
+
+    /**
+     * @param bins Magnitude spectrum size (DC to Nyquist), at least 3
+     * @param binHz Bin spacing in Hz (sample rate / FFT size)
+     * @param magnitudeThreshold Peaks must exceed this magnitude
+     * @param maxPeaks Peaks kept per frame, 1..kMaxSpectralPeaks
+     */
+    bool configure(int bins, float binHz, float magnitudeThreshold, int maxPeaks = kMaxSpectralPeaks);
+
+    /**
+     * Peaks whose interpolated frequency lies in [minHz, maxHz]. Only the
+     * bins that can produce such a peak are read.
+     */
+    void pick(const float* spectrum, float minHz, float maxHz, SpectralPeakList& out);
+};
+
+#endif // SPECTRAL_PEAKS_H
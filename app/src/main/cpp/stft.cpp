@@ -0,0 +1,55 @@
+#include "stft.h"
+#include <cmath>
+
+StftFrontEnd::StftFrontEnd()
+        : frameSize(0) {
+}
+
+bool StftFrontEnd::configure(int newFrameSize) {
+    if (newFrameSize < 4 || !fft.configure(newFrameSize)) {
+        return false;
+    }
+    frameSize = newFrameSize;
+    spectrum.assign(2 * (frameSize / 2 + 1), 0.0f);
+    return true;
+}
+
+void StftFrontEnd::transform(const float* frame) {
+    fft.forward(frame, spectrum.data());
+}
+
+// Three-tap window in the frequency domain. X is conjugate symmetric, so
+// X[-1] = conj(X[1]) and X[N/2 + 1] = conj(X[N/2 - 1]). dc stands in for
+// the transformed DC bin, so callers can shift the frame's mean without
+// another FFT. Needs at least 3 bins.
+template <typename Emit>
+static void raisedCosine(const float* x, int bins, float a, float dc, Emit emit) {
+    const float b = 0.5f * (1.0f - a);
+
+    emit(0, a * dc - 2.0f * b * x[2], 0.0f);
+    emit(1, a * x[2] - b * (dc + x[4]), a * x[3] - b * x[5]);
+    for (int k = 2; k < bins - 1; ++k) {
+        emit(k, a * x[2 * k] - b * (x[2 * k - 2] + x[2 * k + 2]),
+             a * x[2 * k + 1] - b * (x[2 * k - 1] + x[2 * k + 3]));
+    }
+    const int last = bins - 1;
+    emit(last, a * x[2 * last] - 2.0f * b * x[2 * last - 2], 0.0f);
+}
+
+void StftFrontEnd::hannMagnitude(float* magnitudes) const {
+    // Periodic Hann sums to N / 2; Essentia scales its window to sum to 2
+    const float scale = 4.0f / frameSize;
+    raisedCosine(spectrum.data(), frameSize / 2 + 1, 0.5f, spectrum[0],
+                 [&](int k, float re, float im) {
+                     magnitudes[k] = scale * std::sqrt(re * re + im * im);
+                 });
+}
+
+void StftFrontEnd::hammingPower(float dcOffset, float* power) const {
+    // A constant offset only moves the unwindowed DC bin, by N * offset
+    const float dc = spectrum[0] + dcOffset * frameSize;
+    raisedCosine(spectrum.data(), frameSize / 2 + 1, 0.54f, dc,
+                 [&](int k, float re, float im) {
+                     power[k] = re * re + im * im;
+                 });
+}
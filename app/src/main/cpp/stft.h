@@ -0,0 +1,64 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include <vector>
+
+#include "fft.h"
+
+/**
+ * One FFT per frame, windowed spectra for every consumer.
+ *
+ * The analyzer's features want a Hann-windowed magnitude spectrum and the
+ * speaker embedding wants a Hamming-windowed power spectrum of the same
+ * frame. Both windows are raised cosines, a - (1 - a) cos(2 pi n / N), so
+ * the windowed spectrum is the unwindowed one convolved with three taps:
+ *
+ *   Xw[k] = a X[k] - (1 - a) / 2 (X[k - 1] + X[k + 1])
+ *
+ * transform() takes the frame's FFT once and each consumer applies its
+ * window in O(bins). The windows are the periodic forms (N rather than
+ * N - 1 in the cosine), which differ from the symmetric ones Essentia's
+ * Windowing and the Kotlin extractor used by O(1/N) of the peak.
+ *
+ * Not thread-safe; use one per analyzer.
+ */
+class StftFrontEnd {
+private:
+    RealFft fft;
+    int frameSize;
+    std::vector<float> spectrum;    // Unwindowed, interleaved complex, frameSize / 2 + 1 bins
+
+public:
+    StftFrontEnd();
+
+    /**
+     * @param frameSize Even frame length, at least 4
+     */
+    bool configure(int frameSize);
+
+    int getFrameSize() const { return frameSize; }
+
+    /**
+     * FFT of an unwindowed frame of frameSize samples
+     */
+    void transform(const float* frame);
+
+    /**
+     * Magnitude spectrum under Essentia's Windowing("hann") with its
+     * default normalization (window scaled to sum to 2), i.e. what
+     * Windowing followed by Spectrum outputs
+     * @param magnitudes frameSize / 2 + 1 values
+     */
+    void hannMagnitude(float* magnitudes) const;
+
+    /**
+     * Power spectrum under an unnormalized Hamming window (0.54, 0.46),
+     * as the log-mel input
+     * @param dcOffset Added to every sample of the transformed frame first,
+     *        e.g. to restore a mean the caller removed for the analyzer
+     * @param power frameSize / 2 + 1 values
+     */
+    void hammingPower(float dcOffset, float* power) const;
+};
+
+#endif // STFT_H
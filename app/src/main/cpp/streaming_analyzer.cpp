@@ -0,0 +1,178 @@
+#include "streaming_analyzer.h"
+#include "pcm_convert.h"
+#include "trace_events.h"
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "StreamingAnalyzer"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+StreamingAnalyzer::StreamingAnalyzer(EssentiaWrapper& w, int capacitySamples)
+        : wrapper(w)
+        , sampleRate(w.getSampleRate())
+        , frameSize(w.getFrameSize())
+        , hopSize(std::max(1, w.getHopSize()))
+        , capacity(0)
+        , runningSum(0.0)
+        , writeIndex(0)
+        , nextFrameIndex(0)
+        , droppedFrames(0) {
+    if (capacitySamples <= 0) {
+        capacitySamples = frameSize + 8 * hopSize;
+    }
+    capacity = std::max(capacitySamples, frameSize);
+
+    ring.assign(2 * capacity, 0.0f);
+    prefixSum.assign(capacity, 0.0);
+
+    LOGI("Streaming session: sampleRate=%d, frameSize=%d, hopSize=%d, capacity=%d",
+         sampleRate, frameSize, hopSize, capacity);
+}
+
+void StreamingAnalyzer::push(const float* samples, int n) {
+    if (samples == nullptr || n <= 0) return;
+    TRACE_SCOPE(kTraceStreamPush, static_cast<uint32_t>(writeIndex));
+
+    for (int i = 0; i < n; ++i) {
+        const int pos = static_cast<int>(writeIndex % capacity);
+        ring[pos] = samples[i];
+        ring[pos + capacity] = samples[i];
+        prefixSum[pos] = runningSum;
+        runningSum += samples[i];
+        ++writeIndex;
+    }
+
+    // Skip whole hops that have already been overwritten
+    const int64_t oldest = writeIndex - capacity;
+    if (nextFrameIndex < oldest) {
+        const int64_t skipped = (oldest - nextFrameIndex + hopSize - 1) / hopSize;
+        nextFrameIndex += skipped * hopSize;
+        droppedFrames += skipped;
+    }
+}
+
+void StreamingAnalyzer::pushPcm16(const int16_t* samples, int n) {
+    if (samples == nullptr || n <= 0) return;
+
+    // Convert through a small stack block so capture callbacks never allocate
+    float block[256];
+    for (int offset = 0; offset < n; offset += 256) {
+        const int count = std::min(256, n - offset);
+        convertPcm16ToFloat(samples + offset, block, count);
+        push(block, count);
+    }
+}
+
+double StreamingAnalyzer::sumBefore(int64_t index) const {
+    return index == writeIndex ? runningSum : prefixSum[index % capacity];
+}
+
+bool StreamingAnalyzer::pull(StreamFrame& frame) {
+    if (writeIndex - nextFrameIndex < frameSize) {
+        return false;
+    }
+
+    TRACE_SCOPE(kTraceStreamPull, static_cast<uint32_t>(nextFrameIndex / hopSize));
+
+    const float* data = ring.data() + (nextFrameIndex % capacity);
+    const double frameSum = sumBefore(nextFrameIndex + frameSize) - sumBefore(nextFrameIndex);
+    const float dcOffset = static_cast<float>(frameSum / frameSize);
+
+    frame.sampleIndex = nextFrameIndex;
+    frame.timestamp = static_cast<double>(nextFrameIndex) / sampleRate;
+    wrapper.analyzeFrame(data, frameSize, dcOffset, frame.features);
+
+    nextFrameIndex += hopSize;
+    return true;
+}
+
+bool StreamingAnalyzer::takeFrame(float* out, float& dcOffset, int64_t& sampleIndex) {
+    if (out == nullptr || writeIndex - nextFrameIndex < frameSize) {
+        return false;
+    }
+
+    const float* data = ring.data() + (nextFrameIndex % capacity);
+    const double frameSum = sumBefore(nextFrameIndex + frameSize) - sumBefore(nextFrameIndex);
+    std::copy(data, data + frameSize, out);
+    dcOffset = static_cast<float>(frameSum / frameSize);
+    sampleIndex = nextFrameIndex;
+
+    nextFrameIndex += hopSize;
+    return true;
+}
+
+int StreamingAnalyzer::available() const {
+    const int64_t pending = writeIndex - nextFrameIndex;
+    if (pending < frameSize) return 0;
+    return static_cast<int>((pending - frameSize) / hopSize + 1);
+}
+
+void StreamingAnalyzer::reset() {
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    runningSum = 0.0;
+    writeIndex = 0;
+    nextFrameIndex = 0;
+    droppedFrames = 0;
+    // The next frame does not continue the last one
+    wrapper.resetPitchTrack();
+}
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Value at fraction q of the sorted latencies (nearest rank)
+static double latencyPercentile(std::vector<float>& latencies, double q) {
+    if (latencies.empty()) return 0.0;
+    const size_t rank = std::min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()));
+    std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return latencies[rank];
+}
+
+SourceRunStats runAudioSource(AudioSource& source, StreamingAnalyzer& stream, int blockSize,
+                              const std::function<void(const StreamFrame&)>& onFrame) {
+    SourceRunStats stats;
+    std::vector<float> block(std::max(1, blockSize));
+    std::vector<float> latencies;
+    StreamFrame frame;
+    const int hopSize = stream.getHopSize();
+    const int64_t droppedBefore = stream.getDroppedFrames();
+    double latencySum = 0.0;
+
+    const int64_t startNs = steadyNowNs();
+    AudioBlock info;
+    int n;
+    while ((n = source.read(block.data(), static_cast<int>(block.size()), info)) > 0) {
+        stats.samples += n;
+        // A hop at a time so the session's ring never overruns
+        for (int offset = 0; offset < n; offset += hopSize) {
+            stream.push(block.data() + offset, std::min(hopSize, n - offset));
+            while (stream.pull(frame)) {
+                const float latencyMs = static_cast<float>((steadyNowNs() - info.arrivalNs) * 1e-6);
+                latencies.push_back(latencyMs);
+                latencySum += latencyMs;
+                ++stats.frames;
+                stats.validFrames += frame.features.isValid;
+                if (onFrame) onFrame(frame);
+            }
+        }
+    }
+
+    stats.wallSeconds = (steadyNowNs() - startNs) * 1e-9;
+    stats.droppedFrames = stream.getDroppedFrames() - droppedBefore;
+    if (stats.wallSeconds > 0.0) {
+        stats.realtimeFactor = static_cast<double>(stats.samples) / source.getSampleRate() / stats.wallSeconds;
+    }
+    if (!latencies.empty()) {
+        stats.meanLatencyMs = latencySum / latencies.size();
+        stats.maxLatencyMs = *std::max_element(latencies.begin(), latencies.end());
+        stats.p50LatencyMs = latencyPercentile(latencies, 0.50);
+        stats.p95LatencyMs = latencyPercentile(latencies, 0.95);
+    }
+    LOGI("Source run: %lld samples, %lld frames (%lld valid), %.2fx realtime, latency mean %.2f ms, p95 %.2f ms",
+         static_cast<long long>(stats.samples), static_cast<long long>(stats.frames),
+         static_cast<long long>(stats.validFrames), stats.realtimeFactor, stats.meanLatencyMs, stats.p95LatencyMs);
+    return stats;
+}
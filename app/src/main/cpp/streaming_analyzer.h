@@ -0,0 +1,141 @@
+#ifndef STREAMING_ANALYZER_H
+#define STREAMING_ANALYZER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "audio_source.h"
+#include "essentia_wrapper.h"
+
+/**
+ * One analysis result emitted per hop by StreamingAnalyzer
+ */
+struct StreamFrame {
+    int64_t sampleIndex = 0;     // Absolute index of the frame's first sample
+    double timestamp = 0.0;      // sampleIndex / sampleRate, in seconds
+    AudioFeatures features;
+};
+
+/**
+ * Incremental push/pull session over an EssentiaWrapper.
+ *
+ * Samples are appended to an internal ring buffer as they arrive; every
+ * pull() analyzes the next frame on the wrapper's hop grid. The ring is
+ * stored twice back to back so any frame is contiguous in memory, and a
+ * running prefix sum gives each frame's DC offset in O(1), so push() costs
+ * O(n) in the pushed samples and no sample is copied or DC-corrected twice
+ * outside the wrapper's own workspace.
+ *
+ * Not thread-safe; the wrapper must outlive the session and must not be
+ * used concurrently by anyone else while pull() runs.
+ */
+class StreamingAnalyzer {
+private:
+    EssentiaWrapper& wrapper;
+
+    int sampleRate;
+    int frameSize;
+    int hopSize;
+    int capacity;
+
+    std::vector<float> ring;        // 2 * capacity, mirrored halves
+    std::vector<double> prefixSum;  // Sum of all samples before each position
+    double runningSum;
+
+    int64_t writeIndex;             // Total samples pushed
+    int64_t nextFrameIndex;         // First sample of the next frame to emit
+    int64_t droppedFrames;
+
+    double sumBefore(int64_t index) const;
+
+public:
+    /**
+     * @param wrapper Initialized analyzer providing sample rate, frame and hop size
+     * @param capacitySamples Samples retained between pulls; frames that fall out
+     *        of the ring before being pulled are dropped. Defaults to one frame
+     *        plus eight hops.
+     */
+    explicit StreamingAnalyzer(EssentiaWrapper& wrapper, int capacitySamples = 0);
+
+    /**
+     * Append n samples to the stream
+     */
+    void push(const float* samples, int n);
+
+    /**
+     * Append n int16 PCM samples, converting to float on the way in
+     */
+    void pushPcm16(const int16_t* samples, int n);
+
+    /**
+     * Analyze the next complete frame, if any.
+     * Returns false when fewer than one frame of samples is pending.
+     */
+    bool pull(StreamFrame& frame);
+
+    /**
+     * Copy the next complete frame out and step past it without analyzing
+     * it, for callers that analyze on the wrapper elsewhere (e.g. outside
+     * the lock that serializes push()). Analyzing out with dcOffset gives
+     * the same features pull() would.
+     * @param out Receives getFrameSize() samples
+     * @param dcOffset Mean of the frame
+     * @param sampleIndex Absolute index of the frame's first sample
+     * Returns false when fewer than one frame of samples is pending.
+     */
+    bool takeFrame(float* out, float& dcOffset, int64_t& sampleIndex);
+
+    /**
+     * Number of frames that pull() can currently emit
+     */
+    int available() const;
+
+    /**
+     * Frames skipped because the producer overran the ring
+     */
+    int64_t getDroppedFrames() const { return droppedFrames; }
+
+    /**
+     * Total samples pushed since construction or the last reset()
+     */
+    int64_t getSamplesPushed() const { return writeIndex; }
+
+    int getSampleRate() const { return sampleRate; }
+    int getFrameSize() const { return frameSize; }
+    int getHopSize() const { return hopSize; }
+
+    /**
+     * Discard buffered audio, forget the wrapper's pitch track and restart
+     * timestamps at zero
+     */
+    void reset();
+};
+
+/**
+ * Throughput and latency of one run of a source through a stream
+ */
+struct SourceRunStats {
+    int64_t samples = 0;
+    int64_t frames = 0;
+    int64_t validFrames = 0;
+    int64_t droppedFrames = 0;
+    double wallSeconds = 0.0;
+    double realtimeFactor = 0.0;    // Audio seconds per wall second
+    // From the arrival of the block completing a frame to its result
+    double meanLatencyMs = 0.0;
+    double p50LatencyMs = 0.0;
+    double p95LatencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+};
+
+/**
+ * Push a source through a streaming session until it ends, pulling every
+ * frame as soon as it is complete, as the live pipeline does. Blocks are
+ * pushed a hop at a time, so any block size fits the session's ring.
+ * @param onFrame Called for every pulled frame, may be empty
+ */
+SourceRunStats runAudioSource(AudioSource& source, StreamingAnalyzer& stream, int blockSize,
+                              const std::function<void(const StreamFrame&)>& onFrame = nullptr);
+
+#endif // STREAMING_ANALYZER_H
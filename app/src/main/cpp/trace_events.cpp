@@ -0,0 +1,214 @@
+#include "trace_events.h"
+#include <android/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define LOG_TAG "TraceEvents"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static const char* const kTraceStageNames[kTraceStageCount] = {
+        "frame",
+        "energy",
+        "window",
+        "spectrum",
+        "pitch",
+        "pitchConfidence",
+        "spectralMoments",
+        "mfcc",
+        "hnr",
+        "lpc",
+        "formants",
+        "formantSweeps",
+        "buffer",
+        "streamPush",
+        "streamPull",
+        "resample",
+};
+
+std::atomic<bool> g_traceEnabled(false);
+
+namespace {
+
+/**
+ * Single-producer ring owned by one thread. The owner is the only writer;
+ * exporters read a snapshot and discard any slot the owner may have
+ * overwritten while they were copying.
+ */
+struct TraceRing {
+    std::atomic<uint64_t> head{0};   // Total events ever written
+    uint32_t threadId = 0;
+    TraceEvent events[kTraceRingCapacity];
+};
+
+// Rings outlive their threads so late exports still see their events.
+// Analysis threads are long-lived pool workers, so this stays small.
+std::mutex s_registryMutex;
+std::vector<std::unique_ptr<TraceRing>> s_rings;
+
+TraceRing* registerThreadRing() {
+    auto ring = std::make_unique<TraceRing>();
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    ring->threadId = static_cast<uint32_t>(s_rings.size() + 1);
+    s_rings.push_back(std::move(ring));
+    return s_rings.back().get();
+}
+
+TraceRing* threadRing() {
+    thread_local TraceRing* ring = nullptr;
+    if (ring == nullptr) {
+        ring = registerThreadRing();
+    }
+    return ring;
+}
+
+// Copy the retained events of one ring, oldest first
+void snapshot(const TraceRing& ring, std::vector<TraceEvent>& out) {
+    out.clear();
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > kTraceRingCapacity ? head - kTraceRingCapacity : 0;
+
+    out.reserve(static_cast<size_t>(head - first));
+    for (uint64_t i = first; i < head; ++i) {
+        out.push_back(ring.events[i & (kTraceRingCapacity - 1)]);
+    }
+
+    // Slots below the producer's new position minus capacity (and the slot it
+    // may be writing right now) can have been overwritten during the copy
+    const uint64_t after = ring.head.load(std::memory_order_acquire);
+    if (after == head) return;
+    const uint64_t safeFirst = after >= kTraceRingCapacity ? after - kTraceRingCapacity + 1 : 0;
+    if (safeFirst > first) {
+        const size_t torn = static_cast<size_t>(std::min<uint64_t>(safeFirst - first, out.size()));
+        out.erase(out.begin(), out.begin() + torn);
+    }
+}
+
+} // namespace
+
+void traceSetEnabled(bool enabled) {
+    if (enabled && !traceIsAvailable()) {
+        LOGI("Tracing requested but trace points are compiled out (ANALYZER_TRACING=0)");
+    }
+    g_traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+const char* traceStageName(uint16_t stage) {
+    return stage < kTraceStageCount ? kTraceStageNames[stage] : "unknown";
+}
+
+bool traceIsAvailable() {
+    return ANALYZER_TRACING != 0;
+}
+
+void traceRecord(uint16_t stage, uint8_t phase, uint32_t frameId, uint64_t startNs, uint32_t durationNs, float value) {
+    TraceRing* ring = threadRing();
+    const uint64_t index = ring->head.load(std::memory_order_relaxed);
+
+    TraceEvent& event = ring->events[index & (kTraceRingCapacity - 1)];
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.frameId = frameId;
+    event.stage = stage;
+    event.phase = phase;
+    event.reserved = 0;
+    event.value = value;
+
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+void traceClear() {
+    // Only safe to race with producers in the sense that events recorded
+    // concurrently may survive the clear
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    for (auto& ring : s_rings) {
+        ring->head.store(0, std::memory_order_release);
+    }
+}
+
+size_t traceCollect(std::vector<TraceEvent>& out) {
+    out.clear();
+
+    std::vector<const TraceRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        for (auto& ring : s_rings) rings.push_back(ring.get());
+    }
+
+    std::vector<TraceEvent> events;
+    for (const TraceRing* ring : rings) {
+        snapshot(*ring, events);
+        out.insert(out.end(), events.begin(), events.end());
+    }
+    return out.size();
+}
+
+size_t traceExportChromeJson(std::string& out) {
+    out.assign("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    std::vector<const TraceRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        for (auto& ring : s_rings) rings.push_back(ring.get());
+    }
+
+    std::vector<TraceEvent> events;
+    size_t written = 0;
+    char line[256];
+    bool first = true;
+
+    for (const TraceRing* ring : rings) {
+        snapshot(*ring, events);
+        if (events.empty()) continue;
+
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"analysis-%u\"}}",
+                      first ? "" : ",", ring->threadId, ring->threadId);
+        out.append(line);
+        first = false;
+
+        for (const TraceEvent& e : events) {
+            const char* name = traceStageName(e.stage);
+            // Chrome trace timestamps are microseconds
+            const double ts = static_cast<double>(e.startNs) / 1000.0;
+
+            if (e.phase == kTracePhaseSpan) {
+                std::snprintf(line, sizeof(line),
+                              ",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                              "\"args\":{\"frame\":%u}}",
+                              name, ring->threadId, ts, e.durationNs / 1000.0, e.frameId);
+            } else {
+                std::snprintf(line, sizeof(line),
+                              ",{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+                              "\"args\":{\"value\":%g}}",
+                              name, ring->threadId, ts, e.value);
+            }
+            out.append(line);
+            ++written;
+        }
+    }
+
+    out.append("]}\n");
+    return written;
+}
+
+bool traceWriteChromeJson(const char* path) {
+    if (path == nullptr) return false;
+
+    std::string json;
+    const size_t events = traceExportChromeJson(json);
+
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        LOGE("Failed to open trace output %s", path);
+        return false;
+    }
+    const bool ok = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    std::fclose(file);
+
+    LOGI("Wrote %zu trace events to %s", events, path);
+    return ok;
+}
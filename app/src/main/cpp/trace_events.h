@@ -0,0 +1,162 @@
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Low-overhead tracing for the analysis hot path.
+ *
+ * Trace points write fixed-size binary events into a per-thread ring buffer
+ * (no locks, no formatting, no allocation after a thread's first event).
+ * The newest events of every thread can be exported as Chrome trace JSON,
+ * which chrome://tracing and ui.perfetto.dev both open.
+ *
+ * Trace points compile to nothing unless ANALYZER_TRACING is defined to 1
+ * (CMake option ANALYZER_TRACING). When compiled in, recording is still off
+ * until traceSetEnabled(true), and costs one relaxed load per trace point.
+ */
+
+#ifndef ANALYZER_TRACING
+#define ANALYZER_TRACING 0
+#endif
+
+/**
+ * Stage ids recorded in events. Keep kTraceStageNames in trace_events.cpp in sync.
+ */
+enum TraceStage : uint16_t {
+    kTraceFrame = 0,        // Whole analyzeFrame call
+    kTraceEnergyGate,       // Frame energy (value)
+    kTraceWindow,
+    kTraceSpectrum,
+    kTracePitch,            // Pitch in Hz (value), YIN duration
+    kTracePitchConfidence,  // YIN confidence (value)
+    kTraceSpectralMoments,  // Fused centroid/energy/brightness/resonance pass
+    kTraceMfcc,
+    kTraceHnr,
+    kTraceLpc,
+    kTraceFormants,
+    kTraceFormantSweeps,    // Root solver sweeps (value)
+    kTraceBuffer,           // Whole analyzeBuffer call
+    kTraceStreamPush,
+    kTraceStreamPull,
+    kTraceResample,         // Voice band resampling of a frame or buffer
+    kTraceStageCount
+};
+
+/**
+ * One binary trace event (24 bytes)
+ */
+struct TraceEvent {
+    uint64_t startNs;       // steady_clock timestamp
+    uint32_t durationNs;    // 0 for value events
+    uint32_t frameId;
+    uint16_t stage;
+    uint8_t phase;          // kTracePhase*
+    uint8_t reserved;
+    float value;
+};
+
+static const uint8_t kTracePhaseSpan = 'X';
+static const uint8_t kTracePhaseValue = 'C';
+
+/**
+ * Events retained per thread; older events are overwritten
+ */
+static const size_t kTraceRingCapacity = 1u << 14;
+
+extern std::atomic<bool> g_traceEnabled;
+
+void traceSetEnabled(bool enabled);
+
+inline bool traceIsEnabled() {
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * True when trace points were compiled in
+ */
+bool traceIsAvailable();
+
+/**
+ * Short name of a stage id, as used in exported traces
+ */
+const char* traceStageName(uint16_t stage);
+
+/**
+ * Append an event to the calling thread's ring
+ */
+void traceRecord(uint16_t stage, uint8_t phase, uint32_t frameId, uint64_t startNs, uint32_t durationNs, float value);
+
+/**
+ * Discard all recorded events (rings stay allocated)
+ */
+void traceClear();
+
+/**
+ * Copy every thread's retained events into out, grouped by thread and
+ * oldest first within each thread. Returns the number of events.
+ */
+size_t traceCollect(std::vector<TraceEvent>& out);
+
+/**
+ * Render every thread's retained events as Chrome trace JSON.
+ * Returns the number of events written.
+ */
+size_t traceExportChromeJson(std::string& out);
+
+/**
+ * Write the Chrome trace JSON to a file. Returns false on I/O failure.
+ */
+bool traceWriteChromeJson(const char* path);
+
+inline uint64_t traceNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Records one span event covering its lifetime
+ */
+class TraceScope {
+private:
+    uint16_t stage;
+    uint32_t frameId;
+    uint64_t startNs;
+
+public:
+    TraceScope(uint16_t s, uint32_t frame)
+            : stage(s), frameId(frame), startNs(traceIsEnabled() ? traceNowNs() : 0) {}
+
+    ~TraceScope() {
+        if (startNs != 0) {
+            const uint64_t now = traceNowNs();
+            traceRecord(stage, kTracePhaseSpan, frameId, startNs, static_cast<uint32_t>(now - startNs), 0.0f);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if ANALYZER_TRACING
+#define TRACE_SCOPE(stage, frameId) TraceScope TRACE_CONCAT(traceScope_, __LINE__)((stage), (frameId))
+#define TRACE_VALUE(stage, frameId, value) \
+    do { \
+        if (traceIsEnabled()) { \
+            traceRecord((stage), kTracePhaseValue, (frameId), traceNowNs(), 0, static_cast<float>(value)); \
+        } \
+    } while (0)
+#else
+#define TRACE_SCOPE(stage, frameId) ((void)0)
+#define TRACE_VALUE(stage, frameId, value) ((void)0)
+#endif
+
+#endif // TRACE_EVENTS_H
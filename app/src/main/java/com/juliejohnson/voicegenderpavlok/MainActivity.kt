@@ -20,6 +20,7 @@ import com.juliejohnson.voicegenderpavlok.ui.enrollment.EnrollmentHistoryActivit
 import com.juliejohnson.voicegenderpavlok.ui.SettingsActivity
 import com.juliejohnson.voicegenderpavlok.ui.SpeakerTestActivity
 import com.juliejohnson.voicegenderpavlok.utils.*
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.flow.collectLatest
 import kotlinx.coroutines.launch
 
@@ -54,6 +55,8 @@ class MainActivity : AppCompatActivity() {
 
         EnrollmentStorage.initialize(applicationContext)
         MLUtils.initialize(this)
+        // Re-embed enrollments made with an older log-mel front end
+        lifecycleScope.launch(Dispatchers.IO) { MLUtils.migrateEnrollments() }
 
         startButton = findViewById(R.id.button_start)
         stopButton = findViewById(R.id.button_stop)
@@ -0,0 +1,91 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Read-only view over a columnar result written by
+ * [EssentiaAnalyzer.analyzeBufferColumnar].
+ *
+ * Scalar features are stored as one float column each; MFCC and formant
+ * values (and formant bandwidths, which share the formant offsets) are
+ * flattened with per-frame offsets, so frame i spans
+ * [offsets[i], offsets[i + 1]) of the value column. Only valid frames are
+ * present; [frameIndex] gives each one's hop index in the source buffer.
+ * The view reads the buffer lazily and is only valid until it is reused.
+ */
+class AudioFeatureColumns internal constructor(buffer: ByteBuffer) {
+
+    companion object {
+        const val VERSION = 2
+        private const val HEADER_FIELDS = 14
+    }
+
+    private val data: ByteBuffer = buffer.duplicate().order(ByteOrder.nativeOrder())
+    private val header = IntArray(HEADER_FIELDS) { data.getInt(it * 4) }
+
+    val version: Int get() = header[0]
+    val frameCount: Int get() = header[1]
+    val totalBytes: Int get() = header[2]
+
+    private val frameIndexOffset get() = header[3]
+    private val pitchOffset get() = header[4]
+    private val brightnessOffset get() = header[5]
+    private val resonanceOffset get() = header[6]
+    private val centroidOffset get() = header[7]
+    private val hnrOffset get() = header[8]
+    private val mfccIndexOffset get() = header[9]
+    private val mfccValuesOffset get() = header[10]
+    private val formantIndexOffset get() = header[11]
+    private val formantValuesOffset get() = header[12]
+    private val bandwidthValuesOffset get() = header[13]
+
+    fun frameIndex(frame: Int): Int = data.getInt(frameIndexOffset + frame * 4)
+    fun pitch(frame: Int): Float = data.getFloat(pitchOffset + frame * 4)
+    fun brightness(frame: Int): Float = data.getFloat(brightnessOffset + frame * 4)
+    fun resonance(frame: Int): Float = data.getFloat(resonanceOffset + frame * 4)
+    fun centroid(frame: Int): Float = data.getFloat(centroidOffset + frame * 4)
+    fun hnr(frame: Int): Float = data.getFloat(hnrOffset + frame * 4)
+
+    fun mfcc(frame: Int): FloatArray = slice(mfccIndexOffset, mfccValuesOffset, frame)
+    fun formants(frame: Int): FloatArray = slice(formantIndexOffset, formantValuesOffset, frame)
+    fun formantBandwidths(frame: Int): FloatArray = slice(formantIndexOffset, bandwidthValuesOffset, frame)
+
+    /**
+     * Copy one scalar column into a FloatArray (e.g. the pitch track)
+     */
+    fun pitchColumn(): FloatArray = column(pitchOffset)
+    fun brightnessColumn(): FloatArray = column(brightnessOffset)
+    fun resonanceColumn(): FloatArray = column(resonanceOffset)
+    fun centroidColumn(): FloatArray = column(centroidOffset)
+    fun hnrColumn(): FloatArray = column(hnrOffset)
+
+    /**
+     * Materialize the frames as AudioFeatures objects, matching [EssentiaAnalyzer.analyzeBuffer]
+     */
+    fun toFeatures(): List<AudioFeatures> = List(frameCount) { frame ->
+        AudioFeatures(
+            pitch = pitch(frame),
+            brightness = brightness(frame),
+            resonance = resonance(frame),
+            centroid = centroid(frame),
+            mfcc = mfcc(frame),
+            formants = formants(frame),
+            hnr = hnr(frame),
+            isValid = true,
+            formantBandwidths = formantBandwidths(frame)
+        )
+    }
+
+    private fun column(offset: Int): FloatArray {
+        val out = FloatArray(frameCount)
+        data.duplicate().order(ByteOrder.nativeOrder()).apply { position(offset) }.asFloatBuffer().get(out)
+        return out
+    }
+
+    private fun slice(indexOffset: Int, valuesOffset: Int, frame: Int): FloatArray {
+        val start = data.getInt(indexOffset + frame * 4)
+        val end = data.getInt(indexOffset + (frame + 1) * 4)
+        return FloatArray(end - start) { data.getFloat(valuesOffset + (start + it) * 4) }
+    }
+}
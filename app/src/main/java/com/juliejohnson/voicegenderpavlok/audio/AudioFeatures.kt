@@ -8,7 +8,8 @@ data class AudioFeatures(
     val mfcc: FloatArray = floatArrayOf(), // MFCC coefficients
     val formants: FloatArray = floatArrayOf(), // Formant frequencies
     val hnr: Float = 0f,                // Harmonic-to-noise ratio
-    val isValid: Boolean = false        // Whether analysis was successful
+    val isValid: Boolean = false,       // Whether analysis was successful
+    val formantBandwidths: FloatArray = floatArrayOf() // Bandwidth of each formant in Hz
 ) {
     override fun equals(other: Any?): Boolean {
         if (this === other) return true
@@ -24,6 +25,7 @@ data class AudioFeatures(
         if (!formants.contentEquals(other.formants)) return false
         if (hnr != other.hnr) return false
         if (isValid != other.isValid) return false
+        if (!formantBandwidths.contentEquals(other.formantBandwidths)) return false
 
         return true
     }
@@ -37,6 +39,7 @@ data class AudioFeatures(
         result = 31 * result + formants.contentHashCode()
         result = 31 * result + hnr.hashCode()
         result = 31 * result + isValid.hashCode()
+        result = 31 * result + formantBandwidths.contentHashCode()
         return result
     }
 }
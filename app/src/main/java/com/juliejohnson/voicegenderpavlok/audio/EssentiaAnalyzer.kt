@@ -1,9 +1,17 @@
 package com.juliejohnson.voicegenderpavlok.audio
 
+import java.nio.ByteBuffer
+import java.nio.FloatBuffer
+
 /**
- * JNI wrapper for Essentia audio analysis library
+ * JNI wrapper for Essentia audio analysis library.
+ * Each instance owns an independent native analyzer, so several instances
+ * (with different sample rates if needed) can be used concurrently.
  */
-class EssentiaAnalyzer {
+class EssentiaAnalyzer private constructor(
+    private var handle: Long,
+    private val pooled: Boolean
+) {
 
     companion object {
         init {
@@ -11,19 +19,82 @@ class EssentiaAnalyzer {
         }
 
         private const val TAG = "EssentiaAnalyzer"
+
+        /**
+         * Wrap an analyzer checked out of an [EssentiaAnalyzerPool]
+         */
+        internal fun borrowed(handle: Long): EssentiaAnalyzer = EssentiaAnalyzer(handle, pooled = true)
     }
 
-    private var isInitialized = false
+    constructor() : this(0L, pooled = false)
+
+    private val openStreams = mutableListOf<EssentiaStream>()
+
+    private val isInitialized: Boolean
+        get() = handle != 0L
 
     /**
-     * Initialize Essentia library and algorithms
+     * Initialize the native analyzer
      * Call this once before using analysis functions
+     * @param features [FeatureSet] mask; only the algorithms these features need are created
+     * @param voiceBand Resample to about 10-12 kHz before analysis. Keeps everything below
+     *        4 kHz (pitch, formants) and cuts per-frame work; frames are still passed in at
+     *        [sampleRate] and [frameSize].
      */
-    fun initialize(sampleRate: Int = 44100): Boolean {
-        isInitialized = nativeInitialize(sampleRate)
+    fun initialize(
+        sampleRate: Int = 44100,
+        frameSize: Int = 1024,
+        hopSize: Int = 512,
+        features: Int = FeatureSet.ALL,
+        voiceBand: Boolean = false
+    ): Boolean {
+        if (!isInitialized) {
+            handle = nativeCreate(sampleRate, frameSize, hopSize, features, voiceBand)
+        }
         return isInitialized
     }
 
+    /**
+     * Change which features later analysis calls compute.
+     * Features outside the mask are reported as 0 or empty.
+     */
+    fun setFeatureSet(features: Int): Boolean {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeSetFeatureSet(handle, features)
+    }
+
+    /**
+     * Track pitch across frames instead of estimating each frame alone.
+     * Cheaper on sustained speech and resistant to octave jumps, but
+     * consecutive analyzeFrame calls must then be consecutive hops of one
+     * stream (buffer and stream analysis handle this themselves).
+     */
+    fun setPitchTracking(enabled: Boolean): Boolean {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeSetPitchTracking(handle, enabled)
+    }
+
+    /**
+     * Drain capture rings ([analyzeRing]) through a three-stage native
+     * pipeline (front end, pitch/spectral, envelope), one thread per stage.
+     * Raises sustained frames per second on multi-core devices; results
+     * are the same frames in the same order.
+     * @return false if the pipeline could not be started
+     */
+    fun setPipelined(enabled: Boolean): Boolean {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeSetPipelined(handle, enabled)
+    }
+
     /**
      * Analyze audio frame and extract features
      * @param audioData Float array containing audio samples
@@ -39,7 +110,74 @@ class EssentiaAnalyzer {
             return null
         }
 
-        return nativeAnalyzeFrame(audioData, frameSize)
+        return nativeAnalyzeFrame(handle, audioData, frameSize)
+    }
+
+    /**
+     * Analyze a frame of 16-bit PCM as captured by AudioRecord.
+     * The samples are copied out of the array into a reused native buffer
+     * (the array is never pinned) and converted to float natively.
+     * @param pcm Samples, full scale mapped to [-1, 1)
+     * @param frameSize Number of samples to analyze from the start of pcm
+     */
+    fun analyzeFramePcm16(pcm: ShortArray, frameSize: Int = 1024): AudioFeatures? {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        if (pcm.size < frameSize) {
+            return null
+        }
+
+        return nativeAnalyzeFramePcm16(handle, pcm, frameSize)
+    }
+
+    /**
+     * Analyze a frame of 16-bit PCM held in a direct ByteBuffer in native byte order
+     * (e.g. filled by AudioRecord.read(ByteBuffer, ...)). Nothing is copied on the Java side.
+     */
+    fun analyzeFramePcm16(pcm: ByteBuffer, frameSize: Int = 1024): AudioFeatures? {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+        require(pcm.isDirect) { "PCM input must be a direct ByteBuffer" }
+
+        if (pcm.capacity() < frameSize * 2) {
+            return null
+        }
+
+        return nativeAnalyzeFramePcm16Direct(handle, pcm, frameSize)
+    }
+
+    /**
+     * Analyze a 16-bit PCM buffer with automatic windowing
+     * @param pcm Direct ByteBuffer of native-order samples
+     * @param sampleCount Number of samples in pcm
+     * @param hopSize Hop size for windowing
+     */
+    fun analyzeBufferPcm16(pcm: ByteBuffer, sampleCount: Int, hopSize: Int = 512): List<AudioFeatures> {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+        require(pcm.isDirect) { "PCM input must be a direct ByteBuffer" }
+
+        return nativeAnalyzeBufferPcm16Direct(handle, pcm, sampleCount, hopSize)?.filterNotNull() ?: emptyList()
+    }
+
+    /**
+     * Analyze every complete frame waiting in a capture ring, one hop apart, in place.
+     * Consumes the samples before the first frame not yet complete; call again
+     * as more arrive. This analyzer must be the ring's only reader.
+     * @param ring Ring whose maxFrameSize is at least this analyzer's frame size
+     * @return Valid frames, in order
+     */
+    fun analyzeRing(ring: PcmRing): List<AudioFeatures> {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+        check(ring.handle != 0L) { "PcmRing is closed" }
+
+        return nativeAnalyzeRing(handle, ring.handle)?.filterNotNull() ?: emptyList()
     }
 
     /**
@@ -53,18 +191,118 @@ class EssentiaAnalyzer {
             throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
         }
 
-        return nativeAnalyzeBuffer(audioBuffer, hopSize).filterNotNull()
+        return nativeAnalyzeBuffer(handle, audioBuffer, hopSize).filterNotNull()
+    }
+
+    /**
+     * [analyzeBuffer] at the configured hop that also fills the speaker embedding's
+     * log-mel input from the same FFTs, so one STFT serves both. The analyzer must run
+     * on the log-mel grid: initialize(sampleRate = 16000, frameSize = 512, hopSize = 160)
+     * without voice band.
+     * @param logMel Direct buffer from [AudioFeatureExtractor.allocateInput]; receives the
+     *        same values as [AudioFeatureExtractor.extractLogMel] without normalization
+     * @return Features per valid frame, or null if the grids do not match
+     */
+    fun analyzeBufferWithLogMel(audioBuffer: FloatArray, logMel: FloatBuffer): List<AudioFeatures>? {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeAnalyzeBufferWithLogMel(handle, audioBuffer, logMel)?.filterNotNull()
+    }
+
+    /**
+     * Analyze audio buffer across a pool of native worker threads.
+     * Results are identical in content and order to [analyzeBuffer].
+     * @param audioBuffer Complete audio buffer
+     * @param hopSize Hop size for windowing
+     * @param numThreads Worker count (0 = one per CPU core)
+     * @return List of AudioFeatures for each frame
+     */
+    fun analyzeBufferParallel(audioBuffer: FloatArray, hopSize: Int = 512, numThreads: Int = 0): List<AudioFeatures> {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeAnalyzeBufferParallel(handle, audioBuffer, hopSize, numThreads).filterNotNull()
+    }
+
+    /**
+     * Analyze audio buffer through the three-stage native pipeline (see
+     * [setPipelined]). Results are identical in content and order to
+     * [analyzeBuffer].
+     * @param audioBuffer Complete audio buffer
+     * @param hopSize Hop size for windowing
+     * @return List of AudioFeatures for each frame
+     */
+    fun analyzeBufferPipelined(audioBuffer: FloatArray, hopSize: Int = 512): List<AudioFeatures> {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeAnalyzeBufferPipelined(handle, audioBuffer, hopSize)?.filterNotNull() ?: emptyList()
+    }
+
+    /**
+     * Bytes a direct buffer needs to hold [analyzeBufferColumnar] output
+     * for a buffer of the given length (worst case, every frame valid)
+     */
+    fun columnarCapacity(bufferLength: Int, hopSize: Int = 512): Int {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        return nativeColumnarCapacity(handle, bufferLength, hopSize)
+    }
+
+    /**
+     * Analyze audio buffer and write the results as feature columns into
+     * a caller-owned direct buffer, avoiding one object per frame.
+     * The buffer can be reused across calls.
+     * @param audioBuffer Complete audio buffer
+     * @param hopSize Hop size for windowing
+     * @param output Direct ByteBuffer of at least [columnarCapacity] bytes
+     * @return Column view over output, or null if analysis failed
+     */
+    fun analyzeBufferColumnar(audioBuffer: FloatArray, hopSize: Int = 512, output: ByteBuffer): AudioFeatureColumns? {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+        require(output.isDirect) { "Columnar output must be a direct ByteBuffer" }
+
+        val written = nativeAnalyzeBufferColumnar(handle, audioBuffer, hopSize, output)
+        return if (written > 0) AudioFeatureColumns(output) else null
+    }
+
+    /**
+     * Open a continuous analysis session on this analyzer
+     * @param capacitySamples Samples buffered between pulls (0 = one frame plus eight hops)
+     * @return EssentiaStream that emits one AudioFeatures record per hop
+     */
+    fun createStream(capacitySamples: Int = 0): EssentiaStream {
+        if (!isInitialized) {
+            throw IllegalStateException("EssentiaAnalyzer not initialized. Call initialize() first.")
+        }
+
+        val stream = EssentiaStream(handle, capacitySamples)
+        synchronized(openStreams) { openStreams.add(stream) }
+        return stream
     }
 
     /**
      * Clean up resources
-     * Call this when done with analysis
+     * Call this when done with analysis. Closes any streams still open on
+     * this analyzer; pooled analyzers are returned by their pool instead.
      */
     fun cleanup() {
-        if (isInitialized) {
-            nativeCleanup()
-            isInitialized = false
+        synchronized(openStreams) {
+            openStreams.forEach { it.close() }
+            openStreams.clear()
+        }
+        if (isInitialized && !pooled) {
+            nativeDestroy(handle)
         }
+        handle = 0L
     }
 
     /**
@@ -73,8 +311,20 @@ class EssentiaAnalyzer {
     fun isReady(): Boolean = isInitialized
 
     // Native method declarations
-    private external fun nativeInitialize(sampleRate: Int): Boolean
-    private external fun nativeAnalyzeFrame(audioData: FloatArray, frameSize: Int): AudioFeatures?
-    private external fun nativeAnalyzeBuffer(audioBuffer: FloatArray, hopSize: Int): Array<AudioFeatures?>
-    private external fun nativeCleanup()
-}
\ No newline at end of file
+    private external fun nativeCreate(sampleRate: Int, frameSize: Int, hopSize: Int, features: Int, voiceBand: Boolean): Long
+    private external fun nativeSetFeatureSet(handle: Long, features: Int): Boolean
+    private external fun nativeSetPitchTracking(handle: Long, enabled: Boolean): Boolean
+    private external fun nativeSetPipelined(handle: Long, enabled: Boolean): Boolean
+    private external fun nativeAnalyzeFrame(handle: Long, audioData: FloatArray, frameSize: Int): AudioFeatures?
+    private external fun nativeAnalyzeBuffer(handle: Long, audioBuffer: FloatArray, hopSize: Int): Array<AudioFeatures?>
+    private external fun nativeAnalyzeBufferWithLogMel(handle: Long, audioBuffer: FloatArray, logMel: FloatBuffer): Array<AudioFeatures?>?
+    private external fun nativeAnalyzeBufferParallel(handle: Long, audioBuffer: FloatArray, hopSize: Int, numThreads: Int): Array<AudioFeatures?>
+    private external fun nativeAnalyzeBufferPipelined(handle: Long, audioBuffer: FloatArray, hopSize: Int): Array<AudioFeatures?>?
+    private external fun nativeAnalyzeFramePcm16(handle: Long, pcm: ShortArray, frameSize: Int): AudioFeatures?
+    private external fun nativeAnalyzeFramePcm16Direct(handle: Long, pcm: ByteBuffer, frameSize: Int): AudioFeatures?
+    private external fun nativeAnalyzeBufferPcm16Direct(handle: Long, pcm: ByteBuffer, sampleCount: Int, hopSize: Int): Array<AudioFeatures?>?
+    private external fun nativeAnalyzeRing(handle: Long, ringHandle: Long): Array<AudioFeatures?>?
+    private external fun nativeColumnarCapacity(handle: Long, bufferLength: Int, hopSize: Int): Int
+    private external fun nativeAnalyzeBufferColumnar(handle: Long, audioBuffer: FloatArray, hopSize: Int, output: ByteBuffer): Int
+    private external fun nativeDestroy(handle: Long)
+}
@@ -0,0 +1,69 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+/**
+ * Pool of pre-initialized native analyzers sharing one configuration.
+ * Concurrent callers (e.g. the monitoring service and AnalysisActivity)
+ * check analyzers out instead of each creating and tearing one down.
+ *
+ * @param features [FeatureSet] mask computed by every analyzer in the pool
+ * @param voiceBand Analyze in the voice band; see [EssentiaAnalyzer.initialize]
+ * @param maxSize Upper bound on analyzers (0 = unbounded); checkout blocks while all are in use
+ * @param prewarm Analyzers created up front
+ */
+class EssentiaAnalyzerPool(
+    sampleRate: Int = 44100,
+    frameSize: Int = 1024,
+    hopSize: Int = 512,
+    features: Int = FeatureSet.ALL,
+    voiceBand: Boolean = false,
+    maxSize: Int = 0,
+    prewarm: Int = 1
+) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("essentia_wrapper")
+        }
+    }
+
+    private var pool: Long = nativeCreate(sampleRate, frameSize, hopSize, features, voiceBand, maxSize, prewarm)
+
+    init {
+        if (pool == 0L) {
+            throw IllegalStateException("Failed to create native analyzer pool")
+        }
+    }
+
+    /**
+     * Run [block] with an analyzer checked out of the pool, returning it afterwards
+     */
+    fun <T> withAnalyzer(block: (EssentiaAnalyzer) -> T): T {
+        check(pool != 0L) { "EssentiaAnalyzerPool is closed" }
+
+        val handle = nativeAcquire(pool)
+        if (handle == 0L) {
+            throw IllegalStateException("Failed to check out an analyzer")
+        }
+
+        val analyzer = EssentiaAnalyzer.borrowed(handle)
+        try {
+            return block(analyzer)
+        } finally {
+            analyzer.cleanup()
+            nativeRelease(pool, handle)
+        }
+    }
+
+    override fun close() {
+        if (pool != 0L) {
+            nativeDestroy(pool)
+            pool = 0L
+        }
+    }
+
+    // Native method declarations
+    private external fun nativeCreate(sampleRate: Int, frameSize: Int, hopSize: Int, features: Int, voiceBand: Boolean, maxSize: Int, prewarm: Int): Long
+    private external fun nativeAcquire(pool: Long): Long
+    private external fun nativeRelease(pool: Long, handle: Long)
+    private external fun nativeDestroy(pool: Long)
+}
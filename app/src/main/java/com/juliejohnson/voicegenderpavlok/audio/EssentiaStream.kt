@@ -0,0 +1,89 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+import java.nio.ByteBuffer
+
+/**
+ * Analysis result for one hop of a continuous stream
+ * @param sampleIndex Index of the frame's first sample since the stream started
+ * @param timestamp Frame start in seconds (sampleIndex / sampleRate)
+ */
+data class StreamFeatures(
+    val sampleIndex: Long,
+    val timestamp: Double,
+    val features: AudioFeatures
+)
+
+/**
+ * Continuous push/pull analysis session backed by the native StreamingAnalyzer.
+ * Obtain one from [EssentiaAnalyzer.createStream] and close it before the
+ * analyzer is cleaned up.
+ */
+class EssentiaStream internal constructor(analyzerHandle: Long, capacitySamples: Int) : AutoCloseable {
+
+    private var handle: Long = nativeCreate(analyzerHandle, capacitySamples)
+
+    init {
+        if (handle == 0L) {
+            throw IllegalStateException("Failed to create native stream. Is EssentiaAnalyzer initialized?")
+        }
+    }
+
+    /**
+     * Append newly captured samples to the stream
+     */
+    fun push(samples: FloatArray, count: Int = samples.size) {
+        check(handle != 0L) { "EssentiaStream is closed" }
+        nativePush(handle, samples, count)
+    }
+
+    /**
+     * Append 16-bit PCM straight from AudioRecord; converted to float natively
+     */
+    fun pushPcm16(samples: ShortArray, count: Int = samples.size) {
+        check(handle != 0L) { "EssentiaStream is closed" }
+        nativePushPcm16(handle, samples, count)
+    }
+
+    /**
+     * Append 16-bit PCM from a direct ByteBuffer in native byte order
+     */
+    fun pushPcm16(samples: ByteBuffer, count: Int) {
+        check(handle != 0L) { "EssentiaStream is closed" }
+        require(samples.isDirect) { "PCM input must be a direct ByteBuffer" }
+        nativePushPcm16Direct(handle, samples, count)
+    }
+
+    /**
+     * Analyze the next pending hop, or return null if a full frame is not yet buffered
+     */
+    fun pull(): StreamFeatures? {
+        check(handle != 0L) { "EssentiaStream is closed" }
+        return nativePull(handle)
+    }
+
+    /**
+     * Drain every hop that can currently be analyzed
+     */
+    fun pullAll(): List<StreamFeatures> {
+        val frames = mutableListOf<StreamFeatures>()
+        while (true) {
+            frames.add(pull() ?: break)
+        }
+        return frames
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    // Native method declarations
+    private external fun nativeCreate(analyzerHandle: Long, capacitySamples: Int): Long
+    private external fun nativePush(handle: Long, samples: FloatArray, count: Int)
+    private external fun nativePushPcm16(handle: Long, samples: ShortArray, count: Int)
+    private external fun nativePushPcm16Direct(handle: Long, samples: ByteBuffer, count: Int)
+    private external fun nativePull(handle: Long): StreamFeatures?
+    private external fun nativeDestroy(handle: Long)
+}
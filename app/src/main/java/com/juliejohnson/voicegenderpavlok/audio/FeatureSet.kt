@@ -0,0 +1,17 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+/**
+ * Bit flags selecting which features the native analyzer computes.
+ * Mirrors the kFeature* constants in essentia_wrapper.h. Pitch is always
+ * computed because it decides whether a frame is valid.
+ */
+object FeatureSet {
+    const val PITCH = 1 shl 0
+    const val CENTROID = 1 shl 1
+    const val MFCC = 1 shl 2
+    const val FORMANTS = 1 shl 3
+    const val HNR = 1 shl 4
+    const val BRIGHTNESS = 1 shl 5
+    const val RESONANCE = 1 shl 6
+    const val ALL = (1 shl 7) - 1
+}
@@ -0,0 +1,42 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+/**
+ * Controls the native analysis trace points (per-stage timings and values).
+ * Trace points only exist in builds configured with -DANALYZER_TRACING=ON;
+ * otherwise [isAvailable] is false and the other calls do nothing useful.
+ */
+object NativeTrace {
+
+    init {
+        System.loadLibrary("essentia_wrapper")
+    }
+
+    /**
+     * Whether trace points were compiled into the native library
+     */
+    val isAvailable: Boolean
+        get() = nativeIsAvailable()
+
+    /**
+     * Start or stop recording. Each analysis thread keeps its newest events.
+     */
+    fun setEnabled(enabled: Boolean) = nativeSetEnabled(enabled)
+
+    /**
+     * Drop all recorded events
+     */
+    fun clear() = nativeClear()
+
+    /**
+     * Write the recorded events as Chrome trace JSON, viewable in
+     * chrome://tracing or ui.perfetto.dev
+     * @param path Output file, e.g. under Context.filesDir
+     */
+    fun writeChromeJson(path: String): Boolean = nativeWriteChromeJson(path)
+
+    // Native method declarations
+    private external fun nativeIsAvailable(): Boolean
+    private external fun nativeSetEnabled(enabled: Boolean)
+    private external fun nativeClear()
+    private external fun nativeWriteChromeJson(path: String): Boolean
+}
@@ -0,0 +1,148 @@
+package com.juliejohnson.voicegenderpavlok.audio
+
+import android.media.AudioRecord
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Lock-free capture ring shared between one capture thread and one analyzer.
+ *
+ * The samples live in native memory, which this class sees as a direct
+ * ByteBuffer: [write] and [readFrom] put captured samples straight into the
+ * ring, and [EssentiaAnalyzer.analyzeRing] analyzes them where they lie.
+ * Neither side takes a lock. When the analyzer falls behind by more than
+ * [capacity] samples, new samples are dropped (see [dropped]); unread ones
+ * are never overwritten.
+ *
+ * Only one thread may write, and only one analyzer may drain the ring.
+ * Close the ring after both have stopped.
+ *
+ * @param capacitySamples Samples held, rounded up to a power of two
+ * @param maxFrameSize Longest frame the analyzer reads in one piece (its frame size)
+ * @param floatSamples Hold floats in [-1, 1] instead of 16-bit PCM
+ */
+class PcmRing(
+    capacitySamples: Int,
+    maxFrameSize: Int,
+    val floatSamples: Boolean = false
+) : AutoCloseable {
+
+    companion object {
+        init {
+            System.loadLibrary("essentia_wrapper")
+        }
+    }
+
+    internal var handle: Long = nativeCreate(capacitySamples, maxFrameSize, floatSamples)
+        private set
+
+    init {
+        if (handle == 0L) {
+            throw IllegalArgumentException("Invalid ring size: capacity=$capacitySamples, maxFrameSize=$maxFrameSize")
+        }
+    }
+
+    /** Samples held (a power of two) */
+    val capacity: Int = nativeCapacity(handle)
+
+    // Producer's view of the native storage; only the capture thread moves its position
+    private val storage: ByteBuffer = nativeBuffer(handle).order(ByteOrder.nativeOrder())
+    private val shorts = storage.asShortBuffer()
+    private val floats = storage.asFloatBuffer()
+    private val bytesPerSample = if (floatSamples) 4 else 2
+
+    /** Samples written and not yet analyzed */
+    val readable: Int
+        get() = if (handle != 0L) nativeReadable(handle) else 0
+
+    /** Samples dropped because the ring was full */
+    val dropped: Long
+        get() = if (handle != 0L) nativeDropped(handle) else 0L
+
+    /**
+     * Append 16-bit PCM (capture thread only). Requires a 16-bit ring.
+     * @return Samples written; the rest were dropped
+     */
+    fun write(samples: ShortArray, offset: Int = 0, count: Int = samples.size - offset): Int {
+        check(!floatSamples) { "Ring holds float samples" }
+        return fill(count) { position, length, done ->
+            shorts.position(position)
+            shorts.put(samples, offset + done, length)
+        }
+    }
+
+    /**
+     * Append float samples (capture thread only). Requires a float ring.
+     * @return Samples written; the rest were dropped
+     */
+    fun write(samples: FloatArray, offset: Int = 0, count: Int = samples.size - offset): Int {
+        check(floatSamples) { "Ring holds 16-bit samples" }
+        return fill(count) { position, length, done ->
+            floats.position(position)
+            floats.put(samples, offset + done, length)
+        }
+    }
+
+    /**
+     * Read up to [maxSamples] from the recorder directly into the ring
+     * (capture thread only). The recorder's encoding must match the ring:
+     * ENCODING_PCM_16BIT or ENCODING_PCM_FLOAT.
+     * @return Samples read (0 if the ring is full), or the recorder's negative error code
+     */
+    fun readFrom(recorder: AudioRecord, maxSamples: Int): Int {
+        check(handle != 0L) { "PcmRing is closed" }
+        var total = 0
+        while (total < maxSamples) {
+            val span = nativeWriteSpan(handle)
+            val length = minOf((span and 0xffffffffL).toInt(), maxSamples - total)
+            if (length == 0) break
+            // AudioRecord writes at the start of the buffer it is given, whatever its
+            // position, so hand it a view that begins at the span
+            val start = (span ushr 32).toInt() * bytesPerSample
+            val view = storage.duplicate()
+            view.position(start)
+            view.limit(start + length * bytesPerSample)
+            val read = recorder.read(view.slice(), length * bytesPerSample)
+            if (read < 0) return if (total > 0) total else read
+            nativeCommit(handle, read / bytesPerSample, 0)
+            total += read / bytesPerSample
+            if (read < length * bytesPerSample) break
+        }
+        return total
+    }
+
+    // Copy count samples span by span; put(position, length, done) fills one span
+    private inline fun fill(count: Int, put: (Int, Int, Int) -> Unit): Int {
+        check(handle != 0L) { "PcmRing is closed" }
+        var done = 0
+        while (done < count) {
+            val span = nativeWriteSpan(handle)
+            val length = minOf((span and 0xffffffffL).toInt(), count - done)
+            if (length == 0) break
+            put((span ushr 32).toInt(), length, done)
+            done += length
+            nativeCommit(handle, length, 0)
+        }
+        if (done < count) {
+            nativeCommit(handle, 0, count - done)
+        }
+        return done
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    // Native method declarations
+    private external fun nativeCreate(capacity: Int, maxSpan: Int, floatSamples: Boolean): Long
+    private external fun nativeBuffer(handle: Long): ByteBuffer
+    private external fun nativeCapacity(handle: Long): Int
+    private external fun nativeWriteSpan(handle: Long): Long
+    private external fun nativeCommit(handle: Long, count: Int, dropped: Int)
+    private external fun nativeReadable(handle: Long): Int
+    private external fun nativeDropped(handle: Long): Long
+    private external fun nativeDestroy(handle: Long)
+}
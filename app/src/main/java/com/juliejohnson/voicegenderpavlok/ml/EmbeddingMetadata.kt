@@ -7,5 +7,8 @@ data class EmbeddingMetadata(
     val audioFile: String,
     val embeddingFile: String,
     val voiceProfile: VoiceProfile,
-    val autoEnrolled: Boolean = false
+    val autoEnrolled: Boolean = false,
+    // Log-mel front end the embedding was computed with, see
+    // MLUtils.EMBEDDING_FEATURE_VERSION. Files written before the field existed decode as 1.
+    val featureVersion: Int = 1
 )
@@ -18,6 +18,14 @@ import java.nio.FloatBuffer
 
 object MLUtils {
 
+    /**
+     * Version of the log-mel front end behind every stored embedding.
+     * 1: symmetric Hamming window. 2: periodic Hamming from the shared STFT front end.
+     * Embeddings from another version are not comparable and are recomputed from
+     * their enrollment audio by migrateEnrollments.
+     */
+    const val EMBEDDING_FEATURE_VERSION = 2
+
     // --- MODIFIED: Replaced TFLite Interpreter with ONNX OrtSession ---
     private lateinit var speakerSession: OrtSession
     private lateinit var genderInterpreter: Interpreter
@@ -62,25 +70,38 @@ object MLUtils {
         }
     }
 
-    // --- MODIFIED: This function now uses the ONNX model ---
-    fun generateEmbedding(buffer: AudioBuffer): FloatArray {
-        val env = OrtEnvironment.getEnvironment()
+    // Reused ONNX input; generateEmbedding holds inputLock while it is in use
+    private val inputLock = Any()
+    private val inputBuffer: FloatBuffer by lazy { AudioFeatureExtractor.allocateInput() }
 
-        // 1. UNCHANGED: Get the raw audio and create the spectrogram. This is our model's input.
-        val mono = AudioUtils.ensureMono(buffer)
-        val features: Array<FloatArray> = AudioFeatureExtractor.extractLogMelSpectrogram(mono)
+    // --- MODIFIED: This function now uses the ONNX model ---
+    fun generateEmbedding(buffer: AudioBuffer): FloatArray = synchronized(inputLock) {
+        // 1. The spectrogram is computed natively straight into the model's input buffer
+        //    (stereo is mixed to mono on the way, as AudioUtils.ensureMono)
+        val channels = if (buffer.channels == 2) 2 else 1
+        if (!AudioFeatureExtractor.extractLogMel(buffer.samples, channels, inputBuffer)) {
+            throw IllegalStateException("Log-mel extraction failed")
+        }
+        generateEmbedding(inputBuffer)
+    }
 
-        // 2. MODIFIED: Prepare the input for the ONNX model.
-        //    We flatten the 2D spectrogram into a 1D array for the FloatBuffer.
-        val modelInput = features.flatMap { it.asIterable() }.toFloatArray()
-        val inputBuffer = FloatBuffer.wrap(modelInput)
+    /**
+     * Embedding from a log-mel input computed elsewhere, e.g. by
+     * EssentiaAnalyzer.analyzeBufferWithLogMel alongside the voice features
+     * @param logMel Direct buffer of [1, 100, 80] values from AudioFeatureExtractor.allocateInput
+     */
+    fun generateEmbedding(logMel: FloatBuffer): FloatArray {
+        val env = OrtEnvironment.getEnvironment()
+        logMel.rewind()
 
-        // The shape must match what the model was exported with: [batch_size, time_steps, num_mels]
-        // Our Android code uses 100 frames and 80 mels, which is perfect.
-        val inputShape = longArrayOf(1, features.size.toLong(), features[0].size.toLong())
+        // 2. The shape must match what the model was exported with: [batch_size, time_steps, num_mels]
+        val inputShape = longArrayOf(
+            1, AudioFeatureExtractor.NUM_FRAMES.toLong(), AudioFeatureExtractor.MEL_BANDS.toLong()
+        )
 
         // Create the OnnxTensor. "input" is the name we gave it in the export script.
-        val inputTensor = OnnxTensor.createTensor(env, inputBuffer, inputShape)
+        // A direct buffer is wrapped, not copied.
+        val inputTensor = OnnxTensor.createTensor(env, logMel, inputShape)
 
         // 3. MODIFIED: Run inference using the ONNX session.
         val results = speakerSession.run(mapOf("input" to inputTensor))
@@ -118,6 +139,38 @@ object MLUtils {
         }
     }
 
+    /**
+     * Recompute every stored embedding whose featureVersion is not EMBEDDING_FEATURE_VERSION
+     * from the sample's enrollment audio. Samples whose audio cannot be read keep their old
+     * embedding and are left out of verification until they are re-enrolled.
+     * Runs the speaker model once per stale sample, so call it off the main thread.
+     * @return The number of samples migrated
+     */
+    @Synchronized
+    fun migrateEnrollments(): Int {
+        var migrated = 0
+        EnrollmentStorage.listSamples()
+            .filter { it.metadata.featureVersion != EMBEDDING_FEATURE_VERSION }
+            .forEach { sample ->
+                try {
+                    val (pcm, sampleRate) = FileUtils.readWavFile(File(sample.audioPath))
+                    // The stored audio is what was embedded at enrollment, as saveSample wrote it.
+                    // Scaled as live audio is, so every current embedding shares one front end
+                    val samples = AudioUtils.pcm16ToFloat(pcm)
+                    val embedding = generateEmbedding(AudioBuffer(samples, sampleRate))
+                    EnrollmentStorage.updateEmbedding(sample, embedding, EMBEDDING_FEATURE_VERSION)
+                    ++migrated
+                } catch (e: Exception) {
+                    Log.w("MLUtils", "Cannot migrate ${sample.id} from feature version " +
+                            "${sample.metadata.featureVersion}, re-enrollment needed: ${e.message}")
+                }
+            }
+        if (migrated > 0) {
+            Log.i("MLUtils", "Migrated $migrated embeddings to feature version $EMBEDDING_FEATURE_VERSION")
+        }
+        return migrated
+    }
+
     // --- UNCHANGED: This function remains exactly the same ---
     fun verifySpeaker(context: Context, buffer: AudioBuffer): Boolean {
         val rawAudio = AudioUtils.ensureMonoAndFixedLength(buffer)
@@ -127,7 +180,12 @@ object MLUtils {
         val inputEmbedding = generateEmbedding(AudioBuffer(rawAudio, 16000))
         Log.d("Debug", "Raw audio size: ${rawAudio.size}, Embedding size: ${inputEmbedding.size}")
 
-        val storedSamples = EnrollmentStorage.listSamples()
+        // Embeddings from an older front end are not comparable, see migrateEnrollments
+        val storedSamples = EnrollmentStorage.listSamples().filter {
+            val current = it.metadata.featureVersion == EMBEDDING_FEATURE_VERSION
+            if (!current) Log.w("SpeakerSim", "Skipping ${it.id}: feature version ${it.metadata.featureVersion}")
+            current
+        }
 
         if (storedSamples.isEmpty()) return false
 
@@ -4,6 +4,7 @@ import android.content.Context
 import android.util.Log
 import com.juliejohnson.voicegenderpavlok.ml.EmbeddingMetadata
 import com.juliejohnson.voicegenderpavlok.ml.Gender
+import com.juliejohnson.voicegenderpavlok.ml.MLUtils
 import com.juliejohnson.voicegenderpavlok.ml.VoiceProfile
 import java.io.File
 
@@ -75,7 +76,8 @@ object EnrollmentStorage {
             audioFile = audioFileName,
             embeddingFile = embeddingFileName,
             voiceProfile = voiceProfile,
-            autoEnrolled = autoEnrolled
+            autoEnrolled = autoEnrolled,
+            featureVersion = MLUtils.EMBEDDING_FEATURE_VERSION
         )
 
         val sample = EnrollmentSample(
@@ -88,6 +90,14 @@ object EnrollmentStorage {
         saveSample(sample)
     }
 
+    /**
+     * Replace a sample's embedding, e.g. after recomputing it from the stored audio,
+     * and record the feature version it was computed with
+     */
+    fun updateEmbedding(sample: EnrollmentSample, embedding: FloatArray, featureVersion: Int) {
+        FileUtils.writeEmbeddingFile(File(sample.embeddingPath), embedding)
+        saveSample(sample.copy(metadata = sample.metadata.copy(featureVersion = featureVersion)))
+    }
 
     fun deleteSample(sampleId: String) {
         val dir = getEnrollmentDir()
@@ -115,7 +125,9 @@ object EnrollmentStorage {
     }
 
     fun listAllEmbeddings(): List<FloatArray> {
-        return listSamples().mapNotNull { sample ->
+        return listSamples().filter {
+            it.metadata.featureVersion == MLUtils.EMBEDDING_FEATURE_VERSION
+        }.mapNotNull { sample ->
             try {
                 FileUtils.readEmbedding(File(sample.embeddingPath))
             } catch (e: Exception) {
@@ -144,6 +144,54 @@ object FileUtils {
         }
     }
 
+    /**
+     * Reads a mono 16-bit PCM WAV file as written by writeWavFile.
+     * Chunks other than "fmt " and "data" are skipped.
+     * @return The samples and the sample rate
+     */
+    fun readWavFile(file: File): Pair<ShortArray, Int> {
+        val buffer = ByteBuffer.wrap(file.readBytes()).order(ByteOrder.LITTLE_ENDIAN)
+        if (buffer.remaining() < 12 || chunkId(buffer, 0) != "RIFF" || chunkId(buffer, 8) != "WAVE") {
+            throw IOException("Not a WAV file: ${file.name}")
+        }
+
+        var sampleRate = 0
+        var position = 12
+        while (position + 8 <= buffer.limit()) {
+            val id = chunkId(buffer, position)
+            val size = buffer.getInt(position + 4)
+            val body = position + 8
+            if (size < 0 || body + size > buffer.limit()) break
+
+            when (id) {
+                "fmt " -> {
+                    val format = buffer.getShort(body).toInt()
+                    val channels = buffer.getShort(body + 2).toInt()
+                    val bits = buffer.getShort(body + 14).toInt()
+                    if (format != 1 || channels != 1 || bits != 16) {
+                        throw IOException("Unsupported WAV format in ${file.name}: " +
+                                "format $format, $channels channels, $bits bits")
+                    }
+                    sampleRate = buffer.getInt(body + 4)
+                }
+                "data" -> {
+                    if (sampleRate == 0) throw IOException("WAV data before fmt in ${file.name}")
+                    val samples = ShortArray(size / 2)
+                    buffer.position(body)
+                    buffer.asShortBuffer().get(samples)
+                    return Pair(samples, sampleRate)
+                }
+            }
+            // Chunks are padded to an even size
+            position = body + size + (size and 1)
+        }
+        throw IOException("No PCM data in ${file.name}")
+    }
+
+    private fun chunkId(buffer: ByteBuffer, offset: Int): String {
+        return String(ByteArray(4) { buffer.get(offset + it) }, Charsets.US_ASCII)
+    }
+
     private fun intToLittleEndian(value: Int): ByteArray {
         return byteArrayOf(
             (value and 0xFF).toByte(),
@@ -11,12 +11,11 @@ import androidx.core.app.ActivityCompat
 import com.juliejohnson.voicegenderpavlok.R
 import com.juliejohnson.voicegenderpavlok.audio.AudioFeatures
 import com.juliejohnson.voicegenderpavlok.audio.EssentiaAnalyzer
+import com.juliejohnson.voicegenderpavlok.audio.EssentiaStream
+import com.juliejohnson.voicegenderpavlok.audio.FeatureSet
 import com.juliejohnson.voicegenderpavlok.ml.VoiceProfile
 import com.juliejohnson.voicegenderpavlok.storage.SessionStorage
 import com.juliejohnson.voicegenderpavlok.utils.VADManager
-import kotlinx.coroutines.CoroutineScope
-import kotlinx.coroutines.Dispatchers
-import kotlinx.coroutines.launch
 import java.io.ByteArrayOutputStream
 
 class AnalysisActivity : AppCompatActivity() {
@@ -31,14 +30,22 @@ class AnalysisActivity : AppCompatActivity() {
 
     // Analysis Engine
     private lateinit var essentiaAnalyzer: EssentiaAnalyzer
-    private val analysisScope = CoroutineScope(Dispatchers.Default)
+    private var analysisSampleRate = 16000
+
+    // Continuous session over every captured chunk, pushed and pulled on the
+    // capture coroutine; closed under the lock when listening stops
+    private val streamLock = Any()
+    private var analysisStream: EssentiaStream? = null
+    @Volatile
+    private var samplesPushed = 0L
 
     // Session Recording State
     private var isSessionRecording = false
     private lateinit var audioSessionStream: ByteArrayOutputStream
     private val analysisSessionData = mutableListOf<VoiceProfile>()
-    // --- NEW: Add a variable to store the session start time ---
-    private var sessionStartTime: Long = 0L
+    // Stream position when the session started; recorded frames are timed from here
+    @Volatile
+    private var sessionStartSample: Long = 0L
 
     private val permissionsRequestCode = 101
 
@@ -57,9 +64,18 @@ class AnalysisActivity : AppCompatActivity() {
         startRecButton.setOnClickListener { startSessionRecording() }
         stopRecButton.setOnClickListener { stopSessionRecording() }
 
-        essentiaAnalyzer = EssentiaAnalyzer()
-        essentiaAnalyzer.initialize()
         VADManager.initialize(applicationContext)
+        essentiaAnalyzer = EssentiaAnalyzer()
+        // Analyze at the rate the VAD records at. Only pitch, F1/F2 and HNR
+        // are displayed or recorded, all of which fit in the voice band.
+        analysisSampleRate = VADManager.getSampleRate().takeIf { it > 0 } ?: 16000
+        essentiaAnalyzer.initialize(
+            sampleRate = analysisSampleRate,
+            features = FeatureSet.PITCH or FeatureSet.FORMANTS or FeatureSet.HNR,
+            voiceBand = true
+        )
+        // The stream sees consecutive hops, so the pitch track can carry over
+        essentiaAnalyzer.setPitchTracking(true)
     }
 
     override fun onResume() {
@@ -73,20 +89,28 @@ class AnalysisActivity : AppCompatActivity() {
 
     override fun onPause() {
         super.onPause()
+        // Stream first: a chunk still in flight then finds it closed before
+        // the VAD it reads is gone
+        closeStream()
         VADManager.stop()
     }
 
+    override fun onDestroy() {
+        super.onDestroy()
+        closeStream()
+        essentiaAnalyzer.cleanup()
+    }
+
     private fun startVADListening() {
+        synchronized(streamLock) {
+            analysisStream?.close()
+            analysisStream = essentiaAnalyzer.createStream()
+            samplesPushed = 0L
+        }
         VADManager.startListening(
-            onSpeechDetected = {
-                analysisScope.launch {
-                    val speechChunk = VADManager.getRecentAudio()
-                    if (speechChunk.isNotEmpty()) {
-                        analyzeChunk(speechChunk)
-                    }
-                }
-            },
+            onSpeechDetected = {},
             onRawAudio = { rawChunk ->
+                analyzeChunk(rawChunk)
                 if (isSessionRecording) {
                     val byteBuffer = ByteArray(rawChunk.size * 2)
                     for (i in rawChunk.indices) {
@@ -99,24 +123,46 @@ class AnalysisActivity : AppCompatActivity() {
         )
     }
 
-    private fun analyzeChunk(audioBuffer: FloatArray) {
-        val features = essentiaAnalyzer.analyzeFrame(audioBuffer)
-        features?.let {
+    private fun closeStream() {
+        synchronized(streamLock) {
+            analysisStream?.close()
+            analysisStream = null
+        }
+    }
+
+    /**
+     * Push one captured chunk into the stream and handle every hop it
+     * completes. Frames count only while the VAD reports speech, as the
+     * snapshot analysis this replaces only ran on speech.
+     */
+    private fun analyzeChunk(chunk: ShortArray) {
+        var speech = false
+        val frames = synchronized(streamLock) {
+            val stream = analysisStream ?: return
+            stream.pushPcm16(chunk)
+            samplesPushed += chunk.size
+            speech = VADManager.vadStatus.value
+            stream.pullAll()
+        }
+        var latest: AudioFeatures? = null
+        for (frame in frames) {
+            val features = frame.features
+            if (!speech || !features.isValid) continue
 
-            if (isSessionRecording) {
-                // --- MODIFIED: Calculate elapsed time relative to the session start ---
-                val elapsedTimeMs = System.currentTimeMillis() - sessionStartTime
+            if (isSessionRecording && frame.sampleIndex >= sessionStartSample) {
+                val elapsedTimeMs = (frame.sampleIndex - sessionStartSample) * 1000L / analysisSampleRate
                 analysisSessionData.add(
                     VoiceProfile(
-                        elapsedTimeMs, // Use the new relative timestamp
+                        elapsedTimeMs,
                         features.pitch,
                         features.formants.getOrNull(0) ?: 0f,
                         features.formants.getOrNull(1) ?: 0f
                     )
                 )
             }
-            updateUI(features)
+            latest = features
         }
+        latest?.let { updateUI(it) }
     }
 
     private fun updateUI(features: AudioFeatures) {
@@ -149,8 +195,7 @@ class AnalysisActivity : AppCompatActivity() {
     }
 
     private fun startSessionRecording() {
-        // --- NEW: Capture the start time when recording begins ---
-        sessionStartTime = System.currentTimeMillis()
+        sessionStartSample = samplesPushed
         audioSessionStream = ByteArrayOutputStream()
         analysisSessionData.clear()
         isSessionRecording = true
@@ -6,15 +6,25 @@ class CircularShortBuffer(private val capacity: Int) {
     private var isFull = false
 
     fun append(data: ShortArray) {
-        for (value in data) {
-            buffer[index] = value
-            index = (index + 1) % capacity
-            if (index == 0) isFull = true
+        // Only the last capacity samples can survive
+        var offset = maxOf(0, data.size - capacity)
+        while (offset < data.size) {
+            val length = minOf(data.size - offset, capacity - index)
+            System.arraycopy(data, offset, buffer, index, length)
+            offset += length
+            index += length
+            if (index == capacity) {
+                index = 0
+                isFull = true
+            }
         }
     }
 
     fun toArray(): ShortArray {
-        return if (!isFull) buffer.copyOfRange(0, index)
-        else buffer.copyOfRange(index, capacity) + buffer.copyOfRange(0, index)
+        if (!isFull) return buffer.copyOfRange(0, index)
+        val out = ShortArray(capacity)
+        System.arraycopy(buffer, index, out, 0, capacity - index)
+        System.arraycopy(buffer, 0, out, capacity - index, index)
+        return out
     }
 }
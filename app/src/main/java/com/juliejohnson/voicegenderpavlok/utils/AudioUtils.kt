@@ -39,6 +39,11 @@ object AudioUtils {
         return prepareAudio(normalized, length)
     }
 
+    /**
+     * 16-bit PCM to floats in [-1, 1), scaled by 1/32768 as the native PCM16 path does
+     */
+    fun pcm16ToFloat(pcm: ShortArray): FloatArray = FloatArray(pcm.size) { pcm[it] / 32768f }
+
     fun normalizeVolume(input: FloatArray): FloatArray {
         val max = input.maxOfOrNull { abs(it) } ?: 1f
         return if (max < 0.01f) input else input.map { it / max }.toFloatArray()
@@ -24,6 +24,10 @@ object VADManager {
         return vadUtils?.getRecentAudio() ?: FloatArray(0)
     }
 
+    fun getRecentAudioPcm16(): ShortArray {
+        return vadUtils?.getRecentAudioPcm16() ?: ShortArray(0)
+    }
+
     fun getSampleRate(): Int {
         return vadUtils?.getSampleRate() ?: 0
     }
@@ -3,6 +3,7 @@ package com.juliejohnson.voicegenderpavlok.utils
 import android.content.Context
 import android.media.*
 import android.util.Log
+import com.juliejohnson.voicegenderpavlok.audio.PcmRing
 import com.juliejohnson.voicegenderpavlok.ui.CircularShortBuffer
 import com.konovalov.vad.silero.Vad
 import com.konovalov.vad.silero.VadSilero
@@ -43,6 +44,10 @@ class VADUtils(context: Context) {
     private val buffer = ShortArray(CHUNK_SIZE)
     private val audioHistory = CircularShortBuffer(16000) // ~1 sec of history
 
+    // Optional ring feeding a native analyzer; every captured chunk is written into it once
+    @Volatile
+    private var captureRing: PcmRing? = null
+
     private val _vadStatus = MutableStateFlow(false)
     val vadStatus: StateFlow<Boolean> get() = _vadStatus
 
@@ -76,6 +81,7 @@ class VADUtils(context: Context) {
                 if (read > 0) {
                     val currentChunk = buffer.copyOf(read)
                     audioHistory.append(currentChunk)
+                    captureRing?.write(buffer, 0, read)
 
                     // --- NEW: Pass the raw audio chunk to our new callback ---
                     onRawAudio(currentChunk)
@@ -92,7 +98,24 @@ class VADUtils(context: Context) {
     }
 
     fun getRecentAudio(): FloatArray {
-        return audioHistory.toArray().map { it.toFloat() / Short.MAX_VALUE }.toFloatArray()
+        return AudioUtils.pcm16ToFloat(audioHistory.toArray())
+    }
+
+    /**
+     * Recent audio as raw 16-bit PCM, for analyzers that convert natively
+     */
+    fun getRecentAudioPcm16(): ShortArray {
+        return audioHistory.toArray()
+    }
+
+    /**
+     * Also write every captured chunk into a 16-bit ring, for an analyzer
+     * draining it with EssentiaAnalyzer.analyzeRing on another thread.
+     * Pass null to stop. The ring must stay open until detached.
+     */
+    fun attachRing(ring: PcmRing?) {
+        require(ring == null || !ring.floatSamples) { "Capture ring must hold 16-bit samples" }
+        captureRing = ring
     }
 
     fun getSampleRate(): Int {